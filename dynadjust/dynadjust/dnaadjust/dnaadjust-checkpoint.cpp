@@ -0,0 +1,527 @@
+//============================================================================
+// Name         : dnaadjust-checkpoint.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust Network Adjustment (checkpoint, resume and warm start) library
+//============================================================================
+
+#include <dynadjust/dnaadjust/dnaadjust.hpp>
+
+namespace dynadjust {
+namespace networkadjust {
+
+namespace {
+
+// Identifies a checkpoint file
+const char checkpoint_file_magic[8] = { 'D', 'N', 'A', 'C', 'H', 'K', 'P', 'T' };
+
+// Writes a checkpoint to a temporary file, which then replaces the previous
+// checkpoint.  Hence, the checkpoint on disk is always that of a completed
+// iteration, even if the adjustment is interrupted whilst it is written.
+void WriteCheckpointFile(const std::string& filePath, const std::string& checkpoint)
+{
+	const std::string tmpPath(filePath + ".tmp");
+	{
+		std::ofstream checkpoint_file(tmpPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		checkpoint_file.write(checkpoint.data(), static_cast<std::streamsize>(checkpoint.size()));
+		checkpoint_file.close();
+		if (!checkpoint_file)
+			throw std::runtime_error("WriteCheckpointFile(): Could not write " + leafStr<std::string>(tmpPath) + ".");
+	}
+	std::filesystem::rename(tmpPath, filePath);
+}
+
+// Reads a matrix written by operator<< from a checkpoint, i.e. its type,
+// dimensions and padding, followed by the elements and the position of the
+// largest element.  Returns false if the checkpoint is incomplete.
+bool ReadCheckpointMatrix(const std::string& checkpoint, std::size_t& offset, matrix_2d& matrix)
+{
+	const std::size_t header(6 * sizeof(UINT32));
+	if (offset + header > checkpoint.size())
+		return false;
+
+	const UINT32* dimensions(reinterpret_cast<const UINT32*>(checkpoint.data() + offset));
+	if (dimensions[0] != mtx_full)
+		return false;
+
+	const std::size_t size(header +
+		static_cast<std::size_t>(dimensions[3]) * dimensions[4] * sizeof(double) + 2 * sizeof(UINT32));
+	if (offset + size > checkpoint.size())
+		return false;
+
+	matrix.ReadMappedFileRegion(const_cast<char*>(checkpoint.data() + offset));
+	offset += size;
+	return true;
+}
+
+// Cartesian coordinates of a station, as printed in a coordinate output file
+typedef std::pair<std::string, std::array<double, 3> > warm_start_coordinate;
+
+// Reads the cartesian coordinates of each station from a coordinate output
+// file (.xyz).  The X, Y and Z columns are located from the column headings,
+// which are right aligned with the values beneath.  Lines that cannot be read
+// (such as block headings) are skipped.
+void ReadWarmStartCoordinateFile(const std::string& filePath, const std::string& referenceFrame,
+	std::vector<warm_start_coordinate>& coordinates)
+{
+	std::ifstream xyz_file(filePath.c_str());
+	if (!xyz_file)
+		throw std::runtime_error("  Could not open " + filePath + ".");
+
+	std::string record, frame;
+	std::size_t column_end[3] = { 0, 0, 0 };
+	bool columns(false);
+
+	while (std::getline(xyz_file, record))
+	{
+		if (record.compare(0, 16, "Reference frame:") == 0)
+		{
+			frame = trimstr(record.substr(16));
+			continue;
+		}
+
+		// Column headings
+		if (record.compare(0, 7, "Station") == 0 && record.find("Const") == STATION)
+		{
+			std::size_t start(0), end(0);
+			while ((start = record.find_first_not_of(' ', end)) != std::string::npos)
+			{
+				if ((end = record.find(' ', start)) == std::string::npos)
+					end = record.length();
+				const std::string heading(trimstr(record.substr(start, end - start)));
+				if (heading == "X")
+					column_end[0] = end;
+				else if (heading == "Y")
+					column_end[1] = end;
+				else if (heading == "Z")
+					column_end[2] = end;
+			}
+
+			if (column_end[0] == 0 || column_end[1] == 0 || column_end[2] == 0)
+				throw std::runtime_error("  " + leafStr<std::string>(filePath) +
+					" does not contain cartesian coordinates.\n  Print the coordinates of the previous adjustment with --" +
+					OUTPUT_STN_COORD_TYPES + " including XYZ.");
+			columns = true;
+			continue;
+		}
+
+		if (!columns || record.length() < *std::max_element(column_end, column_end + 3))
+			continue;
+
+		warm_start_coordinate coordinate;
+		coordinate.first = trimstr(record.substr(0, STATION));
+		if (coordinate.first.empty())
+			continue;
+
+		try {
+			for (UINT32 i(0); i < 3; ++i)
+				coordinate.second[i] = std::stod(record.substr(column_end[i] - XYZ, XYZ));
+		}
+		catch (const std::logic_error&) {
+			continue;
+		}
+		coordinates.push_back(coordinate);
+	}
+
+	if (!frame.empty() && frame != referenceFrame)
+		throw std::runtime_error("  The coordinates in " + leafStr<std::string>(filePath) +
+			" are on " + frame + ", whereas the network is on " + referenceFrame + ".");
+}
+
+}	// namespace
+
+
+std::string dna_adjust::CheckpointFilePath() const
+{
+	std::stringstream ss;
+	ss << projectSettings_.g.output_folder << FOLDER_SLASH << projectSettings_.g.network_name << "-checkpoint.mtx";
+	return ss.str();
+}
+
+
+// Is a checkpoint to be recorded on completion of the current iteration?
+// Checkpoints are written only when requested (--checkpoint-interval).
+bool dna_adjust::CheckpointDue() const
+{
+	if (projectSettings_.a.checkpoint_interval == 0 || projectSettings_.a.report_mode)
+		return false;
+	return CurrentIteration() % projectSettings_.a.checkpoint_interval == 0;
+}
+
+
+// Copies the station estimates of a staged block as it is offloaded, so 
+// that staged blocks need not be read again to record a checkpoint.  The
+// last copy made in an iteration holds the block's final estimates.
+void dna_adjust::RecordCheckpointBlock(const UINT32& block)
+{
+	if (!CheckpointDue())
+		return;
+
+	if (v_checkpointStations_.size() != blockCount_ * 3)
+		v_checkpointStations_.resize(blockCount_ * 3);
+
+	v_checkpointStations_.at(block * 3) = v_estimatedStations_.at(block);
+	v_checkpointStations_.at(block * 3 + 1) = v_originalStations_.at(block);
+	if (projectSettings_.a.adjust_mode != SimultaneousMode)
+		v_checkpointStations_.at(block * 3 + 2) = v_rigorousStations_.at(block);
+}
+
+
+// Records the estimates on completion of an iteration, so that the
+// adjustment may be resumed from the next iteration.  The estimates held
+// in memory are copied before the next iteration updates them (or, for
+// staged blocks, were copied as each block was offloaded), and the copy
+// is formatted and written to disk in the background whilst the 
+// adjustment continues.  No statistics are recorded, since those of an
+// adjustment (sigma zero, chi-square, n-statistics and so on) are formed
+// afresh from the measurements and estimates of the last iteration.
+void dna_adjust::CheckpointIteration()
+{
+	if (!CheckpointDue())
+		return;
+
+	checkpointHeader_._iteration = CurrentIteration();
+	checkpointHeader_._maxCorrection = maxCorr_;
+
+	// Geographic coordinates of each station
+	const std::shared_ptr<vdouble> coordinates(std::make_shared<vdouble>());
+	coordinates->reserve(bstBinaryRecords_.size() * 3);
+	for (const auto& stn : bstBinaryRecords_)
+	{
+		coordinates->push_back(stn.currentLatitude);
+		coordinates->push_back(stn.currentLongitude);
+		coordinates->push_back(stn.currentHeight);
+	}
+
+	// Station estimates of each block.  Rigorous estimates are formed by
+	// phased adjustments only.  The junction station estimates are carried 
+	// forward from these on the next iteration, so need not be recorded.
+	const bool phased(projectSettings_.a.adjust_mode != SimultaneousMode);
+	const std::shared_ptr<v_mat_2d> stations(std::make_shared<v_mat_2d>());
+
+	if (projectSettings_.a.stage)
+	{
+		// A block which was not offloaded on this iteration has no copy.
+		// The copies of the other blocks are discarded, so that they are
+		// not mistaken for those of a later iteration.
+		bool copied(v_checkpointStations_.size() == blockCount_ * 3);
+		for (UINT32 block(0); copied && block<blockCount_; ++block)
+			copied = v_checkpointStations_.at(block * 3).rows() > 0;
+		if (!copied)
+		{
+			v_checkpointStations_.clear();
+			adj_file << "- Warning: A checkpoint could not be recorded on iteration " << checkpointHeader_._iteration << 
+				", since the estimates" << std::endl << "  of one or more staged blocks were not offloaded." << std::endl;
+			return;
+		}
+		stations->swap(v_checkpointStations_);
+	}
+	else
+	{
+		stations->resize(blockCount_ * 3);
+		for (UINT32 block(0); block<blockCount_; ++block)
+		{
+			stations->at(block * 3) = v_estimatedStations_.at(block);
+			stations->at(block * 3 + 1) = v_originalStations_.at(block);
+			if (phased)
+				stations->at(block * 3 + 2) = v_rigorousStations_.at(block);
+		}
+	}
+
+	const std::string filePath(CheckpointFilePath());
+	const checkpointHeader_t header(checkpointHeader_);
+
+	// Waits for the checkpoint of the previous iteration (if any) to be
+	// written.  A checkpoint that cannot be written does not prevent the
+	// adjustment from continuing.
+	try {
+		checkpointIO_.submit(checkpointHeader_._iteration, [filePath, header, coordinates, stations, phased]() {
+			std::ostringstream checkpoint(std::ios::out | std::ios::binary);
+			checkpoint.write(reinterpret_cast<const char*>(&header), sizeof(checkpointHeader_t));
+			checkpoint.write(reinterpret_cast<const char*>(coordinates->data()), 
+				static_cast<std::streamsize>(coordinates->size() * sizeof(double)));
+
+			for (std::size_t block(0); block<stations->size() / 3; ++block)
+			{
+				checkpoint << stations->at(block * 3) << stations->at(block * 3 + 1);
+				if (phased)
+					checkpoint << stations->at(block * 3 + 2);
+			}
+
+			WriteCheckpointFile(filePath, checkpoint.str());
+		});
+	}
+	catch (const std::exception& e) {
+		adj_file << "- Warning: The checkpoint of the previous iteration could not be written." << std::endl <<
+			"  " << e.what() << std::endl;
+	}
+}
+
+
+// Restores the estimates recorded by the checkpoint of a previous
+// adjustment, and updates the normals and measured minus computed
+// vectors for the next iteration.  Returns the number of iterations
+// completed, from which the adjustment continues.  The checkpoint must
+// have been created from the network as it is currently imported,
+// segmented and ordered.
+UINT32 dna_adjust::ResumeAdjustment()
+{
+	if (projectSettings_.a.report_mode)
+		return 0;
+
+	// Header of the checkpoints written by this adjustment
+	checkpointHeader_ = checkpointHeader_t();
+	memcpy(checkpointHeader_._magic, checkpoint_file_magic, sizeof(checkpointHeader_._magic));
+	checkpointHeader_._version = CHECKPOINT_FILE_VERSION;
+	checkpointHeader_._adjustMode = projectSettings_.a.adjust_mode;
+	checkpointHeader_._blockCount = blockCount_;
+	checkpointHeader_._stationCount = bstBinaryRecords_.size();
+	checkpointHeader_._fingerprint = NetworkFingerprint();
+
+	if (!projectSettings_.a.resume)
+		return 0;
+
+	const std::string filePath(CheckpointFilePath());
+	if (!std::filesystem::exists(filePath))
+	{
+		adj_file << "- Warning: There is no checkpoint from which to resume the adjustment." << std::endl <<
+			"  The adjustment will commence from the a-priori station estimates." << std::endl << std::endl;
+		return 0;
+	}
+
+	std::string checkpoint;
+	checkpoint.resize(static_cast<std::size_t>(std::filesystem::file_size(filePath)));
+	std::ifstream checkpoint_file(filePath.c_str(), std::ios::in | std::ios::binary);
+	checkpoint_file.read(&checkpoint[0], static_cast<std::streamsize>(checkpoint.size()));
+
+	checkpointHeader_t header;
+	std::size_t offset(sizeof(checkpointHeader_t));
+	std::string reason, remedy("without the --" + std::string(RESUME_ADJUSTMENT) + " option.");
+
+	if (!checkpoint_file || checkpoint.size() < sizeof(checkpointHeader_t))
+		reason = "is incomplete or is not a checkpoint file.";
+	else
+	{
+		memcpy(&header, checkpoint.data(), sizeof(checkpointHeader_t));
+
+		if (memcmp(header._magic, checkpoint_file_magic, sizeof(header._magic)) != 0)
+			reason = "is incomplete or is not a checkpoint file.";
+		else if (header._version != CHECKPOINT_FILE_VERSION)
+			reason = "was created by a different version of adjust.";
+		else if (header._adjustMode != checkpointHeader_._adjustMode)
+			reason = "was created by an adjustment in a different mode.";
+		else if (header._blockCount != checkpointHeader_._blockCount ||
+			header._stationCount != checkpointHeader_._stationCount ||
+			header._fingerprint != checkpointHeader_._fingerprint)
+			reason = "was not created from the network as\n  it is currently imported, segmented and ordered.";
+		else if (header._iteration >= projectSettings_.a.max_iterations)
+		{
+			reason = "was written on iteration " + StringFromT(header._iteration) + ".";
+			remedy = "with a value for --" + std::string(MAX_ITERATIONS) + " greater than " + StringFromT(header._iteration) + ".";
+		}
+		else if (offset + header._stationCount * 3 * sizeof(double) > checkpoint.size())
+			reason = "is incomplete or is not a checkpoint file.";
+	}
+
+	// Station estimates of each block
+	const bool phased(projectSettings_.a.adjust_mode != SimultaneousMode);
+	v_mat_2d estimatedStations(blockCount_), originalStations(blockCount_), rigorousStations(blockCount_);
+	if (reason.empty())
+	{
+		offset += header._stationCount * 3 * sizeof(double);
+		for (UINT32 block(0); block<blockCount_; ++block)
+		{
+			if (!ReadCheckpointMatrix(checkpoint, offset, estimatedStations.at(block)) ||
+				!ReadCheckpointMatrix(checkpoint, offset, originalStations.at(block)) ||
+				(phased && !ReadCheckpointMatrix(checkpoint, offset, rigorousStations.at(block))))
+			{
+				reason = "is incomplete or is not a checkpoint file.";
+				break;
+			}
+		}
+	}
+
+	if (!reason.empty())
+	{
+		std::stringstream ss;
+		ss << "ResumeAdjustment(): The checkpoint file " << leafStr<std::string>(filePath) << " " << reason << std::endl << std::endl;
+		ss << "  Please re-run the adjustment " << remedy << std::endl;
+		adj_file << std::endl << "- Error: " << ss.str() << std::endl;
+		SignalExceptionAdjustment(ss.str(), 0);
+	}
+
+	// Geographic coordinates of each station
+	const double* coordinates(reinterpret_cast<const double*>(checkpoint.data() + sizeof(checkpointHeader_t)));
+	for (auto& stn : bstBinaryRecords_)
+	{
+		stn.currentLatitude = *coordinates++;
+		stn.currentLongitude = *coordinates++;
+		stn.currentHeight = *coordinates++;
+	}
+
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		if (projectSettings_.a.stage)
+			DeserialiseBlockFromMappedFile(block, 3,
+				sf_estimated_stns, sf_original_stns, sf_rigorous_stns);
+
+		if (estimatedStations.at(block).rows() != v_estimatedStations_.at(block).rows() ||
+			originalStations.at(block).rows() != v_originalStations_.at(block).rows() ||
+			(phased && rigorousStations.at(block).rows() != v_rigorousStations_.at(block).rows()))
+		{
+			std::stringstream ss;
+			ss << "ResumeAdjustment(): The station estimates of block " << block + 1 << " in the checkpoint file" << std::endl <<
+				"  " << leafStr<std::string>(filePath) << " do not match the network as it is currently" << std::endl <<
+				"  segmented." << std::endl << std::endl;
+			ss << "  Please re-run the adjustment without the --" << RESUME_ADJUSTMENT << " option." << std::endl;
+			adj_file << std::endl << "- Error: " << ss.str() << std::endl;
+			SignalExceptionAdjustment(ss.str(), 0);
+		}
+
+		v_estimatedStations_.at(block) = estimatedStations.at(block);
+		v_originalStations_.at(block) = originalStations.at(block);
+		if (phased)
+			v_rigorousStations_.at(block) = rigorousStations.at(block);
+
+		if (projectSettings_.a.stage)
+		{
+			SerialiseBlockToMappedFile(block, 3,
+				sf_estimated_stns, sf_original_stns, sf_rigorous_stns);
+			UnloadBlock(block, 3,
+				sf_estimated_stns, sf_original_stns, sf_rigorous_stns);
+		}
+	}
+
+	// The largest corrections of the completed iterations are not
+	// reported again
+	for (UINT32 i(0); i<header._iteration; ++i)
+		iterationCorrections_.add_message("");
+
+	initialiseIteration(header._iteration);
+	maxCorr_ = header._maxCorrection;
+
+	adj_file << "+ Resuming adjustment from the checkpoint of iteration " << header._iteration << std::endl;
+
+	// Update normals and measured-computed matrices for the next iteration
+	UpdateAdjustment(true);
+
+	return header._iteration;
+}
+
+
+// Waits for the checkpoint of the last iteration to be written.  Once an
+// adjustment has converged, the checkpoint is no longer needed and is
+// removed.  Otherwise, the checkpoint is retained so that the adjustment
+// may be resumed.
+void dna_adjust::FinaliseCheckpoint()
+{
+	if (projectSettings_.a.report_mode ||
+		projectSettings_.a.adjust_mode == Phased_Block_1Mode)
+		return;
+
+	try {
+		checkpointIO_.wait_all();
+	}
+	catch (const std::exception& e) {
+		adj_file << "- Warning: The checkpoint of the last iteration could not be written." << std::endl <<
+			"  " << e.what() << std::endl;
+	}
+
+	if (adjustStatus_ != ADJUST_SUCCESS)
+		return;
+
+	std::error_code ec;
+	std::filesystem::remove(CheckpointFilePath(), ec);
+}
+
+
+// Initialises the free stations from the coordinates of a previous
+// adjustment, so that an adjustment of a network which has changed little
+// (for instance, by the addition of a few measurements) converges in fewer
+// iterations.  Constrained stations retain their coordinates, and station
+// corrections remain relative to the imported coordinates.
+void dna_adjust::LoadWarmStartCoordinates()
+{
+	if (projectSettings_.a.warm_start_file.empty() || projectSettings_.a.report_mode)
+		return;
+
+	const std::string& filePath(projectSettings_.a.warm_start_file);
+	adj_file << "+ Loading warm start coordinates from " << leafStr<std::string>(filePath) << std::endl;
+
+	std::vector<warm_start_coordinate> coordinates;
+
+	try {
+		if (std::filesystem::path(filePath).extension() == ".bst")
+		{
+			// A binary station file, as updated by a previous adjustment
+			BstFile bst;
+			vstn_t bstRecords;
+			binary_file_meta_t bstMeta;
+			bst.LoadFile(filePath, &bstRecords, bstMeta);
+
+			if (strcmp(bstMeta.epsgCode, bst_meta_.epsgCode) != 0)
+				throw std::runtime_error("  The stations in " + leafStr<std::string>(filePath) +
+					" are on a different reference frame to the network.");
+
+			coordinates.reserve(bstRecords.size());
+			for (const auto& stn : bstRecords)
+			{
+				warm_start_coordinate coordinate;
+				coordinate.first = stn.stationName;
+				GeoToCart<double>(stn.currentLatitude, stn.currentLongitude, stn.currentHeight,
+					&coordinate.second[0], &coordinate.second[1], &coordinate.second[2], datum_.GetEllipsoidRef());
+				coordinates.push_back(coordinate);
+			}
+		}
+		else
+			ReadWarmStartCoordinateFile(filePath, datum_.GetName(), coordinates);
+	}
+	catch (const std::exception& e) {
+		SignalExceptionAdjustment(std::string("LoadWarmStartCoordinates(): Could not load the warm start coordinates.\n") + 
+			e.what(), 0);
+	}
+
+	v_string_uint32_pair vStnsMap;
+	if (projectSettings_.a.map_file.empty())
+		projectSettings_.a.map_file = projectSettings_.g.input_folder + FOLDER_SLASH + projectSettings_.g.network_name + ".map";
+	LoadStationMap(&vStnsMap, projectSettings_.a.map_file);
+
+	UINT32 seeded(0);
+	it_pair_string_vUINT32 it_stnmap_range;
+
+	for (const auto& coordinate : coordinates)
+	{
+		// Stations not in this network are ignored
+		it_stnmap_range = equal_range(vStnsMap.begin(), vStnsMap.end(), coordinate.first, StationNameIDCompareName());
+		if (it_stnmap_range.first == it_stnmap_range.second)
+			continue;
+
+		station_t& stn(bstBinaryRecords_.at(it_stnmap_range.first->second));
+		if (strncmp(stn.stationConst, "FFF", 3) != 0)
+			continue;
+
+		CartToGeo<double>(coordinate.second[0], coordinate.second[1], coordinate.second[2],
+			&stn.currentLatitude, &stn.currentLongitude, &stn.currentHeight, datum_.GetEllipsoidRef());
+		++seeded;
+	}
+
+	adj_file << "  Initialised " << seeded << " of " << bstBinaryRecords_.size() << " stations." << std::endl;
+}
+
+
+}	// namespace networkadjust
+}	// namespace dynadjust
@@ -0,0 +1,332 @@
+//============================================================================
+// Name         : dnaadjust-gnssinverse.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust Network Adjustment (GNSS inverse variance matrices) library
+//============================================================================
+
+#include <dynadjust/dnaadjust/dnaadjust.hpp>
+
+namespace dynadjust {
+namespace networkadjust {
+
+namespace {
+
+// Identifies a GNSS inverse file
+const char gnss_inverse_file_magic[8] = { 'D', 'N', 'A', 'G', 'N', 'S', 'S', 'I' };
+
+// No inverse is held for the record
+const UINT32 NO_GNSS_INVERSE(UINT_MAX);
+
+// Number of binary records of the GNSS baseline or cluster commencing at
+// start, being three for each baseline or point and three for each of its
+// covariances
+UINT32 GnssRecordCount(const vmsr_t& msrs, const UINT32& start)
+{
+	UINT32 end(start);
+	for (UINT32 v(0); v<msrs.at(start).vectorCount1 && end<msrs.size(); ++v)
+		end += 3 + msrs.at(end).vectorCount2 * 3;
+	return end - start;
+}
+
+}	// namespace
+
+
+std::string dna_adjust::GnssInverseFilePath() const
+{
+	std::filesystem::path bmsPath(projectSettings_.a.bms_file);
+	return bmsPath.replace_extension().string() + "-gnss-inverses.mtx";
+}
+
+
+// 64-bit FNV-1a hash (as for IncrementalKey) of the variances, covariances
+// and scalars of the GNSS baseline or cluster commencing at record.  Since
+// the variances are scaled when the records are reduced, the key identifies
+// the cluster and the scaling from which its inverse was formed.
+std::uint64_t dna_adjust::GnssInverseKey(const UINT32& record) const
+{
+	std::uint64_t hash(14695981039346656037ULL);
+	auto add = [&hash](const void* data, const std::size_t& size) {
+		const unsigned char* bytes(static_cast<const unsigned char*>(data));
+		for (std::size_t i(0); i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	const UINT32 end(record + GnssRecordCount(bmsBinaryRecords_, record));
+	for (UINT32 r(record); r<end; ++r)
+	{
+		const measurement_t& rec(bmsBinaryRecords_.at(r));
+		add(&rec.measType, sizeof(rec.measType));
+		add(&rec.clusterID, sizeof(rec.clusterID));
+		add(&rec.vectorCount1, sizeof(rec.vectorCount1));
+		add(&rec.vectorCount2, sizeof(rec.vectorCount2));
+		add(&rec.term1, sizeof(rec.term1));
+		add(&rec.term2, sizeof(rec.term2));
+		add(&rec.term3, sizeof(rec.term3));
+		add(&rec.term4, sizeof(rec.term4));
+		add(&rec.scale1, sizeof(rec.scale1));
+		add(&rec.scale2, sizeof(rec.scale2));
+		add(&rec.scale3, sizeof(rec.scale3));
+		add(&rec.scale4, sizeof(rec.scale4));
+	}
+	return hash;
+}
+
+
+// Indexes the first binary record of each GNSS baseline and cluster, so
+// that the inverse of its variance matrix need only be formed once the
+// records have been reduced.  The inverses recorded by a previous
+// adjustment are then restored.  No inverses are retained if they are 
+// to be discarded.
+void dna_adjust::FormGnssInverseIndex()
+{
+	const UINT32 recordCount(static_cast<UINT32>(bmsBinaryRecords_.size()));
+	UINT32 r(0), slots(0);
+
+	gnssInverseBytes_ = 0;
+	gnssInverseReused_ = 0;
+
+	if (projectSettings_.a.discard_gnss_inverses)
+	{
+		v_gnssInverseSlot_.clear();
+		v_gnssInverses_.clear();
+		gnssInverseFormed_.reset();
+		return;
+	}
+
+	v_gnssInverseSlot_.assign(recordCount, NO_GNSS_INVERSE);
+	while (r < recordCount)
+	{
+		switch (bmsBinaryRecords_.at(r).measType)
+		{
+		case 'G':	// GPS Baseline
+		case 'X':	// GPS Baseline cluster
+		case 'Y':	// GPS Point cluster
+			v_gnssInverseSlot_.at(r) = slots++;
+			r += std::max(GnssRecordCount(bmsBinaryRecords_, r), UINT32(1));
+			break;
+		default:
+			++r;
+		}
+	}
+
+	v_gnssInverses_.assign(slots, matrix_2d());
+	gnssInverseFormed_.reset(new std::atomic<bool>[slots]);
+	for (UINT32 slot(0); slot<slots; ++slot)
+		gnssInverseFormed_[slot].store(false, std::memory_order_relaxed);
+
+	if (projectSettings_.a.persist_gnss_inverses && bms_meta_.reduced)
+		LoadGnssInverses();
+}
+
+
+// Copies the inverse variance matrix of the GNSS baseline or cluster
+// commencing at _it_msr if it has been formed.  Otherwise, returns false
+// and the slot in which it is to be retained.
+bool dna_adjust::FindGnssInverse(const it_vmsr_t& _it_msr, matrix_2d* vmat, UINT32& slot)
+{
+	slot = NO_GNSS_INVERSE;
+
+	// Only the binary records of this adjustment are indexed
+	const measurement_t* record(&(*_it_msr));
+	if (bmsBinaryRecords_.empty() ||
+		std::less<const measurement_t*>()(record, bmsBinaryRecords_.data()) ||
+		!std::less<const measurement_t*>()(record, bmsBinaryRecords_.data() + v_gnssInverseSlot_.size()))
+		return false;
+
+	slot = v_gnssInverseSlot_.at(record - bmsBinaryRecords_.data());
+	if (slot == NO_GNSS_INVERSE || !gnssInverseFormed_[slot].load(std::memory_order_acquire))
+		return false;
+
+	*vmat = v_gnssInverses_.at(slot);
+	++gnssInverseReused_;
+	return true;
+}
+
+
+// Retains an inverse formed by FormInverseGPSVarianceMatrix.  Where two
+// threads form the same inverse, the first is retained.  Inverses which 
+// would exceed the memory limit are not retained, and are formed again
+// each time they are needed.
+void dna_adjust::RetainGnssInverse(const UINT32& slot, const matrix_2d& vmat)
+{
+	if (slot == NO_GNSS_INVERSE)
+		return;
+
+	const std::size_t bytes(static_cast<std::size_t>(vmat.memRows()) * vmat.memColumns() * sizeof(double));
+
+	std::lock_guard<std::mutex> lock(gnssInverseMutex_);
+	if (gnssInverseFormed_[slot].load(std::memory_order_relaxed) || !GnssInverseFits(bytes))
+		return;
+
+	v_gnssInverses_.at(slot) = vmat;
+	gnssInverseBytes_ += bytes;
+	gnssInverseFormed_[slot].store(true, std::memory_order_release);
+}
+
+
+// Can an inverse of the given size be retained within the memory limit?
+bool dna_adjust::GnssInverseFits(const std::size_t& bytes) const
+{
+	if (projectSettings_.a.memory_limit <= 0)
+		return true;
+	return gnssInverseBytes_ + bytes <= 
+		static_cast<std::size_t>(projectSettings_.a.memory_limit * static_cast<double>(MEGABYTE_SIZE));
+}
+
+
+// Restores the inverses recorded by a previous adjustment of the binary
+// measurement file.  Inverses of baselines and clusters which have since
+// changed are discarded, and will be formed again.
+void dna_adjust::LoadGnssInverses()
+{
+	const std::string filePath(GnssInverseFilePath());
+	if (!std::filesystem::exists(filePath))
+		return;
+
+	std::ifstream gnss_file(filePath.c_str(), std::ios::in | std::ios::binary);
+	gnssInverseHeader_t header;
+	gnss_file.read(reinterpret_cast<char*>(&header), sizeof(gnssInverseHeader_t));
+
+	if (!gnss_file || memcmp(header._magic, gnss_inverse_file_magic, sizeof(header._magic)) != 0 ||
+		header._version != GNSS_INVERSE_FILE_VERSION ||
+		header._recordCount != bmsBinaryRecords_.size())
+	{
+		adj_file << "- Warning: The GNSS inverse file " << leafStr<std::string>(filePath) << " was not created from" << std::endl <<
+			"  the binary measurement file as it is currently imported.  The inverses will be re-formed." << std::endl << std::endl;
+		return;
+	}
+
+	UINT32 record, dimension, slot, row, col, restored(0);
+	std::uint64_t key;
+	vdouble elements;
+
+	for (std::uint64_t i(0); i<header._inverseCount; ++i)
+	{
+		gnss_file.read(reinterpret_cast<char*>(&record), sizeof(UINT32));
+		gnss_file.read(reinterpret_cast<char*>(&dimension), sizeof(UINT32));
+		gnss_file.read(reinterpret_cast<char*>(&key), sizeof(std::uint64_t));
+		if (!gnss_file || dimension > 3 * bmsBinaryRecords_.size())
+			break;
+
+		elements.resize(static_cast<std::size_t>(dimension) * dimension);
+		gnss_file.read(reinterpret_cast<char*>(elements.data()), elements.size() * sizeof(double));
+		if (!gnss_file)
+			break;
+
+		// Has the baseline or cluster changed?
+		if (record >= v_gnssInverseSlot_.size() ||
+			(slot = v_gnssInverseSlot_.at(record)) == NO_GNSS_INVERSE ||
+			dimension != bmsBinaryRecords_.at(record).vectorCount1 * 3 ||
+			key != GnssInverseKey(record) ||
+			!GnssInverseFits(elements.size() * sizeof(double)))
+			continue;
+
+		matrix_2d& inverse(v_gnssInverses_.at(slot));
+		inverse = matrix_2d(dimension, dimension);
+		for (row=0; row<dimension; ++row)
+			for (col=0; col<dimension; ++col)
+				inverse.put(row, col, elements.at(static_cast<std::size_t>(row) * dimension + col));
+		gnssInverseBytes_ += elements.size() * sizeof(double);
+		gnssInverseFormed_[slot].store(true, std::memory_order_relaxed);
+		++restored;
+	}
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "GNSS inverses: restored " << restored << " of " << v_gnssInverses_.size() <<
+			" from " << leafStr<std::string>(filePath) << std::endl;
+}
+
+
+// Records the inverses formed by this adjustment alongside the binary
+// measurement file, from which a later adjustment may restore them
+void dna_adjust::SaveGnssInverses()
+{
+	if (projectSettings_.g.verbose > 0)
+	{
+		UINT32 formed(0);
+		for (UINT32 slot(0); slot<v_gnssInverses_.size(); ++slot)
+			if (gnssInverseFormed_[slot].load(std::memory_order_acquire))
+				++formed;
+		debug_file << "GNSS inverses: " << formed << " of " << v_gnssInverses_.size() << " retained (" <<
+			std::fixed << std::setprecision(1) << gnssInverseBytes_ / 1048576.0 << " MB), reused " <<
+			gnssInverseReused_ << " times" << std::endl;
+	}
+
+	if (!projectSettings_.a.persist_gnss_inverses || projectSettings_.a.discard_gnss_inverses ||
+		projectSettings_.a.report_mode)
+		return;
+
+	gnssInverseHeader_t header;
+	memcpy(header._magic, gnss_inverse_file_magic, sizeof(header._magic));
+	header._version = GNSS_INVERSE_FILE_VERSION;
+	header._recordCount = bmsBinaryRecords_.size();
+
+	UINT32 record, dimension, slot, row, col;
+	for (slot=0; slot<v_gnssInverses_.size(); ++slot)
+		if (gnssInverseFormed_[slot].load(std::memory_order_acquire))
+			++header._inverseCount;
+
+	const std::string filePath(GnssInverseFilePath());
+	const std::string tmpPath(filePath + ".tmp");
+
+	std::ofstream gnss_file;
+	try {
+		file_opener(gnss_file, tmpPath, std::ios::out | std::ios::binary | std::ios::trunc, binary);
+	}
+	catch (const std::runtime_error& e) {
+		SignalExceptionAdjustment(e.what(), 0);
+	}
+
+	gnss_file.write(reinterpret_cast<const char*>(&header), sizeof(gnssInverseHeader_t));
+
+	std::uint64_t key;
+	double element;
+	for (record=0; record<v_gnssInverseSlot_.size(); ++record)
+	{
+		if ((slot = v_gnssInverseSlot_.at(record)) == NO_GNSS_INVERSE ||
+			!gnssInverseFormed_[slot].load(std::memory_order_acquire))
+			continue;
+
+		const matrix_2d& inverse(v_gnssInverses_.at(slot));
+		dimension = inverse.rows();
+		key = GnssInverseKey(record);
+
+		gnss_file.write(reinterpret_cast<const char*>(&record), sizeof(UINT32));
+		gnss_file.write(reinterpret_cast<const char*>(&dimension), sizeof(UINT32));
+		gnss_file.write(reinterpret_cast<const char*>(&key), sizeof(std::uint64_t));
+		for (row=0; row<dimension; ++row)
+			for (col=0; col<dimension; ++col)
+			{
+				element = inverse.get(row, col);
+				gnss_file.write(reinterpret_cast<const char*>(&element), sizeof(double));
+			}
+	}
+
+	gnss_file.close();
+	if (!gnss_file)
+		SignalExceptionAdjustment("SaveGnssInverses(): Could not write " + leafStr<std::string>(tmpPath) + ".", 0);
+
+	std::filesystem::rename(tmpPath, filePath);
+}
+
+
+}	// namespace networkadjust
+}	// namespace dynadjust
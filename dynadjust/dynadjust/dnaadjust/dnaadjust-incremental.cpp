@@ -0,0 +1,1053 @@
+//============================================================================
+// Name         : dnaadjust-incremental.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust Network Adjustment (incremental re-adjustment) library
+//============================================================================
+
+#include <dynadjust/dnaadjust/dnaadjust.hpp>
+
+namespace dynadjust {
+namespace networkadjust {
+
+namespace {
+
+// Identifies an incremental adjustment file
+const char incremental_file_magic[8] = { 'D', 'N', 'A', 'I', 'N', 'C', 'R', 'M' };
+
+// Accumulates a 64-bit FNV-1a hash (as for NetworkFingerprint)
+struct incremental_hash {
+	incremental_hash()
+		: value(14695981039346656037ULL) {}
+
+	void add(const void* data, const std::size_t& size) {
+		const unsigned char* bytes(static_cast<const unsigned char*>(data));
+		for (std::size_t i(0); i < size; ++i)
+		{
+			value ^= bytes[i];
+			value *= 1099511628211ULL;
+		}
+	}
+
+	template <typename T>
+	void add(const T& t) { add(&t, sizeof(T)); }
+
+	std::uint64_t value;
+};
+
+// Number of binary records which together form the measurement commencing
+// at start.  GNSS baseline and point clusters are identified by the cluster
+// ID of their records.
+UINT32 IncrementalRecordCount(const vmsr_t& msrs, const UINT32& start)
+{
+	const measurement_t& msr(msrs.at(start));
+	UINT32 end(start + 1);
+
+	switch (msr.measType)
+	{
+	case 'D':	// Direction set
+		return msr.vectorCount1;
+	case 'G':	// GPS Baseline
+		return 3;
+	case 'X':	// GPS Baseline cluster
+	case 'Y':	// GPS Point cluster
+		while (end < msrs.size() && msrs.at(end).measType == msr.measType &&
+			msrs.at(end).clusterID == msr.clusterID)
+			++end;
+		return end - start;
+	}
+	return 1;
+}
+
+// Hash of the records of the measurement commencing at start
+std::uint64_t IncrementalKey(const vmsr_t& msrs, const vstn_t& stns, const UINT32& start, const UINT32& records)
+{
+	incremental_hash hash;
+	for (UINT32 r(start); r<start+records; ++r)
+	{
+		const measurement_t& rec(msrs.at(r));
+		hash.add(rec.measType);
+		hash.add(rec.measStart);
+		hash.add(rec.ignore);
+		hash.add(stns.at(rec.station1).stationName, strlen(stns.at(rec.station1).stationName));
+		if (rec.measurementStations > ONE_STATION)
+			hash.add(stns.at(rec.station2).stationName, strlen(stns.at(rec.station2).stationName));
+		if (rec.measurementStations > TWO_STATION)
+			hash.add(stns.at(rec.station3).stationName, strlen(stns.at(rec.station3).stationName));
+		hash.add(rec.vectorCount1);
+		hash.add(rec.vectorCount2);
+		hash.add(rec.term1);
+		hash.add(rec.term2);
+		hash.add(rec.term3);
+		hash.add(rec.term4);
+		hash.add(rec.scale1);
+		hash.add(rec.scale2);
+		hash.add(rec.scale3);
+		hash.add(rec.scale4);
+	}
+	return hash.value;
+}
+
+// Number of design matrix rows formed by the measurement commencing at msr
+UINT32 IncrementalRowCount(const measurement_t& msr)
+{
+	switch (msr.measType)
+	{
+	case 'D':	// Direction set (angles derived from non-ignored directions)
+		return msr.vectorCount2 - 1;
+	case 'G':	// GPS Baseline
+		return 3;
+	case 'X':	// GPS Baseline cluster
+	case 'Y':	// GPS Point cluster
+		return msr.vectorCount1 * 3;
+	}
+	return 1;
+}
+
+// Stations of the measurement commencing at start (sorted)
+void IncrementalStations(const vmsr_t& msrs, const UINT32& start, const UINT32& records, vUINT32& stations)
+{
+	stations.clear();
+
+	const measurement_t& msr(msrs.at(start));
+	UINT32 r;
+
+	switch (msr.measType)
+	{
+	case 'H':	// Orthometric height
+	case 'I':	// Astronomic latitude
+	case 'J':	// Astronomic longitude
+	case 'P':	// Geodetic latitude
+	case 'Q':	// Geodetic longitude
+	case 'R':	// Ellipsoidal height
+		stations.push_back(msr.station1);
+		break;
+	case 'A':	// Horizontal angle
+		stations.push_back(msr.station1);
+		stations.push_back(msr.station2);
+		stations.push_back(msr.station3);
+		break;
+	case 'D':	// Direction set
+		stations.push_back(msr.station1);
+		for (r=start; r<start+records; ++r)
+			if (!msrs.at(r).ignore)
+				stations.push_back(msrs.at(r).station2);
+		break;
+	case 'X':	// GPS Baseline cluster
+		for (r=start; r<start+records; ++r)
+			if (msrs.at(r).measStart == xMeas)
+			{
+				stations.push_back(msrs.at(r).station1);
+				stations.push_back(msrs.at(r).station2);
+			}
+		break;
+	case 'Y':	// GPS Point cluster
+		for (r=start; r<start+records; ++r)
+			if (msrs.at(r).measStart == xMeas)
+				stations.push_back(msrs.at(r).station1);
+		break;
+	default:
+		stations.push_back(msr.station1);
+		stations.push_back(msr.station2);
+	}
+
+	std::sort(stations.begin(), stations.end());
+	stations.erase(std::unique(stations.begin(), stations.end()), stations.end());
+}
+
+// Reads a matrix written by operator<< from the incremental adjustment
+// file.  Returns false if the file is incomplete.
+template <typename M>
+bool ReadIncrementalMatrix(const std::string& contents, std::size_t& offset, M& matrix, const UINT32& matrixType)
+{
+	const std::size_t header(6 * sizeof(UINT32));
+	if (offset + header > contents.size())
+		return false;
+
+	const UINT32* dimensions(reinterpret_cast<const UINT32*>(contents.data() + offset));
+	if (dimensions[0] != matrixType)
+		return false;
+
+	const std::size_t elements(matrixType == mtx_lower ?
+		sumOfConsecutiveIntegers(dimensions[3]) :
+		static_cast<std::size_t>(dimensions[3]) * dimensions[4]);
+	const std::size_t size(header + elements * sizeof(double) + 2 * sizeof(UINT32));
+	if (offset + size > contents.size())
+		return false;
+
+	matrix.ReadMappedFileRegion(const_cast<char*>(contents.data() + offset));
+	offset += size;
+	return true;
+}
+
+}	// namespace
+
+
+std::string dna_adjust::IncrementalFilePath() const
+{
+	std::stringstream ss;
+	ss << projectSettings_.g.output_folder << FOLDER_SLASH << projectSettings_.g.network_name << "-incremental.mtx";
+	return ss.str();
+}
+
+
+// The solution from which outlier elimination re-adjusts the network, kept
+// apart from the solution recorded for incremental adjustment
+std::string dna_adjust::EliminationFilePath() const
+{
+	std::stringstream ss;
+	ss << projectSettings_.g.output_folder << FOLDER_SLASH << projectSettings_.g.network_name << "-eliminate.mtx";
+	return ss.str();
+}
+
+
+void dna_adjust::RemoveEliminationState()
+{
+	std::error_code ec;
+	std::filesystem::remove(EliminationFilePath(), ec);
+}
+
+
+// Hash of the stations and the parameters of each block, which must be
+// unchanged for the solution of a previous adjustment to be updated.  The
+// measurements are excluded, since they are compared one by one.  Only
+// the characters of each string are hashed, not the bytes which follow.
+std::uint64_t dna_adjust::IncrementalFingerprint()
+{
+	incremental_hash hash;
+
+	hash.add(bst_meta_.binCount);
+	hash.add(bst_meta_.epsgCode, strnlen(bst_meta_.epsgCode, sizeof(bst_meta_.epsgCode)));
+	hash.add(bst_meta_.epoch, strnlen(bst_meta_.epoch, sizeof(bst_meta_.epoch)));
+	hash.add(projectSettings_.a.free_std_dev);
+	hash.add(projectSettings_.a.fixed_std_dev);
+
+	for (const auto& stn : bstBinaryRecords_)
+	{
+		hash.add(stn.stationName, strlen(stn.stationName));
+		hash.add(stn.stationConst, strnlen(stn.stationConst, sizeof(stn.stationConst)));
+		hash.add(stn.initialLatitude);
+		hash.add(stn.initialLongitude);
+		hash.add(stn.initialHeight);
+	}
+
+	hash.add(blockCount_);
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		for (const auto& stn : v_parameterStationList_.at(block))
+		{
+			hash.add(stn);
+			hash.add(BlockStationPosition(block, stn));
+		}
+	}
+
+	return hash.value;
+}
+
+
+// Restores the solution of the previous incremental adjustment, being the
+// coordinates of each station and the variance matrix of each block, and
+// loads the measurements from which it was formed.  The solution can only
+// be restored if the stations and the parameters of each block are as they
+// were, otherwise a full adjustment is performed.
+void dna_adjust::LoadIncrementalState()
+{
+	v_incrementalVariances_.clear();
+	v_incrementalPrevious_.clear();
+
+	if (projectSettings_.a.report_mode)
+		return;
+
+	// Outlier elimination re-adjusts the network from the solution from
+	// which the last outlier was eliminated
+	if (!projectSettings_.a.incremental && v_eliminatedMsrs_.empty())
+		return;
+
+	if (!IncrementalAdjustment())
+	{
+		adj_file << "- Warning: Incremental adjustment is not available for staged or block 1 only" << std::endl <<
+			"  adjustments, or with sparse normals.  A full adjustment will be performed." << std::endl << std::endl;
+		return;
+	}
+
+	const std::string filePath(v_eliminatedMsrs_.empty() ? IncrementalFilePath() : EliminationFilePath());
+	if (!std::filesystem::exists(filePath))
+	{
+		adj_file << "+ There is no previous incremental adjustment of this network.  A full" << std::endl <<
+			"  adjustment will be performed." << std::endl;
+		return;
+	}
+
+	std::string contents;
+	contents.resize(static_cast<std::size_t>(std::filesystem::file_size(filePath)));
+	std::ifstream incremental_file(filePath.c_str(), std::ios::in | std::ios::binary);
+	incremental_file.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+
+	incrementalHeader_t header;
+	std::size_t offset(sizeof(incrementalHeader_t));
+	std::string reason;
+
+	if (!incremental_file || contents.size() < sizeof(incrementalHeader_t))
+		reason = "is incomplete or is not an incremental adjustment file.";
+	else
+	{
+		memcpy(&header, contents.data(), sizeof(incrementalHeader_t));
+
+		if (memcmp(header._magic, incremental_file_magic, sizeof(header._magic)) != 0)
+			reason = "is incomplete or is not an incremental adjustment file.";
+		else if (header._version != INCREMENTAL_FILE_VERSION)
+			reason = "was created by a different version of adjust.";
+		else if (header._adjustMode != projectSettings_.a.adjust_mode)
+			reason = "was created by an adjustment in a different mode.";
+		else if (header._blockCount != blockCount_ ||
+			header._stationCount != bstBinaryRecords_.size() ||
+			header._fingerprint != IncrementalFingerprint())
+			reason = "was not created from the stations and\n  segmentation of the network as it is currently imported.";
+		else if (offset + header._stationCount * 3 * sizeof(double) > contents.size())
+			reason = "is incomplete or is not an incremental adjustment file.";
+	}
+
+	const double* coordinates(reinterpret_cast<const double*>(contents.data() + offset));
+	offset += header._stationCount * 3 * sizeof(double);
+
+	// Variance matrix of each block
+	v_sym_mat variances(reason.empty() ? blockCount_ : 0);
+	for (UINT32 block(0); block<variances.size(); ++block)
+	{
+		if (!ReadIncrementalMatrix(contents, offset, variances.at(block), mtx_lower) ||
+			variances.at(block).rows() != v_unknownsCount_.at(block))
+		{
+			reason = "is incomplete or is not an incremental adjustment file.";
+			break;
+		}
+	}
+
+	// Measurements, each recorded as its keys, block and stations, followed
+	// by its contribution to the normals
+	std::vector<incrementalMsr_t> msrs;
+	if (reason.empty())
+		msrs.resize(static_cast<std::size_t>(header._measurementCount));
+
+	UINT32 stationCount;
+	for (auto& msr : msrs)
+	{
+		if (offset + 2 * sizeof(std::uint64_t) + 2 * sizeof(UINT32) > contents.size())
+		{
+			reason = "is incomplete or is not an incremental adjustment file.";
+			break;
+		}
+		memcpy(&msr._key, contents.data() + offset, sizeof(std::uint64_t));
+		offset += sizeof(std::uint64_t);
+		memcpy(&msr._reducedKey, contents.data() + offset, sizeof(std::uint64_t));
+		offset += sizeof(std::uint64_t);
+		memcpy(&msr._block, contents.data() + offset, sizeof(UINT32));
+		offset += sizeof(UINT32);
+		memcpy(&stationCount, contents.data() + offset, sizeof(UINT32));
+		offset += sizeof(UINT32);
+
+		if (msr._block >= blockCount_ ||
+			offset + stationCount * sizeof(UINT32) > contents.size())
+		{
+			reason = "is incomplete or is not an incremental adjustment file.";
+			break;
+		}
+		msr._stations.resize(stationCount);
+		memcpy(msr._stations.data(), contents.data() + offset, stationCount * sizeof(UINT32));
+		offset += stationCount * sizeof(UINT32);
+
+		if (!ReadIncrementalMatrix(contents, offset, msr._normals, mtx_full) ||
+			!ReadIncrementalMatrix(contents, offset, msr._weighted, mtx_full) ||
+			msr._normals.rows() != stationCount * 3 || msr._weighted.rows() != stationCount * 3)
+		{
+			reason = "is incomplete or is not an incremental adjustment file.";
+			break;
+		}
+	}
+
+	if (!reason.empty())
+	{
+		adj_file << "- Warning: The incremental adjustment file " << leafStr<std::string>(filePath) << " " << reason << std::endl <<
+			"  A full adjustment will be performed." << std::endl << std::endl;
+		return;
+	}
+
+	// Geographic coordinates of each station
+	for (auto& stn : bstBinaryRecords_)
+	{
+		stn.currentLatitude = *coordinates++;
+		stn.currentLongitude = *coordinates++;
+		stn.currentHeight = *coordinates++;
+	}
+
+	v_incrementalVariances_ = std::move(variances);
+	v_incrementalPrevious_ = std::move(msrs);
+
+	adj_file << "+ Restored the previous incremental adjustment of " << v_incrementalPrevious_.size() << " measurements" << std::endl;
+}
+
+
+// Forms the measurements of this adjustment, in the order in which they
+// form the design matrix of each block.  Each measurement is identified
+// by a hash of its records, so that measurements added and removed since
+// the previous adjustment can be found.
+void dna_adjust::FormIncrementalMeasurements()
+{
+	v_incrementalCurrent_.clear();
+
+	if (!IncrementalAdjustment())
+		return;
+
+	it_vUINT32 _it_block_msr;
+	it_vmsr_t _it_msr;
+	UINT32 design_row, records;
+	incrementalMsr_t msr;
+
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		design_row = 0;
+
+		for (_it_block_msr=v_CML_.at(block).begin(); _it_block_msr!=v_CML_.at(block).end(); ++_it_block_msr)
+		{
+			if (InitialiseandValidateMsrPointer(_it_block_msr, _it_msr))
+				continue;
+
+			// Target directions do not form a design matrix row
+			if (_it_msr->measType == 'D')
+				if (_it_msr->vectorCount2 < 1)
+					continue;
+
+			records = IncrementalRecordCount(bmsBinaryRecords_, *_it_block_msr);
+
+			// If the binary measurement file has been reduced by a previous
+			// adjustment, the measurements as imported are not known
+			msr._key = msr._reducedKey = 0;
+			if (isFirstTimeAdjustment_)
+				msr._key = IncrementalKey(bmsBinaryRecords_, bstBinaryRecords_, *_it_block_msr, records);
+			else
+				msr._reducedKey = IncrementalKey(bmsBinaryRecords_, bstBinaryRecords_, *_it_block_msr, records);
+			msr._record = *_it_block_msr;
+			msr._block = block;
+			msr._firstRow = design_row;
+			msr._rows = IncrementalRowCount(*_it_msr);
+			IncrementalStations(bmsBinaryRecords_, *_it_block_msr, records, msr._stations);
+
+			design_row += msr._rows;
+			v_incrementalCurrent_.push_back(msr);
+		}
+
+		// The rows must correspond with those of the design matrix
+		if (design_row != v_measurementParams_.at(block))
+		{
+			adj_file << "- Warning: The measurements of block " << block + 1 << " could not be identified for incremental" << std::endl <<
+				"  adjustment.  The solution of this adjustment will not be recorded." << std::endl << std::endl;
+			projectSettings_.a.incremental = 0;
+			v_incrementalCurrent_.clear();
+			v_incrementalVariances_.clear();
+			return;
+		}
+	}
+}
+
+
+// Forms the contribution of a measurement of this adjustment to the normals
+// (At * V-1 * A) and to At * V-1 * (measured - computed), for the stations
+// of the measurement only.  Since the variance matrix of a cluster is held
+// by its rows of At * V-1, each measurement's contribution is independent
+// of all others.
+void dna_adjust::FormIncrementalNormals(incrementalMsr_t& msr)
+{
+	const UINT32 params(static_cast<UINT32>(msr._stations.size() * 3));
+	const rowblock_matrix& design(v_design_.at(msr._block));
+	const rowblock_matrix& AtVinv(v_AtVinv_.at(msr._block));
+	const matrix_2d& measMinusComp(v_measMinusComp_.at(msr._block));
+
+	vUINT32 positions(params);
+	UINT32 a, b, row;
+	for (a=0; a<params; ++a)
+		positions.at(a) = BlockStationPosition(msr._block, msr._stations.at(a / 3)) * 3 + a % 3;
+
+	msr._normals.redim(params, params);
+	msr._normals.zero();
+	msr._weighted.redim(params, 1);
+	msr._weighted.zero();
+
+	double weight;
+	for (row=msr._firstRow; row<msr._firstRow+msr._rows; ++row)
+	{
+		for (a=0; a<params; ++a)
+		{
+			if ((weight = AtVinv.get(positions.at(a), row)) == 0.)
+				continue;
+			msr._weighted.elementadd(a, 0, weight * measMinusComp.get(row, 0));
+			for (b=0; b<params; ++b)
+				msr._normals.elementadd(a, b, weight * design.get(row, positions.at(b)));
+		}
+	}
+}
+
+
+// Finds the measurements added and removed since the previous incremental
+// adjustment, and determines whether its solution can be updated for them.
+// The update is only worthwhile if the measurements are connected to a
+// small part of the network.
+bool dna_adjust::FormIncrementalUpdate()
+{
+	v_incrementalAdded_.clear();
+	v_incrementalRemoved_.clear();
+
+	if (!IncrementalAdjustment() || v_incrementalVariances_.empty())
+		return false;
+
+	// Sort the measurements of both adjustments by key and compare.  Identical
+	// measurements (i.e. repeated observations) are matched one for one.  The
+	// measurements of a binary file reduced by a previous adjustment are
+	// compared as reduced.
+	auto key = [this](const incrementalMsr_t& msr) {
+		return isFirstTimeAdjustment_ ? msr._key : msr._reducedKey; };
+
+	vUINT32 previous(v_incrementalPrevious_.size()), current(v_incrementalCurrent_.size());
+	std::iota(previous.begin(), previous.end(), 0);
+	std::iota(current.begin(), current.end(), 0);
+	std::sort(previous.begin(), previous.end(), [this, &key](const UINT32& lhs, const UINT32& rhs) {
+		return key(v_incrementalPrevious_.at(lhs)) < key(v_incrementalPrevious_.at(rhs)); });
+	std::sort(current.begin(), current.end(), [this, &key](const UINT32& lhs, const UINT32& rhs) {
+		return key(v_incrementalCurrent_.at(lhs)) < key(v_incrementalCurrent_.at(rhs)); });
+
+	it_vUINT32 _it_prev(previous.begin()), _it_curr(current.begin());
+	while (_it_prev != previous.end() && _it_curr != current.end())
+	{
+		if (key(v_incrementalPrevious_.at(*_it_prev)) < key(v_incrementalCurrent_.at(*_it_curr)))
+			v_incrementalRemoved_.push_back(*_it_prev++);
+		else if (key(v_incrementalCurrent_.at(*_it_curr)) < key(v_incrementalPrevious_.at(*_it_prev)))
+			v_incrementalAdded_.push_back(*_it_curr++);
+		else
+		{
+			// Carry the key of the measurement as imported
+			if (!isFirstTimeAdjustment_)
+				v_incrementalCurrent_.at(*_it_curr)._key = v_incrementalPrevious_.at(*_it_prev)._key;
+			++_it_prev;
+			++_it_curr;
+		}
+	}
+	v_incrementalRemoved_.insert(v_incrementalRemoved_.end(), _it_prev, previous.end());
+	v_incrementalAdded_.insert(v_incrementalAdded_.end(), _it_curr, current.end());
+
+	// Count the parameters of the stations connected to the added and
+	// removed measurements
+	std::vector<vUINT32> blockStations(blockCount_);
+	for (const auto& a : v_incrementalAdded_)
+		blockStations.at(v_incrementalCurrent_.at(a)._block).insert(blockStations.at(v_incrementalCurrent_.at(a)._block).end(),
+			v_incrementalCurrent_.at(a)._stations.begin(), v_incrementalCurrent_.at(a)._stations.end());
+	for (const auto& r : v_incrementalRemoved_)
+		blockStations.at(v_incrementalPrevious_.at(r)._block).insert(blockStations.at(v_incrementalPrevious_.at(r)._block).end(),
+			v_incrementalPrevious_.at(r)._stations.begin(), v_incrementalPrevious_.at(r)._stations.end());
+
+	std::size_t changed(0), params(0);
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		strip_duplicates(blockStations.at(block));
+		changed += blockStations.at(block).size() * 3;
+		params += v_unknownsCount_.at(block);
+	}
+
+	if (changed * 4 > params)
+	{
+		adj_file << "+ The measurements added and removed since the previous incremental adjustment" << std::endl <<
+			"  are connected to more than a quarter of the network.  A full adjustment will" << std::endl <<
+			"  be performed." << std::endl;
+		v_incrementalVariances_.clear();
+		return false;
+	}
+
+	for (const auto& a : v_incrementalAdded_)
+		FormIncrementalNormals(v_incrementalCurrent_.at(a));
+
+	if (projectSettings_.g.verbose > 0)
+	{
+		auto print = [this](const char* change, const incrementalMsr_t& msr) {
+			debug_file << change << " measurement (block " << msr._block + 1 << "):";
+			for (const auto& stn : msr._stations)
+				debug_file << " " << bstBinaryRecords_.at(stn).stationName;
+			debug_file << std::endl;
+		};
+		for (const auto& a : v_incrementalAdded_)
+			print("Added", v_incrementalCurrent_.at(a));
+		for (const auto& r : v_incrementalRemoved_)
+			print("Removed", v_incrementalPrevious_.at(r));
+	}
+
+	adj_file << "+ Updating the previous incremental adjustment for " << v_incrementalAdded_.size() << " added and " <<
+		v_incrementalRemoved_.size() << " removed" << std::endl << "  measurements" << std::endl;
+
+	return true;
+}
+
+
+// Updates the variance matrices of the previous adjustment for the
+// measurements added to and removed from block, and accumulates the
+// corrections to the estimates of each block.
+//
+// Let S be the parameters of the stations connected to the measurements,
+// D the change in the normals of S, g the change in At * V-1 * (measured -
+// computed) of S, and Q the (rigorous) variance matrix.  By the Woodbury
+// identity, the updated variance matrix is:
+//
+//		Q' = Q - C * M * Ct, where C = Q(:, S) and
+//		M = D - D * (Q(S, S)^-1 + D)^-1 * D
+//
+// and the corrections are C * (g - M * Q(S, S) * g).  Hence only matrices
+// the size of S are inverted.
+//
+// In a phased adjustment, the covariances of the parameters of other blocks
+// with S are not held.  Since the measurements of a block connect its
+// stations with those of other blocks only through its junction stations,
+// the covariances of each block with S follow from those of its stations
+// which appear in the blocks already updated (J):
+//
+//		C = Q(:, J) * Q(J, J)^-1 * C(J, :)
+//
+// Blocks are updated outward from block, in the forward and then the
+// reverse direction.
+bool dna_adjust::UpdateBlockIncrementally(const UINT32& block, v_mat_2d& corrections)
+{
+	// Measurements added to and removed from this block
+	std::vector<std::pair<const incrementalMsr_t*, double> > msrs;
+	vUINT32 stations;
+
+	for (const auto& a : v_incrementalAdded_)
+		if (v_incrementalCurrent_.at(a)._block == block)
+			msrs.push_back(std::make_pair(&v_incrementalCurrent_.at(a), 1.));
+	for (const auto& r : v_incrementalRemoved_)
+		if (v_incrementalPrevious_.at(r)._block == block)
+			msrs.push_back(std::make_pair(&v_incrementalPrevious_.at(r), -1.));
+
+	if (msrs.empty())
+		return true;
+
+	for (const auto& msr : msrs)
+		stations.insert(stations.end(), msr.first->_stations.begin(), msr.first->_stations.end());
+	strip_duplicates(stations);
+
+	const UINT32 s(static_cast<UINT32>(stations.size() * 3));
+	vUINT32 positions(s);
+	UINT32 a, b, i, j, r;
+	for (a=0; a<s; ++a)
+		positions.at(a) = BlockStationPosition(block, stations.at(a / 3)) * 3 + a % 3;
+
+	// Change in the normals and weighted measured minus computed of S
+	matrix_2d D(s, s), g(s, 1);
+	D.zero();
+	g.zero();
+	for (const auto& msr : msrs)
+	{
+		vUINT32 index(msr.first->_stations.size() * 3);
+		for (i=0; i<index.size(); ++i)
+			index.at(i) = static_cast<UINT32>(std::lower_bound(stations.begin(), stations.end(),
+				msr.first->_stations.at(i / 3)) - stations.begin()) * 3 + i % 3;
+
+		for (i=0; i<index.size(); ++i)
+		{
+			g.elementadd(index.at(i), 0, msr.second * msr.first->_weighted.get(i, 0));
+			for (j=0; j<index.size(); ++j)
+				D.elementadd(index.at(i), index.at(j), msr.second * msr.first->_normals.get(i, j));
+		}
+	}
+
+	// The measurements were formed from the previous estimates, so
+	// account for the corrections made by the updates of other blocks
+	for (a=0; a<s; ++a)
+		for (b=0; b<s; ++b)
+			g.elementsubtract(a, 0, D.get(a, b) * corrections.at(block).get(positions.at(b), 0));
+
+	symmetric_matrix& variances(v_incrementalVariances_.at(block));
+	symmetric_matrix T(s, s);
+	for (a=0; a<s; ++a)
+		for (b=0; b<=a; ++b)
+			T.put(a, b, variances.get(positions.at(a), positions.at(b)));
+
+	matrix_2d QSSg(s, 1);
+	T.multiply(g, QSSg);
+
+	// M = D - D * (Q(S, S)^-1 + D)^-1 * D
+	matrix_2d M(s, s), TD(s, s);
+	try {
+		T.cholesky_inverse();
+		for (a=0; a<s; ++a)
+			for (b=0; b<=a; ++b)
+				T.elementadd(a, b, D.get(a, b));
+		T.cholesky_inverse();
+	}
+	catch (const std::runtime_error&) {
+		return false;
+	}
+	T.multiply(D, TD);
+	M.multiply(D, "N", TD, "N");
+	for (a=0; a<s; ++a)
+		for (b=0; b<s; ++b)
+			M.put(a, b, D.get(a, b) - M.get(a, b));
+
+	// g - M * Q(S, S) * g
+	matrix_2d weighted(s, 1);
+	weighted.multiply(M, "N", QSSg, "N");
+	for (a=0; a<s; ++a)
+		weighted.put(a, 0, g.get(a, 0) - weighted.get(a, 0));
+
+	// Covariances of each block with S, and the block holding the
+	// covariances of each station
+	v_mat_2d covariances(blockCount_);
+	vUINT32 stationBlocks(bstBinaryRecords_.size(), UINT_MAX);
+
+	auto update = [&](const UINT32& blk) {
+		const matrix_2d& C(covariances.at(blk));
+		const UINT32 n(C.rows());
+
+		matrix_2d CM(n, s), correction(n, 1);
+		CM.multiply(C, "N", M, "N");
+		correction.multiply(C, "N", weighted, "N");
+		corrections.at(blk).add(correction);
+
+		symmetric_matrix& Q(v_incrementalVariances_.at(blk));
+		double sum;
+		UINT32 row, col, k;
+		for (col=0; col<n; ++col)
+			for (row=col; row<n; ++row)
+			{
+				sum = 0.;
+				for (k=0; k<s; ++k)
+					sum += CM.get(row, k) * C.get(col, k);
+				Q.elementsubtract(row, col, sum);
+			}
+
+		for (const auto& stn : v_parameterStationList_.at(blk))
+			if (stationBlocks.at(stn) == UINT_MAX)
+				stationBlocks.at(stn) = blk;
+	};
+
+	auto propagate = [&](const UINT32& blk) -> bool {
+		vUINT32 junctions;
+		for (const auto& stn : v_parameterStationList_.at(blk))
+			if (stationBlocks.at(stn) != UINT_MAX)
+				junctions.push_back(stn);
+		if (junctions.empty())
+			return true;
+
+		const symmetric_matrix& Q(v_incrementalVariances_.at(blk));
+		const UINT32 n(Q.rows()), m(static_cast<UINT32>(junctions.size() * 3));
+		vUINT32 jpositions(m);
+		for (UINT32 p(0); p<m; ++p)
+			jpositions.at(p) = BlockStationPosition(blk, junctions.at(p / 3)) * 3 + p % 3;
+
+		symmetric_matrix QJJ(m, m);
+		matrix_2d QJ(n, m), CJ(m, s), gain(m, s);
+		UINT32 row, col, k;
+		for (col=0; col<m; ++col)
+		{
+			const UINT32 stnBlock(stationBlocks.at(junctions.at(col / 3)));
+			const UINT32 stnRow(BlockStationPosition(stnBlock, junctions.at(col / 3)) * 3 + col % 3);
+			for (k=0; k<s; ++k)
+				CJ.put(col, k, covariances.at(stnBlock).get(stnRow, k));
+			for (k=0; k<=col; ++k)
+				QJJ.put(col, k, Q.get(jpositions.at(col), jpositions.at(k)));
+			for (row=0; row<n; ++row)
+				QJ.put(row, col, Q.get(row, jpositions.at(col)));
+		}
+
+		try {
+			QJJ.cholesky_inverse();
+		}
+		catch (const std::runtime_error&) {
+			return false;
+		}
+		QJJ.multiply(CJ, gain);
+
+		covariances.at(blk).redim(n, s);
+		covariances.at(blk).multiply(QJ, "N", gain, "N");
+		update(blk);
+		return true;
+	};
+
+	// This block
+	const UINT32 n(variances.rows());
+	covariances.at(block).redim(n, s);
+	for (r=0; r<n; ++r)
+		for (a=0; a<s; ++a)
+			covariances.at(block).put(r, a, variances.get(r, positions.at(a)));
+	update(block);
+
+	// Other blocks, outward from this block
+	for (i=block+1; i<blockCount_; ++i)
+		if (!propagate(i))
+			return false;
+	for (i=block; i>0; --i)
+		if (!propagate(i - 1))
+			return false;
+
+	return true;
+}
+
+
+// Updates the inverse of the normals of a simultaneous adjustment from the
+// variance matrix of the previous incremental adjustment, from which the
+// first iteration solves the corrections
+bool dna_adjust::UpdateNormalsIncrementally()
+{
+	if (!FormIncrementalUpdate())
+		return false;
+
+	v_mat_2d corrections(1);
+	corrections.at(0).redim(v_unknownsCount_.at(0), 1);
+	corrections.at(0).zero();
+
+	if (!UpdateBlockIncrementally(0, corrections))
+	{
+		adj_file << "- Warning: The previous incremental adjustment could not be updated.  A full" << std::endl <<
+			"  adjustment will be performed." << std::endl;
+		v_incrementalVariances_.clear();
+		return false;
+	}
+
+	v_normals_.at(0) = std::move(v_incrementalVariances_.at(0));
+	v_incrementalVariances_.clear();
+	return true;
+}
+
+
+// Updates the rigorous estimates and variance matrices of a phased
+// adjustment from those of the previous incremental adjustment, in place
+// of the forward, reverse and combination adjustments of the first
+// iteration.  If the corrections exceed the iteration threshold, the
+// adjustment continues to iterate as usual.
+bool dna_adjust::UpdateEstimatesIncrementally()
+{
+	v_mat_2d corrections(blockCount_);
+	UINT32 block;
+
+	for (block=0; block<blockCount_; ++block)
+	{
+		corrections.at(block).redim(v_unknownsCount_.at(block), 1);
+		corrections.at(block).zero();
+	}
+
+	for (block=0; block<blockCount_; ++block)
+	{
+		if (!UpdateBlockIncrementally(block, corrections))
+		{
+			adj_file << "- Warning: The previous incremental adjustment could not be updated.  A full" << std::endl <<
+				"  adjustment will be performed." << std::endl;
+			v_incrementalVariances_.clear();
+			return false;
+		}
+	}
+
+	for (block=0; block<blockCount_; ++block)
+	{
+		v_corrections_.at(block) = corrections.at(block);
+
+		v_rigorousStations_.at(block) = v_originalStations_.at(block);
+		v_rigorousStations_.at(block).add(v_corrections_.at(block));
+		v_estimatedStations_.at(block) = v_rigorousStations_.at(block);
+		v_originalStations_.at(block) = v_rigorousStations_.at(block);
+
+		v_rigorousVariances_.at(block) = std::move(v_incrementalVariances_.at(block));
+		v_normals_.at(block) = v_rigorousVariances_.at(block);
+
+		// update max correction
+		if (fabs(v_corrections_.at(block).compute_maximum_value()) > fabs(maxCorr_))
+			SetmaxCorr(v_corrections_.at(block).maxvalue());
+
+		// update largest correction
+		if (fabs(v_corrections_.at(block).maxvalue()) > fabs(largestCorr_))
+		{
+			largestCorr_ = v_corrections_.at(block).maxvalue();
+			blockLargeCorr_ = block;
+		}
+	}
+
+	v_incrementalVariances_.clear();
+	return true;
+}
+
+
+// Records the solution of this adjustment, so that a later incremental
+// adjustment may update it for the measurements added and removed since.
+// The solution is only recorded once the adjustment has converged.  When
+// eliminating outliers, the solution is recorded for the re-adjustment, 
+// which loads the binary files unchanged.
+void dna_adjust::SaveIncrementalState(const bool eliminating)
+{
+	if (!IncrementalAdjustment() || adjustStatus_ != ADJUST_SUCCESS ||
+		v_incrementalCurrent_.empty())
+		return;
+
+	incrementalHeader_t header;
+	memcpy(header._magic, incremental_file_magic, sizeof(header._magic));
+	header._version = INCREMENTAL_FILE_VERSION;
+	header._adjustMode = projectSettings_.a.adjust_mode;
+	header._blockCount = blockCount_;
+	header._stationCount = bstBinaryRecords_.size();
+	header._measurementCount = v_incrementalCurrent_.size();
+	header._fingerprint = IncrementalFingerprint();
+
+	const std::string filePath(eliminating ? EliminationFilePath() : IncrementalFilePath());
+	const std::string tmpPath(filePath + ".tmp");
+
+	std::ofstream incremental_file;
+	try {
+		file_opener(incremental_file, tmpPath, std::ios::out | std::ios::binary | std::ios::trunc, binary);
+	}
+	catch (const std::runtime_error& e) {
+		SignalExceptionAdjustment(e.what(), 0);
+	}
+
+	incremental_file.write(reinterpret_cast<const char*>(&header), sizeof(incrementalHeader_t));
+
+	// Geographic coordinates of each station
+	for (const auto& stn : bstBinaryRecords_)
+	{
+		incremental_file.write(reinterpret_cast<const char*>(&stn.currentLatitude), sizeof(double));
+		incremental_file.write(reinterpret_cast<const char*>(&stn.currentLongitude), sizeof(double));
+		incremental_file.write(reinterpret_cast<const char*>(&stn.currentHeight), sizeof(double));
+	}
+
+	// Variance matrix of each block
+	for (UINT32 block(0); block<blockCount_; ++block)
+		incremental_file << v_rigorousVariances_.at(block);
+
+	// Measurements, formed from the adjusted estimates and identified as
+	// they will be reduced in the binary measurement file
+	UINT32 stationCount;
+	for (auto& msr : v_incrementalCurrent_)
+	{
+		FormIncrementalNormals(msr);
+		if (!eliminating)
+			msr._reducedKey = IncrementalKey(bmsBinaryRecords_, bstBinaryRecords_, msr._record, 
+				IncrementalRecordCount(bmsBinaryRecords_, msr._record));
+
+		stationCount = static_cast<UINT32>(msr._stations.size());
+		incremental_file.write(reinterpret_cast<const char*>(&msr._key), sizeof(std::uint64_t));
+		incremental_file.write(reinterpret_cast<const char*>(&msr._reducedKey), sizeof(std::uint64_t));
+		incremental_file.write(reinterpret_cast<const char*>(&msr._block), sizeof(UINT32));
+		incremental_file.write(reinterpret_cast<const char*>(&stationCount), sizeof(UINT32));
+		incremental_file.write(reinterpret_cast<const char*>(msr._stations.data()), stationCount * sizeof(UINT32));
+		incremental_file << msr._normals << msr._weighted;
+
+		msr._normals = matrix_2d();
+		msr._weighted = matrix_2d();
+	}
+
+	incremental_file.close();
+	if (!incremental_file)
+		SignalExceptionAdjustment("SaveIncrementalState(): Could not write " + leafStr<std::string>(tmpPath) + ".", 0);
+
+	std::filesystem::rename(tmpPath, filePath);
+}
+
+
+// Eliminates the measurement with the largest n-statistic exceeding the
+// critical value, by ignoring its records.  Direction sets and GNSS
+// clusters are eliminated whole, and measurements which are not redundant
+// are never eliminated.  Returns false if no measurement is eliminated,
+// either because the elimination rule is satisfied or because the number
+// of measurements to be eliminated has been reached.
+bool dna_adjust::EliminateOutlier()
+{
+	if (v_eliminatedMsrs_.size() >= projectSettings_.a.eliminate_outliers ||
+		adjustStatus_ != ADJUST_SUCCESS)
+		return false;
+
+	// Eliminating measurements cannot raise a sigma zero below 
+	// the lower limit of the chi-square test
+	if (projectSettings_.a.elimination_rule == Eliminate_chisquare && 
+		passFail_ != test_stat_fail)
+		return false;
+
+	it_vUINT32 _it_block_msr;
+	it_vmsr_t _it_msr;
+	UINT32 r, records, worstStart(0), worstRecord(0), worstRecords(0);
+	double nstat(0.);
+
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		for (_it_block_msr=v_CML_.at(block).begin(); _it_block_msr!=v_CML_.at(block).end(); ++_it_block_msr)
+		{
+			if (InitialiseandValidateMsrPointer(_it_block_msr, _it_msr))
+				continue;
+
+			if (_it_msr->measType == 'D')
+				if (_it_msr->vectorCount2 < 1)
+					continue;
+
+			records = IncrementalRecordCount(bmsBinaryRecords_, *_it_block_msr);
+
+			for (r=*_it_block_msr; r<*_it_block_msr+records; ++r)
+			{
+				const measurement_t& msr(bmsBinaryRecords_.at(r));
+				
+				// Skip covariances, ignored directions and 
+				// measurements which are not redundant
+				if (msr.ignore || msr.measStart > zMeas ||
+					msr.PelzerRel >= UNRELIABLE)
+					continue;
+
+				if (fabs(msr.NStat) > nstat)
+				{
+					nstat = fabs(msr.NStat);
+					worstStart = *_it_block_msr;
+					worstRecord = r;
+					worstRecords = records;
+				}
+			}
+		}
+	}
+
+	if (nstat <= criticalValue_)
+		return false;
+
+	eliminatedMsr_t eliminated;
+	eliminated._reduced.assign(bmsBinaryRecords_.begin() + worstStart, 
+		bmsBinaryRecords_.begin() + worstStart + worstRecords);
+
+	for (r=worstStart; r<worstStart+worstRecords; ++r)
+		bmsBinaryRecords_.at(r).ignore = true;
+
+	const measurement_t& msr(bmsBinaryRecords_.at(worstRecord));
+
+	eliminated._measType = msr.measType;
+	eliminated._record = worstStart;
+	eliminated._records = worstRecords;
+	eliminated._nstat = msr.NStat;
+	eliminated._sigmaZero = sigmaZero_;
+	eliminated._station1 = bstBinaryRecords_.at(msr.station1).stationName;
+
+	if (msr.measurementStations > ONE_STATION)
+		eliminated._station2 = bstBinaryRecords_.at(msr.station2).stationName;
+	if (msr.measurementStations > TWO_STATION)
+		eliminated._station3 = bstBinaryRecords_.at(msr.station3).stationName;
+
+	v_eliminatedMsrs_.push_back(eliminated);
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Eliminated " << msr.measType << " " << eliminated._station1 << " " <<
+			eliminated._station2 << " " << eliminated._station3 << " (" << worstRecords << 
+			" records, n-statistic " << std::fixed << std::setprecision(2) << msr.NStat << ")" << std::endl;
+
+	return true;
+}
+
+
+}	// namespace networkadjust
+}	// namespace dynadjust
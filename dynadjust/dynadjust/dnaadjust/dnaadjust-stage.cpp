@@ -24,6 +24,45 @@
 namespace dynadjust { 
 namespace networkadjust {
 
+namespace {
+
+// Matrices of a block which are held in the stage files, i.e. all but 
+// the normals, design and AtVinv, which are formed on each load
+const UINT32 staged_matrices(
+	(1u << sf_normals_r) | (1u << sf_meas_minus_comp) |
+	(1u << sf_estimated_stns) | (1u << sf_original_stns) | (1u << sf_rigorous_stns) |
+	(1u << sf_junction_vars) | (1u << sf_junction_vars_f) | (1u << sf_junction_ests_f) | (1u << sf_junction_ests_r) |
+	(1u << sf_rigorous_vars) | (1u << sf_prec_adj_msrs) | (1u << sf_corrections));
+
+// Matrices of a block which are formed on each load.  Their memory varies
+// as they are formed, and so is counted from the matrices themselves.
+const UINT32 formed_matrices(
+	(1u << sf_normals) | (1u << sf_atvinv) | (1u << sf_design));
+
+// Identifies a stage file
+const char stage_file_magic[8] = { 'D', 'N', 'A', 'S', 'T', 'A', 'G', 'E' };
+
+// Loads a matrix from its region of a stage file.  The matrix wraps a 
+// private (copy on write) mapping of the region rather than a copy of it,
+// so that pages are only copied if the matrix is changed, and changes 
+// reach the file only when the block is serialised.  Regions smaller
+// than a page are cheaper to copy than to map.
+template <typename T>
+void DeserialiseMatrix(const vmat_file_map& file_map, const UINT32& block, T& matrix)
+{
+	const block_map_t& block_map(file_map.vblockMapRegions_.at(block));
+	if (block_map.GetDataSize() < boost::interprocess::mapped_region::get_page_size())
+	{
+		matrix.ReadMappedFileRegion(file_map.GetBlockRegionAddr(block));
+		return;
+	}
+
+	MapRegPtr region(file_map.MapPrivateRegion(block));
+	matrix.MapFileRegion(region->get_address(), region);
+}
+
+}	// namespace
+
 // Prepare mapped regions for staged adjustments that read from
 // existing mapped files.
 void dna_adjust::PrepareMappedRegions(const UINT32& block)
@@ -79,51 +118,51 @@ void dna_adjust::SetRegionOffsets(const UINT32& block, const int file_count, ...
 		{
 		case sf_normals_r:
 			normalsR_map_.addblockMapRegion(block_map_t(v_normalsR_.at(block).get_size()));
-			SetRegionOffset(normalsR_map_);
+			SetRegionOffset(normalsR_map_, block, sf_normals_r);
 			break;
 		case sf_meas_minus_comp:
 			measMinusComp_map_.addblockMapRegion(block_map_t(v_measMinusComp_.at(block).get_size()));
-			SetRegionOffset(measMinusComp_map_);
+			SetRegionOffset(measMinusComp_map_, block, sf_meas_minus_comp);
 			break;
 		case sf_estimated_stns:
 			estimatedStations_map_.addblockMapRegion(block_map_t(v_estimatedStations_.at(block).get_size()));
-			SetRegionOffset(estimatedStations_map_);
+			SetRegionOffset(estimatedStations_map_, block, sf_estimated_stns);
 			break;
 		case sf_original_stns:
 			originalStations_map_.addblockMapRegion(block_map_t(v_originalStations_.at(block).get_size()));
-			SetRegionOffset(originalStations_map_);
+			SetRegionOffset(originalStations_map_, block, sf_original_stns);
 			break;
 		case sf_rigorous_stns:
 			rigorousStations_map_.addblockMapRegion(block_map_t(v_rigorousStations_.at(block).get_size()));
-			SetRegionOffset(rigorousStations_map_);
+			SetRegionOffset(rigorousStations_map_, block, sf_rigorous_stns);
 			break;
 		case sf_junction_vars:
 			junctionVariances_map_.addblockMapRegion(block_map_t(v_junctionVariances_.at(block).get_size()));
-			SetRegionOffset(junctionVariances_map_);
+			SetRegionOffset(junctionVariances_map_, block, sf_junction_vars);
 			break;
 		case sf_junction_vars_f:
 			junctionVariancesFwd_map_.addblockMapRegion(block_map_t(v_junctionVariancesFwd_.at(block).get_size()));
-			SetRegionOffset(junctionVariancesFwd_map_);
+			SetRegionOffset(junctionVariancesFwd_map_, block, sf_junction_vars_f);
 			break;
 		case sf_junction_ests_f:
 			junctionEstimatesFwd_map_.addblockMapRegion(block_map_t(v_junctionEstimatesFwd_.at(block).get_size()));
-			SetRegionOffset(junctionEstimatesFwd_map_);
+			SetRegionOffset(junctionEstimatesFwd_map_, block, sf_junction_ests_f);
 			break;
 		case sf_junction_ests_r:
 			junctionEstimatesRev_map_.addblockMapRegion(block_map_t(v_junctionEstimatesRev_.at(block).get_size()));
-			SetRegionOffset(junctionEstimatesRev_map_);
+			SetRegionOffset(junctionEstimatesRev_map_, block, sf_junction_ests_r);
 			break;
 		case sf_rigorous_vars:
 			rigorousVariances_map_.addblockMapRegion(block_map_t(v_rigorousVariances_.at(block).get_size()));
-			SetRegionOffset(rigorousVariances_map_);
+			SetRegionOffset(rigorousVariances_map_, block, sf_rigorous_vars);
 			break;
 		case sf_prec_adj_msrs:
 			precAdjMsrs_map_.addblockMapRegion(block_map_t(v_precAdjMsrsFull_.at(block).get_size()));
-			SetRegionOffset(precAdjMsrs_map_);
+			SetRegionOffset(precAdjMsrs_map_, block, sf_prec_adj_msrs);
 			break;
 		case sf_corrections:
 			corrections_map_.addblockMapRegion(block_map_t(v_corrections_.at(block).get_size()));
-			SetRegionOffset(corrections_map_);
+			SetRegionOffset(corrections_map_, block, sf_corrections);
 			break;
 		}
 	}
@@ -131,17 +170,185 @@ void dna_adjust::SetRegionOffsets(const UINT32& block, const int file_count, ...
 }
 	
 
-void dna_adjust::SetRegionOffset(vmat_file_map& file_map)
+// Sets the offset of the region last added to file_map.  When the stage
+// file is being created, regions are laid out in the order in which they 
+// are written.  Otherwise, the offset is taken from the index of the 
+// existing file, which must hold a region of the same size.
+void dna_adjust::SetRegionOffset(vmat_file_map& file_map, const UINT32& block, const int file)
+{
+	block_map_t& block_map(file_map.vblockMapRegions_.back());
+
+	if (projectSettings_.a.recreate_stage_files)
+	{
+		block_map.SetRegionOffset(stageFileOffset_);
+		stageFileOffset_ += block_map.GetDataSize();
+		return;
+	}
+
+	std::stringstream ss;
+	if (block >= stageFileHeader_._blockCount)
+		ss << "SetRegionOffset(): The stage file holds " << stageFileHeader_._blockCount << 
+			" blocks, but the network" << std::endl << "  has been segmented into " << blockCount_ << " blocks." << std::endl << std::endl;
+	else if (v_stageFileIndex_.at(StageFileIndex(block, file) + 1) != block_map.GetDataSize())
+		ss << "SetRegionOffset(): The dimensions of the matrices of block " << block + 1 << 
+			" do not match" << std::endl << "  those in the stage file." << std::endl << std::endl;
+
+	if (!ss.str().empty())
+	{
+		ss << "  Please re-run the adjustment using the --" << RECREATE_STAGE_FILES << " option." << std::endl;
+		adj_file << std::endl << "- Error: " << ss.str() << std::endl;
+		SignalExceptionAdjustment(ss.str(), block);
+	}
+
+	block_map.SetRegionOffset(static_cast<size_t>(v_stageFileIndex_.at(StageFileIndex(block, file))));
+}
+	
+
+// Gets the position in the stage file index of the offset of a block's
+// matrix.  The size of the matrix follows.
+std::size_t dna_adjust::StageFileIndex(const UINT32& block, const int file) const
+{
+	const std::size_t matrices(std::bitset<32>(stageFileHeader_._matrices).count());
+	const std::size_t matrix(std::bitset<32>(stageFileHeader_._matrices & ((1u << file) - 1)).count());
+	return (block * matrices + matrix) * 2;
+}
+	
+
+// Computes a hash (FNV-1a) of the segmented and ordered network, so that
+// stage and checkpoint files can be reused only by adjustments of the 
+// network from which they were created
+std::uint64_t dna_adjust::NetworkFingerprint()
+{
+	std::uint64_t hash(14695981039346656037ULL);
+	auto add = [&hash](const char* data, const std::streamsize& size) {
+		for (std::streamsize i(0); i < size; ++i)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	// Stations and measurements
+	binary_file_meta_t bms_meta;
+	try {
+		BmsFile bms;
+		bms.LoadFileMeta(projectSettings_.a.bms_file, bms_meta);
+	}
+	catch (const std::runtime_error& e) {
+		SignalExceptionAdjustment(e.what(), 0);
+	}
+	add(reinterpret_cast<const char*>(&bst_meta_.binCount), sizeof(bst_meta_.binCount));
+	add(reinterpret_cast<const char*>(&bms_meta.binCount), sizeof(bms_meta.binCount));
+	add(bst_meta_.epsgCode, sizeof(bst_meta_.epsgCode));
+	add(bst_meta_.epoch, sizeof(bst_meta_.epoch));
+
+	// Segmentation, excluding the file header which records when and 
+	// how the file was created
+	if (projectSettings_.a.adjust_mode != SimultaneousMode && 
+		std::filesystem::exists(projectSettings_.a.seg_file))
+	{
+		std::ifstream seg_file(projectSettings_.a.seg_file.c_str());
+		std::string line;
+		bool summary(false);
+		while (std::getline(seg_file, line))
+		{
+			if (!summary)
+				summary = (line.compare(0, 20, "SEGMENTATION SUMMARY") == 0);
+			if (summary)
+				add(line.c_str(), static_cast<std::streamsize>(line.length()));
+		}
+	}
+
+	// Position of each station in the normals of each block, which 
+	// depends on the order in which the stations are arranged
+	add(reinterpret_cast<const char*>(&projectSettings_.a.station_ordering), sizeof(projectSettings_.a.station_ordering));
+	UINT32 position;
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		for (const auto& stn : v_parameterStationList_.at(block))
+		{
+			position = BlockStationPosition(block, stn);
+			add(reinterpret_cast<const char*>(&stn), sizeof(UINT32));
+			add(reinterpret_cast<const char*>(&position), sizeof(UINT32));
+		}
+	}
+
+	return hash;
+}
+	
+
+// Reads the header and index of a stage file created by a previous 
+// adjustment.  The file must hold the matrices required, and must have 
+// been created from the network as it is currently imported, segmented
+// and ordered.  When the stage file is opened before the blocks have been 
+// loaded, the latter is verified by PrepareAdjustment once the position 
+// of each station in each block is known.
+void dna_adjust::ReadStageFileIndex(const UINT32& matrices)
+{
+	const std::string filePath(v_stageFileStreams_.front());
+
+	stageFileHeader_ = stageFileHeader_t();
+	v_stageFileIndex_.clear();
+
+	std::string reason;
+	std::ifstream stage_file;
+	
+	if (!std::filesystem::exists(filePath))
+		reason = "does not exist.";
+	else
+	{
+		stage_file.open(filePath.c_str(), std::ios::in | std::ios::binary);
+		stage_file.read(reinterpret_cast<char*>(&stageFileHeader_), sizeof(stageFileHeader_t));
+
+		if (!stage_file || stageFileHeader_._indexOffset == 0 ||
+			memcmp(stageFileHeader_._magic, stage_file_magic, sizeof(stageFileHeader_._magic)) != 0)
+			reason = "is incomplete or is not a stage file.";
+		else if (stageFileHeader_._version != STAGE_FILE_VERSION)
+			reason = "was created by a different version of adjust.";
+		else if ((stageFileHeader_._matrices & matrices) != matrices)
+			reason = "does not hold the matrices required.";
+		else if (!bst_meta_.reduced)
+			reason = "was not created from the network as\n  it is currently imported, segmented and ordered.";
+		else
+		{
+			v_stageFileIndex_.resize(static_cast<std::size_t>(stageFileHeader_._blockCount) * 
+				std::bitset<32>(stageFileHeader_._matrices).count() * 2);
+			stage_file.seekg(static_cast<std::streamoff>(stageFileHeader_._indexOffset));
+			stage_file.read(reinterpret_cast<char*>(v_stageFileIndex_.data()), 
+				static_cast<std::streamsize>(v_stageFileIndex_.size() * sizeof(std::uint64_t)));
+			if (!stage_file)
+				reason = "is incomplete or is not a stage file.";
+		}
+	}
+
+	if (reason.empty())
+	{
+		if (!v_blockStationIndexStart_.empty())
+			VerifyStageFileFingerprint();
+		return;
+	}
+
+	std::stringstream ss;
+	ss << "ReadStageFileIndex(): The stage file " << leafStr<std::string>(filePath) << " " << reason << std::endl << std::endl;
+	ss << "  Please re-run the adjustment using the --" << RECREATE_STAGE_FILES << " option." << std::endl;
+	adj_file << std::endl << "- Error: " << ss.str() << std::endl;
+	SignalExceptionAdjustment(ss.str(), 0);
+}
+	
+
+// Verifies that the stage file being reused was created from the network 
+// as it is currently imported, segmented and ordered
+void dna_adjust::VerifyStageFileFingerprint()
 {
-	// Get iterator to the second last mapped region
-	_it_block_map _it_bmap_prev(file_map.vblockMapRegions_.end() - 1);
-	if (_it_bmap_prev == file_map.vblockMapRegions_.begin())
+	if (stageFileHeader_._fingerprint == NetworkFingerprint())
 		return;
-	_it_bmap_prev--;
-	// Get iterator to the last mapped region
-	_it_block_map _it_bmap(file_map.vblockMapRegions_.end() - 1);
-	// Set region offset for the last mapped region
-	_it_bmap->SetRegionOffset(_it_bmap_prev->GetCumulativeRegionOffset());	
+
+	std::stringstream ss;
+	ss << "VerifyStageFileFingerprint(): The stage file " << leafStr<std::string>(v_stageFileStreams_.front()) << 
+		" was not created from the network as" << std::endl << "  it is currently imported, segmented and ordered." << std::endl << std::endl;
+	ss << "  Please re-run the adjustment using the --" << RECREATE_STAGE_FILES << " option." << std::endl;
+	adj_file << std::endl << "- Error: " << ss.str() << std::endl;
+	SignalExceptionAdjustment(ss.str(), 0);
 }
 	
 
@@ -159,21 +366,41 @@ void dna_adjust::DeserialiseBlockFromMappedFile(const UINT32& block, const int f
 		return;
 	}
 
+	// Wait for any outstanding i/o on this block
+	WaitForBlock(block);
+
 	va_list vlist;
 	va_start(vlist, file_count);
-	
-	void* addr;
+
+	// Charge this block's matrix buffers to the block's lease, which is
+	// released by UnloadBlock
+	memory::arena_lease lease(block + 1);
+
+	int stage_file;
 
 	for (UINT16 file(0); file<file_count; ++file)
 	{
-		switch (va_arg(vlist, int))
+		stage_file = va_arg(vlist, int);
+
+		// Matrices retained in memory since the block was offloaded 
+		// are identical to the stage files, so need not be read again
+		if (RetrieveRetainedMatrix(block, stage_file))
+		{
+			if (stage_file == sf_corrections && v_blockMeta_.at(block)._blockLast)
+				v_correctionsR_.at(block).allocate();
+			continue;
+		}
+
+		if (MemoryLimited())
+			SetMatrixResident(block, stage_file, true);
+
+		switch (stage_file)
 		{
 		case sf_normals:
 			v_normals_.at(block).allocate();
 			break;
 		case sf_normals_r:
-			addr = normalsR_map_.GetBlockRegionAddr(block);
-			v_normalsR_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(normalsR_map_, block, v_normalsR_.at(block));
 			break;
 		case sf_atvinv:
 			v_AtVinv_.at(block).allocate();
@@ -182,48 +409,37 @@ void dna_adjust::DeserialiseBlockFromMappedFile(const UINT32& block, const int f
 			v_design_.at(block).allocate();
 			break;
 		case sf_meas_minus_comp:
-			addr = measMinusComp_map_.GetBlockRegionAddr(block);
-			v_measMinusComp_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(measMinusComp_map_, block, v_measMinusComp_.at(block));
 			break;
 		case sf_estimated_stns:
-			addr = estimatedStations_map_.GetBlockRegionAddr(block);
-			v_estimatedStations_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(estimatedStations_map_, block, v_estimatedStations_.at(block));
 			break;
 		case sf_original_stns:
-			addr = originalStations_map_.GetBlockRegionAddr(block);
-			v_originalStations_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(originalStations_map_, block, v_originalStations_.at(block));
 			break;
 		case sf_rigorous_stns:
-			addr = rigorousStations_map_.GetBlockRegionAddr(block);
-			v_rigorousStations_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(rigorousStations_map_, block, v_rigorousStations_.at(block));
 			break;
 		case sf_junction_vars:
-			addr = junctionVariances_map_.GetBlockRegionAddr(block);
-			v_junctionVariances_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(junctionVariances_map_, block, v_junctionVariances_.at(block));
 			break;
 		case sf_junction_vars_f:
-			addr = junctionVariancesFwd_map_.GetBlockRegionAddr(block);
-			v_junctionVariancesFwd_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(junctionVariancesFwd_map_, block, v_junctionVariancesFwd_.at(block));
 			break;
 		case sf_junction_ests_f:
-			addr = junctionEstimatesFwd_map_.GetBlockRegionAddr(block);
-			v_junctionEstimatesFwd_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(junctionEstimatesFwd_map_, block, v_junctionEstimatesFwd_.at(block));
 			break;
 		case sf_junction_ests_r:
-			addr = junctionEstimatesRev_map_.GetBlockRegionAddr(block);
-			v_junctionEstimatesRev_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(junctionEstimatesRev_map_, block, v_junctionEstimatesRev_.at(block));
 			break;
 		case sf_rigorous_vars:
-			addr = rigorousVariances_map_.GetBlockRegionAddr(block);
-			v_rigorousVariances_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(rigorousVariances_map_, block, v_rigorousVariances_.at(block));
 			break;
 		case sf_prec_adj_msrs:
-			addr = precAdjMsrs_map_.GetBlockRegionAddr(block);
-			v_precAdjMsrsFull_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(precAdjMsrs_map_, block, v_precAdjMsrsFull_.at(block));
 			break;
 		case sf_corrections:
-			addr = corrections_map_.GetBlockRegionAddr(block);
-			v_corrections_.at(block).ReadMappedFileRegion(addr);
+			DeserialiseMatrix(corrections_map_, block, v_corrections_.at(block));
 
 			if (v_blockMeta_.at(block)._blockLast)
 				v_correctionsR_.at(block).allocate();
@@ -232,6 +448,9 @@ void dna_adjust::DeserialiseBlockFromMappedFile(const UINT32& block, const int f
 		}
 	}
 	va_end(vlist);
+
+	if (MemoryLimited())
+		RecordResidentBytes();
 }
 
 void dna_adjust::SerialiseBlockToMappedFile(const UINT32& block, const int file_count, ...)
@@ -248,6 +467,9 @@ void dna_adjust::SerialiseBlockToMappedFile(const UINT32& block, const int file_
 		return;
 	}
 
+	// Wait for any outstanding i/o on this block
+	WaitForBlock(block);
+
 	va_list vlist;
 	va_start(vlist, file_count);
 	
@@ -394,150 +616,46 @@ void dna_adjust::OpenStageFileStreams(const int file_count, ...)
 		return;
 	}
 
+	// The matrices of all blocks are held in the one stage file
 	std::stringstream ss;
-	ss << projectSettings_.g.output_folder << FOLDER_SLASH << projectSettings_.g.network_name << "-";
+	ss << projectSettings_.g.output_folder << FOLDER_SLASH << projectSettings_.g.network_name << "-stage.mtx";
 	std::string filePath(ss.str());
 
 	v_stageFileStreams_.clear();
-	std::string fullfilePath;
+	v_stageFileStreams_.push_back(filePath);
+
+	UINT32 matrices(0);
 
 	va_list vlist;
 	va_start(vlist, file_count);
-	
-	try {		
+	for (UINT16 file(0); file<file_count; ++file)
+		matrices |= 1u << va_arg(vlist, int);
+	va_end(vlist);
 
-		for (UINT16 file(0); file<file_count; ++file)
-		{
-			switch (va_arg(vlist, int))
-			{
-			case sf_normals_r:
-		
-				// Normals - reverse
-				fullfilePath = filePath + "neqr.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_normalsR_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				normalsR_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-			
-				break;
-			case sf_meas_minus_comp:
-
-				// Measured minus computed
-				fullfilePath = filePath + "mmc.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_measMinusComp_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				measMinusComp_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-		
-				break;
-			case sf_estimated_stns:
-
-				// Estimated stations
-				fullfilePath = filePath + "est.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_estimatedStations_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				estimatedStations_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_original_stns:
-
-				// Original stations
-				fullfilePath = filePath + "ost.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_originalStations_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				originalStations_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_rigorous_stns:
-
-				// Rigorous stations
-				fullfilePath = filePath + "rst.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_rigorousStations_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				rigorousStations_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_junction_vars:
-
-				// Junction variances
-				fullfilePath = filePath + "jva.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_junctionVariances_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				junctionVariances_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_junction_vars_f:
-
-				// Junction variances forward
-				fullfilePath = filePath + "jvf.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_junctionVariancesFwd_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				junctionVariancesFwd_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_junction_ests_f:
-
-				// Junction estimates forward
-				fullfilePath = filePath + "jef.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_junctionEstimatesFwd_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				junctionEstimatesFwd_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_junction_ests_r:
-
-				// Junction estimates reverse
-				fullfilePath = filePath + "jer.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_junctionEstimatesRev_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				junctionEstimatesRev_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_rigorous_vars:
-
-				// Rigorous variances
-				fullfilePath = filePath + "rva.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_rigorousVariances_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				rigorousVariances_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_prec_adj_msrs:
-
-				// Precision adjusted measurements
-				fullfilePath = filePath + "pam.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_precAdjMsrs_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				precAdjMsrs_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			case sf_corrections:
-
-				// Corrections
-				fullfilePath = filePath + "cor.mtx";
-				v_stageFileStreams_.push_back(fullfilePath);
-				if (projectSettings_.a.recreate_stage_files)
-					file_opener(f_corrections_, fullfilePath, std::ios::out | std::ios::binary, binary);
-				corrections_map_.setnewFilePath(fullfilePath, projectSettings_.a.purge_stage_files);
-
-				break;
-			}
-		}
-		va_end(vlist);
+	for (int file(sf_normals); file<=sf_corrections; ++file)
+		if (matrices & (1u << file))
+			StageFileMap(file)->setnewFilePath(filePath, projectSettings_.a.purge_stage_files);
+
+	// Reuse the stage file created by a previous adjustment
+	if (!projectSettings_.a.recreate_stage_files)
+	{
+		ReadStageFileIndex(matrices);
+		return;
+	}
+
+	try {
+		file_opener(f_stage_, filePath, std::ios::out | std::ios::binary, binary);
 	}
 	catch (const std::runtime_error& e) {
-		va_end(vlist);
 		SignalExceptionAdjustment(e.what(), 0);
 	}
+
+	// Reserve space for the header, which is completed once all 
+	// blocks have been written
+	stageFileHeader_ = stageFileHeader_t();
+	stageFileHeader_._matrices = matrices;
+	f_stage_.write(reinterpret_cast<const char*>(&stageFileHeader_), sizeof(stageFileHeader_t));
+	stageFileOffset_ = sizeof(stageFileHeader_t);
 }
 	
 void dna_adjust::SetMapRegions(const int file_count, ...)
@@ -839,6 +957,14 @@ void dna_adjust::OffloadBlockToDisk(const UINT32& block)
 	// Write block matrix data to disk
 	SerialiseBlockToDisk(block);
 
+	// Under a memory limit, keep the block in memory if it fits.  The
+	// first block to be needed is the first block of the forward pass.
+	if (MemoryLimited())
+	{
+		RetainBlock(block, 0, false);
+		return;
+	}
+
 	// Unload block matrix data from memory
 	UnloadBlock(block);
 }
@@ -846,11 +972,371 @@ void dna_adjust::OffloadBlockToDisk(const UINT32& block)
 
 void dna_adjust::OffloadBlockToMappedFile(const UINT32& block)
 {
+	// The block's normals, design and At * V-1 are now fully formed
+	if (MemoryLimited())
+		RecordResidentBytes();
+
+	// Copy the block's estimates if a checkpoint is due
+	RecordCheckpointBlock(block);
+
 	// Write block matrix data to disk
 	SerialiseBlockToMappedFile(block);
 
+	// Under a memory limit, keep the block in memory if it fits
+	if (MemoryLimited())
+	{
+		RetainBlock(block, block, forward_);
+		return;
+	}
+
 	// Unload block matrix data from memory
 	UnloadBlock(block);
+
+	// Flush and unmap the block's regions in the background
+	WriteBehindBlock(block);
+}
+	
+
+// Retains the staged matrices of a block in memory once they have been
+// written to the stage files, and unloads the rest.  Blocks are then 
+// evicted until the resident matrices fit within the memory limit.  
+// position and forward give the block just adjusted and the direction 
+// of the pass, from which the order in which blocks are needed is known.
+void dna_adjust::RetainBlock(const UINT32& block, const UINT32& position, const bool forward)
+{
+	for (int stage_file(sf_normals); stage_file<=sf_corrections; ++stage_file)
+		if (staged_matrices & (1u << stage_file))
+			SetMatrixResident(block, stage_file, true);
+	v_blockRetainedFiles_.at(block) = staged_matrices;
+
+	UnloadBlock(block);
+
+	EnforceMemoryLimit(position, forward);
+}
+	
+
+// Hands a retained matrix back to the adjustment.  Returns false if the
+// matrix was not retained and must be read from the stage file.
+bool dna_adjust::RetrieveRetainedMatrix(const UINT32& block, const int file)
+{
+	if (!MemoryLimited())
+		return false;
+	if ((v_blockRetainedFiles_.at(block) & (1u << file)) == 0)
+		return false;
+
+	// Once retrieved, the matrix may be changed and so is no longer 
+	// identical to the stage file
+	v_blockRetainedFiles_.at(block) &= ~(1u << file);
+	return true;
+}
+	
+
+// Records whether a staged or formed matrix is held in memory, and the 
+// memory occupied by all resident staged matrices
+void dna_adjust::SetMatrixResident(const UINT32& block, const int file, const bool resident)
+{
+	if (((staged_matrices | formed_matrices) & (1u << file)) == 0)
+		return;
+	if (((v_blockResidentFiles_.at(block) & (1u << file)) != 0) == resident)
+		return;
+
+	std::size_t bytes(0);
+	if (staged_matrices & (1u << file))
+	{
+		vmat_file_map* file_map(StageFileMap(file));
+		if (block < file_map->vblockMapRegions_.size())
+			bytes = file_map->vblockMapRegions_.at(block).GetDataSize();
+	}
+
+	if (resident)
+	{
+		v_blockResidentFiles_.at(block) |= (1u << file);
+		residentBytes_ += bytes;
+	}
+	else
+	{
+		v_blockResidentFiles_.at(block) &= ~(1u << file);
+		residentBytes_ -= bytes;
+	}
+}
+	
+
+// Memory occupied by the resident staged matrices, the normals, design
+// and At * V-1 of the blocks in use, the columns of the inverse solved by
+// the iterative solver and the retained GNSS inverses
+std::size_t dna_adjust::ResidentBytes() const
+{
+	std::size_t bytes(residentBytes_ + iterativeVariances_.memorySize() + gnssInverseBytes_);
+
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		if ((v_blockResidentFiles_.at(block) & formed_matrices) == 0)
+			continue;
+		if (v_blockResidentFiles_.at(block) & (1u << sf_normals))
+			bytes += v_normals_.at(block).elementCount() * sizeof(double);
+		if (v_blockResidentFiles_.at(block) & (1u << sf_atvinv))
+			bytes += v_AtVinv_.at(block).memorySize();
+		if (v_blockResidentFiles_.at(block) & (1u << sf_design))
+			bytes += v_design_.at(block).memorySize();
+	}
+
+	return bytes;
+}
+	
+
+void dna_adjust::RecordResidentBytes()
+{
+	peakResidentBytes_ = std::max(peakResidentBytes_, ResidentBytes());
+}
+	
+
+// Evicts retained blocks until the resident matrices fit within the 
+// memory limit.  The block evicted first is the one needed furthest in
+// the future.  Blocks in use are never evicted.
+void dna_adjust::EnforceMemoryLimit(const UINT32& position, const bool forward)
+{
+	const std::size_t limit(static_cast<std::size_t>(projectSettings_.a.memory_limit * static_cast<double>(MEGABYTE_SIZE)));
+	UINT32 block, victim, distance, furthest;
+
+	while (ResidentBytes() > limit)
+	{
+		victim = blockCount_;
+		furthest = 0;
+
+		for (block=0; block<blockCount_; ++block)
+		{
+			if (v_blockRetainedFiles_.at(block) == 0)
+				continue;
+			distance = BlocksUntilNeeded(block, position, forward);
+			if (victim == blockCount_ || distance > furthest)
+			{
+				victim = block;
+				furthest = distance;
+			}
+		}
+
+		// Only blocks in use remain
+		if (victim == blockCount_)
+			break;
+
+		EvictBlock(victim);
+	}
+
+	RecordResidentBytes();
+}
+	
+
+// Unloads the retained matrices of a block, leaving the stage files as
+// the only copy
+void dna_adjust::EvictBlock(const UINT32& block)
+{
+	const UINT32 retained(v_blockRetainedFiles_.at(block));
+	v_blockRetainedFiles_.at(block) = 0;
+
+	for (int stage_file(sf_normals); stage_file<=sf_corrections; ++stage_file)
+		if (retained & (1u << stage_file))
+			UnloadBlock(block, 1, stage_file);
+
+	blocksEvicted_++;
+
+	// Flush and unmap the block's regions in the background
+	WriteBehindBlock(block);
+}
+	
+
+// Gets the number of block adjustments that will take place before block
+// is next needed, given that the block at position has just been adjusted
+// in a forward (or reverse) pass.  A forward pass is followed by a reverse 
+// pass, except in Block 1 mode, where only forward passes are run.
+UINT32 dna_adjust::BlocksUntilNeeded(const UINT32& block, const UINT32& position, const bool forward) const
+{
+	const UINT32 lastBlock(blockCount_ - 1);
+
+	if (forward)
+	{
+		if (block > position)
+			return block - position;
+		if (projectSettings_.a.adjust_mode == Phased_Block_1Mode)
+			return lastBlock - position + block + 1;
+		return lastBlock - position + lastBlock - block + 1;
+	}
+
+	if (block < position)
+		return position - block;
+	return position + block + 1;
+}
+	
+
+// Gets the stage files that hold a mapped region for block
+void dna_adjust::StageFileMaps(const UINT32& block, std::vector<vmat_file_map*>& file_maps)
+{
+	vmat_file_map* stage_maps[] = {
+		&normalsR_map_, &measMinusComp_map_,
+		&estimatedStations_map_, &originalStations_map_, &rigorousStations_map_,
+		&junctionVariances_map_, &junctionVariancesFwd_map_, &junctionEstimatesFwd_map_, &junctionEstimatesRev_map_,
+		&rigorousVariances_map_, &precAdjMsrs_map_, &corrections_map_ };
+
+	file_maps.clear();
+	for (vmat_file_map* file_map : stage_maps)
+		if (file_map->getFileMapPtr() && block < file_map->vblockMapRegions_.size())
+			file_maps.push_back(file_map);
+}
+	
+
+// Gets the stage file map which holds the regions of file, or nullptr if
+// the matrix is not staged
+vmat_file_map* dna_adjust::StageFileMap(const int file)
+{
+	switch (file)
+	{
+	case sf_normals_r:
+		return &normalsR_map_;
+	case sf_meas_minus_comp:
+		return &measMinusComp_map_;
+	case sf_estimated_stns:
+		return &estimatedStations_map_;
+	case sf_original_stns:
+		return &originalStations_map_;
+	case sf_rigorous_stns:
+		return &rigorousStations_map_;
+	case sf_junction_vars:
+		return &junctionVariances_map_;
+	case sf_junction_vars_f:
+		return &junctionVariancesFwd_map_;
+	case sf_junction_ests_f:
+		return &junctionEstimatesFwd_map_;
+	case sf_junction_ests_r:
+		return &junctionEstimatesRev_map_;
+	case sf_rigorous_vars:
+		return &rigorousVariances_map_;
+	case sf_prec_adj_msrs:
+		return &precAdjMsrs_map_;
+	case sf_corrections:
+		return &corrections_map_;
+	default:
+		return nullptr;
+	}
+}
+	
+
+// Maps (if required) the regions of block and reads them into memory on the
+// stage i/o thread, so that the block can be deserialised without waiting
+// on the disk.  Called for the next block whilst the current block is 
+// being adjusted.
+void dna_adjust::PrefetchBlock(const UINT32& block)
+{
+	if (!projectSettings_.a.stage)
+		return;
+	if (block >= blockCount_)
+		return;
+	// Retained blocks are already in memory
+	if (MemoryLimited() && v_blockRetainedFiles_.at(block) == staged_matrices)
+		return;
+
+	try {
+		stageIO_.submit(block, [this, block]() {
+			std::vector<vmat_file_map*> file_maps;
+			StageFileMaps(block, file_maps);
+
+			const std::size_t page_size(boost::interprocess::mapped_region::get_page_size());
+			char touched(0);
+
+			for (vmat_file_map* file_map : file_maps)
+			{
+				block_map_t& region(file_map->vblockMapRegions_.at(block));
+				if (!region.region_ptr_)
+					file_map->MapRegion(block);
+				if (region.GetDataSize() == 0)
+					continue;
+
+				region.region_ptr_->advise(boost::interprocess::mapped_region::advice_willneed);
+
+				// Fault in each page of the region
+				const volatile char* addr(static_cast<const char*>(region.GetRegionAddr()));
+				for (std::size_t b(0); b<region.GetDataSize(); b+=page_size)
+					touched ^= addr[b];
+			}
+			(void)touched;
+		});
+	}
+	catch (const std::exception& e) {
+		std::stringstream ss;
+		ss << "PrefetchBlock(): An error was encountered when reading block " << 
+			block + 1 << " from the .mtx stage files." << std::endl << "  " << e.what() << std::endl;
+		SignalExceptionAdjustment(ss.str(), block);
+	}
+}
+	
+
+// Writes the dirty pages of block to disk and unmaps its regions on the
+// stage i/o thread.  The block must have been serialised and unloaded.
+void dna_adjust::WriteBehindBlock(const UINT32& block)
+{
+	if (!projectSettings_.a.stage)
+		return;
+
+	try {
+		stageIO_.submit(block, [this, block]() {
+			std::vector<vmat_file_map*> file_maps;
+			StageFileMaps(block, file_maps);
+
+			for (vmat_file_map* file_map : file_maps)
+			{
+				block_map_t& region(file_map->vblockMapRegions_.at(block));
+				if (!region.region_ptr_)
+					continue;
+				if (region.GetDataSize() > 0)
+					if (!region.region_ptr_->flush(0, region.GetDataSize(), false))
+						throw std::runtime_error("Failed to flush the mapped region to disk.");
+				region.region_ptr_.reset();
+			}
+		});
+	}
+	catch (const std::exception& e) {
+		std::stringstream ss;
+		ss << "WriteBehindBlock(): An error was encountered when writing block " << 
+			block + 1 << " to the .mtx stage files." << std::endl << "  " << e.what() << std::endl;
+		SignalExceptionAdjustment(ss.str(), block);
+	}
+}
+	
+
+// Waits for any prefetch or write-behind of block to finish, and maps
+// the block's regions if they were unmapped by WriteBehindBlock
+void dna_adjust::WaitForBlock(const UINT32& block)
+{
+	if (!projectSettings_.a.stage)
+		return;
+
+	try {
+		stageIO_.wait(block);
+
+		std::vector<vmat_file_map*> file_maps;
+		StageFileMaps(block, file_maps);
+		for (vmat_file_map* file_map : file_maps)
+			if (!file_map->vblockMapRegions_.at(block).region_ptr_)
+				file_map->MapRegion(block);
+	}
+	catch (const std::exception& e) {
+		std::stringstream ss;
+		ss << "WaitForBlock(): An error was encountered when reading or writing block " << 
+			block + 1 << " of the .mtx stage files." << std::endl << "  " << e.what() << std::endl;
+		SignalExceptionAdjustment(ss.str(), block);
+	}
+}
+	
+
+void dna_adjust::WaitForStageIO()
+{
+	try {
+		stageIO_.wait_all();
+	}
+	catch (const std::exception& e) {
+		std::stringstream ss;
+		ss << "WaitForStageIO(): An error was encountered when reading or writing" << 
+			" the .mtx stage files." << std::endl << "  " << e.what() << std::endl;
+		SignalExceptionAdjustment(ss.str(), 0);
+	}
 }
 	
 
@@ -858,30 +1344,20 @@ void dna_adjust::SerialiseBlockToDisk(const UINT32& block)
 {
 	// Write block matrix data to disk
 	try {
-		// Normals - reverse
-		f_normalsR_ << v_normalsR_.at(block);							// ...neqr.mtx		
-		// Measured minus computed
-		f_measMinusComp_ << v_measMinusComp_.at(block);					// ...mmc.mtx		
-		// Estimated stations
-		f_estimatedStations_ << v_estimatedStations_.at(block);			// ...est.mtx
-		// original stations
-		f_originalStations_ << v_originalStations_.at(block);			// ...ost.mtx
-		// Rigorous stations
-		f_rigorousStations_ << v_rigorousStations_.at(block);			// ...rst.mtx
-		// Junction variances
-		f_junctionVariances_ << v_junctionVariances_.at(block);			// ...jva.mtx
-		// Junction variances forward
-		f_junctionVariancesFwd_ << v_junctionVariancesFwd_.at(block);	// ...jvf.mtx
-		// Junction estimates forward
-		f_junctionEstimatesFwd_ << v_junctionEstimatesFwd_.at(block);	// ...jef.mtx
-		// Junction estimates reverse
-		f_junctionEstimatesRev_ << v_junctionEstimatesRev_.at(block);	// ...jer.mtx
-		// Rigorous variances
-		f_rigorousVariances_ << v_rigorousVariances_.at(block);			// ...rva.mtx
-		// Precision adjusted measurements
-		f_precAdjMsrs_ << v_precAdjMsrsFull_.at(block);					// ...pam.mtx
-		// Corrections
-		f_corrections_ << v_corrections_.at(block);						// ...cor.mtx
+		// Matrices are written in the order in which their regions
+		// were laid out by SetRegionOffsets
+		f_stage_ << v_normalsR_.at(block);					// Normals - reverse
+		f_stage_ << v_measMinusComp_.at(block);				// Measured minus computed
+		f_stage_ << v_estimatedStations_.at(block);			// Estimated stations
+		f_stage_ << v_originalStations_.at(block);			// Original stations
+		f_stage_ << v_rigorousStations_.at(block);			// Rigorous stations
+		f_stage_ << v_junctionVariances_.at(block);			// Junction variances
+		f_stage_ << v_junctionVariancesFwd_.at(block);		// Junction variances forward
+		f_stage_ << v_junctionEstimatesFwd_.at(block);		// Junction estimates forward
+		f_stage_ << v_junctionEstimatesRev_.at(block);		// Junction estimates reverse
+		f_stage_ << v_rigorousVariances_.at(block);			// Rigorous variances
+		f_stage_ << v_precAdjMsrsFull_.at(block);			// Precision adjusted measurements
+		f_stage_ << v_corrections_.at(block);				// Corrections
 	}
 	catch (...) {
 		std::stringstream ss;
@@ -907,103 +1383,125 @@ void dna_adjust::UnloadBlock(const UINT32& block, const int file_count, ...)
 	va_list vlist;
 	va_start(vlist, file_count);
 
+	int stage_file;
+
 	// Unload block matrix data from memory
 	for (UINT16 file(0); file<file_count; ++file)
 	{
-		switch (va_arg(vlist, int))
+		stage_file = va_arg(vlist, int);
+
+		if (MemoryLimited())
+		{
+			// Retained matrices remain in memory until the block is evicted
+			if (v_blockRetainedFiles_.at(block) & (1u << stage_file))
+				continue;
+			SetMatrixResident(block, stage_file, false);
+		}
+
+		switch (stage_file)
 		{
 		case sf_normals:
-			v_normals_.at(block).~matrix_2d();
+			v_normals_.at(block).deallocate();
 			break;
 		case sf_normals_r:
-			v_normalsR_.at(block).~matrix_2d();
+			v_normalsR_.at(block).deallocate();
 			break;
 		case sf_atvinv:
-			v_AtVinv_.at(block).~matrix_2d();
+			v_AtVinv_.at(block).deallocate();
 			break;
 		case sf_design:
-			v_design_.at(block).~matrix_2d();
+			v_design_.at(block).deallocate();
 			break;
 		case sf_meas_minus_comp:
-			v_measMinusComp_.at(block).~matrix_2d();
+			v_measMinusComp_.at(block).deallocate();
 			break;
 		case sf_estimated_stns:
-			v_estimatedStations_.at(block).~matrix_2d();
+			v_estimatedStations_.at(block).deallocate();
 			break;
 		case sf_original_stns:
-			v_originalStations_.at(block).~matrix_2d();
+			v_originalStations_.at(block).deallocate();
 			break;
 		case sf_rigorous_stns:
-			v_rigorousStations_.at(block).~matrix_2d();
+			v_rigorousStations_.at(block).deallocate();
 			break;
 		case sf_junction_vars:
-			v_junctionVariances_.at(block).~matrix_2d();
+			v_junctionVariances_.at(block).deallocate();
 			break;
 		case sf_junction_vars_f:
-			v_junctionVariancesFwd_.at(block).~matrix_2d();
+			v_junctionVariancesFwd_.at(block).deallocate();
 			break;
 		case sf_junction_ests_f:
-			v_junctionEstimatesFwd_.at(block).~matrix_2d();
+			v_junctionEstimatesFwd_.at(block).deallocate();
 			break;
 		case sf_junction_ests_r:
-			v_junctionEstimatesRev_.at(block).~matrix_2d();
+			v_junctionEstimatesRev_.at(block).deallocate();
 			break;
 		case sf_rigorous_vars:
-			v_rigorousVariances_.at(block).~matrix_2d();
+			v_rigorousVariances_.at(block).deallocate();
 			break;
 		case sf_prec_adj_msrs:
-			v_precAdjMsrsFull_.at(block).~matrix_2d();
+			v_precAdjMsrsFull_.at(block).deallocate();
 			break;
 		case sf_corrections:
-			v_corrections_.at(block).~matrix_2d();
+			v_corrections_.at(block).deallocate();
 
 			if (v_blockMeta_.at(block)._blockLast)
-				v_correctionsR_.at(block).~matrix_2d();
+				v_correctionsR_.at(block).deallocate();
 			break;
 		}
 	}
 	va_end(vlist);
+
+	// Hand the block's free buffers back to the arena, so that they
+	// may be reused by the next block
+	memory::buffer_arena::instance().release_lease(block + 1);
 }
 	
 
+// Completes the stage file by writing the index of the regions of all
+// blocks, followed by the header
 void dna_adjust::CloseStageFileStreams()
 {
-	// Normals -- reverse
-	f_normalsR_.close();
-
-	// Measured minus computed
-	f_measMinusComp_.close();
-
-	// Estimated stations
-	f_estimatedStations_.close();
-
-	// Original stations
-	f_originalStations_.close();
-
-	// Rigorous stations
-	f_rigorousStations_.close();
-
-	// Junction variances
-	f_junctionVariances_.close();
-
-	// Junction variances forward
-	f_junctionVariancesFwd_.close();
+	if (!f_stage_.is_open())
+		return;
 
-	// Junction estimates forward
-	f_junctionEstimatesFwd_.close();
+	stageFileHeader_._blockCount = blockCount_;
+	stageFileHeader_._indexOffset = stageFileOffset_;
 
-	// Junction estimates reverse
-	f_junctionEstimatesRev_.close();
+	v_stageFileIndex_.clear();
+	v_stageFileIndex_.reserve(static_cast<std::size_t>(blockCount_) * 
+		std::bitset<32>(stageFileHeader_._matrices).count() * 2);
 
-	// Rigorous variances
-	f_rigorousVariances_.close();
+	for (UINT32 block(0); block<blockCount_; ++block)
+	{
+		for (int file(sf_normals); file<=sf_corrections; ++file)
+		{
+			if (!(stageFileHeader_._matrices & (1u << file)))
+				continue;
+			const block_map_t& block_map(StageFileMap(file)->vblockMapRegions_.at(block));
+			v_stageFileIndex_.push_back(block_map.GetRegionOffset());
+			v_stageFileIndex_.push_back(block_map.GetDataSize());
+		}
+	}
 
-	// Precision adjusted measurements
-	f_precAdjMsrs_.close();
+	try {
+		f_stage_.seekp(static_cast<std::streamoff>(stageFileOffset_));
+		f_stage_.write(reinterpret_cast<const char*>(v_stageFileIndex_.data()), 
+			static_cast<std::streamsize>(v_stageFileIndex_.size() * sizeof(std::uint64_t)));
 
-	// Corrections
-	f_corrections_.close();
+		memcpy(stageFileHeader_._magic, stage_file_magic, sizeof(stageFileHeader_._magic));
+		stageFileHeader_._version = STAGE_FILE_VERSION;
+		stageFileHeader_._fingerprint = NetworkFingerprint();
+		f_stage_.seekp(0);
+		f_stage_.write(reinterpret_cast<const char*>(&stageFileHeader_), sizeof(stageFileHeader_t));
 
+		f_stage_.close();
+	}
+	catch (...) {
+		std::stringstream ss;
+		ss << "CloseStageFileStreams(): An error was encountered when writing the stage file index." << std::endl;
+		SignalExceptionAdjustment(ss.str(), 0);
+	}
 }
 
 
@@ -0,0 +1,541 @@
+//============================================================================
+// Name         : dnaadjust-tree.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust Network Adjustment (tree-structured phased) library
+//============================================================================
+
+/// \cond
+#include <iterator>
+/// \endcond
+
+#include <dynadjust/dnaadjust/dnaadjust.hpp>
+
+namespace dynadjust {
+namespace networkadjust {
+
+// Tree-structured phased adjustment
+// Notes for general understanding of the tree-structured operation:
+//	- The blocks of each contiguous network are arranged in a binary
+//	  elimination tree (see FormPhasedTree).  Each leaf is a block, and
+//	  every other node is a range of consecutive blocks, split in two.
+//	- The stations of a node which are also parameters of blocks outside
+//	  the node's range are the junction stations of that node.  All other
+//	  stations of the node are interior stations, and are eliminated at
+//	  that node.
+//	- On the way up the tree, each node assembles the normals of its block
+//	  (a leaf) or the reduced normals of its two children, and eliminates
+//	  its interior stations.  This leaves reduced normals for the junction
+//	  stations, which are passed to the parent.  Sibling subtrees do not
+//	  share any data, and so are reduced concurrently.
+//	- At the root, no junction stations remain and the reduced normals
+//	  are solved.  On the way back down the tree, each node recovers the
+//	  corrections and variance matrix of its stations from the solution of
+//	  its junction stations, passed down by its parent.  At the leaves, this
+//	  yields rigorous estimates and variances for every block.
+//	- The critical path is the depth of the tree (i.e. log2 of the number
+//	  of blocks) rather than the length of the chain of blocks.
+//	- Segmentation is unchanged.  The constraint station variances are
+//	  added once per station, to the block in which the station first
+//	  appears (as per the forward pass), so that the sum of the normals
+//	  of all blocks is the normals of the whole network.
+//
+void dna_adjust::AdjustPhasedTree()
+{
+	initialiseIteration();
+
+	std::string corr_msg;
+	UINT32 i, block;
+	bool iterate(true);
+
+	cpu_timer it_time, tot_time;
+
+	// The tree and its tasks are formed once, and run on every iteration
+	FormPhasedTree();
+
+	task_graph eliminations;
+	FormPhasedTreeTasks(eliminations);
+
+	// Resume from the checkpoint of a previous adjustment, or update
+	// the previous incremental adjustment (if any) on the first iteration
+	i = ResumeAdjustment();
+	bool incremental(i == 0 && FormIncrementalUpdate());
+
+	// do until convergence criteria is met
+	for (; i<projectSettings_.a.max_iterations; ++i)
+	{
+		if (IsCancelled())
+			break;
+
+		isIterationComplete_ = false;
+
+		SetcurrentBlock(0);
+		blockLargeCorr_ = 0;
+		largestCorr_ = 0.0;
+		maxCorr_ = 0.0;
+
+		// initialise potential outlier count and statistical
+		// quantities
+		potentialOutlierCount_ = 0;
+		chiSquaredStage_ = 0.;
+		measurementParams_ = 0;
+
+		// Print the iteration # to adj file
+		printer_->PrintIteration(incrementIteration());
+
+		it_time.start();
+
+		if (!incremental || !UpdateEstimatesIncrementally())
+		{
+			// Reduce and solve the elimination tree.  If an exception is
+			// thrown by any task, run() re-throws it here
+			eliminations.run(projectSettings_.a.threads,
+				[this]() { return IsCancelled(); });
+
+			if (IsCancelled())
+				break;
+
+			// Update largest corrections and print rigorous estimates
+			// in block order
+			for (block=0; block<blockCount_; ++block)
+				UpdateEstimatesFinalTree(block);
+		}
+		incremental = false;
+
+		// calculate and print total time
+		PrintAdjustmentTime(it_time, iteration_time);
+
+		// Calculate and print largest adjustment correction and station ID
+		OutputLargestCorrection(corr_msg);
+
+		iterationCorrections_.add_message(corr_msg);
+		iterationQueue_.push_and_notify(CurrentIteration());	// currentIteration begins at 1, so not zero-indexed
+		isIterationComplete_ = true;
+
+		// Continue iterating?
+		iterate = !IsCancelled() && fabs(maxCorr_) > projectSettings_.a.iteration_threshold;
+		if (!iterate)
+			break;
+
+		// Record the estimates so that the adjustment may be resumed
+		CheckpointIteration();
+
+		// Update normals and measured-computed matrices for the next iteration.
+		UpdateAdjustment(iterate);
+		if (IsCancelled())
+			break;
+
+		// Does the user want to print statistics on each iteration?
+		if (projectSettings_.o._adj_stat_iteration)
+		{
+			// Compute network statistics
+			ComputeStatisticsOnIteration();
+
+			// Print statistics summary to adj file
+			printer_->PrintStatistics(false);
+		}
+
+		// Does the user want to print adjusted measurements
+		// on each iteration?
+		if (projectSettings_.o._adj_msr_iteration)
+			ComputeandPrintAdjMsrOnIteration();
+	}
+
+	chiSquared_ = chiSquaredStage_;
+
+	ValidateandFinaliseAdjustment(tot_time);
+}
+
+
+// Forms an elimination tree for each contiguous network
+void dna_adjust::FormPhasedTree()
+{
+	v_treeNodes_.clear();
+
+	UINT32 block, firstBlock(0);
+
+	// Record the blocks in which each station is a parameter.  Since
+	// blocks are visited in order, each list is sorted.
+	vvUINT32 stationBlocks(bstBinaryRecords_.size());
+	it_vUINT32 _it_stn;
+
+	for (block=0; block<blockCount_; ++block)
+		for (_it_stn=v_parameterStationList_.at(block).begin();
+			_it_stn!=v_parameterStationList_.at(block).end(); ++_it_stn)
+			stationBlocks.at(*_it_stn).push_back(block);
+
+	for (block=0; block<blockCount_; ++block)
+	{
+		if (v_blockMeta_.at(block)._blockFirst)
+			firstBlock = block;
+		if (v_blockMeta_.at(block)._blockLast)
+			FormPhasedTreeNode(firstBlock, block, UINT_MAX, stationBlocks);
+	}
+}
+
+
+// Forms the node for blocks firstBlock to lastBlock, and (recursively)
+// its children.  Returns the index of the node.
+UINT32 dna_adjust::FormPhasedTreeNode(const UINT32& firstBlock, const UINT32& lastBlock,
+	const UINT32& parent, const vvUINT32& stationBlocks)
+{
+	const UINT32 node(static_cast<UINT32>(v_treeNodes_.size()));
+	v_treeNodes_.push_back(phasedTreeNode_t());
+	v_treeNodes_.at(node)._firstBlock = firstBlock;
+	v_treeNodes_.at(node)._lastBlock = lastBlock;
+	v_treeNodes_.at(node)._parent = parent;
+
+	vUINT32 stations;
+
+	if (firstBlock == lastBlock)
+		// A leaf holds the parameter stations of its block
+		stations = v_parameterStationList_.at(firstBlock);
+	else
+	{
+		// Split the range in two.  The stations of this node are the
+		// junction stations of its children.  Note that forming the
+		// children may reallocate v_treeNodes_.
+		const UINT32 middle(firstBlock + (lastBlock - firstBlock) / 2);
+		const UINT32 left(FormPhasedTreeNode(firstBlock, middle, node, stationBlocks));
+		const UINT32 right(FormPhasedTreeNode(middle + 1, lastBlock, node, stationBlocks));
+
+		v_treeNodes_.at(node)._left = left;
+		v_treeNodes_.at(node)._right = right;
+
+		std::set_union(
+			v_treeNodes_.at(left)._junctions.begin(), v_treeNodes_.at(left)._junctions.end(),
+			v_treeNodes_.at(right)._junctions.begin(), v_treeNodes_.at(right)._junctions.end(),
+			std::back_inserter(stations));
+	}
+
+	phasedTreeNode_t& treeNode(v_treeNodes_.at(node));
+
+	// Stations which are also parameters of blocks outside this
+	// range are junction stations.  All others are interior stations.
+	for (it_vUINT32 _it_stn=stations.begin(); _it_stn!=stations.end(); ++_it_stn)
+	{
+		const vUINT32& blocks(stationBlocks.at(*_it_stn));
+		if (blocks.front() < firstBlock || blocks.back() > lastBlock)
+			treeNode._junctions.push_back(*_it_stn);
+		else
+			treeNode._interior.push_back(*_it_stn);
+	}
+
+	return node;
+}
+
+
+void dna_adjust::FormPhasedTreeTasks(task_graph& eliminations)
+{
+	eliminations.clear();
+
+	const UINT32 nodes(static_cast<UINT32>(v_treeNodes_.size()));
+	vUINT32 reduce(nodes), solve(nodes);
+	UINT32 node;
+
+	for (node=0; node<nodes; ++node)
+	{
+		reduce.at(node) = eliminations.add_task([this, node]() { ReducePhasedTreeNode(node); });
+		solve.at(node) = eliminations.add_task([this, node]() { SolvePhasedTreeNode(node); });
+	}
+
+	// A node is reduced after its children, and solved after its parent
+	for (node=0; node<nodes; ++node)
+	{
+		if (v_treeNodes_.at(node).isRoot())
+		{
+			eliminations.add_dependency(reduce.at(node), solve.at(node));
+			continue;
+		}
+
+		eliminations.add_dependency(reduce.at(node), reduce.at(v_treeNodes_.at(node)._parent));
+		eliminations.add_dependency(solve.at(v_treeNodes_.at(node)._parent), solve.at(node));
+	}
+}
+
+
+// Assembles the normals of a node and eliminates its interior stations
+void dna_adjust::ReducePhasedTreeNode(const UINT32& node)
+{
+	phasedTreeNode_t& treeNode(v_treeNodes_.at(node));
+
+	const UINT32 interior(treeNode.interiorCount());
+	const UINT32 junctions(treeNode.junctionCount());
+	const UINT32 size(interior + junctions);
+
+	matrix_2d normals(size, size), weighted(size, 1);
+	vUINT32 rows;
+	UINT32 r, c, i, j;
+
+	if (treeNode.isLeaf())
+	{
+		const UINT32 block(treeNode._firstBlock);
+		SetcurrentBlock(block);
+
+		// Map the rows of this block to the rows of this node
+		rows.resize(v_parameterStationList_.at(block).size() * 3);
+		for (it_vUINT32 _it_stn=v_parameterStationList_.at(block).begin();
+			_it_stn!=v_parameterStationList_.at(block).end(); ++_it_stn)
+		{
+			r = BlockStationPosition(block, *_it_stn) * 3;
+			c = treeNode.position(*_it_stn);
+			for (i=0; i<3; ++i)
+				rows.at(r + i) = c + i;
+		}
+
+		// The normals of this block include the variances of
+		// the constraint stations which first appear in this block
+		const symmetric_matrix& blockNormals(v_normals_.at(block));
+		for (r=0; r<blockNormals.rows(); ++r)
+			for (c=0; c<=r; ++c)
+			{
+				normals.put(rows.at(r), rows.at(c), blockNormals.get(r, c));
+				normals.put(rows.at(c), rows.at(r), blockNormals.get(r, c));
+			}
+
+		// Weighted measurements (i.e. At*V-1*m)
+		matrix_2d At_Vinv_m(blockNormals.rows(), 1);
+		v_AtVinv_.at(block).multiply(v_measMinusComp_.at(block), At_Vinv_m);
+		for (r=0; r<At_Vinv_m.rows(); ++r)
+			weighted.put(rows.at(r), 0, At_Vinv_m.get(r, 0));
+	}
+	else
+	{
+		// Add the reduced normals of the children
+		const UINT32 children[] = { treeNode._left, treeNode._right };
+		for (const UINT32& child : children)
+		{
+			phasedTreeNode_t& childNode(v_treeNodes_.at(child));
+
+			rows.resize(childNode.junctionCount());
+			for (r=0; r<childNode._junctions.size(); ++r)
+			{
+				c = treeNode.position(childNode._junctions.at(r));
+				for (i=0; i<3; ++i)
+					rows.at(r * 3 + i) = c + i;
+			}
+
+			for (r=0; r<rows.size(); ++r)
+			{
+				weighted.elementadd(rows.at(r), 0, childNode._reducedWeighted.get(r, 0));
+				for (c=0; c<rows.size(); ++c)
+					normals.elementadd(rows.at(r), rows.at(c), childNode._reduced.get(r, c));
+			}
+
+			// The reduced normals of the child are no longer required
+			childNode._reduced = matrix_2d();
+			childNode._reducedWeighted = matrix_2d();
+		}
+	}
+
+	// Eliminate the interior stations
+	if (interior > 0)
+	{
+		treeNode._inverse = normals.submatrix(0, 0, interior, interior);
+		treeNode._inverse.cholesky_inverse();
+
+		treeNode._interiorCorr.redim(interior, 1);
+		treeNode._interiorCorr.multiply(treeNode._inverse, "N",
+			weighted.submatrix(0, 0, interior, 1), "N");
+	}
+
+	// The root has no junction stations, and is solved in
+	// SolvePhasedTreeNode
+	if (junctions == 0)
+		return;
+
+	treeNode._reduced = normals.submatrix(interior, interior, junctions, junctions);
+	treeNode._reducedWeighted = weighted.submatrix(interior, 0, junctions, 1);
+
+	if (interior == 0)
+		return;
+
+	// Schur complement of the interior normals
+	//   reduced = N(jj) - N(ji) * N(ii)-1 * N(ij)
+	//   reducedWeighted = w(j) - N(ji) * N(ii)-1 * w(i)
+	matrix_2d coupling(normals.submatrix(0, interior, interior, junctions));
+	treeNode._gain.redim(interior, junctions);
+	treeNode._gain.multiply(treeNode._inverse, "N", coupling, "N");
+
+	matrix_2d reduction(junctions, junctions), weightedReduction(junctions, 1);
+	reduction.multiply(coupling, "T", treeNode._gain, "N");
+	weightedReduction.multiply(coupling, "T", treeNode._interiorCorr, "N");
+
+	for (j=0; j<junctions; ++j)
+	{
+		treeNode._reducedWeighted.elementsubtract(j, 0, weightedReduction.get(j, 0));
+		for (i=0; i<junctions; ++i)
+			treeNode._reduced.elementsubtract(i, j, reduction.get(i, j));
+	}
+}
+
+
+// Recovers the corrections and variances of all stations of a node
+// from the corrections and variances of its junction stations
+void dna_adjust::SolvePhasedTreeNode(const UINT32& node)
+{
+	phasedTreeNode_t& treeNode(v_treeNodes_.at(node));
+
+	const UINT32 interior(treeNode.interiorCount());
+	const UINT32 junctions(treeNode.junctionCount());
+	UINT32 r, c, i, j, k;
+
+	if (treeNode.isRoot())
+	{
+		treeNode._corrections = std::move(treeNode._interiorCorr);
+		treeNode._variances = std::move(treeNode._inverse);
+	}
+	else
+	{
+		const phasedTreeNode_t& parentNode(v_treeNodes_.at(treeNode._parent));
+
+		treeNode._corrections.redim(interior + junctions, 1);
+		treeNode._variances.redim(interior + junctions, interior + junctions);
+
+		// Copy the corrections and variances of the junction stations
+		// solved by the parent
+		for (j=0; j<treeNode._junctions.size(); ++j)
+		{
+			r = parentNode.position(treeNode._junctions.at(j));
+			treeNode._corrections.copyelements(interior + j * 3, 0,
+				parentNode._corrections, r, 0, 3, 1);
+
+			for (k=0; k<treeNode._junctions.size(); ++k)
+			{
+				c = parentNode.position(treeNode._junctions.at(k));
+				treeNode._variances.copyelements(interior + j * 3, interior + k * 3,
+					parentNode._variances, r, c, 3, 3);
+			}
+		}
+
+		if (interior > 0)
+		{
+			//   x(i) = N(ii)-1 * w(i) - G * x(j)
+			//   V(ii) = N(ii)-1 + G * V(jj) * Gt
+			//   V(ij) = -G * V(jj)
+			// where G = N(ii)-1 * N(ij)
+			matrix_2d junctionCorr(treeNode._corrections.submatrix(interior, 0, junctions, 1));
+			matrix_2d junctionVar(treeNode._variances.submatrix(interior, interior, junctions, junctions));
+
+			matrix_2d gainCorr(interior, 1), gainVar(interior, junctions), gainVarGain(interior, interior);
+			gainCorr.multiply(treeNode._gain, "N", junctionCorr, "N");
+			gainVar.multiply(treeNode._gain, "N", junctionVar, "N");
+			gainVarGain.multiply(gainVar, "N", treeNode._gain, "T");
+
+			for (i=0; i<interior; ++i)
+			{
+				treeNode._corrections.put(i, 0,
+					treeNode._interiorCorr.get(i, 0) - gainCorr.get(i, 0));
+
+				for (k=0; k<interior; ++k)
+					treeNode._variances.put(i, k,
+						treeNode._inverse.get(i, k) + gainVarGain.get(i, k));
+
+				for (j=0; j<junctions; ++j)
+				{
+					treeNode._variances.put(i, interior + j, -gainVar.get(i, j));
+					treeNode._variances.put(interior + j, i, -gainVar.get(i, j));
+				}
+			}
+		}
+	}
+
+	// The elimination matrices are no longer required
+	treeNode._inverse = matrix_2d();
+	treeNode._gain = matrix_2d();
+	treeNode._interiorCorr = matrix_2d();
+
+	if (treeNode.isLeaf())
+		UpdateEstimatesTree(node);
+}
+
+
+// Copies the rigorous corrections and variances of a leaf to its block
+void dna_adjust::UpdateEstimatesTree(const UINT32& node)
+{
+	phasedTreeNode_t& treeNode(v_treeNodes_.at(node));
+	const UINT32 block(treeNode._firstBlock);
+
+	// Map the rows of this block to the rows of this node
+	vUINT32 rows(v_parameterStationList_.at(block).size() * 3);
+	UINT32 r, c, i;
+	for (it_vUINT32 _it_stn=v_parameterStationList_.at(block).begin();
+		_it_stn!=v_parameterStationList_.at(block).end(); ++_it_stn)
+	{
+		r = BlockStationPosition(block, *_it_stn) * 3;
+		c = treeNode.position(*_it_stn);
+		for (i=0; i<3; ++i)
+			rows.at(r + i) = c + i;
+	}
+
+	matrix_2d* corrections(&v_corrections_.at(block));
+	symmetric_matrix* aposterioriVariances(&v_normals_.at(block));
+
+	for (r=0; r<rows.size(); ++r)
+	{
+		corrections->put(r, 0, treeNode._corrections.get(rows.at(r), 0));
+		for (c=0; c<=r; ++c)
+			aposterioriVariances->put(r, c, treeNode._variances.get(rows.at(r), rows.at(c)));
+	}
+
+	// The corrections and variances of a leaf are held by its block
+	treeNode._corrections = matrix_2d();
+	treeNode._variances = matrix_2d();
+
+	// update station coordinates with lsq-estimated corrections
+	v_estimatedStations_.at(block).add(*corrections);
+
+	// compute degrees of freedom as per the forward pass
+	v_statSummary_.at(block)._degreesofFreedom =
+		v_measurementParams_.at(block) +
+		(v_pseudoMeasCountFwd_.at(block) * 3) -
+		v_unknownParams_.at(block);
+
+	// Now copy 'estimated' coordinates to 'rigorous' for comparison on the next iteration
+	v_rigorousStations_.at(block) = v_estimatedStations_.at(block);
+	v_rigorousVariances_.at(block) = *aposterioriVariances;
+
+	// update original coordinates
+	v_originalStations_.at(block) = v_rigorousStations_.at(block);
+}
+
+
+void dna_adjust::UpdateEstimatesFinalTree(const UINT32& block)
+{
+	// update max correction
+	if (fabs(v_corrections_.at(block).compute_maximum_value()) > fabs(maxCorr_))
+		SetmaxCorr(v_corrections_.at(block).maxvalue());
+
+	// update largest correction
+	if (fabs(v_corrections_.at(block).maxvalue()) > fabs(largestCorr_))
+	{
+		largestCorr_ = v_corrections_.at(block).maxvalue();
+		blockLargeCorr_ = block;
+	}
+
+	// print the 'rigorous' stations for this block
+	if (projectSettings_.o._adj_stn_iteration)
+	{
+		adj_file << std::endl << "Adjusted block " << block + 1 << " (rigorous)" << std::endl;
+		printer_->PrintBlockStations(adj_file, block,
+			&v_rigorousStations_.at(block), &v_rigorousVariances_.at(block),
+			false, true, false, true, false);		// update coordinates
+	}
+}
+
+} // namespace networkadjust
+} // namespace dynadjust
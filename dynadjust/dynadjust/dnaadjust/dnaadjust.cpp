@@ -27,11 +27,6 @@ std::mutex combine_blockMutex;
 std::mutex current_blockMutex, current_iterationMutex, maxCorrMutex;
 std::mutex adj_file_mutex, xyz_file_mutex, dbg_file_mutex;
 
-// multi thread adjustment variables
-concurrent_queue<UINT32> combineAdjustmentQueue;
-concurrent_queue<UINT32> prepareAdjustmentQueue;
-std::exception_ptr fwd_error, rev_error, cmb_error, prep_error;
-
 dna_adjust::dna_adjust()
 	: isPreparing_(false)
 	, isAdjusting_(false)
@@ -40,6 +35,7 @@ dna_adjust::dna_adjust()
 	, isFirstTimeAdjustment_(true)
 	, isIterationComplete_(false)
 	, isAdjustmentQuestionable_(false)
+	, normalsFrozen_(false)
 	, blockCount_(1)
 	, currentBlock_(0)
 	, total_time_(0)
@@ -64,6 +60,14 @@ dna_adjust::dna_adjust()
 	, maxCorr_(0.)
 	, criticalValue_(1.68)
 	, allStationsFixed_(false)
+	, iterativePreconditioned_(false)
+	, residentBytes_(0)
+	, peakResidentBytes_(0)
+	, blocksEvicted_(0)
+	, stageFileOffset_(0)
+	, checkpointIO_(1)
+	, gnssInverseReused_(0)
+	, gnssInverseBytes_(0)
 	, databaseIDsLoaded_(false)
 	, isCancelled_(false)
 {
@@ -100,6 +104,8 @@ dna_adjust::dna_adjust()
 	v_precAdjMsrsFull_.clear();
 	v_corrections_.clear();
 	v_blockStationsMap_.clear();
+	v_blockStationIndexStart_.clear();
+	v_blockStationIndex_.clear();
 
 	v_parameterStationCount_.clear();
 	v_parameterStationList_.clear();
@@ -241,6 +247,7 @@ void dna_adjust::PrepareAdjustment(const project_settings& projectSettings)
 	isAdjusting_ = true;
 	isCombining_ = false;
 	isFirstTimeAdjustment_ = true;
+	normalsFrozen_ = false;
 	projectSettings_ = projectSettings;
 
 	if (projectSettings_.a.stage && 
@@ -265,12 +272,38 @@ void dna_adjust::PrepareAdjustment(const project_settings& projectSettings)
 	// Load type b uncertainties, method handler, and the station map
 	InitialiseTypeBUncertainties();
 
+	// Initialise free stations from a previous adjustment
+	LoadWarmStartCoordinates();
+
 	isFirstTimeAdjustment_ = !bms_meta_.reduced;
 
 	// Resizes matrix vectors using blockCount_.  
 	// For phased adjustments, segmentation file is loaded
 	ResizeMatrixVectors();
 
+	// Reorder the stations in each block to reduce the
+	// bandwidth and fill-in of the normals
+	if (projectSettings_.a.station_ordering != Ordering_none)
+		OrderBlockStations();
+
+	// Index the (ordered) position of each station in each block
+	FormBlockStationIndex();
+
+	// Verify that a stage file being reused was created from the 
+	// blocks as they are now loaded and ordered
+	if (projectSettings_.a.stage && !projectSettings_.a.recreate_stage_files)
+		VerifyStageFileFingerprint();
+
+	// Index the inverse variance matrix of each GNSS measurement, and
+	// restore those recorded by a previous adjustment
+	FormGnssInverseIndex();
+
+	// Restore the solution of the previous incremental adjustment, and
+	// identify the measurements of this adjustment (prior to their
+	// reduction) so that the two can be compared
+	LoadIncrementalState();
+	FormIncrementalMeasurements();
+
 	if (!projectSettings_.a.report_mode)
 	{
 		std::string block_str(" block");
@@ -431,6 +464,20 @@ void dna_adjust::UpdateBinaryFiles()
 	snprintf(bms_meta_.modifiedBy, sizeof(bms_meta_.modifiedBy), "%s", __BINARY_NAME__);
 	bms_meta_.reduced = true;
 
+	// Measurements eliminated as outliers are not reduced by this adjustment,
+	// so are written as reduced by the adjustment from which they were 
+	// eliminated.  They remain ignored only if requested.
+	vmsr_t adjusted;
+	for (const auto& msr : v_eliminatedMsrs_)
+	{
+		for (UINT32 r(0); r<msr._records; ++r)
+		{
+			adjusted.push_back(bmsBinaryRecords_.at(msr._record + r));
+			bmsBinaryRecords_.at(msr._record + r) = msr._reduced.at(r);
+			bmsBinaryRecords_.at(msr._record + r).ignore = projectSettings_.a.persist_eliminations;
+		}
+	}
+
 	try {
 		// Write binary measurements data.  Throws runtime_error on failure.
 		BmsFile bms;
@@ -439,6 +486,12 @@ void dna_adjust::UpdateBinaryFiles()
 	catch (const std::runtime_error& e) {
 		SignalExceptionAdjustment(e.what(), 0);
 	}	
+
+	// Restore the records of this adjustment
+	it_vmsr_t _it_adjusted(adjusted.begin());
+	for (const auto& msr : v_eliminatedMsrs_)
+		for (UINT32 r(0); r<msr._records; ++r)
+			bmsBinaryRecords_.at(msr._record + r) = *_it_adjusted++;
 }
 	
 
@@ -552,11 +605,18 @@ void dna_adjust::UpdateAdjustment(bool iterate)
 
 				break;
 			case SimultaneousMode:
-				if (v_msrTally_.at(0).ContainsNonGPS())
+				// In frozen Jacobian mode, the inverse (or factor) of the
+				// normals from a previous iteration is retained
+				if (v_msrTally_.at(0).ContainsNonGPS() && !normalsFrozen_)
 				{
 					// update normals
-					v_normals_.at(0).zero();
-					UpdateNormals(0, false);
+					if (SparseNormals())
+						FormSparseNormals(0);
+					else
+					{
+						v_normals_.at(0).zero();
+						UpdateNormals(0, false);
+					}
 					AddConstraintStationstoNormalsSimultaneous(0);
 				}
 				break;
@@ -607,18 +667,40 @@ void dna_adjust::PopulateEstimatedStationMatrix(const UINT32& block, UINT32& unk
 	it_vUINT32_const _it_stn;
 
 	double X, Y, Z;
-	UINT32 j(0);
+	UINT32 j(0), s(0);
+
+	// Convert the block's stations to cartesian coordinates in batches
+	// (on the stack) of GEODESY_BATCH_SIZE
+	double x[GEODESY_BATCH_SIZE], y[GEODESY_BATCH_SIZE], z[GEODESY_BATCH_SIZE];
+	it_vUINT32_const _it_batch;
+	std::size_t batch_count(0);
 
 	// add inner and junction stations (all stations in phased mode are kept in v_parameterStationList_)
 	for (_it_stn=v_parameterStationList_.at(block).begin();
 		_it_stn!=v_parameterStationList_.at(block).end(); 
-		++_it_stn)
+		++_it_stn, ++s)
 	{
-		GeoToCart<double>(
-			bstBinaryRecords_.at(*_it_stn).currentLatitude,
-			bstBinaryRecords_.at(*_it_stn).currentLongitude,
-			bstBinaryRecords_.at(*_it_stn).currentHeight,
-			&X, &Y, &Z, datum_.GetEllipsoidRef());
+		if (s == batch_count)
+		{
+			batch_count = std::min(static_cast<std::size_t>(v_parameterStationList_.at(block).end() - _it_stn), 
+				GEODESY_BATCH_SIZE);
+			for (s=0, _it_batch=_it_stn; s<batch_count; ++s, ++_it_batch)
+			{
+				x[s] = bstBinaryRecords_.at(*_it_batch).currentLatitude;
+				y[s] = bstBinaryRecords_.at(*_it_batch).currentLongitude;
+				z[s] = bstBinaryRecords_.at(*_it_batch).currentHeight;
+			}
+
+			GeoToCart_Batch<double>(x, y, z, x, y, z, batch_count, datum_.GetEllipsoidRef());
+			s = 0;
+		}
+
+		// position of this station in the station matrices
+		j = BlockStationPosition(block, *_it_stn) * 3;
+
+		X = x[s];
+		Y = y[s];
+		Z = z[s];
 
 		// add junction stations
 		switch (projectSettings_.a.adjust_mode)
@@ -859,8 +941,10 @@ void dna_adjust::PrepareDesignAndMsrMnsCmpMatrices(const UINT32& block)
 	
 	// Simultaneous, phased (multithreaded and block1) adjustments
 
-	// Redim all matrices
-	v_normals_.at(block).redim(v_unknownsCount_.at(block), v_unknownsCount_.at(block));
+	// Redim all matrices.  When the sparse solver is used, the normals
+	// are formed in sparseNormals_ (see PrepareSparseNormals)
+	if (!SparseNormals())
+		v_normals_.at(block).redim(v_unknownsCount_.at(block), v_unknownsCount_.at(block));
 	
 	v_design_.at(block).redim(v_measurementCount_.at(block), v_unknownsCount_.at(block));
 	v_corrections_.at(block).redim(v_unknownsCount_.at(block), 1);
@@ -882,7 +966,10 @@ void dna_adjust::PrepareDesignAndMsrMnsCmpMatrices(const UINT32& block)
 
 	// Now, form the design matrices
 	FillDesignNormalMeasurementsMatrices(true, block, false);
-	
+
+	// Form the sparse normals from the design and At*V-1 matrices
+	if (SparseNormals())
+		PrepareSparseNormals(block);
 }
 	
 
@@ -947,7 +1034,7 @@ void dna_adjust::CarryStnEstimatesandVariancesForward(const UINT32& thisBlock, c
 	{
 		// get index of this JSL
 		jslvar = static_cast<UINT32>(std::distance(v_JSL_.at(thisBlock).begin(), _it_jsl) * 3);
-		jsl = v_blockStationsMap_.at(thisBlock)[*_it_jsl] * 3;
+		jsl = BlockStationPosition(thisBlock, *_it_jsl) * 3;
 		
 		// copy variance elements for this JSL
 		v_junctionVariances_.at(thisBlock).copyelements(jslvar, jslvar, 
@@ -967,7 +1054,7 @@ void dna_adjust::CarryStnEstimatesandVariancesForward(const UINT32& thisBlock, c
 				continue;
 
 			jslcovar = static_cast<UINT32>(std::distance(v_JSL_.at(thisBlock).begin(), _it_jsl_cov) * 3);
-			jsl_cov = v_blockStationsMap_.at(thisBlock)[*_it_jsl_cov] * 3;
+			jsl_cov = BlockStationPosition(thisBlock, *_it_jsl_cov) * 3;
 			v_junctionVariances_.at(thisBlock).copyelements(jslvar, jslcovar, 
 				v_normals_.at(thisBlock), jsl, jsl_cov, 3, 3);
 			v_junctionVariances_.at(thisBlock).copyelements(jslcovar, jslvar, 
@@ -1008,7 +1095,7 @@ void dna_adjust::CarryStnEstimatesandVariancesForward(const UINT32& thisBlock, c
 		++_it_jsl, paramCount+=3)
 	{
 		// get index of this JSL in the next block
-		jsl = v_blockStationsMap_.at(nextBlock)[*_it_jsl] * 3;		// next block
+		jsl = BlockStationPosition(nextBlock, *_it_jsl) * 3;		// next block
 		jslvar = static_cast<UINT32>(std::distance(v_JSL_.at(thisBlock).begin(), _it_jsl) * 3);
 
 		// add variance elements for this JSL to normals of the next block
@@ -1048,7 +1135,7 @@ void dna_adjust::CarryStnEstimatesandVariancesForward(const UINT32& thisBlock, c
 				continue;
 
 			jslcovar = static_cast<UINT32>(std::distance(v_JSL_.at(thisBlock).begin(), _it_jsl_cov) * 3);
-			jsl_cov = v_blockStationsMap_.at(nextBlock)[*_it_jsl_cov] * 3;		// next block
+			jsl_cov = BlockStationPosition(nextBlock, *_it_jsl_cov) * 3;		// next block
 
 			// copy covariance elements for this JSL to normals of the next block
 			v_normals_.at(nextBlock).blockadd(jsl, jsl_cov,
@@ -1075,13 +1162,13 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 	UINT32 jsl_var_next, jsl_covar_next;
 	UINT32 est(0);
 
-	matrix_2d* junctionVariances(&v_junctionVariances_.at(nextBlock));
-	matrix_2d* aposterioriVariances(&v_normals_.at(thisBlock));
+	symmetric_matrix* junctionVariances(&v_junctionVariances_.at(nextBlock));
+	symmetric_matrix* aposterioriVariances(&v_normals_.at(thisBlock));
 	matrix_2d* estimatedStationsThis(&v_estimatedStations_.at(thisBlock));
 	matrix_2d* estimatedStationsNext(&v_estimatedStations_.at(nextBlock));
-	matrix_2d* normals(&v_normals_.at(nextBlock));
+	symmetric_matrix* normals(&v_normals_.at(nextBlock));
 	matrix_2d* measMinusCompNext(&v_measMinusComp_.at(nextBlock));
-	matrix_2d* AtVinvNext(&v_AtVinv_.at(nextBlock));
+	rowblock_matrix* AtVinvNext(&v_AtVinv_.at(nextBlock));
 
 	if (MT_ReverseOrCombine)
 	{
@@ -1101,7 +1188,7 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 	{
 		// get index of this JSL
 		jsl_var_next = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl) * 3);
-		jsl_var_order_this = v_blockStationsMap_.at(thisBlock)[*_it_jsl] * 3;
+		jsl_var_order_this = BlockStationPosition(thisBlock, *_it_jsl) * 3;
 		
 		// copy junction variance elements
 		junctionVariances->copyelements(jsl_var_next, jsl_var_next, 
@@ -1121,7 +1208,7 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 				continue;
 
 			jsl_covar_next = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl_cov) * 3);
-			jsl_covar_order_this = v_blockStationsMap_.at(thisBlock)[*_it_jsl_cov] * 3;
+			jsl_covar_order_this = BlockStationPosition(thisBlock, *_it_jsl_cov) * 3;
 			junctionVariances->copyelements(jsl_var_next, jsl_covar_next, 
 				aposterioriVariances, jsl_var_order_this, jsl_covar_order_this, 3, 3);
 			junctionVariances->copyelements(jsl_covar_next, jsl_var_next, 
@@ -1160,8 +1247,8 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 	{
 		// get index of this JSL in the next block
 		jsl_var_next = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl) * 3);
-		jsl_var_order_this = v_blockStationsMap_.at(thisBlock)[*_it_jsl] * 3;		// previous block
-		jsl_var_order_next = v_blockStationsMap_.at(nextBlock)[*_it_jsl] * 3;
+		jsl_var_order_this = BlockStationPosition(thisBlock, *_it_jsl) * 3;		// previous block
+		jsl_var_order_next = BlockStationPosition(nextBlock, *_it_jsl) * 3;
 
 		// add variance elements for this JSL to normals of the next block
 		normals->blockadd(jsl_var_order_next, jsl_var_order_next,
@@ -1200,7 +1287,7 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 				continue;
 
 			jsl_covar_next = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl_cov) * 3);
-			jsl_covar_order_next = v_blockStationsMap_.at(nextBlock)[*_it_jsl_cov] * 3;
+			jsl_covar_order_next = BlockStationPosition(nextBlock, *_it_jsl_cov) * 3;
 
 			// add covariance elements for this JSL to normals of the next block
 			normals->blockadd(jsl_covar_order_next, jsl_var_order_next, 
@@ -1222,7 +1309,7 @@ void dna_adjust::CarryStnEstimatesandVariancesReverse(const UINT32& nextBlock, c
 
 // Update AtVinv based on new design matrix elements
 void dna_adjust::UpdateAtVinv(pit_vmsr_t _it_msr, const UINT32& stn1, const UINT32& stn2, const UINT32& stn3, 
-							UINT32& design_row, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+							UINT32& design_row, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// variance
 	double variance(1./(*_it_msr)->term2);
@@ -1267,7 +1354,7 @@ void dna_adjust::UpdateAtVinv(pit_vmsr_t _it_msr, const UINT32& stn1, const UINT
 void dna_adjust::UpdateAtVinv_D(const UINT32& stn1, const UINT32& stn2, const UINT32& stn3, 
 							const UINT32& angle, const UINT32& angle_count,
 							UINT32& design_row, UINT32& design_row_begin,
-							matrix_2d* Vinv, matrix_2d* design, matrix_2d* AtVinv)
+							matrix_2d* Vinv, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
 	for (UINT32 j, i(0); i<3; ++i)													// for each coordinate element (x, y, z)
 	{
@@ -1295,6 +1382,219 @@ void dna_adjust::UpdateAtVinv_D(const UINT32& stn1, const UINT32& stn2, const UI
 }
 	
 
+namespace {
+
+// Admits additions to a range of columns of the normals only.  When the
+// normals are formed on several threads, each thread owns a range of
+// (station) columns and walks, in order, the measurements with a station in
+// that range, so that no two threads write to the same element, and each
+// element receives its additions in the same order as when formed on one
+// thread.  Hence, the normals are identical regardless
+// of the number of threads.
+class normals_columns
+{
+public:
+	normals_columns(symmetric_matrix* normals, const UINT32& begin, const UINT32& end)
+		: normals_(normals), begin_(begin), end_(end) {}
+
+	inline bool owns(const UINT32& column) const {
+		return column >= begin_ && column < end_;
+	}
+
+	inline void elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+		if (owns(column))
+			normals_->elementadd(row, column, increment);
+	}
+
+	// col_dest is the first column of a station, and begin_ and end_
+	// fall on station boundaries, so a block is wholly owned or not at all
+	inline void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+		const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& columns) {
+		if (owns(col_dest))
+			normals_->blockadd(row_dest, col_dest, mat_src, row_src, col_src, rows, columns);
+	}
+
+	inline void stationblockadd(const UINT32& row_dest, const UINT32& col_dest, const double* block) {
+		if (owns(col_dest))
+			normals_->stationblockadd(row_dest, col_dest, block);
+	}
+
+private:
+	symmetric_matrix* normals_;
+	UINT32 begin_, end_;
+};
+
+// Is column of the normals written by this thread?  Used to avoid
+// computing contributions which would be discarded.
+template <typename T>
+inline bool owns_column(const T*, const UINT32&) { return true; }
+
+inline bool owns_column(const normals_columns* normals, const UINT32& column) {
+	return normals->owns(column);
+}
+
+// Admits additions to the 3x3 diagonal (station) blocks of the normals only,
+// from which the block Jacobi preconditioner of the iterative solver is
+// formed.  Each block is held row-major, nine elements per station.
+class normals_diagonal
+{
+public:
+	explicit normals_diagonal(vdouble* blocks)
+		: blocks_(blocks) {}
+
+	inline void elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+		if (row / 3 == column / 3)
+			blocks_->at(row * 3 + column % 3) += increment;
+	}
+
+	inline void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+		const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& columns) {
+		for (UINT32 row(0), col; row<rows; ++row)
+			for (col=0; col<columns; ++col)
+				elementadd(row_dest + row, col_dest + col, mat_src.get(row_src + row, col_src + col));
+	}
+
+	inline void stationblockadd(const UINT32& row_dest, const UINT32& col_dest, const double* block) {
+		if (row_dest != col_dest)
+			return;
+		for (UINT32 row(0), col; row<3; ++row)
+			for (col=0; col<3; ++col)
+				blocks_->at(row_dest * 3 + row * 3 + col) += block[row + col * 3];
+	}
+
+private:
+	vdouble* blocks_;
+};
+
+// Fixed-size kernels for adding a measurement to the normals.  Rather than
+// add At * V-1 * A one element at a time, the (three element) station blocks
+// of At * V-1 and A for the measurement are loaded once, and each 3x3
+// station block of the normals is formed in full and added in one call.
+// The products and the order in which each element receives them are
+// unchanged, so the normals are identical to those formed element-wise.
+
+// block = at * d, where at is the column of At * V-1 and d the row of A
+// for one station, and block is column-major
+inline void msr_station_block(const double* at, const double* d, double* block)
+{
+	for (UINT32 col(0); col<3; ++col)
+	{
+		block[col * 3] = at[0] * d[col];
+		block[col * 3 + 1] = at[1] * d[col];
+		block[col * 3 + 2] = at[2] * d[col];
+	}
+}
+
+// Adds the contribution of a single component measurement (design_row) to 
+// the station blocks of the normals for Stations stations.  If Variances
+// is false, the station (diagonal) blocks are not added.
+template <UINT32 Stations, bool Variances = true, typename T>
+void add_msr_to_normals(const UINT32 (&stn)[Stations], const UINT32& design_row, 
+	T* normals, const rowblock_matrix* design, const rowblock_matrix* AtVinv)
+{
+	double at[Stations][3], d[Stations][3], block[9];
+	UINT32 row, col;
+
+	for (col=0; col<Stations; ++col)
+	{
+		AtVinv->getblock(stn[col], design_row, at[col]);
+		design->getblock(design_row, stn[col], d[col]);
+	}
+
+	for (col=0; col<Stations; ++col)
+	{
+		if (!owns_column(normals, stn[col]))
+			continue;
+
+		for (row=0; row<Stations; ++row)
+		{
+			if (!Variances && row == col)
+				continue;
+			msr_station_block(at[row], d[col], block);
+			normals->stationblockadd(stn[row], stn[col], block);
+		}
+	}
+}
+
+// Adds the contribution of a three component GNSS baseline (design_row..
+// design_row+2) to the normals.  The design elements for stn1 and stn2 are
+// always -1 and 1 respectively (see UpdateDesignMeasMatrices_GX()), and so
+// each block of the normals is the relevant 3x3 block of At * V-1.
+template <typename T>
+void add_baseline_to_normals(const UINT32& stn1, const UINT32& stn2, const UINT32& design_row, 
+	T* normals, const rowblock_matrix* AtVinv)
+{
+	double at1[9], at2[9], neg[9];
+	UINT32 i;
+
+	for (i=0; i<3; ++i)
+	{
+		AtVinv->getblock(stn1, design_row + i, &at1[i * 3]);
+		AtVinv->getblock(stn2, design_row + i, &at2[i * 3]);
+	}
+
+	if (owns_column(normals, stn2))
+	{
+		normals->stationblockadd(stn2, stn2, at2);
+		normals->stationblockadd(stn1, stn2, at1);
+	}
+
+	if (owns_column(normals, stn1))
+	{
+		for (i=0; i<9; ++i)
+			neg[i] = -at1[i];
+		normals->stationblockadd(stn1, stn1, neg);
+		for (i=0; i<9; ++i)
+			neg[i] = -at2[i];
+		normals->stationblockadd(stn2, stn1, neg);
+	}
+}
+
+// Computes the variance A * V * At of a single component measurement
+// (design_row) connected to Stations stations.  The variances are read
+// in station blocks, as held by the sparse (selected) inverse.
+template <UINT32 Stations>
+double msr_precision(const UINT32 (&stn)[Stations], const UINT32& design_row, 
+	const rowblock_matrix* design, const variance_matrix& aposterioriVariances)
+{
+	double d[Stations][3], v[9], part_1[3], variance(0.);
+	UINT32 s, i, j;
+
+	for (s=0; s<Stations; ++s)
+		design->getblock(design_row, stn[s], d[s]);
+
+	for (s=0; s<Stations; ++s)			// for every station
+	{
+		part_1[0] = part_1[1] = part_1[2] = 0.;
+		for (j=0; j<Stations; ++j)		// for every correlated station
+		{
+			aposterioriVariances.getblock(stn[j], stn[s], v);
+			for (i=0; i<3; ++i)			// X, Y, Z
+			{
+				part_1[i] += d[j][0] * v[i * 3];
+				part_1[i] += d[j][1] * v[i * 3 + 1];
+				part_1[i] += d[j][2] * v[i * 3 + 2];
+			}
+		}
+		
+		for (i=0; i<3; ++i)
+			variance += part_1[i] * d[s][i];
+	}
+
+	return variance;
+}
+
+// The iterative solver reduces the (preconditioned) residual of each 
+// column to this fraction of the iteration threshold, relative to that
+// of the right hand side
+const double ITERATIVE_THRESHOLD_FRACTION(1.0e-6);
+
+// Number of unit vectors solved together when estimating precisions
+const UINT32 ITERATIVE_PRECISION_COLUMNS(48);
+
+} // namespace
+
+
 // Re-form normals for next block using measurement variances and all parameter station variances
 // Called by:
 //		- AdjustPhasedReverseCombine()
@@ -1302,176 +1602,295 @@ void dna_adjust::UpdateAtVinv_D(const UINT32& stn1, const UINT32& stn2, const UI
 //		- PrepareFwdAdj (used by adjust_forward_thread)
 void dna_adjust::UpdateNormals(const UINT32& block, bool MT_ReverseOrCombine)
 {
-	UINT32 stn1, stn2, stn3, design_row(0);
-	
-	it_vUINT32 _it_block_msr;
-	it_vmsr_t _it_msr;
-
-	matrix_2d* normals(&v_normals_.at(block));
-	matrix_2d* design(&v_design_.at(block));
-	matrix_2d* AtVinv(&v_AtVinv_.at(block));
+	symmetric_matrix* normals(&v_normals_.at(block));
+	rowblock_matrix* design(&v_design_.at(block));
+	rowblock_matrix* AtVinv(&v_AtVinv_.at(block));
 
 	if (MT_ReverseOrCombine)
 	{
 		normals = &v_normalsR_.at(block);
 		design = &v_designR_.at(block);
 		AtVinv = &v_AtVinvR_.at(block);
-	}	
+	}
+
+	if (NormalsAssemblyThreads(block) > 1)
+		UpdateNormalsParallel(block, normals, design, AtVinv);
+	else
+		UpdateNormals(block, normals, design, AtVinv);
+}
+
+
+UINT32 dna_adjust::NormalsAssemblyThreads(const UINT32& block) const
+{
+	UINT32 threads(projectSettings_.a.assembly_threads);
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+	// UpdateNormals_Y prints to debug_file at verbose level 5 and above
+	if (projectSettings_.g.verbose > 4)
+		return 1;
+
+	// Blocks adjusted concurrently (e.g. by the workers of a multi-thread
+	// phased adjustment) already occupy the cores
+	if (task_graph::in_task())
+		return 1;
+
+	// At least two stations per thread
+	return std::min(threads, std::max(v_unknownsCount_.at(block) / 6, 1U));
+}
+
+
+// Records the position in v_CML_ and the first design row of each 
+// measurement of the block in msrDesignRows_, so that measurements can be
+// divided amongst threads.  See FillDesignNormalMeasurementsMatrices.
+void dna_adjust::IndexDesignRows(const UINT32& block)
+{
+	UINT32 design_row(0);
+
+	it_vUINT32 _it_block_msr;
+	it_vmsr_t _it_msr;
+
+	msrDesignRows_.clear();
 
 	for (_it_block_msr=v_CML_.at(block).begin(); _it_block_msr!=v_CML_.at(block).end(); ++_it_block_msr)
 	{
 		if (InitialiseandValidateMsrPointer(_it_block_msr, _it_msr))
 			continue;
-	
-		stn1 = GetBlkMatrixElemStn1(block, &_it_msr);
-
-		switch (_it_msr->measType)
-		{
-		case 'H':	// Orthometric height
-		case 'I':	// Astronomic latitude
-		case 'J':	// Astronomic longitude
-		case 'P':	// Geodetic latitude
-		case 'Q':	// Geodetic longitude
-		case 'R':	// Ellipsoidal height
-			UpdateNormals_HIJPQR(stn1, design_row, normals, design, AtVinv);
-			break;
-
-		case 'A':	// Horizontal angle
-			stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
-			stn3 = GetBlkMatrixElemStn3(block, &_it_msr);
-			UpdateNormals_A(stn1, stn2, stn3, design_row, normals, design, AtVinv);
-			break;
 
-		case 'D':	// Direction set	
-			// When a target direction is found, continue to next element.  
-			if (_it_msr->vectorCount1 < 1)
+		// When a target direction is found, continue to next element.  
+		if (_it_msr->measType == 'D')
+			if (_it_msr->vectorCount2 < 1)
 				continue;
-			UpdateNormals_D(block, _it_msr, design_row, normals, design, AtVinv);
-			break;
 
-		case 'B':	// Geodetic azimuth
-		case 'C':	// Chord dist
-		case 'E':	// Ellipsoid arc
-		case 'K':	// Astronomic azimuth
-		case 'L':	// Level difference
-		case 'M':	// MSL arc
-		case 'S':	// Slope distance
-		case 'V':	// Zenith distance
-		case 'Z':	// Vertical angle
-			stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
-			UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
-			break;
+		msrDesignRows_.push_back(uint32_uint32_pair(
+			static_cast<UINT32>(_it_block_msr - v_CML_.at(block).begin()), design_row));
+		design_row += DesignRows(_it_msr);
+	}
+}
 
-		case 'G':	// GPS Baseline
-			// multiplies only the elements of AT * V-1 and A that contain this measurement
-			stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
-			UpdateNormals_G(stn1, stn2, design_row, normals, AtVinv);
-			break;
-		
-		case 'X':	// GPS Baseline cluster
-			UpdateNormals_X(block, _it_msr, design_row, normals, design, AtVinv);
-			break;
-		
-		case 'Y':	// GPS Point cluster
-			UpdateNormals_Y(block, _it_msr, design_row, normals, AtVinv);
-			break;		
-		
-		default:
-			std::stringstream ss;
-			ss << "UpdateNormals(): Unknown measurement type - '" << static_cast<std::string>(&(_it_msr->measType)) << 
-				"'." << std::endl;
-			SignalExceptionAdjustment(ss.str(), block);
-		}		
-	}	
+
+// Number of rows of the design matrix formed for a measurement
+UINT32 dna_adjust::DesignRows(const it_vmsr_t& _it_msr) const
+{
+	switch (_it_msr->measType)
+	{
+	case 'D':	// Direction set (one row per derived angle)
+		return _it_msr->vectorCount2 - 1;
+	case 'G':	// GPS Baseline
+		return 3;
+	case 'X':	// GPS Baseline cluster
+	case 'Y':	// GPS Point cluster
+		return _it_msr->vectorCount1 * 3;
+	default:
+		return 1;
+	}
 }
-	
 
-void dna_adjust::AddMsrtoNormalsVar(const UINT32& design_row, const UINT32& stn,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+
+// Form normals on several threads.  Columns of the normals are divided
+// into contiguous ranges of stations, one per thread, and each thread walks
+// only those measurements with a station in its range.  The stations of a
+// measurement are found from the blocks of its rows of the design and 
+// At * V-1 matrices.  The threads are those of assembly_, which are 
+// retained between calls.
+void dna_adjust::UpdateNormalsParallel(const UINT32& block, symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	// Add weighted measurement contributions to normal matrix
-	for (UINT32 row, col(0); col<3; ++col)
+	const UINT32 threads(NormalsAssemblyThreads(block));
+	const UINT32 stations(v_unknownsCount_.at(block) / 3);
+
+	IndexDesignRows(block);
+
+	// Divide the measurements amongst the threads
+	std::vector<vUINT32> partition(threads);
+	UINT32 m, t, row, rows, first, last, min_stn, max_stn;
+
+	for (m=0; m<msrDesignRows_.size(); ++m)
 	{
-		for (row=0; row<3; ++row)
+		row = msrDesignRows_.at(m).second;
+		rows = DesignRows(bmsBinaryRecords_.begin() + 
+			v_CML_.at(block).at(msrDesignRows_.at(m).first));
+
+		min_stn = stations;
+		max_stn = 0;
+		for (; rows>0; --rows, ++row)
 		{
-			normals->elementadd(stn+row, stn+col,
-				AtVinv->get(stn+row, design_row) * design->get(design_row, stn+col));
+			if (design->blockrange(row, first, last))
+			{
+				min_stn = std::min(min_stn, first);
+				max_stn = std::max(max_stn, last);
+			}
+			if (AtVinv->blockrange(row, first, last))
+			{
+				min_stn = std::min(min_stn, first);
+				max_stn = std::max(max_stn, last);
+			}
 		}
+
+		for (t=0; t<threads; ++t)
+			if (min_stn < stations * (t + 1) / threads && 
+				max_stn >= stations * t / threads)
+				partition.at(t).push_back(m);
+	}
+
+	assembly_.clear();
+	for (t=0; t<threads; ++t)
+	{
+		normals_columns columns(normals,
+			(stations * t / threads) * 3,				// first column
+			(stations * (t + 1) / threads) * 3);		// one past last column
+
+		assembly_.add_task([this, &block, design, AtVinv, columns, &partition, t]() mutable {
+			UINT32 design_row;
+			it_vmsr_t _it_msr;
+			for (const UINT32& m : partition.at(t))
+			{
+				design_row = msrDesignRows_.at(m).second;
+				_it_msr = bmsBinaryRecords_.begin() + v_CML_.at(block).at(msrDesignRows_.at(m).first);
+				UpdateNormalsMeasurement(block, _it_msr, design_row, &columns, design, AtVinv);
+			}
+		});
 	}
+
+	assembly_.run(threads);
 }
-	
 
-void dna_adjust::AddMsrtoNormalsCoVar2(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+
+// Re-form normals in the supplied normals matrix, which may be dense (matrix_2d)
+// or sparse (sparse_matrix)
+template <typename T>
+void dna_adjust::UpdateNormals(const UINT32& block, T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	// Add covariance terms (station 1 and station 2) to normal matrix
-	for (UINT32 row, col(0); col<3; ++col)
+	UINT32 design_row(0);
+	
+	it_vUINT32 _it_block_msr;
+	it_vmsr_t _it_msr;
+
+	for (_it_block_msr=v_CML_.at(block).begin(); _it_block_msr!=v_CML_.at(block).end(); ++_it_block_msr)
 	{
-		for (row=0; row<3; ++row)
-		{
-			// 1-2
-			normals->elementadd(stn1+row, stn2+col,
-				AtVinv->get(stn1+row, design_row) * design->get(design_row, stn2+col));
+		if (InitialiseandValidateMsrPointer(_it_block_msr, _it_msr))
+			continue;
 
-			normals->elementadd(stn2+row, stn1+col,
-				AtVinv->get(stn2+row, design_row) * design->get(design_row, stn1+col));
-		}
+		UpdateNormalsMeasurement(block, _it_msr, design_row, normals, design, AtVinv);
 	}
 }
 
-void dna_adjust::AddMsrtoNormalsCoVar3(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2, const UINT32& stn3,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+
+// Adds the contribution of a measurement, commencing at design_row, to the
+// normals
+template <typename T>
+void dna_adjust::UpdateNormalsMeasurement(const UINT32& block, it_vmsr_t _it_msr, UINT32& design_row,
+	T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	// Add covariance terms (station 1, station 2, station 3) to normal matrix
-	for (UINT32 row, col(0); col<3; ++col)
+	UINT32 stn1, stn2, stn3;
+
+	stn1 = GetBlkMatrixElemStn1(block, &_it_msr);
+
+	switch (_it_msr->measType)
 	{
-		for (row=0; row<3; ++row)
-		{
-			// 1-2
-			normals->elementadd(stn1+row, stn2+col,
-				AtVinv->get(stn1+row, design_row) * design->get(design_row, stn2+col));
+	case 'H':	// Orthometric height
+	case 'I':	// Astronomic latitude
+	case 'J':	// Astronomic longitude
+	case 'P':	// Geodetic latitude
+	case 'Q':	// Geodetic longitude
+	case 'R':	// Ellipsoidal height
+		UpdateNormals_HIJPQR(stn1, design_row, normals, design, AtVinv);
+		break;
 
-			normals->elementadd(stn2+row, stn1+col,
-				AtVinv->get(stn2+row, design_row) * design->get(design_row, stn1+col));
+	case 'A':	// Horizontal angle
+		stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
+		stn3 = GetBlkMatrixElemStn3(block, &_it_msr);
+		UpdateNormals_A(stn1, stn2, stn3, design_row, normals, design, AtVinv);
+		break;
 
-			// 1-3
-			normals->elementadd(stn1+row, stn3+col,
-				AtVinv->get(stn1+row, design_row) * design->get(design_row, stn3+col));
+	case 'D':	// Direction set	
+		// When a target direction is found, continue to next element.  
+		if (_it_msr->vectorCount1 < 1)
+			return;
+		UpdateNormals_D(block, _it_msr, design_row, normals, design, AtVinv);
+		break;
 
-			normals->elementadd(stn3+row, stn1+col,
-				AtVinv->get(stn3+row, design_row) * design->get(design_row, stn1+col));
-			
-			// 2-3
-			normals->elementadd(stn2+row, stn3+col,
-				AtVinv->get(stn2+row, design_row) * design->get(design_row, stn3+col));
+	case 'B':	// Geodetic azimuth
+	case 'C':	// Chord dist
+	case 'E':	// Ellipsoid arc
+	case 'K':	// Astronomic azimuth
+	case 'L':	// Level difference
+	case 'M':	// MSL arc
+	case 'S':	// Slope distance
+	case 'V':	// Zenith distance
+	case 'Z':	// Vertical angle
+		stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
+		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
+		break;
 
-			normals->elementadd(stn3+row, stn2+col,
-				AtVinv->get(stn3+row, design_row) * design->get(design_row, stn2+col));
-		}
-	}
+	case 'G':	// GPS Baseline
+		// multiplies only the elements of AT * V-1 and A that contain this measurement
+		stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
+		UpdateNormals_G(stn1, stn2, design_row, normals, AtVinv);
+		break;
+	
+	case 'X':	// GPS Baseline cluster
+		UpdateNormals_X(block, _it_msr, design_row, normals, design, AtVinv);
+		break;
+	
+	case 'Y':	// GPS Point cluster
+		UpdateNormals_Y(block, _it_msr, design_row, normals, AtVinv);
+		break;		
+	
+	default:
+		std::stringstream ss;
+		ss << "UpdateNormals(): Unknown measurement type - '" << static_cast<std::string>(&(_it_msr->measType)) << 
+			"'." << std::endl;
+		SignalExceptionAdjustment(ss.str(), block);
+	}		
+}
+	
+
+template <typename T>
+void dna_adjust::AddMsrtoNormalsVar(const UINT32& design_row, const UINT32& stn,
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
+{
+	// Add weighted measurement contributions to normal matrix
+	const UINT32 stations[1] = {stn};
+	add_msr_to_normals(stations, design_row, normals, design, AtVinv);
+}
+	
+
+template <typename T>
+void dna_adjust::AddMsrtoNormalsCoVar2(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2,
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
+{
+	// Add covariance terms (station 1 and station 2) to normal matrix
+	const UINT32 stations[2] = {stn1, stn2};
+	add_msr_to_normals<2, false>(stations, design_row, normals, design, AtVinv);
+}
+
+template <typename T>
+void dna_adjust::AddMsrtoNormalsCoVar3(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2, const UINT32& stn3,
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
+{
+	// Add covariance terms (station 1, station 2, station 3) to normal matrix
+	const UINT32 stations[3] = {stn1, stn2, stn3};
+	add_msr_to_normals<3, false>(stations, design_row, normals, design, AtVinv);
 }
 
 
+template <typename T>
 void dna_adjust::UpdateNormals_A(const UINT32& stn1, const UINT32& stn2, const UINT32& stn3, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	// station 1
-	AddMsrtoNormalsVar(design_row, stn1, normals, design, AtVinv);
-	// station 2
-	AddMsrtoNormalsVar(design_row, stn2, normals, design, AtVinv);
-	// station 3
-	AddMsrtoNormalsVar(design_row, stn3, normals, design, AtVinv);
-	// covariance terms (station 1, station 2, station 3)
-	AddMsrtoNormalsCoVar3(design_row, stn1, stn2, stn3, normals, design, AtVinv);
+	// variance and covariance terms (station 1, station 2, station 3)
+	const UINT32 stations[3] = {stn1, stn2, stn3};
+	add_msr_to_normals(stations, design_row, normals, design, AtVinv);
 	design_row ++;
 
 }
 	
 
+template <typename T>
 void dna_adjust::UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	UINT32 row, col, a, angle_count(_it_msr->vectorCount2 - 1);
+	UINT32 a, angle_count(_it_msr->vectorCount2 - 1);
 	UINT32 skip(0), ignored(_it_msr->vectorCount1 - _it_msr->vectorCount2);
 
 	std::vector<UINT32> stations;
@@ -1501,9 +1920,9 @@ void dna_adjust::UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 
 		it_angle->station3 = _it_msr->station2;
 
-		stn1 = (v_blockStationsMap_.at(block)[it_angle->station1] * 3); 
-		stn2 = (v_blockStationsMap_.at(block)[it_angle->station2] * 3);
-		stn3 = (v_blockStationsMap_.at(block)[it_angle->station3] * 3);
+		stn1 = (BlockStationPosition(block, it_angle->station1) * 3); 
+		stn2 = (BlockStationPosition(block, it_angle->station2) * 3);
+		stn3 = (BlockStationPosition(block, it_angle->station3) * 3);
 
 		if (!binary_search(stations.begin(), stations.end(), it_angle->station1))
 		{
@@ -1521,23 +1940,10 @@ void dna_adjust::UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 			std::sort(stations.begin(), stations.end());
 		}
 
-		// station 1
-		for (col=0; col<3; ++col)
-			for (row=0; row<3; ++row)
-				normals->elementadd(stn1+row, stn1+col,
-					AtVinv->get(stn1+row, design_row+a) * design->get(design_row+a, stn1+col));
-		//
-		// station 2
-		for (col=0; col<3; ++col)
-			for (row=0; row<3; ++row)
-				normals->elementadd(stn2+row, stn2+col,
-					AtVinv->get(stn2+row, design_row+a) * design->get(design_row+a, stn2+col));
-		//
-		// station 3
-		for (col=0; col<3; ++col)
-			for (row=0; row<3; ++row)
-				normals->elementadd(stn3+row, stn3+col,
-					AtVinv->get(stn3+row, design_row+a) * design->get(design_row+a, stn3+col));
+		// stations 1, 2 and 3
+		AddMsrtoNormalsVar(design_row+a, stn1, normals, design, AtVinv);
+		AddMsrtoNormalsVar(design_row+a, stn2, normals, design, AtVinv);
+		AddMsrtoNormalsVar(design_row+a, stn3, normals, design, AtVinv);
 
 		if (a+1 == angle_count)
 			break;
@@ -1560,25 +1966,15 @@ void dna_adjust::UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 		// requires std::vector<UINT32> stations which was built during formation of v_AtVinv_
 		for (it_stn=stations.begin(); it_stn!=stations.end(); ++it_stn)
 		{
-			stn1 = (v_blockStationsMap_.at(block)[*it_stn] * 3);
+			stn1 = (BlockStationPosition(block, *it_stn) * 3);
 
 			for (it_cov=it_stn; it_cov!=stations.end(); ++it_cov)
 			{
-				stn2 = (v_blockStationsMap_.at(block)[*it_cov] * 3);
+				stn2 = (BlockStationPosition(block, *it_cov) * 3);
 				if (stn2 == stn1)
 					continue;
 
-				for (col=0; col<3; ++col)
-				{
-					for (row=0; row<3; ++row)
-					{
-						// 1-2
-						normals->elementadd(stn1+row, stn2+col,
-							AtVinv->get(stn1+row, design_row+a) * design->get(design_row+a, stn2+col));
-						normals->elementadd(stn2+row, stn1+col,
-							AtVinv->get(stn2+row, design_row+a) * design->get(design_row+a, stn1+col));
-					}				
-				}
+				AddMsrtoNormalsCoVar2(design_row+a, stn1, stn2, normals, design, AtVinv);
 			}
 		}
 		it_angle++;
@@ -1589,22 +1985,21 @@ void dna_adjust::UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 	
 
 // This function can be used for all two-station measurements
+template <typename T>
 void dna_adjust::UpdateNormals_BCEKLMSVZ(const UINT32& stn1, const UINT32& stn2, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
-	// station 1
-	AddMsrtoNormalsVar(design_row, stn1, normals, design, AtVinv);
-	// station 2
-	AddMsrtoNormalsVar(design_row, stn2, normals, design, AtVinv);
-	// covariance terms (station 1 and station 2)
-	AddMsrtoNormalsCoVar2(design_row, stn1, stn2, normals, design, AtVinv);
+	// variance and covariance terms (station 1 and station 2)
+	const UINT32 stations[2] = {stn1, stn2};
+	add_msr_to_normals(stations, design_row, normals, design, AtVinv);
 	design_row ++;
 }
 	
 
 // This function can be used for all two-station measurements
+template <typename T>
 void dna_adjust::UpdateNormals_HIJPQR(const UINT32& stn1, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
 	// station 1
 	AddMsrtoNormalsVar(design_row, stn1, normals, design, AtVinv);
@@ -1612,49 +2007,20 @@ void dna_adjust::UpdateNormals_HIJPQR(const UINT32& stn1, UINT32& design_row,
 }
 	
 
+template <typename T>
 void dna_adjust::UpdateNormals_G(const UINT32& stn1, const UINT32& stn2, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* AtVinv)
 {
-	UINT32 col, row;
-
-	// station 2
-	for (col=0; col<3; ++col)
-		for (row=0; row<3; ++row)
-			normals->elementadd(stn2+row, stn2+col,
-				// AtVinv->get(stn2+row, design_row+col) * design->get(design_row+col, stn2+col));
-				// No need to multiply by 1 as stn2 design element is always 1.  See UpdateDesignMeasMatrices_GX()
-				AtVinv->get(stn2+row, design_row+col));
-
-	// station 1
-	for (col=0; col<3; ++col)
-		for (row=0; row<3; ++row)
-			normals->elementadd(stn1+row, stn1+col,
-				// AtVinv->get(stn1+row, design_row+col) * design->get(design_row+col, stn1+col));
-				// No need to multiply by -1 as stn1 design element is always -1.  See UpdateDesignMeasMatrices_GX()
-				-AtVinv->get(stn1+row, design_row+col));
-
-	// covariance terms (station 1 and station 2)
-	for (col=0; col<3; ++col)
-		for (row=0; row<3; ++row)
-			normals->elementadd(stn1+row, stn2+col,
-				// AtVinv->get(stn1+row, design_row+col) * design->get(design_row+col, stn2+col));
-				// No need to multiply as stn2 is always 1.  See UpdateDesignMeasMatrices_GX()
-				AtVinv->get(stn1+row, design_row+col));
-
-	// covariance terms (station 2 and station 1)
-	for (col=0; col<3; ++col)
-		for (row=0; row<3; ++row)
-			normals->elementadd(stn2+row, stn1+col,
-				// AtVinv->get(stn2+row, design_row+col) * design->get(design_row+col, stn1+col));
-				// No need to multiply by -1 as stn1 design element is always -1.  See UpdateDesignMeasMatrices_GX()
-				-AtVinv->get(stn2+row, design_row+col));
+	// variance and covariance terms (station 1 and station 2)
+	add_baseline_to_normals(stn1, stn2, design_row, normals, AtVinv);
 
 	design_row += 3;
 }
 	
 
+template <typename T>
 void dna_adjust::UpdateNormals_X(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv)
 {
 	UINT32 cluster_bsl, baseline_count(_it_msr->vectorCount1);
 	UINT32 cluster_cov, covariance_count;
@@ -1702,8 +2068,9 @@ void dna_adjust::UpdateNormals_X(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 		// add variances for these stations
 		normals->blockadd(stn1, stn1,							// Station 1.
 			tmp, 0, 0, 3, 3);
+		AtVinv->submatrix(stn2, design_row+covr, &tmp, 3, 3);
 		normals->blockadd(stn2, stn2,							// Station 2
-			*AtVinv, stn2, design_row+covr, 3, 3);	
+			tmp, 0, 0, 3, 3);
 
 		covariance_count = _it_msr->vectorCount2;
 		_it_msr += 3;			// move to covariances
@@ -1726,6 +2093,9 @@ void dna_adjust::UpdateNormals_X(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 
 			stn2 = baseline_stations.at(cluster_cov);
 
+			if (!owns_column(normals, stn2))
+				continue;
+
 			//// add covariances for these stations
 			//normals->blockadd(stn1, stn2,		
 			//	AtVinv->submatrix(stn1,			
@@ -1756,13 +2126,16 @@ void dna_adjust::UpdateNormals_X(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 }
 	
 
+template <typename T>
 void dna_adjust::UpdateNormals_Y(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-										 matrix_2d* normals, matrix_2d* AtVinv)
+										 T* normals, rowblock_matrix* AtVinv)
 {
 	UINT32 cluster_pnt, point_count(_it_msr->vectorCount1);
 	UINT32 cluster_cov, covariance_count;
 	UINT32 stn1, stn2, cov_c;
 
+	matrix_2d tmp(3, 3);
+
 	// Add to At * V-1 * A
 	for (cluster_pnt=0; cluster_pnt<point_count; ++cluster_pnt)
 	{		
@@ -1770,11 +2143,12 @@ void dna_adjust::UpdateNormals_Y(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 		covariance_count = _it_msr->vectorCount2;
 		
 		// add variance for this station
-		normals->blockadd(stn1, stn1, *AtVinv, stn1, design_row, 3, 3);
+		AtVinv->submatrix(stn1, design_row, &tmp, 3, 3);
+		normals->blockadd(stn1, stn1, tmp, 0, 0, 3, 3);
 
 		if (projectSettings_.g.verbose > 4)
 			debug_file << "- Adding variances for " << bstBinaryRecords_.at(_it_msr->station1).stationName << " to v_normals_ (block " << block+1 << "), (" << stn1 << ", " << stn1 << "): " << 
-				std::fixed << std::setprecision(16) << AtVinv->submatrix(stn1, design_row, 3, 3);
+				std::fixed << std::setprecision(16) << tmp;
 
 		if (covariance_count < 1)
 		{
@@ -1791,8 +2165,10 @@ void dna_adjust::UpdateNormals_Y(const UINT32& block, it_vmsr_t& _it_msr, UINT32
 			cov_c += 3;
 
 			// add covariance between stn1 and this station
-			normals->blockadd(stn1, stn2, *AtVinv, stn1, design_row + cov_c, 3, 3);
-			normals->blockadd(stn2, stn1, *AtVinv, stn2, design_row, 3, 3);
+			AtVinv->submatrix(stn1, design_row + cov_c, &tmp, 3, 3);
+			normals->blockadd(stn1, stn2, tmp, 0, 0, 3, 3);
+			AtVinv->submatrix(stn2, design_row, &tmp, 3, 3);
+			normals->blockadd(stn2, stn1, tmp, 0, 0, 3, 3);
 			
 			_it_msr += 3;
 		}
@@ -1878,7 +2254,7 @@ void dna_adjust::AddConstraintStationstoNormalsForward(const UINT32& block)
 				<< std::scientific << std::setprecision(16) << var_cart << std::endl;
 		
 		// Add the variance to the normals
-		stn = v_blockStationsMap_.at(block)[(*_it_const)] * 3;
+		stn = BlockStationPosition(block, *_it_const) * 3;
 		v_normals_.at(block).blockadd(stn, stn, var_cart, 0, 0, 3, 3);
 	}
 }
@@ -1896,7 +2272,7 @@ void dna_adjust::AddConstraintStationstoNormalsReverse(const UINT32& block, bool
 	
 	UINT32 stn;
 	matrix_2d var_cart(3, 3);
-	matrix_2d* normals(&v_normals_.at(block));
+	symmetric_matrix* normals(&v_normals_.at(block));
 
 	if (MT_ReverseOrCombine)
 		normals = &v_normalsR_.at(block);	
@@ -1915,7 +2291,7 @@ void dna_adjust::AddConstraintStationstoNormalsReverse(const UINT32& block, bool
 		FormConstraintStationVarianceMatrix(_it_const, var_cart);
 
 		// Add the variance to the normals
-		stn = v_blockStationsMap_.at(block)[(*_it_const)] * 3;
+		stn = BlockStationPosition(block, *_it_const) * 3;
 		normals->blockadd(stn, stn, var_cart, 0, 0, 3, 3);
 	}
 }
@@ -1933,7 +2309,7 @@ void dna_adjust::AddConstraintStationstoNormalsCombine(const UINT32& block, bool
 	
 	UINT32 stn;
 	matrix_2d var_cart(3, 3);
-	matrix_2d* normals(&v_normals_.at(block));
+	symmetric_matrix* normals(&v_normals_.at(block));
 
 	if (MT_ReverseOrCombine)
 		normals = &v_normalsR_.at(block);	
@@ -1962,7 +2338,7 @@ void dna_adjust::AddConstraintStationstoNormalsCombine(const UINT32& block, bool
 		FormConstraintStationVarianceMatrix(_it_const, var_cart);
 
 		// Add the variance to the normals
-		stn = v_blockStationsMap_.at(block)[(*_it_const)] * 3;
+		stn = BlockStationPosition(block, *_it_const) * 3;
 
 		if (!_it_appear->first_appearance_fwd)
 			normals->blocksubtract(stn, stn, var_cart,
@@ -1997,13 +2373,459 @@ void dna_adjust::AddConstraintStationstoNormalsSimultaneous(const UINT32& block)
                 << std::scientific << std::setprecision(16) << var_cart << std::endl;
 		
 		// Add the variance to the normals
-		stn = v_blockStationsMap_.at(block)[(*_it_const)] * 3;
-		v_normals_.at(block).blockadd(stn, stn, var_cart, 0, 0, 3, 3);
+		stn = BlockStationPosition(block, *_it_const) * 3;
+		if (IterativeNormals())
+		{
+			// Held separately, since the normals are not formed
+			for (UINT32 row(0), col; row<3; ++row)
+				for (col=0; col<3; ++col)
+				{
+					v_iterativeConstraints_.at(stn * 3 + row * 3 + col) += var_cart.get(std::max(row, col), std::min(row, col));
+					v_iterativePreconditioner_.at(stn * 3 + row * 3 + col) += var_cart.get(std::max(row, col), std::min(row, col));
+				}
+		}
+		else if (SparseNormals())
+			sparseNormals_.blockadd(stn, stn, var_cart, 0, 0, 3, 3);
+		else
+			v_normals_.at(block).blockadd(stn, stn, var_cart, 0, 0, 3, 3);
 	}
 
-	if (projectSettings_.g.verbose > 6)
+	if (projectSettings_.g.verbose > 6 && !SparseNormals())
         debug_file << "Constrained normals " << std::scientific << std::setprecision(16) << v_normals_.at(block) << std::endl;
 }
+
+
+// Performs the symbolic analysis of the sparse normals and forms the normals
+// from the design and At*V-1 matrices.  The symbolic analysis is only required 
+// once, since the structure of the normals does not change between iterations.
+// Constraint station variances are added by AddConstraintStationstoNormalsSimultaneous
+void dna_adjust::PrepareSparseNormals(const UINT32& block)
+{
+	if (IterativeNormals())
+	{
+		PrepareIterativeNormals(block);
+		return;
+	}
+
+	// Register the non-zero 3x3 blocks.  Only the structure of the
+	// normals is captured here.  Constraint stations only contribute to
+	// the diagonal blocks, which are always present.
+	sparseNormals_.initialise(v_unknownsCount_.at(block));
+	UpdateNormals(block, &sparseNormals_, &v_design_.at(block), &v_AtVinv_.at(block));
+	sparseNormals_.analyse();
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Sparse normals: " << sparseNormals_.blockCount() << " stations, " <<
+			sparseNormals_.nonzeroBlocks() << " non-zero blocks in factor (" << 
+			std::fixed << std::setprecision(1) << 
+			sparseNormals_.factorSize() / 1048576.0 << " MB)" << std::endl;
+
+	FormSparseNormals(block);
+}
+	
+
+// Re-form the sparse normals from the design and At*V-1 matrices
+void dna_adjust::FormSparseNormals(const UINT32& block)
+{
+	if (IterativeNormals())
+	{
+		FormIterativePreconditioner(block);
+		return;
+	}
+
+	sparseNormals_.zero();
+	UpdateNormals(block, &sparseNormals_, &v_design_.at(block), &v_AtVinv_.at(block));
+}
+	
+
+// Forms the inverse of the normals (i.e. the variance matrix of the estimates)
+// from the sparse factor.  Unless covariances between all stations are 
+// required, only the selected inverse is computed, which provides the 
+// station variances and the covariances of all stations connected by a 
+// measurement (i.e. all elements required for the precision of adjusted 
+// measurements).  The selected inverse is held in sparseNormals_ and read
+// via AposterioriVariances.  Otherwise, the full inverse is formed in 
+// v_normals_ as for the dense solver.  See FormIterativePrecisions for the
+// iterative solver.
+void dna_adjust::FormSparseInverse(const UINT32& block)
+{
+	if (IterativeNormals())
+	{
+		FormIterativePrecisions(block);
+		return;
+	}
+
+	if (FullInverseRequired())
+	{
+		sparseNormals_.inverse(v_normals_.at(block));
+		return;
+	}
+
+	sparseNormals_.selectedinverse();
+}
+
+
+// The variance matrix of the estimates of block, from the latest inverse
+variance_matrix dna_adjust::AposterioriVariances(const UINT32& block)
+{
+	if (SparseVariances())
+	{
+		if (IterativeNormals())
+			return &iterativeVariances_;
+		return &sparseNormals_;
+	}
+	return &v_normals_.at(block);
+}
+
+
+// The rigorous variance matrix of the estimates of block (see 
+// ValidateandFinaliseAdjustment)
+variance_matrix dna_adjust::RigorousVariances(const UINT32& block)
+{
+	if (SparseVariances())
+		return AposterioriVariances(block);
+	return &v_rigorousVariances_.at(block);
+}
+
+
+// Prepares the iterative solution of the normals, in which the normals are
+// never formed.  Instead, the product of the normals and a vector is formed
+// from the design and At*V-1 matrices (see MultiplyIterativeNormals), and
+// the normals are solved by conjugate gradients, preconditioned by the
+// inverse of the 3x3 diagonal block of each station (block Jacobi).  Hence,
+// the memory required is that of the design matrix only.
+void dna_adjust::PrepareIterativeNormals(const UINT32& block)
+{
+	const UINT32 stations(v_unknownsCount_.at(block) / 3);
+	v_iterativeConstraints_.assign(stations * 9, 0.);
+	v_iterativePreconditioner_.assign(stations * 9, 0.);
+
+	// Stations for which precisions are to be estimated
+	v_iterativePrecisionStations_.clear();
+	if (!projectSettings_.a.precision_stations.empty())
+	{
+		vstring names;
+		try {
+			SplitDelimitedString<std::string>(projectSettings_.a.precision_stations, std::string(","), &names);
+		}
+		catch (...) {
+			SignalExceptionAdjustment("PrepareIterativeNormals(): Could not read the precision stations \"" + 
+				projectSettings_.a.precision_stations + "\".", block);
+		}
+
+		for (const auto& name : names)
+		{
+			std::string station(name);
+			station = trimstr(station);
+			vstn_t::const_iterator _it_stn(std::find_if(bstBinaryRecords_.begin(), bstBinaryRecords_.end(),
+				[&station](const station_t& stn) { return station == stn.stationName; }));
+
+			if (_it_stn == bstBinaryRecords_.end())
+				SignalExceptionAdjustment("PrepareIterativeNormals(): The precision station " + station + 
+					" is not in the binary station file.", block);
+
+			// Stations without measurements are not estimated
+			const UINT32 stn(static_cast<UINT32>(_it_stn - bstBinaryRecords_.begin()));
+			if (v_blockStationIndexStart_.at(stn) < v_blockStationIndexStart_.at(stn + 1))
+				v_iterativePrecisionStations_.push_back(stn);
+		}
+
+		strip_duplicates(v_iterativePrecisionStations_);
+	}
+
+	// Unless covariances between all stations are required, the columns
+	// of the inverse are only solved for the precision stations
+	if (!FullInverseRequired())
+		adj_file << "- Warning: Precisions will be estimated for " << v_iterativePrecisionStations_.size() << 
+			" of " << stations << " stations only (see --" << PRECISION_STATIONS << ").  The precisions" << std::endl <<
+			"  of other stations, and of adjusted measurements to them, are not computed." << std::endl << std::endl;
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Iterative normals: " << stations << " stations, " <<
+			v_design_.at(block).nonzeroBlocks() + v_AtVinv_.at(block).nonzeroBlocks() << 
+			" non-zero blocks in the design and At*V-1 matrices" << std::endl;
+
+	FormSparseNormals(block);
+}
+
+
+// Forms the 3x3 diagonal block of each station from the design and At*V-1
+// matrices.  Constraint station variances are added by 
+// AddConstraintStationstoNormalsSimultaneous.
+void dna_adjust::FormIterativePreconditioner(const UINT32& block)
+{
+	std::fill(v_iterativeConstraints_.begin(), v_iterativeConstraints_.end(), 0.);
+	std::fill(v_iterativePreconditioner_.begin(), v_iterativePreconditioner_.end(), 0.);
+	iterativePreconditioned_ = false;
+
+	normals_diagonal diagonal(&v_iterativePreconditioner_);
+	UpdateNormals(block, &diagonal, &v_design_.at(block), &v_AtVinv_.at(block));
+}
+
+
+// Inverts the 3x3 diagonal block of each station (as for the normals, from
+// the lower triangle)
+void dna_adjust::InvertIterativePreconditioner()
+{
+	if (iterativePreconditioned_)
+		return;
+
+	matrix_2d var(3, 3);
+	UINT32 row, col;
+	for (std::size_t stn(0); stn<v_iterativePreconditioner_.size(); stn+=9)
+	{
+		for (row=0; row<3; ++row)
+			for (col=0; col<=row; ++col)
+				var.put(row, col, v_iterativePreconditioner_.at(stn + row * 3 + col));
+
+		try {
+			FormInverseVarianceMatrix(&var);
+		}
+		catch (const MatrixInversionFailure&) {
+			// A station which is not fully determined by its own measurements
+			// is preconditioned by the inverse of its diagonal only
+			for (row=0; row<3; ++row)
+				for (col=0; col<3; ++col)
+				{
+					const double diagonal(v_iterativePreconditioner_.at(stn + row * 4));
+					var.put(row, col, row == col && diagonal > 0. ? 1. / diagonal : 0.);
+				}
+		}
+
+		for (row=0; row<3; ++row)
+			for (col=0; col<3; ++col)
+				v_iterativePreconditioner_.at(stn + row * 3 + col) = var.get(row, col);
+	}
+
+	iterativePreconditioned_ = true;
+}
+
+
+// result = N * x, where N = At * V-1 * A + the constraint station variances
+void dna_adjust::MultiplyIterativeNormals(const UINT32& block, const matrix_2d& x, matrix_2d& result)
+{
+	matrix_2d design_x(v_design_.at(block).rows(), x.columns());
+	v_design_.at(block).multiply(x, design_x);
+
+	result.redim(x.rows(), x.columns());
+	v_AtVinv_.at(block).multiply(design_x, result);
+
+	UINT32 row, col, k, c;
+	for (std::size_t stn(0); stn<v_iterativeConstraints_.size(); stn+=9)
+	{
+		row = static_cast<UINT32>(stn / 3);
+		for (c=0; c<x.columns(); ++c)
+			for (k=0; k<3; ++k)
+				for (col=0; col<3; ++col)
+					result.elementadd(row + k, c, 
+						v_iterativeConstraints_.at(stn + k * 3 + col) * x.get(row + col, c));
+	}
+}
+
+
+// Solves N * x = rhs for each column of rhs by preconditioned conjugate
+// gradients.  A column is solved once the preconditioned norm of its 
+// residual, sqrt(r' * M-1 * r), is reduced to tolerance times that of its
+// right hand side.  If p' * N * p is not positive (i.e. the normals or the 
+// preconditioner are not positive definite), the solution of a column breaks
+// down and cannot proceed.  Such columns are reported, and are not solved.
+// Returns the number of iterations.
+UINT32 dna_adjust::SolveIterativeNormals(const UINT32& block, const matrix_2d& rhs, matrix_2d& x,
+	const double& tolerance)
+{
+	const UINT32 n(rhs.rows()), columns(rhs.columns());
+	const UINT32 maxIterations(std::max(n * 2, UINT32(100)));
+
+	matrix_2d r(rhs), z(n, columns), p(n, columns), q(n, columns);
+	x.redim(n, columns);
+	x.zero();
+
+	// z = M-1 * r
+	auto precondition = [this, &n, &columns](const matrix_2d& r, matrix_2d& z) {
+		UINT32 row, k, c;
+		for (UINT32 stn(0); stn<n; stn+=3)
+			for (c=0; c<columns; ++c)
+				for (row=0; row<3; ++row)
+				{
+					double sum(0.);
+					for (k=0; k<3; ++k)
+						sum += v_iterativePreconditioner_.at(stn * 3 + row * 3 + k) * r.get(stn + k, c);
+					z.put(stn + row, c, sum);
+				}
+	};
+
+	auto dot = [&n](const matrix_2d& a, const matrix_2d& b, const UINT32& c) {
+		double sum(0.);
+		for (UINT32 i(0); i<n; ++i)
+			sum += a.get(i, c) * b.get(i, c);
+		return sum;
+	};
+
+	InvertIterativePreconditioner();
+	precondition(r, z);
+	p = z;
+
+	// rz_limit is the square of the residual norm at which a column is solved
+	vdouble rz(columns), rz_limit(columns);
+	std::vector<bool> active(columns, true);
+	UINT32 i, c, iteration(0), unsolved(columns), brokendown(0);
+	double alpha, beta, rz_next;
+
+	auto breakdown = [&active, &unsolved, &brokendown](const UINT32& c) {
+		active.at(c) = false;
+		--unsolved;
+		++brokendown;
+	};
+
+	for (c=0; c<columns; ++c)
+	{
+		rz.at(c) = dot(r, z, c);
+		rz_limit.at(c) = rz.at(c) * tolerance * tolerance;
+
+		// A zero right hand side is solved by x = 0
+		if (rz.at(c) == 0.)
+		{
+			active.at(c) = false;
+			--unsolved;
+		}
+		else if (!(rz.at(c) > 0.))
+			breakdown(c);
+	}
+
+	while (unsolved > 0 && iteration < maxIterations)
+	{
+		++iteration;
+		MultiplyIterativeNormals(block, p, q);
+
+		for (c=0; c<columns; ++c)
+		{
+			if (!active.at(c))
+				continue;
+
+			const double pq(dot(p, q, c));
+			if (!(pq > 0.))
+			{
+				breakdown(c);
+				continue;
+			}
+
+			alpha = rz.at(c) / pq;
+			for (i=0; i<n; ++i)
+			{
+				x.elementadd(i, c, alpha * p.get(i, c));
+				r.elementadd(i, c, -alpha * q.get(i, c));
+			}
+		}
+
+		precondition(r, z);
+
+		for (c=0; c<columns; ++c)
+		{
+			if (!active.at(c))
+				continue;
+
+			rz_next = dot(r, z, c);
+			if (!(rz_next >= 0.))
+			{
+				breakdown(c);
+				continue;
+			}
+
+			if (rz_next <= rz_limit.at(c))
+			{
+				active.at(c) = false;
+				--unsolved;
+				continue;
+			}
+
+			beta = rz_next / rz.at(c);
+			rz.at(c) = rz_next;
+			for (i=0; i<n; ++i)
+				p.put(i, c, z.get(i, c) + beta * p.get(i, c));
+		}
+	}
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Iterative normals: " << columns - unsolved - brokendown << " of " << 
+			columns << (columns > 1 ? " columns" : " column") <<
+			" solved in " << iteration << " iterations" << std::endl;
+
+	if (brokendown > 0)
+		adj_file << "- Warning: The iterative solution of the normals broke down for " << brokendown << 
+			" of " << columns << (columns > 1 ? " columns" : " column") << 
+			", as the normals are not positive" << std::endl <<
+			"  definite.  The solution of " << (brokendown > 1 ? "these columns is" : "this column is") <<
+			" incomplete." << std::endl << std::endl;
+
+	if (unsolved > 0)
+		adj_file << "- Warning: The iterative solution of the normals did not converge within " << 
+			maxIterations << " iterations." << std::endl << std::endl;
+
+	return iteration;
+}
+
+
+// Estimates the precisions of the stations, by solving the columns of the
+// inverse of the normals for each precision station (see 
+// --precision-stations).  The columns are held in iterativeVariances_, and
+// elements of the inverse which are not solved are zero.  Only if 
+// covariances between all stations are required is every column solved, 
+// in which case the inverse is formed in v_normals_ as for the sparse 
+// inverse.
+void dna_adjust::FormIterativePrecisions(const UINT32& block)
+{
+	const UINT32 n(v_unknownsCount_.at(block));
+	const bool full(FullInverseRequired());
+
+	vUINT32 columns;
+	if (full)
+	{
+		columns.resize(n);
+		for (UINT32 c(0); c<n; ++c)
+			columns.at(c) = c;
+
+		v_normals_.at(block).redim(n, n);
+		v_normals_.at(block).zero();
+	}
+	else
+	{
+		for (const auto& stn : v_iterativePrecisionStations_)
+			for (UINT32 c(BlockStationPosition(block, stn) * 3); c<BlockStationPosition(block, stn) * 3 + 3; ++c)
+				columns.push_back(c);
+
+		iterativeVariances_.initialise(n);
+	}
+
+	const double tolerance(projectSettings_.a.iteration_threshold * ITERATIVE_THRESHOLD_FRACTION);
+	matrix_2d unit, inverse;
+	UINT32 first, count, c, row;
+
+	for (first=0; first<columns.size(); first+=count)
+	{
+		count = std::min(static_cast<UINT32>(columns.size()) - first, ITERATIVE_PRECISION_COLUMNS);
+
+		unit.redim(n, count);
+		unit.zero();
+		for (c=0; c<count; ++c)
+			unit.put(columns.at(first + c), c, 1.);
+
+		SolveIterativeNormals(block, unit, inverse, tolerance);
+
+		for (c=0; c<count; ++c)
+		{
+			if (full)
+			{
+				for (row=0; row<n; ++row)
+					v_normals_.at(block).put(row, columns.at(first + c), inverse.get(row, c));
+				continue;
+			}
+
+			double* column(iterativeVariances_.column(columns.at(first + c)));
+			for (row=0; row<n; ++row)
+				column[row] = inverse.get(row, c);
+		}
+	}
+}
 	
 
 // used in phased adjustment to compute variances for all inner stations
@@ -2140,6 +2962,18 @@ _ADJUST_STATUS_ dna_adjust::AdjustNetwork()
 			return adjustStatus_;
 		}
 
+		if (projectSettings_.a.tree_phased)
+		{
+			if (!projectSettings_.a.report_mode)
+			{
+				adj_file << std::endl << "  Optimised for concurrent processing via elimination of blocks over a binary tree." << std::endl;
+				adj_file << "  The active CPU supports the execution of " << std::thread::hardware_concurrency() << " concurrent threads." << std::endl;
+				adj_file << std::endl;
+			}
+			AdjustPhasedTree();
+			return adjustStatus_;
+		}
+
 		if (!projectSettings_.a.report_mode)
 			adj_file << std::endl << std::endl;
 		AdjustPhased();
@@ -2389,9 +3223,26 @@ void dna_adjust::AdjustSimultaneous()
 	std::chrono::milliseconds elapsed_time(std::chrono::milliseconds(0));
 	cpu_timer it_time, tot_time;
 
-	bool iterate;
+	bool iterate, refactorised(false);
+	double previousCorr(0.);
+
+	// In frozen Jacobian mode, the normals are re-formed and re-factorised
+	// only when corrections converge more slowly than this rate
+	const double FROZEN_CONVERGENCE_RATE(0.5);
+
+	normalsFrozen_ = false;
 
-	for (UINT32 i=0; i<projectSettings_.a.max_iterations; ++i)
+	// Resume from the checkpoint of a previous adjustment?
+	const UINT32 resumed(ResumeAdjustment());
+
+	// Otherwise, update the inverse of the normals from the previous
+	// incremental adjustment (if any), which is retained whilst 
+	// corrections converge as for frozen Jacobian mode
+	const bool incremental(resumed == 0 && UpdateNormalsIncrementally());
+	bool updatedInverse(incremental);
+	normalsFrozen_ = incremental;
+
+	for (UINT32 i=resumed; i<projectSettings_.a.max_iterations; ++i)
 	{
 		if (IsCancelled())
 			break;
@@ -2414,11 +3265,17 @@ void dna_adjust::AdjustSimultaneous()
 
 		// Least Squares Solution
 		// Inverse is only required if:
-		//	- This is the first iteration
+		//	- This is the first iteration (or the first iteration since
+		//	  resuming from a checkpoint)
 		//	- The network contains non-GPS measurements, in which an updated 
 		//	  normals matrix would be available based upon reformed partial
-		//	  derivatives in the design matrix
-		SolveTry(CurrentIteration() < 2 || v_msrTally_.at(0).ContainsNonGPS());
+		//	  derivatives in the design matrix, unless the inverse from a
+		//	  previous iteration is retained (frozen Jacobian mode)
+		refactorised = !normalsFrozen_ && 
+			(i == resumed || v_msrTally_.at(0).ContainsNonGPS());
+		SolveTry(refactorised);
+		if (refactorised)
+			updatedInverse = false;
 
 		// calculate and print total time
 		PrintAdjustmentTime(it_time, iteration_time);
@@ -2440,6 +3297,26 @@ void dna_adjust::AdjustSimultaneous()
 		if (!iterate)
 			break;
 
+		// An inverse updated by an incremental adjustment is rigorous
+		// only if no further iterations are required
+		updatedInverse = false;
+
+		// Record the estimates so that the adjustment may be resumed
+		CheckpointIteration();
+
+		// Retain the inverse of the normals for the next iteration, unless
+		// corrections from the retained inverse have stopped shrinking
+		if ((FrozenJacobian() || incremental) && v_msrTally_.at(0).ContainsNonGPS())
+		{
+			normalsFrozen_ = refactorised || i == resumed ||
+				fabs(maxCorr_) < FROZEN_CONVERGENCE_RATE * fabs(previousCorr);
+
+			if (projectSettings_.g.verbose > 0)
+				debug_file << "Iteration " << CurrentIteration() << ": " <<
+					(normalsFrozen_ ? "retaining" : "re-forming") << " normals for next iteration" << std::endl;
+		}
+		previousCorr = maxCorr_;
+
 		// Does the user want to print statistics on each iteration?
 		if (projectSettings_.o._adj_stat_iteration)
 		{
@@ -2450,6 +3327,13 @@ void dna_adjust::AdjustSimultaneous()
 			printer_->PrintStatistics(false);
 		}
 
+		// The sparse solver does not form the inverse of the normals,
+		// which is required for adjusted measurement and station
+		// precisions on each iteration
+		if (SparseNormals() && 
+			(projectSettings_.o._adj_msr_iteration || projectSettings_.o._adj_stn_iteration))
+			FormSparseInverse(0);
+
 		// Does the user want to print adjusted measurements
 		// on each iteration?
 		if (projectSettings_.o._adj_msr_iteration)
@@ -2459,7 +3343,7 @@ void dna_adjust::AdjustSimultaneous()
 		// on each iteration?
 		if (projectSettings_.o._adj_stn_iteration)
 			// computes geographic coordinates if required
-			printer_->PrintBlockStations(adj_file, 0, &v_estimatedStations_.at(0), &v_normals_.at(0), 
+			printer_->PrintBlockStations(adj_file, 0, &v_estimatedStations_.at(0), AposterioriVariances(0), 
 				false, !v_msrTally_.at(0).ContainsNonGPS(), !v_msrTally_.at(0).ContainsNonGPS(), true, false);
 
 		// Update normals and measured-computed matrices for the next iteration.
@@ -2469,9 +3353,47 @@ void dna_adjust::AdjustSimultaneous()
 		UpdateAdjustment(!lastIteration);
 	}
 
+	// If the final corrections were computed from a retained inverse,
+	// re-form the normals from which precisions are computed
+	if ((FrozenJacobian() || incremental) && v_msrTally_.at(0).ContainsNonGPS() && 
+		!refactorised && !updatedInverse && !IsCancelled())
+		RefreshFrozenNormals();
+	normalsFrozen_ = false;
+
+	// Form the inverse of the normals from the final sparse factor
+	if (SparseNormals() && (sparseNormals_.factorised() || iterativePreconditioned_))
+		FormSparseInverse(0);
+
 	ValidateandFinaliseAdjustment(tot_time);
 }
 
+// In frozen Jacobian mode, the final corrections may have been computed from
+// the inverse (or factor) of normals formed on an earlier iteration.  Re-form
+// the normals from the latest design matrix and invert, so that precisions
+// of the adjusted stations and measurements are rigorous.
+void dna_adjust::RefreshFrozenNormals()
+{
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Re-forming normals for computation of precisions" << std::endl;
+
+	if (SparseNormals())
+		FormSparseNormals(0);
+	else
+	{
+		v_normals_.at(0).zero();
+		UpdateNormals(0, false);
+	}
+	AddConstraintStationstoNormalsSimultaneous(0);
+
+	try {
+		InvertNormals(0);
+	}
+	catch (const std::runtime_error& e) {
+		SignalExceptionAdjustment(e.what(), 0);
+	}
+}
+	
+
 void dna_adjust::ValidateandFinaliseAdjustment(cpu_timer& tot_time)
 {
 	isAdjusting_ = false;
@@ -2489,13 +3411,20 @@ void dna_adjust::ValidateandFinaliseAdjustment(cpu_timer& tot_time)
 		fabs(maxCorr_) > projectSettings_.a.iteration_threshold)
 		adjustStatus_ = ADJUST_MAX_ITERATIONS_EXCEEDED;
 
+	FinaliseCheckpoint();
+
 	// Back up simultaneous rigorous variance estimates (for serialising 
 	// to disk at SerialiseAdjustedVarianceMatrices() ), so that executing adjust
 	// in report-results mode has access to the latest variance estimates
 	switch (projectSettings_.a.adjust_mode)
 	{
 	case SimultaneousMode:
-		v_rigorousVariances_.at(0) = v_normals_.at(0);
+		// The selected inverse (or the columns solved by the iterative 
+		// solver) is retained, and so only its dimension is recorded
+		if (SparseVariances())
+			v_rigorousVariances_.at(0).setsize(v_unknownsCount_.at(0), v_unknownsCount_.at(0));
+		else
+			v_rigorousVariances_.at(0) = v_normals_.at(0);
 		break;
 	case Phased_Block_1Mode:
 	case PhasedMode:
@@ -2531,8 +3460,13 @@ void dna_adjust::AdjustPhased()
 
 	cpu_timer it_time, tot_time;
 		
+	// Resume from the checkpoint of a previous adjustment, or update
+	// the previous incremental adjustment (if any) on the first iteration
+	i = ResumeAdjustment();
+	bool incremental(i == 0 && FormIncrementalUpdate());
+
 	// do until convergence criteria is met
-	for (i=0; i<projectSettings_.a.max_iterations; ++i)
+	for (; i<projectSettings_.a.max_iterations; ++i)
 	{
 		if (IsCancelled())
 			break;
@@ -2554,13 +3488,17 @@ void dna_adjust::AdjustPhased()
 		
 		it_time.start();
 
-		AdjustPhasedForward();
-		if (IsCancelled())
-			break;
+		if (!incremental || !UpdateEstimatesIncrementally())
+		{
+			AdjustPhasedForward();
+			if (IsCancelled())
+				break;
 
-		AdjustPhasedReverseCombine();
-		if (IsCancelled())
-			break;
+			AdjustPhasedReverseCombine();
+			if (IsCancelled())
+				break;
+		}
+		incremental = false;
 
 		// calculate and print total time
 		PrintAdjustmentTime(it_time, iteration_time);
@@ -2577,6 +3515,9 @@ void dna_adjust::AdjustPhased()
 		if (!iterate)
 			break;
 
+		// Record the estimates so that the adjustment may be resumed
+		CheckpointIteration();
+
 		// Update normals and measured-computed matrices for the next iteration.
 		// Similar to PrepareAdjustment, UpdateAdjustment prepares every block
 		// in the network so that forward and reverse adjustments can commence
@@ -2714,6 +3655,11 @@ void dna_adjust::AdjustPhasedForward()
 
 		SetcurrentBlock(currentBlock);
 
+		// For staged adjustments, read the next block from disk whilst
+		// this block is adjusted
+		if (projectSettings_.a.stage)
+			PrefetchBlock(currentBlock + 1);
+
 		// Does the user want to print computed measurements?
 		if (projectSettings_.o._cmp_msr_iteration)
 			printer_->PrintCompMeasurements(currentBlock, "a-priori");
@@ -2779,6 +3725,10 @@ void dna_adjust::AdjustPhasedForward()
 			if (currentBlock < (blockCount_ - 1))
 				OffloadBlockToMappedFile(currentBlock);
 	}
+
+	// Wait for the blocks still being written to disk
+	if (projectSettings_.a.stage)
+		WaitForStageIO();
 }
 	
 
@@ -3092,8 +4042,8 @@ void dna_adjust::BackupNormals(const UINT32 block, bool MT_ReverseOrCombine)
 	if (!CombineRequired(block))
 		return;
 
-	matrix_2d* normals(&v_normals_.at(block));
-	matrix_2d* normalsCopy(&v_normalsR_.at(block));
+	symmetric_matrix* normals(&v_normals_.at(block));
+	symmetric_matrix* normalsCopy(&v_normalsR_.at(block));
 
 	if (MT_ReverseOrCombine)
 	{
@@ -3101,8 +4051,7 @@ void dna_adjust::BackupNormals(const UINT32 block, bool MT_ReverseOrCombine)
 		normalsCopy = &v_normalsRC_.at(block);
 	}
 
-	normalsCopy->copyelements(0, 0, normals, 0, 0,
-		normals->rows(), normals->columns());
+	*normalsCopy = *normals;
 }
 	
 
@@ -3139,8 +4088,8 @@ void dna_adjust::CarryStnEstimatesandVariancesCombine(
 	UINT32 pseudoMsrCount(static_cast<UINT32>(v_JSL_.at(nextBlock).size()));			// junctions from forward
 	UINT32 pseudoMsrElemCount(pseudoMsrCount * 3);
 
-	matrix_2d* AtVinv(&v_AtVinv_.at(thisBlock));
-	matrix_2d* normals(&v_normals_.at(thisBlock));
+	rowblock_matrix* AtVinv(&v_AtVinv_.at(thisBlock));
+	symmetric_matrix* normals(&v_normals_.at(thisBlock));
 	matrix_2d* measMinusComp(&v_measMinusComp_.at(thisBlock));
 	matrix_2d* estimatedStations(&v_estimatedStations_.at(thisBlock));
 
@@ -3180,7 +4129,7 @@ void dna_adjust::CarryStnEstimatesandVariancesCombine(
 		++_it_jsl, paramCount+=3)
 	{
 		// get index of this JSL in the next block
-		jsl = v_blockStationsMap_.at(thisBlock)[*_it_jsl] * 3;
+		jsl = BlockStationPosition(thisBlock, *_it_jsl) * 3;
 		jslvar = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl) * 3);
 
 		// add variances for this JSL to normals
@@ -3221,7 +4170,7 @@ void dna_adjust::CarryStnEstimatesandVariancesCombine(
 			
 			// get index of all covariances for this JSL in the next block
 			jslcovar = static_cast<UINT32>(std::distance(v_JSL_.at(nextBlock).begin(), _it_jsl_cov) * 3);
-			jsl_cov1 = v_blockStationsMap_.at(thisBlock)[*_it_jsl_cov] * 3;
+			jsl_cov1 = BlockStationPosition(thisBlock, *_it_jsl_cov) * 3;
 			
 			// add covariances for this JSL to normals
 			normals->blockadd(jsl_cov1, jsl, v_junctionVariancesFwd_.at(nextBlock), jslcovar, jslvar, 3, 3);
@@ -3389,6 +4338,11 @@ void dna_adjust::AdjustPhasedReverseCombine()
 			break;
 
 		SetcurrentBlock(currentBlock);
+
+		// For staged adjustments, read the next block from disk whilst
+		// this block is adjusted
+		if (projectSettings_.a.stage && currentBlock > 0)
+			PrefetchBlock(currentBlock - 1);
 	
 		// If currentBlock is a single block, then there is no need to perform a 
 		// reverse adjustment (i.e. continue);
@@ -3500,6 +4454,10 @@ void dna_adjust::AdjustPhasedReverseCombine()
 			OffloadBlockToMappedFile(currentBlock);
 
 	}	// for (UINT32 block=0; block<blockCount_; ++block, --currentBlock)
+
+	// Wait for the blocks still being written to disk
+	if (projectSettings_.a.stage)
+		WaitForStageIO();
 }
 	
 
@@ -3521,6 +4479,11 @@ void dna_adjust::AdjustPhasedReverse()
 
 		SetcurrentBlock(currentBlock);
 
+		// For staged adjustments, read the next block from disk whilst
+		// this block is adjusted
+		if (projectSettings_.a.stage && currentBlock > 0)
+			PrefetchBlock(currentBlock - 1);
+
 		// If currentBlock is a single block, then there is no need to perform a 
 		// reverse adjustment (i.e. continue);
 		// Otherwise, if currentBlock is the last block, then this is the 
@@ -3580,6 +4543,10 @@ void dna_adjust::AdjustPhasedReverse()
 			OffloadBlockToMappedFile(currentBlock);
 
 	}	// for (UINT32 block=0; block<blockCount_; ++block, --currentBlock)
+
+	// Wait for the blocks still being written to disk
+	if (projectSettings_.a.stage)
+		WaitForStageIO();
 }
 	
 
@@ -3589,7 +4556,7 @@ void dna_adjust::UpdateEstimatesReverse(const UINT32 currentBlock, bool MT_Rever
 {
 	matrix_2d* estimatedStations(&v_estimatedStations_.at(currentBlock));
 	matrix_2d* corrections(&v_corrections_.at(currentBlock));
-	matrix_2d* aposterioriVariances(&v_normals_.at(currentBlock));
+	symmetric_matrix* aposterioriVariances(&v_normals_.at(currentBlock));
 
 	if (MT_ReverseOrCombine)
 	{
@@ -3629,7 +4596,7 @@ void dna_adjust::UpdateEstimatesCombine(const UINT32 currentBlock, UINT32 pseudo
 {
 	matrix_2d* estimatedStations(&v_estimatedStations_.at(currentBlock));
 	matrix_2d* corrections(&v_corrections_.at(currentBlock));
-	matrix_2d* AtVinv(&v_AtVinv_.at(currentBlock));
+	rowblock_matrix* AtVinv(&v_AtVinv_.at(currentBlock));
 	matrix_2d* measMinusComp(&v_measMinusComp_.at(currentBlock));
 
 	if (projectSettings_.a.multi_thread)
@@ -3667,9 +4634,9 @@ void dna_adjust::UpdateEstimatesFinal(const UINT32 currentBlock)
 	
 	matrix_2d* estimatedStations(&v_estimatedStations_.at(currentBlock));
 	matrix_2d* corrections(&v_corrections_.at(currentBlock));
-	matrix_2d* AtVinv(&v_AtVinv_.at(currentBlock));
+	rowblock_matrix* AtVinv(&v_AtVinv_.at(currentBlock));
 	matrix_2d* measMinusComp(&v_measMinusComp_.at(currentBlock));
-	matrix_2d* aposterioriVariances(&v_normals_.at(currentBlock));
+	symmetric_matrix* aposterioriVariances(&v_normals_.at(currentBlock));
 
 	if (projectSettings_.a.multi_thread)
 	{
@@ -3790,6 +4757,20 @@ bool dna_adjust::CarryReverseJunctions(const UINT32 currentBlock, const UINT32 n
 // go through each of the measurements in the binary measurements file and formulate partial derivatives
 void dna_adjust::FillDesignNormalMeasurementsMatrices(bool buildnewMatrices, const UINT32& block, bool MT_ReverseOrCombine)
 {
+	// When updating matrices already built, each measurement writes only
+	// its own rows of the design matrix (and columns of At * V-1), and so
+	// contiguous ranges of measurements can be updated on several threads.
+	// Matrices are built (and debug output printed) on one thread.
+	if (!buildnewMatrices && projectSettings_.g.verbose == 0)
+	{
+		const UINT32 threads(NormalsAssemblyThreads(block));
+		if (threads > 1)
+		{
+			FillDesignMeasurementsMatricesParallel(block, threads, MT_ReverseOrCombine);
+			return;
+		}
+	}
+
 	UINT32 design_row(0);
 	
 	it_vUINT32 _it_block_msr;
@@ -3810,6 +4791,34 @@ void dna_adjust::FillDesignNormalMeasurementsMatrices(bool buildnewMatrices, con
 	}
 }
 
+// Updates the design and measured minus computed matrices of a block on
+// several threads, each of which updates a contiguous range of measurements
+void dna_adjust::FillDesignMeasurementsMatricesParallel(const UINT32& block, const UINT32& threads, bool MT_ReverseOrCombine)
+{
+	IndexDesignRows(block);
+
+	const UINT32 measurements(static_cast<UINT32>(msrDesignRows_.size()));
+
+	assembly_.clear();
+	for (UINT32 t=0; t<threads; ++t)
+	{
+		const UINT32 begin(measurements * t / threads), end(measurements * (t + 1) / threads);
+		
+		assembly_.add_task([this, &block, &MT_ReverseOrCombine, begin, end]() {
+			UINT32 design_row;
+			it_vmsr_t _it_msr;
+			for (UINT32 m=begin; m<end; ++m)
+			{
+				design_row = msrDesignRows_.at(m).second;
+				_it_msr = bmsBinaryRecords_.begin() + v_CML_.at(block).at(msrDesignRows_.at(m).first);
+				UpdateDesignNormalMeasMatrices(&_it_msr, design_row, false, block, MT_ReverseOrCombine);
+			}
+		});
+	}
+
+	assembly_.run(threads);
+}
+
 // Initialise msr pointer if new matrices need to be built
 // If the data has already been reduced, then restore via the
 // pre-adjustment value, otherwise back up the current value.
@@ -3840,10 +4849,10 @@ void dna_adjust::UpdateDesignNormalMeasMatrices(pit_vmsr_t _it_msr, UINT32& desi
 	std::stringstream ss;
 
 	matrix_2d* estimatedStations(&v_estimatedStations_.at(block));
-	matrix_2d* design(&v_design_.at(block));
-	matrix_2d* AtVinv(&v_AtVinv_.at(block));
+	rowblock_matrix* design(&v_design_.at(block));
+	rowblock_matrix* AtVinv(&v_AtVinv_.at(block));
 	matrix_2d* measMinusComp(&v_measMinusComp_.at(block));
-	matrix_2d* normals(&v_normals_.at(block));
+	symmetric_matrix* normals(&v_normals_.at(block));
 
 	if (MT_ReverseOrCombine)
 	{
@@ -4579,14 +5588,14 @@ void dna_adjust::LoadVarianceMatrix_Y(it_vmsr_t _it_msr, matrix_2d* var_cart, co
 }
 	
 
-inline void dna_adjust::AddElementtoDesign(const UINT32& row, const UINT32& col, const double value, matrix_2d* design)
+inline void dna_adjust::AddElementtoDesign(const UINT32& row, const UINT32& col, const double value, rowblock_matrix* design)
 {
 	design->put(row, col, value);
 }
 	
 
 inline void dna_adjust::AddMsrtoDesign(const UINT32& design_row, const UINT32& stn,
-				const double& dmdx, const double& dmdy, const double& dmdz, matrix_2d* design)
+				const double& dmdx, const double& dmdy, const double& dmdz, rowblock_matrix* design)
 {
 		// design matrix elements for dA/dX1, dA/dY1, dA/dZ1 for 1 station
 	AddElementtoDesign(design_row, stn, dmdx, design);
@@ -4597,7 +5606,7 @@ inline void dna_adjust::AddMsrtoDesign(const UINT32& design_row, const UINT32& s
 
 inline void dna_adjust::AddMsrtoDesign_L(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2, 
 				const double dmdx1, const double dmdy1, const double dmdz1, 
-				const double dmdx2, const double dmdy2, const double dmdz2, matrix_2d* design)
+				const double dmdx2, const double dmdy2, const double dmdz2, rowblock_matrix* design)
 {
 	// design matrix dA/dX1, dA/dY1, dA/dZ1
 	AddMsrtoDesign(design_row, stn1, dmdx1, dmdy1, dmdz1, design);	
@@ -4607,7 +5616,7 @@ inline void dna_adjust::AddMsrtoDesign_L(const UINT32& design_row, const UINT32&
 	
 
 inline void dna_adjust::AddMsrtoDesign_BCEKMSVZ(const UINT32& design_row, const UINT32& stn1, const UINT32& stn2, 
-				const double dmdx, const double dmdy, const double dmdz, matrix_2d* design)
+				const double dmdx, const double dmdy, const double dmdz, rowblock_matrix* design)
 {
 	// design matrix dA/dX1, dA/dY1, dA/dZ1
 	AddMsrtoDesign(design_row, stn1, dmdx, dmdy, dmdz, design);	
@@ -4653,7 +5662,7 @@ void dna_adjust::AddMsrtoMeasMinusComp(pit_vmsr_t _it_msr, const UINT32& design_
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_A(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -4802,7 +5811,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_A(pit_vmsr_t _it_msr, UINT32& de
 
 	UpdateAtVinv(_it_msr, stn1, stn2, stn3, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_A(stn1, stn2, stn3, design_row, normals, design, AtVinv);
 	else
@@ -4812,7 +5821,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_A(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_BK(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -4906,7 +5915,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_BK(pit_vmsr_t _it_msr, UINT32& d
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -4916,7 +5925,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_BK(pit_vmsr_t _it_msr, UINT32& d
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_C(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -4935,7 +5944,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_C(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_CEM(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -4971,7 +5980,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_CEM(pit_vmsr_t _it_msr, UINT32&
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -4981,7 +5990,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_CEM(pit_vmsr_t _it_msr, UINT32&
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_D(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	it_vmsr_t _it_msr_first(*_it_msr);
 	UINT32 design_row_begin(design_row);
@@ -5121,9 +6130,9 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_D(pit_vmsr_t _it_msr, UINT32& de
 	// Update AtVinv based on new design matrix elements
 	for (a=0; a<angle_count; ++a)																  // for each angle
 	{
-		stn1 = (v_blockStationsMap_.at(block)[it_angle->station1] * 3); 
-		stn2 = (v_blockStationsMap_.at(block)[it_angle->station2] * 3);
-		stn3 = (v_blockStationsMap_.at(block)[it_angle->station3] * 3);
+		stn1 = (BlockStationPosition(block, it_angle->station1) * 3); 
+		stn2 = (BlockStationPosition(block, it_angle->station2) * 3);
+		stn3 = (BlockStationPosition(block, it_angle->station3) * 3);
 		
 		// Update AtVinv
 		UpdateAtVinv_D(stn1, stn2, stn3, a, angle_count, 
@@ -5134,14 +6143,14 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_D(pit_vmsr_t _it_msr, UINT32& de
 		it_angle++;
 	}
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_D(block, _it_msr_first, design_row_begin, normals, design, AtVinv);
 }
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_E(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -5181,7 +6190,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_E(pit_vmsr_t _it_msr, UINT32& de
 }
 
 void dna_adjust::UpdateDesignMeasMatrices_GX(pit_vmsr_t _it_msr, UINT32& design_row,
-											matrix_2d* measMinusComp, matrix_2d* estimatedStations, matrix_2d* design,
+											matrix_2d* measMinusComp, matrix_2d* estimatedStations, rowblock_matrix* design,
 											const UINT32& stn1, const UINT32& stn2, bool buildnewMatrices)
 {
 	// If this method is called via PrepareAdjustment() and the adjustment 
@@ -5252,7 +6261,7 @@ void dna_adjust::UpdateDesignMeasMatrices_GX(pit_vmsr_t _it_msr, UINT32& design_
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_G(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	it_vmsr_t _it_msr_first(*_it_msr);
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
@@ -5285,10 +6294,10 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_G(pit_vmsr_t _it_msr, UINT32& de
 			return;
 	
 		// Build  At * V-1
-		AtVinv->replace(stn1, design_row_begin, var_cart * -1);
 		AtVinv->replace(stn2, design_row_begin, var_cart);
+		AtVinv->replace(stn1, design_row_begin, var_cart.scale(-1.));
 
-		if (buildnewMatrices && !projectSettings_.a.stage)
+		if (buildnewMatrices && !projectSettings_.a.stage && !SparseNormals())
 			// Add weighted measurement contributions to normal matrix
 			UpdateNormals_G(stn1, stn2, design_row_begin, normals, AtVinv);
 	}
@@ -5299,7 +6308,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_G(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_M(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -5336,7 +6345,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_M(pit_vmsr_t _it_msr, UINT32& de
 // instrument and target).
 void dna_adjust::UpdateDesignNormalMeasMatrices_S(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// preAdjMeas is used to store original measured MSL arc distance
 	if (buildnewMatrices)
@@ -5385,7 +6394,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_S(pit_vmsr_t _it_msr, UINT32& de
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -5403,7 +6412,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_S(pit_vmsr_t _it_msr, UINT32& de
 // instrument and target).
 void dna_adjust::UpdateDesignNormalMeasMatrices_V(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -5493,7 +6502,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_V(pit_vmsr_t _it_msr, UINT32& de
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -5512,7 +6521,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_V(pit_vmsr_t _it_msr, UINT32& de
 // instrument and target).
 void dna_adjust::UpdateDesignNormalMeasMatrices_Z(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -5602,7 +6611,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_Z(pit_vmsr_t _it_msr, UINT32& de
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -5616,7 +6625,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_Z(pit_vmsr_t _it_msr, UINT32& de
 // Hence, run geoid with -f, -s and -n options
 void dna_adjust::UpdateDesignNormalMeasMatrices_L(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	UINT32 stn2(GetBlkMatrixElemStn2(block, _it_msr));
@@ -5676,7 +6685,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_L(pit_vmsr_t _it_msr, UINT32& de
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, stn2, 0, design_row, design, AtVinv, buildnewMatrices);
 
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_BCEKLMSVZ(stn1, stn2, design_row, normals, design, AtVinv);
 	else
@@ -5685,7 +6694,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_L(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_I(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement.  No need to test if no further calculations are 
 	// required (as in stage mode), as this is done later (below)
@@ -5715,7 +6724,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_I(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_J(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement.  No need to test if no further calculations are 
 	// required (as in stage mode), as this is done later (below)
@@ -5746,7 +6755,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_J(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_P(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -5760,53 +6769,35 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_P(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_IP(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	
 	// Due to the lack of an explicit relationship between latitude and cartesian elements,
 	// use mechanical differentiation.
-	double latitude;
-	// partial derivative for x
-	double partialDerivative = PartialD_Latitude_F(
+	double latitude, partialDerivatives[3];
+	PartialD_Latitude_Batch(
 		estimatedStations->get(stn1, 0),		// X1
 		estimatedStations->get(stn1+1, 0),		// Y1
 		estimatedStations->get(stn1+2, 0),		// Z1
-		x_element,								// compute for X
-		&latitude, 
+		&latitude, partialDerivatives,
 		datum_.GetEllipsoidRef());
-	AddElementtoDesign(design_row, stn1, partialDerivative, 
+
+	AddElementtoDesign(design_row, stn1, partialDerivatives[x_element], 
 		design);								// X
 
 	// Update measured minus computed value
 	AddMsrtoMeasMinusComp(_it_msr, design_row, latitude, measMinusComp);
 
-	// partial derivative for Y
-	partialDerivative = PartialD_Latitude(
-		estimatedStations->get(stn1, 0),		// X1
-		estimatedStations->get(stn1+1, 0),		// Y1
-		estimatedStations->get(stn1+2, 0),		// Z1
-		y_element,								// compute for Y
-		latitude, 
-		datum_.GetEllipsoidRef());
-	AddElementtoDesign(design_row, stn1+1, partialDerivative, 
+	AddElementtoDesign(design_row, stn1+1, partialDerivatives[y_element], 
 		design);								// Y
-
-	// partial derivative for Z
-	partialDerivative = PartialD_Latitude(
-		estimatedStations->get(stn1, 0),		// X1
-		estimatedStations->get(stn1+1, 0),		// Y1
-		estimatedStations->get(stn1+2, 0),		// Z1
-		z_element,								// compute for Z
-		latitude, 
-		datum_.GetEllipsoidRef());
-	AddElementtoDesign(design_row, stn1+2, partialDerivative, 
+	AddElementtoDesign(design_row, stn1+2, partialDerivatives[z_element], 
 		design);								// Z
 
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, 0, 0, design_row, design, AtVinv, buildnewMatrices);
 	
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_HIJPQR(stn1, design_row, normals, design, AtVinv);
 	else
@@ -5816,7 +6807,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_IP(pit_vmsr_t _it_msr, UINT32& d
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_Q(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -5830,7 +6821,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_Q(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_JQ(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr)); 
 	
@@ -5858,7 +6849,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_JQ(pit_vmsr_t _it_msr, UINT32& d
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, 0, 0, design_row, design, AtVinv, buildnewMatrices);
 	
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_HIJPQR(stn1, design_row, normals, design, AtVinv);
 	else
@@ -5868,7 +6859,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_JQ(pit_vmsr_t _it_msr, UINT32& d
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_H(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement.  No need to test if no further calculations are 
 	// required (as in stage mode), as this is done later (below)
@@ -5897,7 +6888,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_H(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_HR(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	UINT32 stn1(GetBlkMatrixElemStn1(block, _it_msr));
 
@@ -5931,7 +6922,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_HR(pit_vmsr_t _it_msr, UINT32& d
 	// Update AtVinv based on new design matrix elements
 	UpdateAtVinv(_it_msr, stn1, 0, 0, design_row, design, AtVinv, buildnewMatrices);
 	
-	if (buildnewMatrices)
+	if (buildnewMatrices && !SparseNormals())
 		// Add weighted measurement contributions to normal matrix
 		UpdateNormals_HIJPQR(stn1, design_row, normals, design, AtVinv);
 	else
@@ -5941,7 +6932,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_HR(pit_vmsr_t _it_msr, UINT32& d
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_R(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	// Initialise measurement and test if no further calculations are 
 	// required (as in stage mode)
@@ -5955,7 +6946,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_R(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	it_vmsr_t _it_msr_first(*_it_msr);
 
@@ -6018,7 +7009,6 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& de
 	std::sort(baseline_stations.begin(), baseline_stations.end());
 
 	covc = baseline_count * 3;
-	matrix_2d tmp(3, covc);
 
 	// Build  At * V-1
 	for (cluster_bsl=0; cluster_bsl<baseline_count; ++cluster_bsl)
@@ -6042,20 +7032,12 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& de
 		covr = cluster_bsl * 3;
 		//covc = baseline_count * 3;
 
-		// add variances/covariances for this baseline to At * V-1
-		//AtVinv->blockadd(stn1, design_row_begin, 
-		//	var_cart.submatrix(covr, 
-		//	0, 3, covc).scale(-1.), 0, 0, 3, covc);						// add entire row of this vcv
-		
-		// copy the relevant var_cart elements to temp and multiply 
-		// by -1 to effect the design matrix elements
-		var_cart.submatrix(covr, 0, &tmp, 3, covc);
-		tmp.scale(-1.);
-		// add variances/covariances for this baseline to At * V-1
-		AtVinv->blockadd(stn1, design_row_begin, 
-			tmp, 0, 0, 3, covc);										// add entire row of this vcv		
+		// add variances/covariances for this baseline to At * V-1.
+		// Station 1 is subtracted to effect the design matrix elements (-1)
+		AtVinv->blocksubtract(stn1, design_row_begin, 
+			var_cart.view(covr, 0, 3, covc));							// add entire row of this vcv
 		AtVinv->blockadd(stn2, design_row_begin, 
-			var_cart, covr, 0, 3, covc);								// add entire row of this vcv
+			var_cart.view(covr, 0, 3, covc));							// add entire row of this vcv
 		
 		covariance_count = _it_msr_temp->vectorCount2;
 		_it_msr_temp += 3;			// move to covariances
@@ -6064,7 +7046,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& de
 			_it_msr_temp += 3;
 	}
 
-	if (projectSettings_.a.stage || !buildnewMatrices)
+	if (projectSettings_.a.stage || !buildnewMatrices || SparseNormals())
 		return;
 	
 	_it_msr_temp = _it_msr_first;
@@ -6092,8 +7074,9 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& de
 		// add variances for these stations
 		v_normals_.at(block).blockadd(stn1, stn1,						// Station 1.
 			tmp0, 0, 0, 3, 3);
+		AtVinv->submatrix(stn2, design_row_begin+covr, &tmp0, 3, 3);
 		v_normals_.at(block).blockadd(stn2, stn2,						// Station 2
-			v_AtVinv_.at(block), stn2, design_row_begin+covr, 3, 3);	
+			tmp0, 0, 0, 3, 3);
 
 		covariance_count = _it_msr_temp->vectorCount2;
 		_it_msr_temp += 3;			// move to covariances
@@ -6148,7 +7131,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_X(pit_vmsr_t _it_msr, UINT32& de
 
 void dna_adjust::UpdateDesignNormalMeasMatrices_Y(pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
 											  matrix_2d* measMinusComp, matrix_2d* estimatedStations, 
-											  matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices)
+											  rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices)
 {
 	it_vmsr_t _it_msr_first(*_it_msr);
 	it_vmsr_t tmp_msr;
@@ -6420,7 +7403,7 @@ void dna_adjust::UpdateDesignNormalMeasMatrices_Y(pit_vmsr_t _it_msr, UINT32& de
 		design_row_begin += 3;
 	}
 
-	if (projectSettings_.a.stage || !buildnewMatrices)
+	if (projectSettings_.a.stage || !buildnewMatrices || SparseNormals())
 		return;
 	
 	_it_msr_temp = _it_msr_first;
@@ -6483,12 +7466,23 @@ void dna_adjust::SolveTry(bool COMPUTE_INVERSE, const UINT32& block)
 }
 	
 
-void dna_adjust::Solve(bool COMPUTE_INVERSE, const UINT32& block)
+// Computes the inverse of the normals (dense), or the factor of the normals (sparse)
+void dna_adjust::InvertNormals(const UINT32& block)
 {
-	// debug matrices if required
-	debug_SolutionInformation(block);
-
-	if (COMPUTE_INVERSE)
+	if (IterativeNormals())
+	{
+		// The normals are not formed, and so only the preconditioner
+		// is inverted.  The corrections are solved iteratively (see Solve)
+		InvertIterativePreconditioner();
+	}
+	else if (SparseNormals())
+	{
+		// Compute the sparse Cholesky factor of the normals.  The 
+		// corrections are solved from the factor (see Solve) and the inverse 
+		// is formed only when required (see FormSparseInverse)
+		sparseNormals_.factorise(projectSettings_.a.scale_normals_to_unity);
+	}
+	else
 	{
 		// When non-GPS measurements exist, partial derivatives will vary upon
 		// each iteration due to changes in the latest estimates, and so
@@ -6504,30 +7498,22 @@ void dna_adjust::Solve(bool COMPUTE_INVERSE, const UINT32& block)
 		// the normal matrix before inversion and subsequently reversing the effect.
 		//
 
-		// 1. Create scalar matrix
-		matrix_2d *S = nullptr, *SN = nullptr;
+		// 1. Create scalar (diagonal) matrix
+		std::vector<double> S;
 
 		if (projectSettings_.a.scale_normals_to_unity)
 		{
-			S = new matrix_2d(v_normals_.at(block).rows(), v_normals_.at(block).rows());
-			SN = new matrix_2d(v_normals_.at(block).rows(), v_normals_.at(block).rows());
+			S.resize(v_normals_.at(block).rows());
 			for (UINT32 i(0); i<v_normals_.at(block).rows(); ++i)
-				S->put(i, i, sqrt(v_normals_.at(block).get(i, i)));
+				S.at(i) = 1. / sqrt(v_normals_.at(block).get(i, i));
 			// 2. Scale Normals to reduce the diagonal elements of Normals to unity
-			//SN->multiply(*S, v_normals_.at(block));
-			SN->multiply(*S, "N", v_normals_.at(block), "N");
-			
-			//v_normals_.at(block).multiply(*SN, *S);
-			v_normals_.at(block).multiply(*SN, "N", *S, "N");
+			v_normals_.at(block).diagonalscale(S);
 		}
 		//////////////////
 	
-		// Clear upper triangle to match expected structure for cholesky_inverse
-		v_normals_.at(block).clearupper();
-		
 		// Calculate Inverse of AT * V-1 * A
-		// Explicitly set LOWER_IS_CLEARED to false (data is in lower triangle)
-		FormInverseVarianceMatrix(&(v_normals_.at(block)), false);
+		// (the normals hold the lower triangle only)
+		FormInverseVarianceMatrix(&(v_normals_.at(block)));
 
 		// Check for a failed inverse solution
 		if (boost::math::isnan(v_normals_.at(block).get(0, 0)) || 
@@ -6542,20 +7528,62 @@ void dna_adjust::Solve(bool COMPUTE_INVERSE, const UINT32& block)
 		//////////////////
 		// 2. Compute inverse of N (via S * (SNS)-1 * S)
 		if (projectSettings_.a.scale_normals_to_unity)
-		{
-			//SN->multiply(*S, v_normals_.at(block));
-			SN->multiply(*S, "N", v_normals_.at(block), "N");
-
-			//v_normals_.at(block).multiply(*SN, *S);
-			v_normals_.at(block).multiply(*SN, "N", *S, "N");
-
-			delete S;
-			delete SN;
-		}
+			v_normals_.at(block).diagonalscale(S);
 		//////////////////
 	}
+}
 	
+
+// Computes the inverse of the normals in single precision, and solves the
+// corrections, refined to double precision.  Scaling to unity is implicit.
+// Normals for which refinement does not converge are inverted in double
+// precision.  The inverse itself is not refined, so the precisions of
+// adjusted stations and measurements, and the junction variances carried
+// between blocks of a phased adjustment, hold single precision accuracy.
+void dna_adjust::InvertNormalsMixed(symmetric_matrix* normals, const matrix_2d& At_Vinv_m, 
+	matrix_2d& corrections, const UINT32& block)
+{
+	const bool single(normals->cholesky_inverse_mixed(At_Vinv_m, corrections));
+
 	if (projectSettings_.g.verbose > 0)
+	{
+		std::stringstream ss;
+		ss << "Block " << block + 1 << ": normals inverted in " <<
+			(single ? "single" : "double") << " precision" << std::endl;
+		ThreadSafeWritetoDbgFile(ss.str());
+	}
+
+	// Check for a failed inverse solution
+	if (boost::math::isnan(normals->get(0, 0)) || 
+		boost::math::isinf(normals->get(0, 0)))
+	{
+		std::stringstream ss;
+		ss << "Solve(): Invalid variance matrix:" << std::endl;
+		ss << std::setprecision(6) << std::fixed << *normals;
+		SignalExceptionAdjustment(ss.str(), block);
+	}
+}
+	
+
+void dna_adjust::Solve(bool COMPUTE_INVERSE, const UINT32& block)
+{
+	// debug matrices if required
+	debug_SolutionInformation(block);
+
+	// compute weighted "measured minus computed"
+	matrix_2d At_Vinv_m(v_design_.at(block).columns(), 1);
+	v_AtVinv_.at(block).multiply(v_measMinusComp_.at(block), At_Vinv_m);
+	v_corrections_.at(block).redim(v_design_.at(block).columns(), 1);
+
+	// The mixed precision inverse solves the corrections as well
+	const bool mixed(COMPUTE_INVERSE && MixedPrecisionNormals());
+
+	if (mixed)
+		InvertNormalsMixed(&v_normals_.at(block), At_Vinv_m, v_corrections_.at(block), block);
+	else if (COMPUTE_INVERSE)
+		InvertNormals(block);
+	
+	if (projectSettings_.g.verbose > 0 && !SparseNormals())
 	{
 		debug_file << "Block " << block + 1;
 		if (projectSettings_.a.adjust_mode != SimultaneousMode)
@@ -6564,13 +7592,17 @@ void dna_adjust::Solve(bool COMPUTE_INVERSE, const UINT32& block)
 		debug_file << "Precisions " << std::fixed << std::setprecision(16) << v_normals_.at(block) << std::endl;
 	}
 	
-	// compute weighted "measured minus computed"
-	matrix_2d At_Vinv_m(v_design_.at(block).columns(), 1);
-	At_Vinv_m.multiply(v_AtVinv_.at(block), "N", v_measMinusComp_.at(block), "N");
-	
 	// Solve corrections from normal equations
-	v_corrections_.at(block).redim(v_design_.at(block).columns(), 1);
-	v_corrections_.at(block).multiply(v_normals_.at(block), "N", At_Vinv_m, "N");
+	if (!mixed)
+	{
+		if (IterativeNormals())
+			SolveIterativeNormals(block, At_Vinv_m, v_corrections_.at(block), 
+				projectSettings_.a.iteration_threshold * ITERATIVE_THRESHOLD_FRACTION);
+		else if (SparseNormals())
+			sparseNormals_.solve(At_Vinv_m, v_corrections_.at(block));
+		else
+			v_normals_.at(block).multiply(At_Vinv_m, v_corrections_.at(block));
+	}
 
 	if (projectSettings_.g.verbose > 0)
 	{
@@ -6666,10 +7698,6 @@ void dna_adjust::DeSerialiseAdjustedVarianceMatrices()
 		DeserialiseBlockFromMappedFile(block, 2,
 			sf_rigorous_vars, sf_prec_adj_msrs);
 	}
-
-	// Close rigorous variances stream
-	f_rigorousVariances_.close();
-	f_precAdjMsrs_.close();
 }
 	
 
@@ -6695,13 +7723,12 @@ void dna_adjust::SerialiseAdjustedVarianceMatrices()
 		SetRegionOffsets(block, 2, sf_rigorous_vars, sf_prec_adj_msrs);
 
 		// Write to disk (the memory mapped file)
-		f_rigorousVariances_ << v_rigorousVariances_.at(block);			// ...rva.mtx
-		f_precAdjMsrs_ << v_precAdjMsrsFull_.at(block);					// ...pam.mtx
+		RigorousVariances(block).write(f_stage_);			// Rigorous variances
+		f_stage_ << v_precAdjMsrsFull_.at(block);			// Precision adjusted measurements
 	}
 
-	// Close rigorous variances stream
-	f_rigorousVariances_.close();
-	f_precAdjMsrs_.close();
+	// Write the index and close the stage file
+	CloseStageFileStreams();
 }
 	
 
@@ -6727,6 +7754,10 @@ void dna_adjust::GenerateStatistics()
 			printer_->PrintStatistics();
 			break;
 		}
+
+		// Print the outliers eliminated before this adjustment
+		if (!v_eliminatedMsrs_.empty())
+			printer_->PrintEliminatedMeasurements();
 	}
 	catch (const std::out_of_range& e) {
 		std::cerr << "ERROR in GenerateStatistics: out_of_range exception - " << e.what() << std::endl;
@@ -7261,7 +8292,7 @@ void dna_adjust::OutputLargestCorrection(std::string& formatted_msg)
 
 	// which station?
 	stnIndex = (UINT32)floor(v_corrections_.at(blockLargeCorr_).maxvalueRow() / 3.);
-	stnIndex = v_parameterStationList_.at(blockLargeCorr_).at(stnIndex);
+	stnIndex = BlockStationAtPosition(blockLargeCorr_, stnIndex);
 	x_coordElement = (UINT32)(v_corrections_.at(blockLargeCorr_).maxvalueRow() % 3);
 
 	switch (projectSettings_.a.adjust_mode)
@@ -7356,7 +8387,8 @@ void dna_adjust::ComputePrecisionAdjMsrs(const UINT32& block /*= 0*/)
 	it_vUINT32 _it_block_msr;
 	it_vmsr_t _it_msr;
 
-	matrix_2d *design(&v_design_.at(block)), *aposterioriVariances(&v_normals_.at(block));
+	rowblock_matrix* design(&v_design_.at(block));
+	const variance_matrix aposterioriVariances(AposterioriVariances(block));
 
 	// Measurements can only ever appear once in the whole CML.  That is, no one measurement will be found
 	// in two or more blocks.  Therefore, unlike precisions of adjusted stations (which may appear in one
@@ -7433,35 +8465,13 @@ void dna_adjust::ComputePrecisionAdjMsrs(const UINT32& block /*= 0*/)
 	
 
 void dna_adjust::ComputePrecisionAdjMsrs_A(const UINT32& block, const UINT32& stn1, const UINT32& stn2, const UINT32& stn3, 
-											  matrix_2d* design, matrix_2d* aposterioriVariances, 
+											  rowblock_matrix* design, const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	// Horizontal angle
-	double part_1[9] = {0.,0.,0.,0.,0.,0.,0.,0.,0.};
-	UINT32 stations[3] = {stn1, stn2, stn3};
-	UINT32 station_count(3);
-	UINT32 station_i[3] = {0, 3, 6};
-	UINT32 var, elem(0);
-	UINT32 j, i, s;
-
-	for (s=0; s<station_count; ++s)	// for every station
-	{
-		for (i=0; i<3; ++i)		// X, Y, Z
-		{
-			for (j=0; j<station_count; ++j)			// for every correlated station
-			{	
-				var = stations[j];
-				part_1[elem] += design->get(design_row, var) * aposterioriVariances->get(var, stations[s]+i);
-				part_1[elem] += design->get(design_row, var+1) * aposterioriVariances->get(var+1, stations[s]+i);
-				part_1[elem] += design->get(design_row, var+2) * aposterioriVariances->get(var+2, stations[s]+i);
-			}
-			elem++;
-		}		
-	}
-
-	for (s=0; s<station_count; ++s)		// for every station
-		for (i=0; i<3; ++i)				// X, Y, Z
-			v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, part_1[station_i[s]+i] * design->get(design_row, stations[s]+i));
+	const UINT32 stations[3] = {stn1, stn2, stn3};
+	v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, 
+		msr_precision(stations, design_row, design, aposterioriVariances));
 	
 	design_row++;
 	precadjmsr_row++;
@@ -7469,7 +8479,7 @@ void dna_adjust::ComputePrecisionAdjMsrs_A(const UINT32& block, const UINT32& st
 	
 
 void dna_adjust::ComputePrecisionAdjMsrs_D(const UINT32& block, it_vmsr_t& _it_msr, 
-											  matrix_2d* design, matrix_2d* aposterioriVariances, 
+											  rowblock_matrix* design, const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	UINT32 stn1, stn2, stn3;
@@ -7505,35 +8515,13 @@ void dna_adjust::ComputePrecisionAdjMsrs_D(const UINT32& block, it_vmsr_t& _it_m
 	
 
 void dna_adjust::ComputePrecisionAdjMsrs_BCEKLMSVZ(const UINT32& block, const UINT32& stn1, const UINT32& stn2, 
-											  matrix_2d* design, matrix_2d* aposterioriVariances, 
+											  rowblock_matrix* design, const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	// Two station measurement
-	double part_1[6] = {0.,0.,0.,0.,0.,0.};
-	UINT32 stations[2] = {stn1, stn2};
-	UINT32 station_count(2);
-	UINT32 station_i[2] = {0, 3};
-	UINT32 var, elem(0);
-	UINT32 j, i, s;
-
-	for (s=0; s<station_count; ++s)		// for every station
-	{
-		for (i=0; i<3; ++i)				// X, Y, Z
-		{
-			for (j=0; j<station_count; ++j)			// for every correlated station
-			{	
-				var = stations[j];
-				part_1[elem] += design->get(design_row, var) * aposterioriVariances->get(var, stations[s]+i);
-				part_1[elem] += design->get(design_row, var+1) * aposterioriVariances->get(var+1, stations[s]+i);
-				part_1[elem] += design->get(design_row, var+2) * aposterioriVariances->get(var+2, stations[s]+i);
-			}
-			elem++;
-		}		
-	}
-
-	for (s=0; s<station_count; ++s)	// for every station
-		for (i=0; i<3; ++i)		// X, Y, Z
-			v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, part_1[station_i[s]+i] * design->get(design_row, stations[s]+i));
+	const UINT32 stations[2] = {stn1, stn2};
+	v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, 
+		msr_precision(stations, design_row, design, aposterioriVariances));
 	
 	design_row++;
 	precadjmsr_row++;
@@ -7541,23 +8529,13 @@ void dna_adjust::ComputePrecisionAdjMsrs_BCEKLMSVZ(const UINT32& block, const UI
 	
 
 void dna_adjust::ComputePrecisionAdjMsrs_HIJPQR(const UINT32& block, const UINT32& stn1, 
-											  matrix_2d* design, matrix_2d* aposterioriVariances, 
+											  rowblock_matrix* design, const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	// Single station measurement
-	double part_1[3] = {0.,0.,0.};
-	UINT32 i, elem;
-
-	for (elem=0,i=0; i<3; ++i)		// X, Y, Z
-	{	
-		part_1[elem] += design->get(design_row, stn1) * aposterioriVariances->get(stn1, stn1+i);
-		part_1[elem] += design->get(design_row, stn1+1) * aposterioriVariances->get(stn1+1, stn1+i);
-		part_1[elem] += design->get(design_row, stn1+2) * aposterioriVariances->get(stn1+2, stn1+i);
-		elem++;
-	}
-
-	for (i=0; i<3; ++i)				// X, Y, Z
-		v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, part_1[i] * design->get(design_row, stn1+i));
+	const UINT32 stations[1] = {stn1};
+	v_precAdjMsrsFull_.at(block).elementadd(precadjmsr_row, 0, 
+		msr_precision(stations, design_row, design, aposterioriVariances));
 	
 	design_row++;
 	precadjmsr_row++;
@@ -7565,7 +8543,7 @@ void dna_adjust::ComputePrecisionAdjMsrs_HIJPQR(const UINT32& block, const UINT3
 		
 
 void dna_adjust::ComputePrecisionAdjMsrs_GX(const UINT32& block, it_vmsr_t& _it_msr, 
-											  matrix_2d* aposterioriVariances, 
+											  const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	UINT32 cluster_bsl, baseline_count(_it_msr->vectorCount1);
@@ -7579,7 +8557,7 @@ void dna_adjust::ComputePrecisionAdjMsrs_GX(const UINT32& block, it_vmsr_t& _it_
 		stn1 = GetBlkMatrixElemStn1(block, &_it_msr);
 		stn2 = GetBlkMatrixElemStn2(block, &_it_msr);
 
-		Precision_Adjusted_GNSS_bsl<double>(*aposterioriVariances,
+		Precision_Adjusted_GNSS_bsl<double>(aposterioriVariances,
 			stn1, stn2, &precision_bsl, false);
 
 		for (i=0; i<3; ++i)
@@ -7593,7 +8571,7 @@ void dna_adjust::ComputePrecisionAdjMsrs_GX(const UINT32& block, it_vmsr_t& _it_
 	
 
 void dna_adjust::ComputePrecisionAdjMsrs_Y(const UINT32& block, it_vmsr_t& _it_msr, 
-											  matrix_2d* aposterioriVariances, 
+											  const variance_matrix& aposterioriVariances, 
 											  UINT32& design_row, UINT32& precadjmsr_row)
 {
 	UINT32 cluster_pnt, point_count(_it_msr->vectorCount1);
@@ -7608,7 +8586,7 @@ void dna_adjust::ComputePrecisionAdjMsrs_Y(const UINT32& block, it_vmsr_t& _it_m
 			for (j=i; j<3; ++j, ++precadjmsr_row)
 			{
 				v_precAdjMsrsFull_.at(block).put(precadjmsr_row, 0, 
-					aposterioriVariances->get(stn1+i, stn1+j));
+					aposterioriVariances.get(stn1+i, stn1+j));
 			}
 		}
 		
@@ -8076,13 +9054,34 @@ void dna_adjust::FormInverseVarianceMatrix(matrix_2d* vmat, bool LOWER_IS_CLEARE
 }
 	
 
+void dna_adjust::FormInverseVarianceMatrix(symmetric_matrix* vmat)
+{
+	if (vmat->rows() == 1)
+	{
+		vmat->put(0, 0, 1./vmat->get(0, 0));
+		return;
+	}
+
+	// Inversion of the packed lower triangle (see above)
+	vmat->cholesky_inverse();
+}
+	
+
 void dna_adjust::FormInverseGPSVarianceMatrix(const it_vmsr_t& _it_msr, matrix_2d* vmat)
 {
+	// Has the inverse been formed already?
+	UINT32 slot;
+	if (FindGnssInverse(_it_msr, vmat, slot))
+		return;
+
 	// 1. Get upper triangular a-priori measurements variance matrix
 	GetGPSVarianceMatrix<it_vmsr_t>(_it_msr, vmat);
 
 	// 2. Inverse
 	FormInverseVarianceMatrix(vmat, true);
+
+	// 3. Retain the inverse for the next iteration, block or thread
+	RetainGnssInverse(slot, *vmat);
 }
 	
 
@@ -8121,7 +9120,6 @@ void dna_adjust::ComputeChiSquare_XY(const it_vmsr_t& _it_msr, UINT32& measureme
 	// 2. Form residuals matrix
 	matrix_2d r(measMinusComp->submatrix(measurement_index, 0, variance_dim, 1));
 	
-	matrix_2d rt(r.transpose());
 	matrix_2d rt_Vinv(1, variance_dim);
 	matrix_2d rt_Vinv_r(1, 1);
 	
@@ -8253,7 +9251,7 @@ void dna_adjust::PrintCorStations(std::ostream &cor_file, const UINT32& block)
 	for (i=0; i<v_blockStationsMap_.at(block).size(); ++i)
 	{
 		stn = v_blockStations.at(i);
-		mat_idx = v_blockStationsMap_.at(block)[stn] * 3;
+		mat_idx = BlockStationPosition(block, stn) * 3;
 
 		printer_->PrintCorStation(cor_file, block, stn, mat_idx, 
 			&estimates->at(block));
@@ -8269,40 +9267,61 @@ void dna_adjust::PrintCorStations(std::ostream &cor_file, const UINT32& block)
 
 void dna_adjust::UpdateGeographicCoordsPhased(const UINT32& block, matrix_2d* estimatedStations)
 {
-	UINT32 i(0), j(0);
-	vUINT32 v_blockStations(v_parameterStationList_.at(block));
+	UINT32 j(0);
+	const vUINT32& v_blockStations(v_parameterStationList_.at(block));
 	it_vstn_appear _it_appear(v_paramStnAppearance_.at(block).begin());
 
-	for (j=0, i=0; i<estimatedStations->rows(); j++, i+=3, ++_it_appear)
-	{
-		// The same station may appear in several blocks.  So, only
-		// update (once) when this is the first time this station 
-		// appears
-		if (!_it_appear->first_appearance_fwd)
-			continue;
+	// The same station may appear in several blocks.  So, only
+	// update (once) when this is the first time this station 
+	// appears
+	vUINT32 stations;
+	stations.reserve(v_blockStations.size());
 
-		CartToGeo<double>(estimatedStations->get(i, 0), estimatedStations->get(i+1, 0), estimatedStations->get(i+2, 0),
-			&(bstBinaryRecords_.at(v_blockStations.at(j)).currentLatitude), 
-			&(bstBinaryRecords_.at(v_blockStations.at(j)).currentLongitude), 
-			&(bstBinaryRecords_.at(v_blockStations.at(j)).currentHeight), 
-			datum_.GetEllipsoidRef());
-	}
+	for (j=0; j<v_blockStations.size(); j++, ++_it_appear)
+		if (_it_appear->first_appearance_fwd)
+			stations.push_back(v_blockStations.at(j));
+
+	UpdateGeographicCoords(block, stations, estimatedStations);
 }
 	
 
 void dna_adjust::UpdateGeographicCoords()
 {
-	it_vUINT32 _it_stn;
-	UINT32 stn(0);
-	
 	// all stations in simultaneous mode are kept in ISL
-	for (_it_stn=v_ISL_.at(0).begin(); _it_stn!=v_ISL_.at(0).end(); ++_it_stn, stn+=3)
+	UpdateGeographicCoords(0, v_ISL_.at(0), &v_estimatedStations_.at(0));
+}
+
+
+// Converts the estimated cartesian coordinates of the block stations to 
+// geographic coordinates, in batches (on the stack) of GEODESY_BATCH_SIZE
+void dna_adjust::UpdateGeographicCoords(const UINT32& block, const vUINT32& stations, matrix_2d* estimatedStations)
+{
+	double x[GEODESY_BATCH_SIZE], y[GEODESY_BATCH_SIZE], z[GEODESY_BATCH_SIZE];
+	std::size_t first, count, s;
+	UINT32 i;
+
+	for (first=0; first<stations.size(); first+=count)
 	{
-		CartToGeo<double>(v_estimatedStations_.at(0).get(stn, 0), v_estimatedStations_.at(0).get(stn+1, 0), v_estimatedStations_.at(0).get(stn+2, 0),
-			&(bstBinaryRecords_.at(*_it_stn).currentLatitude), 
-			&(bstBinaryRecords_.at(*_it_stn).currentLongitude), 
-			&(bstBinaryRecords_.at(*_it_stn).currentHeight), 
-			datum_.GetEllipsoidRef());
+		count = std::min(stations.size() - first, GEODESY_BATCH_SIZE);
+
+		for (s=0; s<count; ++s)
+		{
+			// position of this station in the station matrices
+			i = BlockStationPosition(block, stations.at(first + s)) * 3;
+
+			x[s] = estimatedStations->get(i, 0);
+			y[s] = estimatedStations->get(i+1, 0);
+			z[s] = estimatedStations->get(i+2, 0);
+		}
+
+		CartToGeo_Batch<double>(x, y, z, x, y, z, count, datum_.GetEllipsoidRef());
+
+		for (s=0; s<count; ++s)
+		{
+			bstBinaryRecords_.at(stations.at(first + s)).currentLatitude = x[s];
+			bstBinaryRecords_.at(stations.at(first + s)).currentLongitude = y[s];
+			bstBinaryRecords_.at(stations.at(first + s)).currentHeight = z[s];
+		}
 	}
 }
 
@@ -9669,6 +10688,13 @@ void dna_adjust::LoadNetworkFiles()
     
     try {
         NetworkDataLoader loader(projectSettings_);
+
+        // Measurements eliminated as outliers are ignored by the re-adjustment
+        vUINT32 eliminatedRecords;
+        for (const auto& msr : v_eliminatedMsrs_)
+            for (UINT32 r(msr._record); r < msr._record + msr._records; ++r)
+                eliminatedRecords.push_back(r);
+        loader.SetIgnoredRecords(eliminatedRecords);
         
         UINT32 measurementVarianceCount = 0;
         
@@ -9920,6 +10946,9 @@ void dna_adjust::ResizeMatrixVectors()
 		v_passFail_.resize(blockCount_);
 
 		v_correctionsR_.resize(blockCount_);
+
+		v_blockResidentFiles_.assign(blockCount_, 0);
+		v_blockRetainedFiles_.assign(blockCount_, 0);
 		break;
 	default:
 		// thrown in LoadNetworkFiles()
@@ -9943,22 +10972,10 @@ void dna_adjust::ResizeMatrixVectors()
 	if (projectSettings_.a.multi_thread)
 		v_normalsRC_.resize(blockCount_);
 
+	// compressed row-block matrices.  At * V-1 is held by
+	// (measurement) column
 	for (UINT32 block(0); block<blockCount_; ++block)
-	{
-		// sparse matrix
-		v_design_.at(block).matrixType(mtx_sparse);
-
-		// lower triangular
-		v_normals_.at(block).matrixType(mtx_lower);
-		v_normalsR_.at(block).matrixType(mtx_lower);
-		v_rigorousVariances_.at(block).matrixType(mtx_lower);
-
-		if (projectSettings_.a.adjust_mode == PhasedMode)
-		{
-			v_junctionVariances_.at(block).matrixType(mtx_lower);
-			v_junctionVariancesFwd_.at(block).matrixType(mtx_lower);
-		}
-	}
+		v_AtVinv_.at(block).storage(blk_columns);
 	
 }
 	
@@ -10223,6 +11240,147 @@ void dna_adjust::LoadSegmentationFile()
 }
 	
 
+// Permutes the position of each station in the normals (i.e. the values
+// of v_blockStationsMap_) using a fill-reducing ordering of the block's
+// station graph.  v_parameterStationList_ is left in station id order, so
+// all output remains in the original order.
+void dna_adjust::OrderBlockStations()
+{
+	UINT32 block, stn, stationCount;
+	it_vUINT32 _it_block_msr, _it_stn, _it_adj;
+	it_vmsr_t _it_msr;
+	it_uint32_uint32_map _it_map;
+	vUINT32 msrStations, order, position;
+	
+	for (block=0; block<blockCount_; ++block)
+	{
+		uint32_uint32_map& blockStationsMap(v_blockStationsMap_.at(block));
+		stationCount = static_cast<UINT32>(blockStationsMap.size());
+
+		if (stationCount < 3)
+			continue;
+
+		// Form the station graph, in which two stations are 
+		// adjacent if they are connected by a measurement
+		vvUINT32 adjacency(stationCount);
+		for (_it_block_msr=v_CML_.at(block).begin(); _it_block_msr!=v_CML_.at(block).end(); ++_it_block_msr)
+		{
+			if (InitialiseandValidateMsrPointer(_it_block_msr, _it_msr))
+				continue;
+
+			GetMsrStations(bmsBinaryRecords_, *_it_block_msr, msrStations);
+
+			// Get the positions of the stations in this block
+			position.clear();
+			for (_it_stn=msrStations.begin(); _it_stn!=msrStations.end(); ++_it_stn)
+				if ((_it_map = blockStationsMap.find(*_it_stn)) != blockStationsMap.end())
+					position.push_back(_it_map->second);
+
+			for (_it_stn=position.begin(); _it_stn!=position.end(); ++_it_stn)
+				for (_it_adj=position.begin(); _it_adj!=position.end(); ++_it_adj)
+					if (*_it_stn != *_it_adj)
+						adjacency.at(*_it_stn).push_back(*_it_adj);
+		}
+
+		for (auto& adj : adjacency)
+			strip_duplicates(adj);
+
+		switch (projectSettings_.a.station_ordering)
+		{
+		case Ordering_rcm:
+			ReverseCuthillMcKee(adjacency, order);
+			break;
+		case Ordering_mindegree:
+		default:
+			MinimumDegree(adjacency, order);
+			break;
+		}
+
+		if (projectSettings_.g.verbose > 1)
+		{
+			position.resize(stationCount);
+			initialiseIncrementingIntegerVector<UINT32>(position, stationCount);
+
+			if (blockCount_ > 1)
+				debug_file << "Block " << block + 1 << " station ordering:" << std::endl;
+			else
+				debug_file << "Station ordering:" << std::endl;
+			debug_file << "  Bandwidth (stations): " << OrderingBandwidth(adjacency, position) <<
+				" -> " << OrderingBandwidth(adjacency, order) << std::endl;
+			debug_file << "  Factor blocks (3x3):  " << OrderingFactorBlocks(adjacency, position) <<
+				" -> " << OrderingFactorBlocks(adjacency, order) << std::endl;
+		}
+
+		// order holds the current position of the station to be placed at
+		// each new position. Invert to get the new position of each station.
+		position.resize(stationCount);
+		for (stn=0; stn<stationCount; ++stn)
+			position.at(order.at(stn)) = stn;
+
+		for (_it_map=blockStationsMap.begin(); _it_map!=blockStationsMap.end(); ++_it_map)
+			_it_map->second = position.at(_it_map->second);
+	}
+}
+	
+
+// Forms a dense index of the position of each station in the normals of
+// each block in which it appears, held in station order, so that the
+// position of a station can be found without searching the map of each
+// block.  The index must be re-formed if v_blockStationsMap_ changes.
+void dna_adjust::FormBlockStationIndex()
+{
+	cpu_timer time;
+
+	const UINT32 stationCount(static_cast<UINT32>(bstBinaryRecords_.size()));
+	UINT32 block;
+	it_uint32_uint32_map _it_map;
+
+	// Count the blocks in which each station appears
+	v_blockStationIndexStart_.assign(stationCount + 1, 0);
+	for (block=0; block<blockCount_; ++block)
+		for (_it_map=v_blockStationsMap_.at(block).begin(); _it_map!=v_blockStationsMap_.at(block).end(); ++_it_map)
+			++v_blockStationIndexStart_.at(_it_map->first + 1);
+
+	for (UINT32 stn(0); stn<stationCount; ++stn)
+		v_blockStationIndexStart_.at(stn + 1) += v_blockStationIndexStart_.at(stn);
+
+	// Record the block and position of each appearance, in block order
+	vUINT32 next(v_blockStationIndexStart_.begin(), v_blockStationIndexStart_.end() - 1);
+	v_blockStationIndex_.resize(v_blockStationIndexStart_.back());
+	for (block=0; block<blockCount_; ++block)
+		for (_it_map=v_blockStationsMap_.at(block).begin(); _it_map!=v_blockStationsMap_.at(block).end(); ++_it_map)
+			v_blockStationIndex_.at(next.at(_it_map->first)++) = uint32_uint32_pair(block, _it_map->second);
+
+	if (projectSettings_.g.verbose > 0)
+		debug_file << "Block station index: " << v_blockStationIndex_.size() << " entries (" <<
+			std::fixed << std::setprecision(1) <<
+			(v_blockStationIndexStart_.capacity() * sizeof(UINT32) + 
+				v_blockStationIndex_.capacity() * sizeof(uint32_uint32_pair)) / 1048576.0 << " MB), formed in " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(time.elapsed().wall).count() << " us" << std::endl;
+}
+
+
+UINT32 dna_adjust::BlockStationNotFound(const UINT32& block, const UINT32& station) const
+{
+	std::stringstream ss;
+	ss << "BlockStationPosition(): Station " << bstBinaryRecords_.at(station).stationName << 
+		" is not a parameter of block " << block + 1 << ".";
+	throw std::runtime_error(ss.str());
+}
+	
+
+// Returns the station at the given position in the normals of a block
+UINT32 dna_adjust::BlockStationAtPosition(const UINT32& block, const UINT32& position)
+{
+	it_uint32_uint32_map _it_map;
+	for (_it_map=v_blockStationsMap_.at(block).begin(); _it_map!=v_blockStationsMap_.at(block).end(); ++_it_map)
+		if (_it_map->second == position)
+			return _it_map->first;
+
+	return v_parameterStationList_.at(block).at(position);
+}
+	
+
 void dna_adjust::RemoveDuplicateStations(vUINT32& vStations)
 {
 	if (vStations.size() < 2)
@@ -29,6 +29,8 @@
 #endif
 
 /// \cond
+#include <algorithm>
+#include <bitset>
 #include <cstdarg>
 #include <exception>
 #include <fstream>
@@ -80,6 +82,12 @@
 #include <include/functions/dnatimer.hpp>
 
 #include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_rowblock.hpp>
+#include <include/math/dnamatrix_sparse.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
+#include <include/math/dnamatrix_variance.hpp>
+#include <include/math/dnaordering.hpp>
+#include <include/memory/dnabuffer_arena.hpp>
 #include <include/memory/dnafile_mapping.hpp>
 #include <include/parameters/dnadatum.hpp>
 #include <include/parameters/dnaepsg.hpp>
@@ -107,100 +115,171 @@ using dynadjust::cpu_timer;
 class dna_adjust;
 class DynAdjustPrinter;
 
-class adjust_prepare_thread {
-  public:
-    adjust_prepare_thread(dna_adjust* dnaAdj, std::exception_ptr& error)
-        : main_adj_(dnaAdj), error_(error) {}
-    void operator()();
-
-  private:
-    dna_adjust* main_adj_;
-    std::exception_ptr& error_;
+// A node in the elimination tree of a tree-structured phased adjustment.
+// A leaf holds one block, and any other node holds the range of blocks
+// of its two children.  Corrections and variances are held for the interior
+// stations followed by the junction stations.
+struct phasedTreeNode_t {
+    phasedTreeNode_t()
+        : _firstBlock(0), _lastBlock(0), _parent(UINT_MAX), _left(UINT_MAX), _right(UINT_MAX) {}
+
+    inline bool isLeaf() const { return _left == UINT_MAX; }
+    inline bool isRoot() const { return _parent == UINT_MAX; }
+    inline UINT32 interiorCount() const { return static_cast<UINT32>(_interior.size() * 3); }
+    inline UINT32 junctionCount() const { return static_cast<UINT32>(_junctions.size() * 3); }
+
+    // Returns the row of the x element of stn in _corrections and _variances
+    UINT32 position(const UINT32& stn) const {
+        auto it = std::lower_bound(_interior.begin(), _interior.end(), stn);
+        if (it != _interior.end() && *it == stn)
+            return static_cast<UINT32>(std::distance(_interior.begin(), it)) * 3;
+        it = std::lower_bound(_junctions.begin(), _junctions.end(), stn);
+        return interiorCount() + static_cast<UINT32>(std::distance(_junctions.begin(), it)) * 3;
+    }
 
-    // Prevent assignment operator
-    adjust_prepare_thread& operator=(const adjust_prepare_thread& rhs);
+    UINT32 _firstBlock;          // First block in the range
+    UINT32 _lastBlock;           // Last block in the range
+    UINT32 _parent;              // Parent node (UINT_MAX for the root)
+    UINT32 _left;                // Child nodes (UINT_MAX for a leaf)
+    UINT32 _right;
+    vUINT32 _interior;           // Stations eliminated at this node (sorted)
+    vUINT32 _junctions;          // Stations shared with blocks outside the range (sorted)
+    matrix_2d _inverse;          // Inverse of the normals of the interior stations
+    matrix_2d _gain;             // _inverse * normals(interior, junctions)
+    matrix_2d _interiorCorr;     // _inverse * At*V-1*m(interior)
+    matrix_2d _reduced;          // Normals of the junction stations, interior eliminated
+    matrix_2d _reducedWeighted;  // At*V-1*m of the junction stations, interior eliminated
+    matrix_2d _corrections;      // Corrections to the interior and junction stations
+    matrix_2d _variances;        // Variance matrix of the interior and junction stations
 };
 
-class adjust_process_prepare_thread {
-  public:
-    adjust_process_prepare_thread(dna_adjust* dnaAdj, const UINT32& id,
-                                  std::exception_ptr& error,
-                                  std::vector<std::exception_ptr>& prep_errors)
-        : main_adj_(dnaAdj), thread_id_(id), error_(error),
-          prep_errors_(prep_errors) {}
-    void operator()();
+// Header of the stage file, which holds the staged matrices of all blocks.
+// The matrices of each block are stored together in the order of
+// STAGE_FILE, and are followed by an index of the offset and size of 
+// every matrix.  The header is written last, so that a file which was
+// not completed is not mistaken for a valid one.
+const UINT32 STAGE_FILE_VERSION(1);
+
+struct stageFileHeader_t {
+    stageFileHeader_t()
+        : _version(0), _blockCount(0), _matrices(0), _reserved(0), _fingerprint(0), _indexOffset(0) {
+        memset(_magic, 0, sizeof(_magic));
+        memset(_padding, 0, sizeof(_padding));
+    }
 
-  private:
-    dna_adjust* main_adj_;
-    UINT32 thread_id_;
-    std::exception_ptr& error_;
-    std::vector<std::exception_ptr>& prep_errors_;
-
-    // Prevent assignment operator
-    adjust_process_prepare_thread&
-    operator=(const adjust_process_prepare_thread& rhs);
+    char _magic[8];              // "DNASTAGE"
+    UINT32 _version;             // STAGE_FILE_VERSION of the writer
+    UINT32 _blockCount;          // Number of blocks
+    UINT32 _matrices;            // Bit (1 << STAGE_FILE) set for each matrix in the file
+    UINT32 _reserved;
+    std::uint64_t _fingerprint;  // Hash of the segmented network from which the file was created
+    std::uint64_t _indexOffset;  // Offset of the index
+    char _padding[24];
 };
 
-class adjust_forward_thread {
-  public:
-    adjust_forward_thread(dna_adjust* dnaAdj, std::exception_ptr& error)
-        : main_adj_(dnaAdj), error_(error) {}
-    void operator()();
-
-  private:
-    dna_adjust* main_adj_;
-    std::exception_ptr& error_;
+const UINT32 CHECKPOINT_FILE_VERSION(1);
+
+// Header of the checkpoint file, which records the estimates on completion
+// of an iteration so that an adjustment may be resumed.  The header is 
+// followed by the coordinates of each station, and then the estimated,
+// original and (for phased adjustments) rigorous station estimates of 
+// each block.
+struct checkpointHeader_t {
+    checkpointHeader_t()
+        : _version(0), _adjustMode(0), _blockCount(0), _iteration(0), _stationCount(0), _fingerprint(0), _maxCorrection(0.) {
+        memset(_magic, 0, sizeof(_magic));
+        memset(_padding, 0, sizeof(_padding));
+    }
 
-    // Prevent assignment operator
-    adjust_forward_thread& operator=(const adjust_forward_thread& rhs);
+    char _magic[8];              // "DNACHKPT"
+    UINT32 _version;             // CHECKPOINT_FILE_VERSION of the writer
+    UINT32 _adjustMode;          // Simultaneous or phased
+    UINT32 _blockCount;          // Number of blocks
+    UINT32 _iteration;           // Number of iterations completed
+    std::uint64_t _stationCount; // Number of stations
+    std::uint64_t _fingerprint;  // Hash of the segmented network
+    double _maxCorrection;       // Largest correction of the last iteration
+    char _padding[16];
 };
 
-class adjust_reverse_thread {
-  public:
-    adjust_reverse_thread(dna_adjust* dnaAdj, std::exception_ptr& error)
-        : main_adj_(dnaAdj), error_(error) {}
-    void operator()();
-
-  private:
-    dna_adjust* main_adj_;
-    std::exception_ptr& error_;
+const UINT32 INCREMENTAL_FILE_VERSION(1);
+
+// Header of the incremental adjustment file, which records the solution of
+// an adjustment so that a later adjustment of the network may update it for
+// the measurements added or removed since.  The header is followed by the
+// coordinates of each station, the variance matrix of each block, and then
+// the contribution of each measurement to the normal equations.
+struct incrementalHeader_t {
+    incrementalHeader_t()
+        : _version(0), _adjustMode(0), _blockCount(0), _reserved(0), _stationCount(0), _measurementCount(0), _fingerprint(0) {
+        memset(_magic, 0, sizeof(_magic));
+        memset(_padding, 0, sizeof(_padding));
+    }
 
-    // Prevent assignment operator
-    adjust_reverse_thread& operator=(const adjust_reverse_thread& rhs);
+    char _magic[8];                    // "DNAINCRM"
+    UINT32 _version;                   // INCREMENTAL_FILE_VERSION of the writer
+    UINT32 _adjustMode;                // Simultaneous or phased
+    UINT32 _blockCount;                // Number of blocks
+    UINT32 _reserved;
+    std::uint64_t _stationCount;       // Number of stations
+    std::uint64_t _measurementCount;   // Number of measurements
+    std::uint64_t _fingerprint;        // Hash of the stations and the parameters of each block
+    char _padding[16];
 };
 
-class adjust_combine_thread {
-  public:
-    adjust_combine_thread(dna_adjust* dnaAdj, std::exception_ptr& error)
-        : main_adj_(dnaAdj), error_(error) {}
-    void operator()();
-
-  private:
-    dna_adjust* main_adj_;
-    std::exception_ptr& error_;
+// A measurement of an incremental adjustment, being the records which
+// together form one or more rows of the design matrix.  Since adjust
+// reduces the records of the binary measurement file, each measurement
+// is identified by a hash of its records both as imported and as reduced.
+struct incrementalMsr_t {
+    incrementalMsr_t()
+        : _key(0), _reducedKey(0), _record(0), _block(0), _firstRow(0), _rows(0) {}
+
+    std::uint64_t _key;          // Hash of the measurement records (as imported)
+    std::uint64_t _reducedKey;   // Hash of the measurement records (as reduced)
+    UINT32 _record;              // First binary record (this adjustment only)
+    UINT32 _block;               // Block in which the measurement is adjusted
+    UINT32 _firstRow;            // First row of the design matrix (this adjustment only)
+    UINT32 _rows;                // Number of rows of the design matrix
+    vUINT32 _stations;           // Stations of the measurement (sorted)
+    matrix_2d _normals;          // At*V-1*A of the stations
+    matrix_2d _weighted;         // At*V-1*(measured - computed) of the stations
+};
 
-    // Prevent assignment operator
-    adjust_combine_thread& operator=(const adjust_combine_thread& rhs);
+// A measurement eliminated as an outlier (see EliminateOutlier), described
+// by its record with the largest n-statistic
+struct eliminatedMsr_t {
+    eliminatedMsr_t()
+        : _measType(' '), _record(0), _records(0), _nstat(0.), _sigmaZero(0.) {}
+
+    char _measType;
+    std::string _station1;
+    std::string _station2;
+    std::string _station3;
+    UINT32 _record;              // First binary record eliminated
+    UINT32 _records;             // Number of binary records eliminated
+    vmsr_t _reduced;             // Records as reduced by the adjustment from which it was eliminated
+    double _nstat;               // N-statistic of the record
+    double _sigmaZero;           // Sigma zero of the adjustment from which it was eliminated
 };
 
-class adjust_process_combine_thread {
-  public:
-    adjust_process_combine_thread(dna_adjust* dnaAdj, const UINT32& id,
-                                  std::exception_ptr& error,
-                                  std::vector<std::exception_ptr>& cmb_errors)
-        : main_adj_(dnaAdj), thread_id_(id), error_(error),
-          cmb_errors_(cmb_errors) {}
-    void operator()();
+const UINT32 GNSS_INVERSE_FILE_VERSION(1);
 
-  private:
-    dna_adjust* main_adj_;
-    UINT32 thread_id_;
-    std::exception_ptr& error_;
-    std::vector<std::exception_ptr>& cmb_errors_;
-
-    // Prevent assignment operator
-    adjust_process_combine_thread&
-    operator=(const adjust_process_combine_thread& rhs);
+// Header of the GNSS inverse file, which records the inverse variance
+// matrices of the GNSS baselines and clusters of a binary measurement file
+// once reduced by adjust.  The header is followed by each inverse, as its
+// first binary record, dimension and key, and the elements of its rows.
+struct gnssInverseHeader_t {
+    gnssInverseHeader_t()
+        : _version(0), _reserved(0), _recordCount(0), _inverseCount(0) {
+        memset(_magic, 0, sizeof(_magic));
+    }
+
+    char _magic[8];                    // "DNAGNSSI"
+    UINT32 _version;                   // GNSS_INVERSE_FILE_VERSION of the writer
+    UINT32 _reserved;
+    std::uint64_t _recordCount;        // Number of binary measurement records
+    std::uint64_t _inverseCount;       // Number of inverses
 };
 
 // This class is exported from the dnaAdjust.dll
@@ -290,6 +369,18 @@ class dna_adjust {
 
     void CloseOutputFiles();
     void UpdateBinaryFiles();
+    void SaveIncrementalState(const bool eliminating = false);
+    void RemoveEliminationState();
+    void SaveGnssInverses();
+
+    // Outlier elimination
+    bool EliminateOutlier();
+    inline const std::vector<eliminatedMsr_t>& GetEliminatedMeasurements() const {
+        return v_eliminatedMsrs_;
+    }
+    inline void SetEliminatedMeasurements(const std::vector<eliminatedMsr_t>& msrs) {
+        v_eliminatedMsrs_ = msrs;
+    }
 
     UINT32 CurrentIteration() const;
     UINT32& incrementIteration();
@@ -383,6 +474,7 @@ class dna_adjust {
     bool isFirstTimeAdjustment_;
     bool isIterationComplete_;
     bool isAdjustmentQuestionable_;
+    bool normalsFrozen_;  // reuse the inverse (or factor) of the normals on the next iteration
 
     UINT32 blockCount_;
     UINT32 currentBlock_;
@@ -415,6 +507,22 @@ class dna_adjust {
 
     void Solve(bool COMPUTE_INVERSE, const UINT32& block = 0);
     void SolveMT(bool COMPUTE_INVERSE, const UINT32& block);
+    void InvertNormals(const UINT32& block);
+    void InvertNormalsMixed(symmetric_matrix* normals, const matrix_2d& At_Vinv_m,
+                            matrix_2d& corrections, const UINT32& block);
+
+    // Mixed precision inverse (dense normals only)
+    inline bool MixedPrecisionNormals() const {
+        return projectSettings_.a.inverse_method_lsq == Cholesky_mixed &&
+               !SparseNormals();
+    }
+
+    // Frozen Jacobian (modified Newton) iterations
+    inline bool FrozenJacobian() const {
+        return projectSettings_.a.frozen_jacobian &&
+               projectSettings_.a.adjust_mode == SimultaneousMode;
+    }
+    void RefreshFrozenNormals();
 
     inline bool CombineRequired(const UINT32& block) const {
         if (v_blockMeta_.at(block)._blockLast)
@@ -450,10 +558,24 @@ class dna_adjust {
     void AdjustPhased();
     void AdjustPhasedForward();
     void AdjustPhasedReverseCombine();
-    bool CombinationThreadRequired();
 
     // Phased adjustment using multiple cores
     void AdjustPhasedMultiThread();
+    void FormPhasedAdjustmentTasks(task_graph& adjustments);
+    void AdjustPhasedForwardBlockMT(const UINT32& block);
+    void AdjustPhasedReverseBlockMT(const UINT32& block);
+    void AdjustPhasedCombineBlockMT(const UINT32& block);
+
+    // Phased adjustment by elimination of blocks over a binary tree
+    void AdjustPhasedTree();
+    void FormPhasedTree();
+    UINT32 FormPhasedTreeNode(const UINT32& firstBlock, const UINT32& lastBlock,
+                              const UINT32& parent, const vvUINT32& stationBlocks);
+    void FormPhasedTreeTasks(task_graph& eliminations);
+    void ReducePhasedTreeNode(const UINT32& node);
+    void SolvePhasedTreeNode(const UINT32& node);
+    void UpdateEstimatesTree(const UINT32& node);
+    void UpdateEstimatesFinalTree(const UINT32& block);
 
     // Phased adjustment producing rigorous
     // coordinates for block 1 only
@@ -469,6 +591,8 @@ class dna_adjust {
     void LoadSegmentationFile();
     void LoadSegmentationMetrics();
     void RemoveDuplicateStations(vUINT32& vStns);
+    void OrderBlockStations();
+    UINT32 BlockStationAtPosition(const UINT32& block, const UINT32& position);
     void InitialiseTypeBUncertainties();
 
     // Adjusted measurement sorting
@@ -487,7 +611,11 @@ class dna_adjust {
     // Stage helps
     void
     SetRegionOffsets(const UINT32& block, const int file_count = 0, ...);
-    void SetRegionOffset(vmat_file_map& file_map);
+    void SetRegionOffset(vmat_file_map& file_map, const UINT32& block, const int file);
+    std::uint64_t NetworkFingerprint();
+    void ReadStageFileIndex(const UINT32& matrices);
+    void VerifyStageFileFingerprint();
+    std::size_t StageFileIndex(const UINT32& block, const int file) const;
     void SetMapRegions(const int file_count = 0, ...);
     void PrepareMemoryMapRegions(const UINT32& block,
                                  const int file_count = 0, ...);
@@ -500,36 +628,94 @@ class dna_adjust {
                                         const int count = 0, ...);
     void UnloadBlock(const UINT32& block, const int file_count = 0, ...);
     void PurgeMatricesFromDisk();
+    void PrefetchBlock(const UINT32& block);
+    void WriteBehindBlock(const UINT32& block);
+    void WaitForBlock(const UINT32& block);
+    void WaitForStageIO();
+    void StageFileMaps(const UINT32& block, std::vector<vmat_file_map*>& file_maps);
+    vmat_file_map* StageFileMap(const int file);
+
+    // Checkpoint and resume
+    std::string CheckpointFilePath() const;
+    bool CheckpointDue() const;
+    void RecordCheckpointBlock(const UINT32& block);
+    void CheckpointIteration();
+    UINT32 ResumeAdjustment();
+    void FinaliseCheckpoint();
+    void LoadWarmStartCoordinates();
+
+    // Incremental adjustment
+    inline bool IncrementalAdjustment() const {
+        return (projectSettings_.a.incremental || projectSettings_.a.eliminate_outliers) &&
+               !projectSettings_.a.stage &&
+               !projectSettings_.a.report_mode && !SparseNormals() &&
+               projectSettings_.a.adjust_mode != Phased_Block_1Mode;
+    }
+    std::string IncrementalFilePath() const;
+    std::string EliminationFilePath() const;
+    std::uint64_t IncrementalFingerprint();
+    void LoadIncrementalState();
+    void FormIncrementalMeasurements();
+    void FormIncrementalNormals(incrementalMsr_t& msr);
+    bool FormIncrementalUpdate();
+    bool UpdateBlockIncrementally(const UINT32& block, v_mat_2d& corrections);
+    bool UpdateNormalsIncrementally();
+    bool UpdateEstimatesIncrementally();
+
+    // Inverse variance matrices of GNSS baselines and clusters
+    std::string GnssInverseFilePath() const;
+    std::uint64_t GnssInverseKey(const UINT32& record) const;
+    void FormGnssInverseIndex();
+    void LoadGnssInverses();
+    bool FindGnssInverse(const it_vmsr_t& _it_msr, matrix_2d* vmat, UINT32& slot);
+    void RetainGnssInverse(const UINT32& slot, const matrix_2d& vmat);
+    bool GnssInverseFits(const std::size_t& bytes) const;
+
+    // Residency of staged blocks under a memory limit
+    inline bool MemoryLimited() const {
+        return projectSettings_.a.stage && projectSettings_.a.memory_limit > 0;
+    }
+    void RetainBlock(const UINT32& block, const UINT32& position, const bool forward);
+    bool RetrieveRetainedMatrix(const UINT32& block, const int file);
+    void SetMatrixResident(const UINT32& block, const int file, const bool resident);
+    void EnforceMemoryLimit(const UINT32& position, const bool forward);
+    std::size_t ResidentBytes() const;
+    void RecordResidentBytes();
+    void EvictBlock(const UINT32& block);
+    UINT32 BlocksUntilNeeded(const UINT32& block, const UINT32& position, const bool forward) const;
 
     // Helpers
     void AddMsrtoMeasMinusComp(pit_vmsr_t _it_msr, const UINT32& design_row,
                                const double comp_msr, matrix_2d* measMinusComp,
                                bool printBlock = true);
+    template <typename T>
     void AddMsrtoNormalsVar(const UINT32& design_row, const UINT32& stn,
-                            matrix_2d* normals, matrix_2d* design,
-                            matrix_2d* AtVinv);
+                            T* normals, rowblock_matrix* design,
+                            rowblock_matrix* AtVinv);
+    template <typename T>
     void AddMsrtoNormalsCoVar2(const UINT32& design_row, const UINT32& stn1,
-                               const UINT32& stn2, matrix_2d* normals,
-                               matrix_2d* design, matrix_2d* AtVinv);
+                               const UINT32& stn2, T* normals,
+                               rowblock_matrix* design, rowblock_matrix* AtVinv);
+    template <typename T>
     void AddMsrtoNormalsCoVar3(const UINT32& design_row, const UINT32& stn1,
                                const UINT32& stn2, const UINT32& stn3,
-                               matrix_2d* normals, matrix_2d* design,
-                               matrix_2d* AtVinv);
+                               T* normals, rowblock_matrix* design,
+                               rowblock_matrix* AtVinv);
 
     inline void AddMsrtoDesign(const UINT32& design_row, const UINT32& stn,
                                const double& dmdx, const double& dmdy,
-                               const double& dmdz, matrix_2d* design);
+                               const double& dmdz, rowblock_matrix* design);
     inline void
     AddMsrtoDesign_L(const UINT32& design_row, const UINT32& stn1,
                      const UINT32& stn2, const double dmdx1, const double dmdy1,
                      const double dmdz1, const double dmdx2, const double dmdy2,
-                     const double dmdz2, matrix_2d* design);
+                     const double dmdz2, rowblock_matrix* design);
     inline void AddMsrtoDesign_BCEKMSVZ(const UINT32& design_row,
                                         const UINT32& stn1, const UINT32& stn2,
                                         const double dmdx, const double dmdy,
-                                        const double dmdz, matrix_2d* design);
+                                        const double dmdz, rowblock_matrix* design);
     inline void AddElementtoDesign(const UINT32& row, const UINT32& col,
-                                   const double value, matrix_2d* design);
+                                   const double value, rowblock_matrix* design);
 
     void
     UpdateDesignNormalMeasMatrices(pit_vmsr_t _it_msr, UINT32& design_row,
@@ -541,159 +727,159 @@ class dna_adjust {
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_BK(pit_vmsr_t _it_msr, UINT32& design_row,
                                       const UINT32& block,
                                       matrix_2d* measMinusComp,
                                       matrix_2d* estimatedStations,
-                                      matrix_2d* normals, matrix_2d* design,
-                                      matrix_2d* AtVinv, bool buildnewMatrices);
+                                      symmetric_matrix* normals, rowblock_matrix* design,
+                                      rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_C(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void UpdateDesignNormalMeasMatrices_CEM(
         pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
         matrix_2d* measMinusComp, matrix_2d* estimatedStations,
-        matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv,
+        symmetric_matrix* normals, rowblock_matrix* design, rowblock_matrix* AtVinv,
         bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_D(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_E(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void UpdateDesignMeasMatrices_GX(pit_vmsr_t _it_msr, UINT32& design_row,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* design, const UINT32& stn1,
+                                     rowblock_matrix* design, const UINT32& stn1,
                                      const UINT32& stn2, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_G(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_H(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_HR(pit_vmsr_t _it_msr, UINT32& design_row,
                                       const UINT32& block,
                                       matrix_2d* measMinusComp,
                                       matrix_2d* estimatedStations,
-                                      matrix_2d* normals, matrix_2d* design,
-                                      matrix_2d* AtVinv, bool buildnewMatrices);
+                                      symmetric_matrix* normals, rowblock_matrix* design,
+                                      rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_I(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_IP(pit_vmsr_t _it_msr, UINT32& design_row,
                                       const UINT32& block,
                                       matrix_2d* measMinusComp,
                                       matrix_2d* estimatedStations,
-                                      matrix_2d* normals, matrix_2d* design,
-                                      matrix_2d* AtVinv, bool buildnewMatrices);
+                                      symmetric_matrix* normals, rowblock_matrix* design,
+                                      rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_J(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_JQ(pit_vmsr_t _it_msr, UINT32& design_row,
                                       const UINT32& block,
                                       matrix_2d* measMinusComp,
                                       matrix_2d* estimatedStations,
-                                      matrix_2d* normals, matrix_2d* design,
-                                      matrix_2d* AtVinv, bool buildnewMatrices);
+                                      symmetric_matrix* normals, rowblock_matrix* design,
+                                      rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_L(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_M(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_P(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_Q(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_R(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_S(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_V(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
     void UpdateDesignNormalMeasMatrices_X(
         pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
         matrix_2d* measMinusComp, matrix_2d* estimatedStations,
-        matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices);
+        rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices);
     void UpdateDesignNormalMeasMatrices_Y(
         pit_vmsr_t _it_msr, UINT32& design_row, const UINT32& block,
         matrix_2d* measMinusComp, matrix_2d* estimatedStations,
-        matrix_2d* design, matrix_2d* AtVinv, bool buildnewMatrices);
+        rowblock_matrix* design, rowblock_matrix* AtVinv, bool buildnewMatrices);
     void
     UpdateDesignNormalMeasMatrices_Z(pit_vmsr_t _it_msr, UINT32& design_row,
                                      const UINT32& block,
                                      matrix_2d* measMinusComp,
                                      matrix_2d* estimatedStations,
-                                     matrix_2d* normals, matrix_2d* design,
-                                     matrix_2d* AtVinv, bool buildnewMatrices);
+                                     symmetric_matrix* normals, rowblock_matrix* design,
+                                     rowblock_matrix* AtVinv, bool buildnewMatrices);
 
     void UpdateIgnoredMeasurements(pit_vmsr_t _it_msr,
                                    bool storeOriginalMeasurement);
@@ -780,45 +966,66 @@ class dna_adjust {
     // Update AtVinv based on new design matrix elements
     void
     UpdateAtVinv(pit_vmsr_t _it_msr, const UINT32& stn1, const UINT32& stn2,
-                 const UINT32& stn3, UINT32& design_row, matrix_2d* design,
-                 matrix_2d* AtVinv, bool buildnewMatrices = true);
+                 const UINT32& stn3, UINT32& design_row, rowblock_matrix* design,
+                 rowblock_matrix* AtVinv, bool buildnewMatrices = true);
     // Direction (cluster measurement)
     void
     UpdateAtVinv_D(const UINT32& stn1, const UINT32& stn2, const UINT32& stn3,
                    const UINT32& angle, const UINT32& angle_count,
                    UINT32& design_row, UINT32& design_row_begin,
-                   matrix_2d* Vinv, matrix_2d* design, matrix_2d* AtVinv);
+                   matrix_2d* Vinv, rowblock_matrix* design, rowblock_matrix* AtVinv);
 
     // Update Normals based on new design matrix elements (i.e. when non-GPS
     // msrs are involved)
     void UpdateNormals(const UINT32& block, bool MT_ReverseOrCombine);
+    template <typename T>
+    void UpdateNormals(const UINT32& block, T* normals, rowblock_matrix* design,
+                       rowblock_matrix* AtVinv);
+    template <typename T>
+    void UpdateNormalsMeasurement(const UINT32& block, it_vmsr_t _it_msr,
+                                  UINT32& design_row, T* normals,
+                                  rowblock_matrix* design, rowblock_matrix* AtVinv);
+    // Forms normals on several threads, with results identical to those of
+    // UpdateNormals on one thread
+    void UpdateNormalsParallel(const UINT32& block, symmetric_matrix* normals,
+                               rowblock_matrix* design, rowblock_matrix* AtVinv);
+    UINT32 NormalsAssemblyThreads(const UINT32& block) const;
+    void IndexDesignRows(const UINT32& block);
+    UINT32 DesignRows(const it_vmsr_t& _it_msr) const;
     // three station measurements
+    template <typename T>
     void
     UpdateNormals_A(const UINT32& stn1, const UINT32& stn2, const UINT32& stn3,
-                    UINT32& design_row, matrix_2d* normals, matrix_2d* design,
-                    matrix_2d* AtVinv);
+                    UINT32& design_row, T* normals, rowblock_matrix* design,
+                    rowblock_matrix* AtVinv);
     // two station measurements
+    template <typename T>
     void UpdateNormals_BCEKLMSVZ(const UINT32& stn1, const UINT32& stn2,
-                                 UINT32& design_row, matrix_2d* normals,
-                                 matrix_2d* design, matrix_2d* AtVinv);
+                                 UINT32& design_row, T* normals,
+                                 rowblock_matrix* design, rowblock_matrix* AtVinv);
     // single station measurements
+    template <typename T>
     void UpdateNormals_HIJPQR(const UINT32& stn1, UINT32& design_row,
-                              matrix_2d* normals, matrix_2d* design,
-                              matrix_2d* AtVinv);
+                              T* normals, rowblock_matrix* design,
+                              rowblock_matrix* AtVinv);
     // Direction (cluster measurement)
+    template <typename T>
     void
     UpdateNormals_D(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-                    matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv);
+                    T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv);
     // GPS specific
+    template <typename T>
     void
     UpdateNormals_G(const UINT32& stn1, const UINT32& stn2, UINT32& design_row,
-                    matrix_2d* normals, matrix_2d* AtVinv);
+                    T* normals, rowblock_matrix* AtVinv);
+    template <typename T>
     void
     UpdateNormals_X(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-                    matrix_2d* normals, matrix_2d* design, matrix_2d* AtVinv);
+                    T* normals, rowblock_matrix* design, rowblock_matrix* AtVinv);
+    template <typename T>
     void
     UpdateNormals_Y(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row,
-                    matrix_2d* normals, matrix_2d* AtVinv);
+                    T* normals, rowblock_matrix* AtVinv);
 
     void OutputLargestCorrection(std::string& formatted_msg);
 
@@ -828,6 +1035,9 @@ class dna_adjust {
     void FillDesignNormalMeasurementsMatrices(bool buildnewMatrices,
                                               const UINT32& block,
                                               bool MT_ReverseOrCombine);
+    void FillDesignMeasurementsMatricesParallel(const UINT32& block,
+                                                const UINT32& threads,
+                                                bool MT_ReverseOrCombine);
 
     // void RecomputeMeasurementsCommonJunctions(const UINT32& nextBlock, const
     // UINT32& thisBlock, const UINT32& prevBlock);
@@ -837,6 +1047,52 @@ class dna_adjust {
     void AddConstraintStationstoNormalsCombine(const UINT32& block,
                                                bool MT_ReverseOrCombine);
     void AddConstraintStationstoNormalsSimultaneous(const UINT32& block);
+
+    // Sparse normals (simultaneous adjustments).  The normals are not held
+    // densely, but are either factorised by the sparse Cholesky solver or
+    // solved from the design matrix by the iterative solver.
+    inline bool SparseNormals() const {
+        return projectSettings_.a.adjust_mode == SimultaneousMode &&
+               (projectSettings_.a.lsq_solver == Sparse_cholesky ||
+                projectSettings_.a.lsq_solver == Iterative_pcg);
+    }
+    inline bool IterativeNormals() const {
+        return projectSettings_.a.adjust_mode == SimultaneousMode &&
+               projectSettings_.a.lsq_solver == Iterative_pcg;
+    }
+    // The full inverse of the normals is only required when covariances
+    // between all stations are printed or exported.  Otherwise, only the
+    // blocks of stations connected by measurements are required.
+    inline bool FullInverseRequired() const {
+        return projectSettings_.o._output_pu_covariances ||
+               projectSettings_.o._export_snx_file ||
+               projectSettings_.o._export_xml_msr_file ||
+               projectSettings_.o._export_dna_msr_file;
+    }
+    // Unless the full inverse is required, the sparse solver holds only
+    // the selected inverse, the iterative solver only the columns of the
+    // precision stations, and the dense inverse is not formed
+    inline bool SparseVariances() const {
+        return SparseNormals() && !FullInverseRequired() &&
+               !projectSettings_.a.report_mode;
+    }
+    void PrepareSparseNormals(const UINT32& block);
+    void FormSparseNormals(const UINT32& block);
+    void FormSparseInverse(const UINT32& block);
+
+    // Variance matrices of the estimates, whether formed densely or held
+    // as the selected inverse (or columns of the inverse)
+    variance_matrix AposterioriVariances(const UINT32& block);
+    variance_matrix RigorousVariances(const UINT32& block);
+
+    // Iterative (preconditioned conjugate gradient) solution of the normals
+    void PrepareIterativeNormals(const UINT32& block);
+    void FormIterativePreconditioner(const UINT32& block);
+    void InvertIterativePreconditioner();
+    void MultiplyIterativeNormals(const UINT32& block, const matrix_2d& x, matrix_2d& result);
+    UINT32 SolveIterativeNormals(const UINT32& block, const matrix_2d& rhs, matrix_2d& x,
+                                 const double& tolerance);
+    void FormIterativePrecisions(const UINT32& block);
     void FormConstraintStationVarianceMatrix(const it_vUINT32& _it_param_stn,
                                              matrix_2d& var_cart);
 
@@ -877,29 +1133,29 @@ class dna_adjust {
     void ComputePrecisionAdjMsrs(const UINT32& block = 0);
     void ComputePrecisionAdjMsrs_A(const UINT32& block, const UINT32& stn1,
                                    const UINT32& stn2, const UINT32& stn3,
-                                   matrix_2d* design,
-                                   matrix_2d* aposterioriVariances,
+                                   rowblock_matrix* design,
+                                   const variance_matrix& aposterioriVariances,
                                    UINT32& design_row, UINT32& precadjmsr_row);
     void ComputePrecisionAdjMsrs_D(const UINT32& block, it_vmsr_t& _it_msr,
-                                   matrix_2d* design,
-                                   matrix_2d* aposterioriVariances,
+                                   rowblock_matrix* design,
+                                   const variance_matrix& aposterioriVariances,
                                    UINT32& design_row, UINT32& precadjmsr_row);
     void
     ComputePrecisionAdjMsrs_BCEKLMSVZ(const UINT32& block, const UINT32& stn1,
-                                      const UINT32& stn2, matrix_2d* design,
-                                      matrix_2d* aposterioriVariances,
+                                      const UINT32& stn2, rowblock_matrix* design,
+                                      const variance_matrix& aposterioriVariances,
                                       UINT32& design_row,
                                       UINT32& precadjmsr_row);
     void
     ComputePrecisionAdjMsrs_HIJPQR(const UINT32& block, const UINT32& stn1,
-                                   matrix_2d* design,
-                                   matrix_2d* aposterioriVariances,
+                                   rowblock_matrix* design,
+                                   const variance_matrix& aposterioriVariances,
                                    UINT32& design_row, UINT32& precadjmsr_row);
     void ComputePrecisionAdjMsrs_GX(const UINT32& block, it_vmsr_t& _it_msr,
-                                    matrix_2d* aposterioriVariances,
+                                    const variance_matrix& aposterioriVariances,
                                     UINT32& design_row, UINT32& precadjmsr_row);
     void ComputePrecisionAdjMsrs_Y(const UINT32& block, it_vmsr_t& _it_msr,
-                                   matrix_2d* aposterioriVariances,
+                                   const variance_matrix& aposterioriVariances,
                                    UINT32& design_row, UINT32& precadjmsr_row);
 
     void UpdateMsrRecords(const UINT32& block = 0);
@@ -930,6 +1186,7 @@ class dna_adjust {
 
     void
     FormInverseVarianceMatrix(matrix_2d* vmat, bool LOWER_IS_CLEARED = false);
+    void FormInverseVarianceMatrix(symmetric_matrix* vmat);
     void
     FormInverseGPSVarianceMatrix(const it_vmsr_t& _it_msr, matrix_2d* vmat);
     bool
@@ -1045,18 +1302,33 @@ class dna_adjust {
     void UpdateGeographicCoordsPhased(const UINT32& block,
                                       matrix_2d* estimatedStations);
     void UpdateGeographicCoords();
+    void UpdateGeographicCoords(const UINT32& block, const vUINT32& stations,
+                                matrix_2d* estimatedStations);
+
+    // Position of a station in the normals of a block, from the dense
+    // index formed by FormBlockStationIndex().  Most stations appear in
+    // one block only, and junction stations in very few.
+    inline UINT32
+    BlockStationPosition(const UINT32& block, const UINT32& station) const {
+        for (UINT32 i(v_blockStationIndexStart_[station]); i<v_blockStationIndexStart_[station+1]; ++i)
+            if (v_blockStationIndex_[i].first == block)
+                return v_blockStationIndex_[i].second;
+        return BlockStationNotFound(block, station);
+    }
+    UINT32 BlockStationNotFound(const UINT32& block, const UINT32& station) const;
+    void FormBlockStationIndex();
 
     inline UINT32
-    GetBlkMatrixElemStn1(const UINT32& block, const pit_vmsr_t _it_msr) {
-        return v_blockStationsMap_.at(block)[(*_it_msr)->station1] * 3;
+    GetBlkMatrixElemStn1(const UINT32& block, const pit_vmsr_t _it_msr) const {
+        return BlockStationPosition(block, (*_it_msr)->station1) * 3;
     }
     inline UINT32
-    GetBlkMatrixElemStn2(const UINT32& block, const pit_vmsr_t _it_msr) {
-        return v_blockStationsMap_.at(block)[(*_it_msr)->station2] * 3;
+    GetBlkMatrixElemStn2(const UINT32& block, const pit_vmsr_t _it_msr) const {
+        return BlockStationPosition(block, (*_it_msr)->station2) * 3;
     }
     inline UINT32
-    GetBlkMatrixElemStn3(const UINT32& block, const pit_vmsr_t _it_msr) {
-        return v_blockStationsMap_.at(block)[(*_it_msr)->station3] * 3;
+    GetBlkMatrixElemStn3(const UINT32& block, const pit_vmsr_t _it_msr) const {
+        return BlockStationPosition(block, (*_it_msr)->station3) * 3;
     }
 
     void debug_BlockInformation(const UINT32& currentBlock,
@@ -1142,6 +1414,9 @@ class dna_adjust {
     // ----------------------------------------------
 
     v_uint32_uint32_map v_blockStationsMap_;
+    vUINT32 v_blockStationIndexStart_;          // First entry of each station in v_blockStationIndex_
+    v_uint32_uint32_pair v_blockStationIndex_;  // [block, position] of each station, by station
+    std::vector<phasedTreeNode_t> v_treeNodes_; // Elimination tree (tree-structured phased adjustment)
     v_u32u32_uint32_pair
         v_blockStationsMapUnique_; // [ [station, block index] , [block] ]
     void BuildUniqueBlockStationMap();
@@ -1152,6 +1427,10 @@ class dna_adjust {
     vvUINT32 v_CML_; // Measurements.  Each index refers to:
                      //  - Non-ignored measurements
                      //  - The fist measurement in a cluster
+    v_uint32_uint32_pair msrDesignRows_; // [position in v_CML_, first design row] of
+                                         // each measurement of a block.  See IndexDesignRows()
+    task_graph assembly_;                // Workers which form the design matrix and normals
+                                         // of a block.  See NormalsAssemblyThreads()
 
     v_uint32_u32u32_pair v_msr_block_; // map of measurements and block number,
                                        // prec adj msr matrix index
@@ -1179,11 +1458,22 @@ class dna_adjust {
     // Adjustment matrices for phased adjustment
     // In the case where MULTI_THREAD is defined, these
     // matrices are used for the forward thread
-    v_mat_2d v_normals_;           // vector of ((At * V-1) * A) matrices
-    v_mat_2d v_normalsR_;          // vector of ((At * V-1) * A) matrices
-    v_mat_2d v_AtVinv_;            // vector of (At * V-1) matrices
-    v_mat_2d v_design_;            // vector of design matrices
-    v_mat_2d v_rigorousVariances_; // Precisions of rigorous coordinates
+    v_sym_mat v_normals_;          // vector of ((At * V-1) * A) matrices
+    v_sym_mat v_normalsR_;         // vector of ((At * V-1) * A) matrices
+    v_rowblock_matrix v_AtVinv_;   // vector of (At * V-1) matrices
+    v_rowblock_matrix v_design_;   // vector of design matrices
+    v_sym_mat v_rigorousVariances_; // Precisions of rigorous coordinates
+    sparse_matrix sparseNormals_;  // ((At * V-1) * A) for the sparse solver
+                                   // (simultaneous adjustments only)
+
+    // The iterative solver holds the 3x3 constraint and diagonal blocks
+    // of the normals of each station.  The remainder of the normals is
+    // applied from the design and At*V-1 matrices.
+    vdouble v_iterativeConstraints_;
+    vdouble v_iterativePreconditioner_;
+    vUINT32 v_iterativePrecisionStations_;  // Stations for which precisions are estimated
+    column_inverse iterativeVariances_;     // Columns of the inverse for the precision stations
+    bool iterativePreconditioned_;
 
     v_mat_2d v_measMinusComp_;     // vector of measurement matrices
     v_mat_2d v_estimatedStations_; // Coordinate estimates for each block after
@@ -1192,9 +1482,9 @@ class dna_adjust {
                                    // estimates matrices
     v_mat_2d v_rigorousStations_;  // Coordinate estimates for each block after
                                    // rigorous phased adjustment
-    v_mat_2d v_junctionVariances_; // used to carry junction variances between
-                                   // all successive blocks
-    v_mat_2d
+    v_sym_mat v_junctionVariances_; // used to carry junction variances between
+                                    // all successive blocks
+    v_sym_mat
         v_junctionVariancesFwd_; // retains junction variances from forward pass
     v_mat_2d v_junctionEstimatesFwd_; // retains junctions estimates from
                                       // forward pass
@@ -1229,22 +1519,60 @@ class dna_adjust {
     vmat_file_map precAdjMsrs_map_;
     vmat_file_map corrections_map_;
 
+    // Background prefetch and write-behind of block regions.  Declared
+    // after the file maps so that outstanding i/o completes before the
+    // maps are destroyed.
+    io_pipeline stageIO_;
+
+    // Staged matrices held in memory when a memory limit is set.  Retained
+    // matrices are those of offloaded blocks which are identical to their
+    // stage file regions, and so need not be read again.
+    vUINT32 v_blockResidentFiles_;      // Bit (1 << STAGE_FILE) set for each matrix in memory
+    vUINT32 v_blockRetainedFiles_;      // Bit set for each matrix retained since the block was offloaded
+    std::size_t residentBytes_;         // Memory occupied by resident staged matrices.  See ResidentBytes()
+    std::size_t peakResidentBytes_;
+    UINT32 blocksEvicted_;
+
     vstring v_stageFileStreams_;
-    std::fstream f_normals_;
-    std::fstream f_normalsR_;
-    std::fstream f_AtVinv_;
-    std::fstream f_design_;
-    std::fstream f_measMinusComp_;
-    std::fstream f_estimatedStations_;
-    std::fstream f_originalStations_;
-    std::fstream f_rigorousStations_;
-    std::fstream f_junctionVariances_;
-    std::fstream f_junctionVariancesFwd_;
-    std::fstream f_junctionEstimatesFwd_;
-    std::fstream f_junctionEstimatesRev_;
-    std::fstream f_rigorousVariances_;
-    std::fstream f_precAdjMsrs_;
-    std::fstream f_corrections_;
+    std::fstream f_stage_;
+
+    // Header and index of the stage file.  The index holds the offset and
+    // size of each matrix in the file, by block and then matrix.
+    stageFileHeader_t stageFileHeader_;
+    std::vector<std::uint64_t> v_stageFileIndex_;
+    std::uint64_t stageFileOffset_;     // Offset at which the next region is written
+
+    // Header of the checkpoints written by this adjustment.  The checkpoint
+    // of each completed iteration is written in the background, so that the
+    // next iteration need not wait for the disk.
+    checkpointHeader_t checkpointHeader_;
+    v_mat_2d v_checkpointStations_;     // Estimated, original and rigorous stations of each
+                                        // staged block, copied as it is offloaded
+    io_pipeline checkpointIO_;
+
+    // Solution of the previous incremental adjustment (the variance matrix
+    // of each block and its measurements), the measurements of this
+    // adjustment, and those added and removed since
+    v_sym_mat v_incrementalVariances_;
+    std::vector<incrementalMsr_t> v_incrementalPrevious_;
+    std::vector<incrementalMsr_t> v_incrementalCurrent_;
+    vUINT32 v_incrementalAdded_;
+    vUINT32 v_incrementalRemoved_;
+
+    // Measurements eliminated as outliers by this and previous adjustments
+    // of the network, in the order in which they were eliminated
+    std::vector<eliminatedMsr_t> v_eliminatedMsrs_;
+
+    // Inverse variance matrix of each GNSS baseline and cluster, formed
+    // once its records have been reduced and shared by all threads.  Each
+    // is indexed by its first binary record, and recorded with a hash of
+    // its (scaled) variances by SaveGnssInverses().
+    vUINT32 v_gnssInverseSlot_;
+    v_mat_2d v_gnssInverses_;
+    std::unique_ptr<std::atomic<bool>[]> gnssInverseFormed_;
+    std::atomic<std::uint64_t> gnssInverseReused_;
+    std::atomic<std::size_t> gnssInverseBytes_;     // Memory occupied by the retained inverses.  See ResidentBytes()
+    std::mutex gnssInverseMutex_;
 
     // queue to handle notification of messages for each iteration
     concurrent_queue<UINT32> iterationQueue_;
@@ -1252,15 +1580,15 @@ class dna_adjust {
     // ----------------------------------------------
     // Adjustment matrices for multi-threaded phased adjustment
     // These matrices are used for reverse and combine threads
-    v_mat_2d v_designR_;   // vector of design matrices
-    v_mat_2d v_AtVinvR_;   // vector of (At * V-1) matrices
-    v_mat_2d v_normalsRC_; // vector of ((At * V-1) * A) matrices
+    v_rowblock_matrix v_designR_;   // vector of design matrices
+    v_rowblock_matrix v_AtVinvR_;   // vector of (At * V-1) matrices
+    v_sym_mat v_normalsRC_; // vector of ((At * V-1) * A) matrices
 
     v_mat_2d v_measMinusCompR_;     // vector of measurement matrices
     v_mat_2d v_estimatedStationsR_; // Coordinate estimates for each block after
                                     // each block adjustment (in isolation)
-    v_mat_2d v_junctionVariancesR_; // used to carry junction variances between
-                                    // all successive blocks
+    v_sym_mat v_junctionVariancesR_; // used to carry junction variances between
+                                     // all successive blocks
 
     vUINT32
         v_blockStationsR; // Stations in the current block (used for printing);
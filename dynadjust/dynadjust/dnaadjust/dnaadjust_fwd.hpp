@@ -30,14 +30,6 @@ class dna_adjust;
 class DynAdjustPrinter;
 class NetworkDataLoader;
 
-// Thread helper classes
-class adjust_prepare_thread;
-class adjust_process_prepare_thread;
-class adjust_forward_thread;
-class adjust_reverse_thread;
-class adjust_combine_thread;
-class adjust_process_combine_thread;
-
 } // namespace networkadjust
 } // namespace dynadjust
 
@@ -95,10 +95,44 @@ void DynAdjustPrinter::PrintAdjustmentTime(cpu_timer& time, int timer_type) {
         adjust_.adj_file << std::setw(PRINT_VAR_PAD) << std::left << "Elapsed time" << ss.str() << std::endl;
     else
     {
-        adjust_.adj_file << std::setw(PRINT_VAR_PAD) << std::left << "Total time" << ss.str() << std::endl << std::endl;
+        adjust_.adj_file << std::setw(PRINT_VAR_PAD) << std::left << "Total time" << ss.str() << std::endl;
+
+        if (adjust_.MemoryLimited())
+            PrintResidentMemoryUsage();
+
+        adjust_.adj_file << std::endl;
+
+        if (adjust_.projectSettings_.g.verbose)
+            PrintMatrixMemoryUsage();
     }
 }
 
+void DynAdjustPrinter::PrintMatrixMemoryUsage() {
+    // Usage of the matrix buffer arena, in megabytes
+    const memory::arena_statistics stats(memory::buffer_arena::instance().statistics());
+    const double mb(static_cast<double>(MEGABYTE_SIZE));
+
+    adjust_.debug_file << std::fixed << std::setprecision(1) <<
+        std::setw(PRINT_VAR_PAD) << std::left << "Matrix memory (peak)" << stats.peak_bytes_in_use / mb << " MB" << std::endl <<
+        std::setw(PRINT_VAR_PAD) << std::left << "Matrix memory (current)" << stats.bytes_in_use / mb << " MB" << std::endl <<
+        std::setw(PRINT_VAR_PAD) << std::left << "Matrix memory (cached)" << stats.bytes_cached / mb << " MB" << std::endl <<
+        std::setw(PRINT_VAR_PAD) << std::left << "Matrix buffers reused" << stats.reuses << " of " << stats.acquisitions << std::endl << std::endl;
+}
+
+void DynAdjustPrinter::PrintResidentMemoryUsage() {
+    // Peak memory occupied by the staged matrices held in memory and the
+    // matrices of the blocks in use (see ResidentBytes), and the number
+    // of blocks written out to make room for others
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) <<
+        adjust_.peakResidentBytes_ / static_cast<double>(MEGABYTE_SIZE) << " MB" <<
+        " (limit " << adjust_.projectSettings_.a.memory_limit << " MB)";
+
+    adjust_.adj_file << 
+        std::setw(PRINT_VAR_PAD) << std::left << "Peak resident memory" << ss.str() << std::endl <<
+        std::setw(PRINT_VAR_PAD) << std::left << "Blocks evicted" << adjust_.blocksEvicted_ << std::endl;
+}
+
 constexpr int DynAdjustPrinter::GetStationCount(char measurement_type) const {
     // Use constexpr lookup for station count
     for (const auto& [type, count] : kStationCounts) {
@@ -547,8 +581,8 @@ void DynAdjustPrinter::PrintAdjustedNetworkStations() {
 
     switch (adjust_.projectSettings_.a.adjust_mode) {
     case SimultaneousMode:
-        PrintAdjStations(adjust_.adj_file, 0, &adjust_.v_estimatedStations_.at(0), &adjust_.v_rigorousVariances_.at(0), false, true, true, printHeader, true);
-        PrintAdjStations(adjust_.xyz_file, 0, &adjust_.v_estimatedStations_.at(0), &adjust_.v_rigorousVariances_.at(0), false, false, false, printHeader, false);
+        PrintAdjStations(adjust_.adj_file, 0, &adjust_.v_estimatedStations_.at(0), adjust_.RigorousVariances(0), false, true, true, printHeader, true);
+        PrintAdjStations(adjust_.xyz_file, 0, &adjust_.v_estimatedStations_.at(0), adjust_.RigorousVariances(0), false, false, false, printHeader, false);
         break;
     case PhasedMode:
     case Phased_Block_1Mode:
@@ -724,6 +758,40 @@ void DynAdjustPrinter::PrintStatistics(bool printPelzer) {
     adjust_.adj_file << std::setw(PASS_FAIL) << std::right << ss.str() << std::endl << std::endl;
 }
 
+void DynAdjustPrinter::PrintEliminatedMeasurements() {
+    adjust_.adj_file << std::endl << "Eliminated Outliers" << std::endl <<
+        "------------------------------------------" << std::endl << std::endl;
+
+    UINT32 i, j(PAD + PAD2 + STATION + STATION + STATION + PAD + STAT + REL);
+    adjust_.adj_file <<
+        std::setw(PAD) << std::left << "#" <<
+        std::setw(PAD2) << std::left << "M" <<
+        std::setw(STATION) << std::left << "Station 1" <<
+        std::setw(STATION) << std::left << "Station 2" <<
+        std::setw(STATION) << std::left << "Station 3" <<
+        std::setw(PAD) << std::right << "Recs" <<
+        std::setw(STAT) << std::right << "N-stat" <<
+        std::setw(REL) << std::right << "Sigma Zero" << std::endl;
+
+    for (i=0; i<j; ++i)
+        adjust_.adj_file << "-";
+    adjust_.adj_file << std::endl;
+
+    i = 0;
+    for (const auto& msr : adjust_.v_eliminatedMsrs_)
+        adjust_.adj_file <<
+            std::setw(PAD) << std::left << ++i <<
+            std::setw(PAD2) << std::left << msr._measType <<
+            std::setw(STATION) << std::left << msr._station1 <<
+            std::setw(STATION) << std::left << msr._station2 <<
+            std::setw(STATION) << std::left << msr._station3 <<
+            std::setw(PAD) << std::right << msr._records <<
+            std::setw(STAT) << std::right << std::fixed << std::setprecision(2) << msr._nstat <<
+            std::setw(REL) << std::right << std::fixed << std::setprecision(3) << msr._sigmaZero << std::endl;
+
+    adjust_.adj_file << std::endl;
+}
+
 void DynAdjustPrinter::PrintMeasurementsToStation() {
     // Create Measurement tally.  Loads up the AML file.
     adjust_.CreateMsrToStnTally();
@@ -1245,7 +1313,7 @@ void DynAdjustPrinter::PrintPositionalUncertaintyHeader(std::ostream& os, std::s
 // Geographic coordinate specialization
 template<>
 void DynAdjustPrinter::PrintStationCoordinates<GeographicCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                      const matrix_2d* estimates, const matrix_2d* variances) {
+                                                                      const matrix_2d* estimates, const symmetric_matrix* variances) {
     // Station name and constraint
     os << std::setw(STATION) << std::left << stn_it->stationName;
     os << std::setw(CONSTRAINT) << std::left << stn_it->stationConst;
@@ -1267,7 +1335,7 @@ void DynAdjustPrinter::PrintStationCoordinates<GeographicCoordinates>(std::ostre
 // Cartesian coordinate specialization  
 template<>
 void DynAdjustPrinter::PrintStationCoordinates<CartesianCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                     const matrix_2d* estimates, const matrix_2d* variances) {
+                                                                     const matrix_2d* estimates, const symmetric_matrix* variances) {
     // Station name and constraint
     os << std::setw(STATION) << std::left << stn_it->stationName;
     os << std::setw(CONSTRAINT) << std::left << stn_it->stationConst;
@@ -1289,7 +1357,7 @@ void DynAdjustPrinter::PrintStationCoordinates<CartesianCoordinates>(std::ostrea
 // Projection coordinate specialization
 template<>
 void DynAdjustPrinter::PrintStationCoordinates<ProjectionCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                      const matrix_2d* estimates, const matrix_2d* variances) {
+                                                                      const matrix_2d* estimates, const symmetric_matrix* variances) {
     // Station name and constraint
     os << std::setw(STATION) << std::left << stn_it->stationName;
     os << std::setw(CONSTRAINT) << std::left << stn_it->stationConst;
@@ -1304,7 +1372,7 @@ void DynAdjustPrinter::PrintStationCoordinates<ProjectionCoordinates>(std::ostre
 // Geographic uncertainty specialization
 template<>
 void DynAdjustPrinter::PrintStationUncertainties<GeographicCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                        const matrix_2d* variances, UncertaintyMode mode) {
+                                                                        const symmetric_matrix* variances, UncertaintyMode mode) {
     if (!variances) return;
     
     switch (mode) {
@@ -1331,7 +1399,7 @@ void DynAdjustPrinter::PrintStationUncertainties<GeographicCoordinates>(std::ost
 // Cartesian uncertainty specialization
 template<>
 void DynAdjustPrinter::PrintStationUncertainties<CartesianCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                       const matrix_2d* variances, UncertaintyMode mode) {
+                                                                       const symmetric_matrix* variances, UncertaintyMode mode) {
     if (!variances) return;
     
     // Print cartesian coordinate standard deviations
@@ -1409,7 +1477,7 @@ void DynAdjustPrinter::PrintStationCorrelations(std::ostream& cor_file, const UI
 }
 
 void DynAdjustPrinter::PrintStationsInBlock(std::ostream& os, const UINT32& block,
-                                           const matrix_2d* estimates, const matrix_2d* variances,
+                                           const matrix_2d* estimates, const symmetric_matrix* variances,
                                            const std::string& stn_coord_types, const UINT16& printStationCorrections) {
     // Print header
     PrintStationColumnHeaders(os, stn_coord_types, printStationCorrections);
@@ -1419,7 +1487,7 @@ void DynAdjustPrinter::PrintStationsInBlock(std::ostream& os, const UINT32& bloc
 }
 
 void DynAdjustPrinter::PrintUniqueStationsList(std::ostream& os, 
-                                              const matrix_2d* estimates, const matrix_2d* variances,
+                                              const matrix_2d* estimates, const symmetric_matrix* variances,
                                               const std::string& stn_coord_types, const UINT16& printStationCorrections) {
     // Print unique stations across all blocks
     PrintStationColumnHeaders(os, stn_coord_types, printStationCorrections);
@@ -1427,7 +1495,7 @@ void DynAdjustPrinter::PrintUniqueStationsList(std::ostream& os,
 }
 
 void DynAdjustPrinter::PrintAdjStationsUniqueList(std::ostream& os,
-                                                           const v_mat_2d* stationEstimates, v_mat_2d* stationVariances,
+                                                           const v_mat_2d* stationEstimates, v_sym_mat* stationVariances,
                                                            bool recomputeGeographicCoords, bool updateGeographicCoords,
                                                            bool reapplyTypeBUncertainties) {
     
@@ -1562,7 +1630,7 @@ void DynAdjustPrinter::PrintPositionalUncertaintyOutput() {
 
 void DynAdjustPrinter::PrintStationAdjustmentResults(std::ostream& os, const UINT32& block,
                                                     const UINT32& stn, const UINT32& mat_idx,
-                                                    const matrix_2d* estimates, matrix_2d* variances) {
+                                                    const matrix_2d* estimates, symmetric_matrix* variances) {
     it_vstn_t stn_it(adjust_.bstBinaryRecords_.begin() + stn);
     
     // Print station name and constraint using existing infrastructure
@@ -2721,7 +2789,7 @@ void DynAdjustPrinter::PrintPositionalUncertainty()
     {
     case SimultaneousMode:
         PrintPosUncertainties(apu_file, 0, 
-            &adjust_.v_rigorousVariances_.at(0));
+            adjust_.RigorousVariances(0));
         break;
     case PhasedMode:
         // Output phased blocks as a single block?
@@ -2898,7 +2966,8 @@ bool DynAdjustPrinter::PrintEstimatedStationCoordinatestoSNX(std::string& sinex_
     std::string sinexBasename = adjust_.projectSettings_.g.output_folder + FOLDER_SLASH + adjust_.projectSettings_.g.network_name;
     std::stringstream ssBlock;
 
-    matrix_2d *estimates = nullptr, *variances = nullptr;
+    matrix_2d *estimates = nullptr;
+    symmetric_matrix *variances = nullptr;
 
     bool success(true);
 
@@ -3055,7 +3124,8 @@ void DynAdjustPrinter::PrintEstimatedStationCoordinatestoDNAXML_Y(const std::str
     }
 
     try {
-        matrix_2d *estimates = nullptr, *variances = nullptr;
+        matrix_2d *estimates = nullptr;
+    symmetric_matrix *variances = nullptr;
         dnaMsrPtr msr_ptr;
         std::string comment;
 
@@ -3152,7 +3222,7 @@ void DynAdjustPrinter::PrintEstimatedStationCoordinatestoDNAXML_Y(const std::str
     }
 }
 
-void DynAdjustPrinter::PrintPosUncertaintiesUniqueList(std::ostream& os, const v_mat_2d* stationVariances)
+void DynAdjustPrinter::PrintPosUncertaintiesUniqueList(std::ostream& os, v_sym_mat* stationVariances)
 {
     // Print header
     PrintPosUncertaintiesHeader(os);
@@ -3342,7 +3412,7 @@ void DynAdjustPrinter::PrintStationCorrectionsList(std::ostream& cor_file)
 }
 
 void DynAdjustPrinter::PrintBlockStations(std::ostream& os, const UINT32& block,
-    const matrix_2d* stationEstimates, matrix_2d* stationVariances, bool printBlockID,
+    const matrix_2d* stationEstimates, variance_matrix stationVariances, bool printBlockID,
     bool recomputeGeographicCoords, bool updateGeographicCoords, bool printHeader,
     bool reapplyTypeBUncertainties)
 {
@@ -3405,7 +3475,7 @@ void DynAdjustPrinter::PrintBlockStations(std::ostream& os, const UINT32& block,
     for (UINT32 i(0); i<adjust_.v_blockStationsMap_.at(block).size(); ++i)
     {
         stn = v_blockStations.at(i);
-        mat_idx = adjust_.v_blockStationsMap_.at(block)[stn] * 3;
+        mat_idx = adjust_.BlockStationPosition(block, stn) * 3;
 
         PrintAdjStation(os, block, stn, mat_idx,
             stationEstimates, stationVariances, 
@@ -3694,7 +3764,7 @@ void DynAdjustPrinter::PrintCompMeasurements_GXY(const UINT32& block, it_vmsr_t&
 }
 
 void DynAdjustPrinter::PrintStationsUniqueList(std::ostream& os,
-    const v_mat_2d* stationEstimates, v_mat_2d* stationVariances,
+    const v_mat_2d* stationEstimates, v_sym_mat* stationVariances,
     bool recomputeGeographicCoords, bool updateGeographicCoords,
     bool reapplyTypeBUncertainties)
 {
@@ -3903,7 +3973,7 @@ bool DynAdjustPrinter::IgnoredMeasurementContainsInvalidStation(pit_vmsr_t _it_m
 
 void DynAdjustPrinter::PrintAdjStation(std::ostream& os, 
     const UINT32& block, const UINT32& stn, const UINT32& mat_idx,
-    const matrix_2d* stationEstimates, matrix_2d* stationVariances,
+    const matrix_2d* stationEstimates, variance_matrix stationVariances,
     bool recomputeGeographicCoords, bool updateGeographicCoords,
     bool reapplyTypeBUncertainties)
 {
@@ -3996,7 +4066,7 @@ void DynAdjustPrinter::PrintAdjStation(std::ostream& os,
             {
                 // Add the cartesian type b variances 
                 // Note: Cartesian variances for this station were computed in dna_io_tbu::reduce_uncertainties_local(...)
-                stationVariances->blockadd(mat_idx, mat_idx,
+                stationVariances.blockadd(mat_idx, mat_idx,
                     adjust_.v_typeBUncertaintiesLocal_.at(adjust_.v_stationTypeBMap_.at(stn).second).type_b,
                     0, 0, 3, 3);
             }
@@ -4010,13 +4080,13 @@ void DynAdjustPrinter::PrintAdjStation(std::ostream& os,
                     estLatitude, estLongitude, true);
 
                 // Add the cartesian type b variances 
-                stationVariances->blockadd(mat_idx, mat_idx,
+                stationVariances.blockadd(mat_idx, mat_idx,
                     var_cart_typeb, 0, 0, 3, 3);
             }	
         }
     }
 
-    var_cart.copyelements(0, 0, stationVariances, mat_idx, mat_idx, 3, 3);
+    stationVariances.submatrix(mat_idx, mat_idx, &var_cart, 3, 3);
 
     PropagateVariances_LocalCart(var_cart, var_local, 
         estLatitude, estLongitude, false);
@@ -4248,7 +4318,7 @@ void DynAdjustPrinter::PrintCorStations(std::ostream& cor_file, const UINT32& bl
     for (i=0; i<adjust_.v_blockStationsMap_.at(block).size(); ++i)
     {
         stn = v_blockStations.at(i);
-        mat_idx = adjust_.v_blockStationsMap_.at(block)[stn] * 3;
+        mat_idx = adjust_.BlockStationPosition(block, stn) * 3;
 
         PrintCorStation(cor_file, block, stn, mat_idx, 
             &estimates->at(block));
@@ -4298,7 +4368,7 @@ void DynAdjustPrinter::PrintPosUncertaintiesHeader(std::ostream& os)
 }
 
 void DynAdjustPrinter::PrintPosUncertainty(std::ostream& os, const UINT32& block, const UINT32& stn, 
-                                           const UINT32& mat_idx, const matrix_2d* stationVariances, 
+                                           const UINT32& mat_idx, const variance_matrix& stationVariances, 
                                            const UINT32& map_idx, const vUINT32* blockStations)
 {
     double semimajor, semiminor, azimuth, hzPosU, vtPosU;
@@ -4315,7 +4385,7 @@ void DynAdjustPrinter::PrintPosUncertainty(std::ostream& os, const UINT32& block
     }
 
     // get cartesian matrix
-    stationVariances->submatrix(mat_idx, mat_idx, &variances_cart, 3, 3);
+    stationVariances.submatrix(mat_idx, mat_idx, &variances_cart, 3, 3);
 
     // Calculate standard deviations in local reference frame
     PropagateVariances_LocalCart<double>(variances_cart, variances_local, 
@@ -4406,10 +4476,10 @@ void DynAdjustPrinter::PrintPosUncertainty(std::ostream& os, const UINT32& block
     // Print covariances
     for (ic=map_idx+1; ic<adjust_.v_blockStationsMap_.at(block).size(); ++ic)
     {
-        jc = adjust_.v_blockStationsMap_.at(block)[blockStations->at(ic)] * 3;
+        jc = adjust_.BlockStationPosition(block, blockStations->at(ic)) * 3;
 
         // get cartesian submatrix corresponding to the covariance
-        stationVariances->submatrix(mat_idx, jc, &variances_cart, 3, 3);
+        stationVariances.submatrix(mat_idx, jc, &variances_cart, 3, 3);
             
         switch (adjust_.projectSettings_.o._apu_vcv_units)
         {
@@ -4445,7 +4515,7 @@ void DynAdjustPrinter::PrintPosUncertainty(std::ostream& os, const UINT32& block
     }
 }
 
-void DynAdjustPrinter::PrintPosUncertainties(std::ostream& os, const UINT32& block, const matrix_2d* stationVariances)
+void DynAdjustPrinter::PrintPosUncertainties(std::ostream& os, const UINT32& block, const variance_matrix& stationVariances)
 {
     vUINT32 v_blockStations(adjust_.v_parameterStationList_.at(block));
 
@@ -4470,7 +4540,7 @@ void DynAdjustPrinter::PrintPosUncertainties(std::ostream& os, const UINT32& blo
     for (UINT32 i=0; i<adjust_.v_blockStationsMap_.at(block).size(); ++i)
     {
         stn = v_blockStations.at(i);
-        mat_idx = adjust_.v_blockStationsMap_.at(block)[stn] * 3;
+        mat_idx = adjust_.BlockStationPosition(block, stn) * 3;
 
         PrintPosUncertainty(os,
             block, stn, mat_idx,
@@ -5214,7 +5284,7 @@ void DynAdjustPrinter::PrintCorStationsUniqueList(std::ostream& cor_file)
 
 void DynAdjustPrinter::PrintAdjStations(std::ostream& os, const UINT32& block,
                       const matrix_2d* stationEstimates,
-                      matrix_2d* stationVariances, bool printBlockID,
+                      variance_matrix stationVariances, bool printBlockID,
                       bool recomputeGeographicCoords,
                       bool updateGeographicCoords, bool printHeader,
                       bool reapplyTypeBUncertainties)
@@ -5274,7 +5344,7 @@ void DynAdjustPrinter::PrintAdjStations(std::ostream& os, const UINT32& block,
     for (UINT32 i(0); i<adjust_.v_blockStationsMap_.at(block).size(); ++i)
     {
         stn = v_blockStations.at(i);
-        mat_idx = adjust_.v_blockStationsMap_.at(block)[stn] * 3;
+        mat_idx = adjust_.BlockStationPosition(block, stn) * 3;
         PrintAdjStation(os, block, stn, mat_idx,
             stationEstimates, stationVariances, 
             recomputeGeographicCoords, updateGeographicCoords,
@@ -42,6 +42,7 @@
 #include <include/measurement_types/dnameasurement.hpp>
 #include <include/measurement_types/dnastation.hpp>
 #include <include/measurement_types/dnagpspoint.hpp>
+#include <include/math/dnamatrix_variance.hpp>
 #include <include/io/dnaiodna.hpp>
 #include <include/functions/dnaiostreamfuncs.hpp>
 #include <include/functions/dnatimer.hpp>
@@ -126,6 +127,8 @@ class DNAADJUST_API DynAdjustPrinter {
     // Utility functions
     void PrintIteration(const UINT32& iteration);
     void PrintAdjustmentTime(cpu_timer& time, int timer_type);
+    void PrintMatrixMemoryUsage();
+    void PrintResidentMemoryUsage();
     void PrintAdjustmentStatus();
     void PrintMeasurementDatabaseID(const it_vmsr_t& it_msr, bool initialise_dbindex = false);
     void PrintAdjMeasurementStatistics(char cardinal, const it_vmsr_t& it_msr, bool initialise_dbindex);
@@ -150,16 +153,16 @@ class DNAADJUST_API DynAdjustPrinter {
     void PrintEstimatedStationCoordinatestoDNAXML(const std::string& stnFile, INPUT_FILE_TYPE t, bool flagUnused = false);
     bool PrintEstimatedStationCoordinatestoSNX(std::string& sinex_filename);
     void PrintCompMeasurements(const UINT32& block, const std::string& type);
-    void PrintPosUncertaintiesUniqueList(std::ostream& os, const v_mat_2d* stationVariances);
+    void PrintPosUncertaintiesUniqueList(std::ostream& os, v_sym_mat* stationVariances);
     void PrintStationCorrectionsList(std::ostream& cor_file);
     void PrintBlockStations(std::ostream& os, const UINT32& block, const matrix_2d* stationEstimates, 
-                           matrix_2d* stationVariances, bool printBlockID, bool recomputeGeographicCoords, 
+                           variance_matrix stationVariances, bool printBlockID, bool recomputeGeographicCoords, 
                            bool updateGeographicCoords, bool printHeader, bool reapplyTypeBUncertainties);
     void PrintOutputFileHeaderInfo();
     void PrintCompMeasurements_GXY(const UINT32& block, it_vmsr_t& _it_msr, UINT32& design_row, printMeasurementsMode printMode);
     void PrintAdjGNSSAlternateUnits(it_vmsr_t& _it_msr, const uint32_uint32_pair& b_pam);
     void UpdateGNSSNstatsForAlternateUnits(const v_uint32_u32u32_pair& msr_block);
-    void PrintStationsUniqueList(std::ostream& os, const v_mat_2d* stationEstimates, v_mat_2d* stationVariances, 
+    void PrintStationsUniqueList(std::ostream& os, const v_mat_2d* stationEstimates, v_sym_mat* stationVariances, 
                                  bool recomputeGeographicCoords, bool updateGeographicCoords, bool reapplyTypeBUncertainties);
     void PrintCompMeasurements_D(it_vmsr_t& _it_msr, UINT32& design_row, bool printIgnored);
     void PrintAdjMeasurements_D(it_vmsr_t& _it_msr);
@@ -183,6 +186,7 @@ class DNAADJUST_API DynAdjustPrinter {
     
     // Stage 3: Statistical and summary generators
     void PrintStatistics(bool printPelzer = true);
+    void PrintEliminatedMeasurements();
     void PrintMeasurementsToStation();
     void PrintCorrelationStations(std::ostream& cor_file, const UINT32& block);
 
@@ -190,11 +194,11 @@ class DNAADJUST_API DynAdjustPrinter {
     template<typename CoordinateType>
     void PrintStationCoordinates(std::ostream& os, const it_vstn_t& stn_it, 
                                 const matrix_2d* estimates = nullptr, 
-                                const matrix_2d* variances = nullptr);
+                                const symmetric_matrix* variances = nullptr);
                                 
     template<typename CoordinateType>
     void PrintStationUncertainties(std::ostream& os, const it_vstn_t& stn_it,
-                                  const matrix_2d* variances, UncertaintyMode mode);
+                                  const symmetric_matrix* variances, UncertaintyMode mode);
 
     // Stage 4: Station file headers
     void PrintStationFileHeader(std::ostream& os, std::string_view file_type, 
@@ -207,15 +211,15 @@ class DNAADJUST_API DynAdjustPrinter {
     // void PrintNetworkStationCorrections(); - Already declared above
     void PrintStationCorrelations(std::ostream& cor_file, const UINT32& block);
     void PrintStationsInBlock(std::ostream& os, const UINT32& block,
-                             const matrix_2d* estimates, const matrix_2d* variances,
+                             const matrix_2d* estimates, const symmetric_matrix* variances,
                              const std::string& stn_coord_types, const UINT16& printStationCorrections);
     void PrintUniqueStationsList(std::ostream& os, 
-                                const matrix_2d* estimates, const matrix_2d* variances,
+                                const matrix_2d* estimates, const symmetric_matrix* variances,
                                 const std::string& stn_coord_types, const UINT16& printStationCorrections);
                                 
     // Enhanced unique stations list processing
     void PrintAdjStationsUniqueList(std::ostream& os,
-                                              const v_mat_2d* stationEstimates, v_mat_2d* stationVariances,
+                                              const v_mat_2d* stationEstimates, v_sym_mat* stationVariances,
                                               bool recomputeGeographicCoords, bool updateGeographicCoords,
                                               bool reapplyTypeBUncertainties);
 
@@ -223,7 +227,7 @@ class DNAADJUST_API DynAdjustPrinter {
     void PrintPositionalUncertaintyOutput();
     void PrintStationAdjustmentResults(std::ostream& os, const UINT32& block,
                                       const UINT32& stn, const UINT32& mat_idx,
-                                      const matrix_2d* estimates, matrix_2d* variances);
+                                      const matrix_2d* estimates, symmetric_matrix* variances);
 
     // Stage 6: Export functions
     void PrintEstimatedStationCoordinatestoDNAXML_Y(const std::string& msrFile, INPUT_FILE_TYPE t);
@@ -233,7 +237,7 @@ class DNAADJUST_API DynAdjustPrinter {
     
     // Enhanced station formatting
     void PrintAdjStation(std::ostream& os, const UINT32& block, const UINT32& stn, const UINT32& mat_idx,
-                        const matrix_2d* stationEstimates, matrix_2d* stationVariances,
+                        const matrix_2d* stationEstimates, variance_matrix stationVariances,
                         bool recomputeGeographicCoords, bool updateGeographicCoords, bool reapplyTypeBUncertainties);
     
     // GPS cluster measurement printing
@@ -246,15 +250,15 @@ class DNAADJUST_API DynAdjustPrinter {
     void PrintCorStationsUniqueList(std::ostream& cor_file);
     void PrintAdjStations(std::ostream& os, const UINT32& block,
                           const matrix_2d* stationEstimates,
-                          matrix_2d* stationVariances, bool printBlockID,
+                          variance_matrix stationVariances, bool printBlockID,
                           bool recomputeGeographicCoords,
                           bool updateGeographicCoords, bool printHeader,
                           bool reapplyTypeBUncertainties);
     void PrintPosUncertaintiesHeader(std::ostream& os);
     void PrintPosUncertainty(std::ostream& os, const UINT32& block, const UINT32& stn, 
-                            const UINT32& mat_idx, const matrix_2d* stationVariances, 
+                            const UINT32& mat_idx, const variance_matrix& stationVariances, 
                             const UINT32& map_idx, const vUINT32* blockStations);
-    void PrintPosUncertainties(std::ostream& os, const UINT32& block, const matrix_2d* stationVariances);
+    void PrintPosUncertainties(std::ostream& os, const UINT32& block, const variance_matrix& stationVariances);
 
     // Stage 4: Enhanced coordinate formatting utilities for PrintAdjStation refactoring
     void PrintStationCoordinatesByType(std::ostream& os, const it_vstn_t& stn_it,
@@ -314,14 +318,14 @@ void DynAdjustPrinter::PrintComputedMeasurements(char cardinal, const double& co
 // Stage 4: Template implementations for station coordinate formatting
 template <typename CoordinateType>
 void DynAdjustPrinter::PrintStationCoordinates(std::ostream& os, const it_vstn_t& stn_it,
-                                               const matrix_2d* estimates, const matrix_2d* variances) {
+                                               const matrix_2d* estimates, const symmetric_matrix* variances) {
     // Default implementation - will be replaced by explicit specializations
     static_assert(sizeof(CoordinateType) == 0, "Must use specialization");
 }
 
 template <typename CoordinateType>
 void DynAdjustPrinter::PrintStationUncertainties(std::ostream& os, const it_vstn_t& stn_it,
-                                                 const matrix_2d* variances, UncertaintyMode mode) {
+                                                 const symmetric_matrix* variances, UncertaintyMode mode) {
     // Default implementation - will be replaced by explicit specializations
     static_assert(sizeof(CoordinateType) == 0, "Must use specialization");
 }
@@ -346,23 +350,23 @@ void DynAdjustPrinter::PrintComputedMeasurements<LinearMeasurement>(char cardina
 // Stage 4: Station coordinate formatting specializations
 template <>
 void DynAdjustPrinter::PrintStationCoordinates<GeographicCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                      const matrix_2d* estimates, const matrix_2d* variances);
+                                                                      const matrix_2d* estimates, const symmetric_matrix* variances);
 
 template <>
 void DynAdjustPrinter::PrintStationCoordinates<CartesianCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                     const matrix_2d* estimates, const matrix_2d* variances);
+                                                                     const matrix_2d* estimates, const symmetric_matrix* variances);
 
 template <>
 void DynAdjustPrinter::PrintStationCoordinates<ProjectionCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                      const matrix_2d* estimates, const matrix_2d* variances);
+                                                                      const matrix_2d* estimates, const symmetric_matrix* variances);
 
 template <>
 void DynAdjustPrinter::PrintStationUncertainties<GeographicCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                        const matrix_2d* variances, UncertaintyMode mode);
+                                                                        const symmetric_matrix* variances, UncertaintyMode mode);
 
 template <>
 void DynAdjustPrinter::PrintStationUncertainties<CartesianCoordinates>(std::ostream& os, const it_vstn_t& stn_it,
-                                                                       const matrix_2d* variances, UncertaintyMode mode);
+                                                                       const symmetric_matrix* variances, UncertaintyMode mode);
 
 // Stage 5: Enhanced measurement formatting template specializations
 template <>
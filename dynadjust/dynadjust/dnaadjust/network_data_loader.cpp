@@ -57,6 +57,12 @@ bool NetworkDataLoader::LoadCommon(vstn_t *bstBinaryRecords, binary_file_meta_t
 
     if (!LoadMeasurements(bmsBinaryRecords, bms_meta, bmsr_count)) { return false; }
 
+    // Ignore measurements eliminated as outliers before they are processed
+    if (bmsBinaryRecords) {
+        for (const auto& record : ignored_records_)
+            if (record < bmsBinaryRecords->size()) bmsBinaryRecords->at(record).ignore = true;
+    }
+
     return true;
 }
 
@@ -91,8 +97,8 @@ bool NetworkDataLoader::LoadForSimultaneous(
     UINT32 &measurementParams, UINT32 &measurementCount, UINT32 &measurementVarianceCount, UINT32 *blockCount,
     vvUINT32 *v_JSL, vUINT32 *v_unknownsCount, vUINT32 *v_measurementCount, vUINT32 *v_measurementVarianceCount,
     vUINT32 *v_measurementParams, vUINT32 *v_ContiguousNetList, std::vector<blockMeta_t> *v_blockMeta,
-    vvUINT32 *v_parameterStationList, vv_stn_appear *v_paramStnAppearance, v_mat_2d *v_junctionVariances,
-    v_mat_2d *v_junctionVariancesFwd) {
+    vvUINT32 *v_parameterStationList, vv_stn_appear *v_paramStnAppearance, v_sym_mat *v_junctionVariances,
+    v_sym_mat *v_junctionVariancesFwd) {
     vUINT32 v_ISLTemp;
     if (!LoadCommon(bstBinaryRecords, bst_meta, vAssocStnList, bmsBinaryRecords, bms_meta, v_ISLTemp, bstn_count,
                     asl_count, bmsr_count, unknownParams, unknownsCount)) {
@@ -335,7 +341,7 @@ void NetworkDataLoader::InitializeSimultaneousModeVectors(
     UINT32 measurementVarianceCount, UINT32 *blockCount, vvUINT32 *v_JSL, vUINT32 *v_unknownsCount,
     vUINT32 *v_measurementCount, vUINT32 *v_measurementVarianceCount, vUINT32 *v_measurementParams,
     vUINT32 *v_ContiguousNetList, std::vector<blockMeta_t> *v_blockMeta, vvUINT32 *v_parameterStationList,
-    vv_stn_appear *v_paramStnAppearance, v_mat_2d *v_junctionVariances, v_mat_2d *v_junctionVariancesFwd) {
+    vv_stn_appear *v_paramStnAppearance, v_sym_mat *v_junctionVariances, v_sym_mat *v_junctionVariancesFwd) {
     // Only initialize if we're in simultaneous mode
     if (settings_.a.adjust_mode != SimultaneousMode) { return; }
 
@@ -38,6 +38,7 @@
 #include <include/io/map_file.hpp>
 #include <include/io/asl_file.hpp>
 #include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
 
 #include "measurement_processor.hpp"
 
@@ -113,8 +114,8 @@ public:
                           std::vector<blockMeta_t>* v_blockMeta,
                           vvUINT32* v_parameterStationList,
                           vv_stn_appear* v_paramStnAppearance,
-                          v_mat_2d* v_junctionVariances,
-                          v_mat_2d* v_junctionVariancesFwd);
+                          v_sym_mat* v_junctionVariances,
+                          v_sym_mat* v_junctionVariancesFwd);
 
   // Constraint application
   void ApplyConstraints(vstn_t& stations, std::string_view station_map_file = "");
@@ -128,6 +129,10 @@ public:
   // Station filtering  
   void RemoveInvalidStations(vUINT32& station_list, const vASL& associated_stations);
 
+  // Binary records to be ignored once loaded, being measurements eliminated
+  // as outliers by a previous adjustment of this network
+  void SetIgnoredRecords(const vUINT32& records) { ignored_records_ = records; }
+
 private:
   // Common loading logic for both modes
   bool LoadCommon(vstn_t *bstBinaryRecords, binary_file_meta_t &bst_meta,
@@ -180,8 +185,8 @@ private:
                                         std::vector<blockMeta_t>* v_blockMeta,
                                         vvUINT32* v_parameterStationList,
                                         vv_stn_appear* v_paramStnAppearance,
-                                        v_mat_2d* v_junctionVariances,
-                                        v_mat_2d* v_junctionVariancesFwd);
+                                        v_sym_mat* v_junctionVariances,
+                                        v_sym_mat* v_junctionVariancesFwd);
 
   const project_settings &settings_;
   std::unique_ptr<dynadjust::iostreams::BstFile> bst_loader_;
@@ -191,6 +196,7 @@ private:
 
   // State for constraint and measurement processing
   bool apply_discontinuities_ = false;
+  vUINT32 ignored_records_;
 };
 
 } // namespace networkadjust
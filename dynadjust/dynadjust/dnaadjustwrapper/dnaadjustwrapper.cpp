@@ -184,6 +184,42 @@ void SerialiseVarianceMatrices(dna_adjust* netAdjust, const project_settings* p)
 }
 	
 
+void SaveGnssInverses(dna_adjust* netAdjust, const project_settings* p)
+{
+	if (!p->g.quiet && p->a.persist_gnss_inverses)
+	{
+		std::cout << "+ Recording GNSS inverse variance matrices... ";
+		std::cout.flush();
+	}
+
+	netAdjust->SaveGnssInverses();
+
+	if (!p->g.quiet && p->a.persist_gnss_inverses)
+	{
+		std::cout << "done." << std::endl;
+		std::cout.flush();
+	}
+}
+	
+
+void SaveIncrementalState(dna_adjust* netAdjust, const project_settings* p)
+{
+	if (!p->g.quiet)
+	{
+		std::cout << "+ Recording the solution for incremental adjustment... ";
+		std::cout.flush();
+	}
+
+	netAdjust->SaveIncrementalState();
+
+	if (!p->g.quiet)
+	{
+		std::cout << "done." << std::endl;
+		std::cout.flush();
+	}
+}
+
+
 void DeserialiseVarianceMatrices(dna_adjust* netAdjust, const project_settings* p)
 {
 	// No need to facilitate serialising if network adjustment is in stage,
@@ -272,6 +308,67 @@ void GenerateStatistics(dna_adjust* netAdjust, const project_settings* p)
 		std::cout << std::endl;
 }
 
+// Eliminates outliers one at a time.  After each elimination, the solution 
+// is recorded apart from the incremental solution and the network is 
+// re-adjusted by a new adjustment, which ignores the eliminated measurements
+// as it loads the unchanged binary files and updates the recorded solution 
+// for them.  Returns false if a re-adjustment raised an exception.
+bool EliminateOutliers(std::unique_ptr<dna_adjust>& netAdjust, project_settings* p)
+{
+	boost::posix_time::milliseconds elapsed_time(boost::posix_time::milliseconds(0));
+	std::vector<eliminatedMsr_t> eliminated;
+	_ADJUST_STATUS_ adjustStatus;
+
+	while (netAdjust->EliminateOutlier())
+	{
+		eliminated = netAdjust->GetEliminatedMeasurements();
+
+		if (!p->g.quiet)
+		{
+			const eliminatedMsr_t& msr(eliminated.back());
+			std::cout << "+ Eliminating outlier " << eliminated.size() << ": " << 
+				msr._measType << " " << msr._station1;
+			if (!msr._station2.empty())
+				std::cout << " " << msr._station2;
+			if (!msr._station3.empty())
+				std::cout << " " << msr._station3;
+			std::cout << " (n-statistic " << std::fixed << std::setprecision(2) << msr._nstat << ")" << std::endl;
+			std::cout.flush();
+		}
+
+		// Record the solution from which the network is re-adjusted
+		netAdjust->SaveIncrementalState(true);
+		netAdjust->CloseOutputFiles();
+
+		netAdjust = std::make_unique<dna_adjust>();
+		netAdjust->SetEliminatedMeasurements(eliminated);
+
+		if (p->a.adjust_mode == PhasedMode)
+			netAdjust->LoadSegmentationFileParameters(p->a.seg_file);
+
+		std::thread progress(dna_adjust_progress_thread(netAdjust.get(), p));
+		dna_adjust_thread(netAdjust.get(), p, &adjustStatus)();
+		progress.join();
+
+		if (adjustStatus == ADJUST_EXCEPTION_RAISED)
+		{
+			netAdjust->RemoveEliminationState();
+			return false;
+		}
+
+		elapsed_time = boost::posix_time::milliseconds(netAdjust->adjustTime().count());
+		PrintSummaryMessage(netAdjust.get(), p, &elapsed_time);
+
+		if (netAdjust->GetStatus() > ADJUST_THRESHOLD_EXCEEDED)
+			break;
+
+		GenerateStatistics(netAdjust.get(), p);
+	}
+
+	netAdjust->RemoveEliminationState();
+	return true;
+}
+
 void PrintAdjustedMeasurements(dna_adjust* netAdjust, const project_settings* p)
 {
 	if (p->o._adj_msr_final)
@@ -583,6 +680,11 @@ int ParseCommandLineOptions(const int& argc, char* argv[], const boost::program_
 		p.a.adjust_mode = SimultaneousMode;		// default
 	else if (vm.count(MODE_PHASED_BLOCK1))
 		p.a.adjust_mode = Phased_Block_1Mode;
+	else if (vm.count(MODE_PHASED_TREE))
+	{
+		p.a.tree_phased = 1;
+		p.a.adjust_mode = PhasedMode;
+	}
 	else if (vm.count(MODE_PHASED_MT))
 	{
 		p.a.multi_thread = 1;
@@ -602,10 +704,12 @@ int ParseCommandLineOptions(const int& argc, char* argv[], const boost::program_
 	else if (p.a.max_iterations < 1)
 		p.a.report_mode = true;
 
-	if (vm.count(STAGED_ADJUSTMENT))
+	// A memory limit implies a staged adjustment
+	if (vm.count(STAGED_ADJUSTMENT) || p.a.memory_limit > 0)
 	{
 		p.a.stage = true;
 		p.a.multi_thread = false;
+		p.a.tree_phased = false;
 		p.a.adjust_mode = PhasedMode;
 		//p.o._output_stn_blocks = true;
 	}
@@ -616,6 +720,30 @@ int ParseCommandLineOptions(const int& argc, char* argv[], const boost::program_
 	//	p.a.inverse_method_msr = p.a.inverse_method_lsq;
 	if (vm.count(SCALE_NORMAL_UNITY))
 		p.a.scale_normals_to_unity = 1;
+	if (vm.count(FROZEN_JACOBIAN))
+		p.a.frozen_jacobian = 1;
+	if (vm.count(RESUME_ADJUSTMENT) && !p.a.report_mode)
+		p.a.resume = 1;
+	if (vm.count(INCREMENTAL_ADJUSTMENT) && !p.a.report_mode)
+		p.a.incremental = 1;
+	if (vm.count(DISCARD_GNSS_INVERSES))
+		p.a.discard_gnss_inverses = 1;
+	// Only retained inverses can be recorded
+	if (vm.count(PERSIST_GNSS_INVERSES) && !p.a.report_mode && !p.a.discard_gnss_inverses)
+		p.a.persist_gnss_inverses = 1;
+	if (vm.count(PERSIST_ELIMINATIONS))
+		p.a.persist_eliminations = 1;
+	// Outliers are eliminated on the statistics of a complete adjustment
+	if (p.a.report_mode || p.a.adjust_mode == Phased_Block_1Mode || p.a.adjust_mode == SimulationMode)
+		p.a.eliminate_outliers = 0;
+	if (p.a.elimination_rule > Eliminate_chisquare)
+		p.a.elimination_rule = Eliminate_nstat;
+	if (p.a.inverse_method_lsq != Cholesky_mixed)
+		p.a.inverse_method_lsq = Cholesky_mkl;
+	if (p.a.lsq_solver > Iterative_pcg)
+		p.a.lsq_solver = Dense_cholesky;
+	if (p.a.station_ordering > Ordering_mindegree)
+		p.a.station_ordering = Ordering_none;
 	if (vm.count(OUTPUT_ADJ_MSR_TSTAT))
 		p.o._adj_msr_tstat = 1;
 	if (vm.count(OUTPUT_ADJ_MSR_DBID))
@@ -695,6 +823,17 @@ int ParseCommandLineOptions(const int& argc, char* argv[], const boost::program_
 				p.o._cor_file += "-stage";
 
 		}
+		else if (p.a.tree_phased)
+		{
+			p.o._adj_file += "-tree";
+			p.o._xyz_file += "-tree";
+			
+			if (vm.count(OUTPUT_POS_UNCERTAINTY))
+				p.o._apu_file += "-tree";
+
+			if (vm.count(OUTPUT_STN_COR_FILE))
+				p.o._cor_file += "-tree";
+		}
 		else if (p.a.multi_thread)
 		{
 			p.o._adj_file += "-mt";
@@ -832,6 +971,10 @@ int main(int argc, char* argv[])
 				"Store adjustment matrices in memory mapped files instead of retaining data in memory.  This option decreases efficiency but may be required if there is insufficient RAM to hold an adjustment in memory.")
 			(MODE_PHASED_MT,
 				"Process forward, reverse and combination adjustments concurrently using all available CPU cores.")
+			(MODE_PHASED_TREE,
+				"Eliminate blocks concurrently over a binary tree of block ranges, passing the normals of junction stations up the tree and solutions back down.  Produces the same rigorous estimates as a sequential phased adjustment.")
+			(ADJUSTMENT_THREADS, boost::program_options::value<UINT16>(&p.a.threads),
+				"Number of threads used to prepare blocks for adjustment, and to run the adjustments of a multi-thread or tree phased adjustment.  0 uses all cores.  Default is 0.")
 			(MODE_PHASED_BLOCK1,
 				"Sequential phased adjustment mode resulting in rigorous estimates for block 1 only.")
 			;
@@ -846,6 +989,24 @@ int main(int argc, char* argv[])
 			(MAX_ITERATIONS, boost::program_options::value<UINT16>(&p.a.max_iterations),
 				(std::string("Maximum number of iterations. Default is ")+
 				StringFromT(p.a.max_iterations)+std::string(".")).c_str())
+			(RESUME_ADJUSTMENT,
+				"Resume an adjustment from the checkpoint written by a previous adjustment of the network (see --checkpoint-interval).  The checkpoint is retained if the previous adjustment was interrupted or exceeded the maximum number of iterations.")
+			(CHECKPOINT_INTERVAL, boost::program_options::value<UINT16>(&p.a.checkpoint_interval),
+				"Record a checkpoint of the station estimates every arg iterations, from which an interrupted adjustment may be resumed (see --resume).  Default is 0 (no checkpoints).")
+			(WARM_START_FILE, boost::program_options::value<std::string>(&p.a.warm_start_file),
+				"Initialise the free stations from the coordinates of a previous adjustment.  arg is the full path to a coordinate output file (.xyz) printed with cartesian coordinates (see --stn-coord-types), or a binary station file (.bst).  Stations not found in the file retain their imported coordinates.")
+			(INCREMENTAL_ADJUSTMENT,
+				"Update the solution of the previous incremental adjustment of the network for the measurements which have since been added, removed or ignored, rather than adjust the network from the beginning.  The solution is recorded on completion of every incremental adjustment.  Simultaneous and (unstaged) phased adjustments only.")
+			(ELIMINATE_OUTLIERS, boost::program_options::value<UINT32>(&p.a.eliminate_outliers),
+				"Eliminate up to arg outliers, one at a time.  On each elimination, the measurement with the largest n-statistic is ignored and the network is re-adjusted incrementally from the solution of the previous adjustment (see --incremental).  Direction sets and GNSS clusters are eliminated as a whole, and non redundant measurements are never eliminated.  The eliminated measurements are listed in the adj file in the order in which they were eliminated.  The binary files are not changed until the final adjustment, and the eliminated measurements are not flagged as ignored in the binary measurement file unless --persist-eliminations is given.")
+			(PERSIST_ELIMINATIONS,
+				"Flag the measurements eliminated as outliers (see --eliminate-outliers) as ignored in the binary measurement file, so that later adjustments of the network also ignore them.")
+			(ELIMINATION_RULE, boost::program_options::value<UINT16>(&p.a.elimination_rule),
+				"Rule by which outlier elimination stops, in addition to the limit given by --eliminate-outliers.\n  0: No n-statistic exceeds the critical value (default)\n  1: Sigma zero no longer exceeds the upper limit of the global chi-square test, or no n-statistic exceeds the critical value")
+			(PERSIST_GNSS_INVERSES,
+				"Record the inverse variance matrices of the GNSS baselines, baseline clusters and point clusters alongside the binary measurement file, so that later adjustments of the network need not re-form them.  Inverses are re-formed for the baselines and clusters which have since changed.")
+			(DISCARD_GNSS_INVERSES,
+				"Form the inverse variance matrix of each GNSS baseline, baseline cluster and point cluster each time it is needed, rather than retain it for later iterations, blocks and threads.  Retained inverses count against --memory-limit, beyond which further inverses are not retained.")
 			(STN_CONSTRAINTS, boost::program_options::value<std::string>(&p.a.station_constraints),
 				"Station constraints. arg is a comma delimited string \"stn1,CCC,stn2,CCF\" defining specific station constraints. These constraints override those contained in the station file.")
 			(FREE_STN_SD, boost::program_options::value<double>(&p.a.free_std_dev),
@@ -856,6 +1017,18 @@ int main(int argc, char* argv[])
 				StringFromT(p.a.fixed_std_dev, 6)+std::string("m.")).c_str())
 			(SCALE_NORMAL_UNITY,
 				"Scale adjustment normal matrices to unity prior to computing inverse to minimise loss of precision caused by tight variances placed on constraint stations.")
+			(LSQ_INVERSE_METHOD, boost::program_options::value<UINT16>(&p.a.inverse_method_lsq),
+				"Method for inverting dense normals.\n  3: Cholesky, double precision (default)\n  4: Cholesky, single precision with iterative refinement of corrections.  Normals are scaled to unity.  Reverts to double precision if refinement does not converge.  Precisions and junction variances are of single precision accuracy.")
+			(LSQ_SOLVER, boost::program_options::value<UINT16>(&p.a.lsq_solver),
+				"Solver for the normal equations in simultaneous adjustments.\n  0: Dense Cholesky inverse (default)\n  1: Sparse Cholesky factorisation\n  2: Preconditioned conjugate gradients.  The normals are not formed, but are applied from the measurements on each iteration.  The residual of the corrections is reduced to one millionth of the iteration threshold, relative to that of the right hand side.  See also --precision-stations.")
+			(PRECISION_STATIONS, boost::program_options::value<std::string>(&p.a.precision_stations),
+				"Stations for which precisions are estimated when the normals are solved by preconditioned conjugate gradients (--lsq-solver 2).  arg is a comma delimited string \"stn1,stn2,stn3\".  The precisions of other stations, and of measurements to them, are not computed.  Default is none, unless covariances between all stations are printed or exported, in which case all precisions are estimated.")
+			(STATION_ORDERING, boost::program_options::value<UINT16>(&p.a.station_ordering),
+				"Order in which stations are arranged in the normals.  Reordering reduces the fill-in and bandwidth of the normals, but does not alter the solution or the order of output.\n  0: Station file order (default)\n  1: Reverse Cuthill-McKee\n  2: Minimum degree")
+			(ASSEMBLY_THREADS, boost::program_options::value<UINT16>(&p.a.assembly_threads),
+				"Number of threads used to form the normal equations of each block.  The solution does not depend on the number of threads.  0 uses all cores.  Default is 1.")
+			(FROZEN_JACOBIAN,
+				"Retain the inverse of the normals formed on the first iteration of a simultaneous adjustment, and update only the measured minus computed vector on subsequent iterations.  The normals are re-formed when corrections stop converging, and prior to computing precisions.")
 			(TYPE_B_GLOBAL, boost::program_options::value<std::string>(&p.a.type_b_global),
 				"Type b uncertainties to be added to each computed uncertainty. arg is a comma delimited string that provides 1D, 2D or 3D uncertainties in the local reference frame (e.g. \"up\" or \"e,n\" or \"e,n,up\").")
 			(TYPE_B_FILE, boost::program_options::value<std::string>(&p.a.type_b_file),
@@ -864,9 +1037,11 @@ int main(int argc, char* argv[])
 
 		staged_adj_options.add_options()
 			(RECREATE_STAGE_FILES,
-				"Recreate memory mapped files.")
+				"Recreate the memory mapped stage file.  Not required if the stage file was created from the network as it is currently imported and segmented.")
 			(PURGE_STAGE_FILES,
 				"Purge memory mapped files from disk upon adjustment completion.")
+			(MEMORY_LIMIT, boost::program_options::value<float>(&p.a.memory_limit),
+				"Memory (in MB) in which the matrices of a staged adjustment may remain resident.  Blocks are kept in memory until the limit is reached, after which the blocks needed furthest in the future are written to the memory mapped files.  The retained GNSS inverses (see --discard-gnss-inverses) count against the limit.  Implies --staged-adjustment.")
 			;
 
 		output_options.add_options()
@@ -1109,7 +1284,7 @@ int main(int argc, char* argv[])
 		return EXIT_FAILURE;
 
 	// Create an instance of the dna_adjust object exposed by the dnaadjust dll
-	dna_adjust netAdjust;
+	std::unique_ptr<dna_adjust> netAdjust(std::make_unique<dna_adjust>());
 
 	// Capture binary file metadata
 	binary_file_meta_t bst_meta, bms_meta;
@@ -1156,6 +1331,8 @@ int main(int argc, char* argv[])
 				std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Recreate mapped stage files: " << "yes" << std::endl;
 			if (p.a.purge_stage_files)
 				std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Purge mapped stage files: " << "yes" << std::endl;
+			if (p.a.memory_limit > 0)
+				std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Memory limit: " << p.a.memory_limit << " MB" << std::endl;
 		}		
 		
 		std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Reference frame: " << datum.GetName() << std::endl;
@@ -1165,6 +1342,47 @@ int main(int argc, char* argv[])
 
 		if (p.a.scale_normals_to_unity)
 			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Scale normals to unity: " << "yes" << std::endl;
+		if (p.a.inverse_method_lsq == Cholesky_mixed)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Normals inverse: " << "mixed precision Cholesky" << std::endl;
+		if (p.a.frozen_jacobian && p.a.adjust_mode == SimultaneousMode)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Frozen Jacobian iterations: " << "yes" << std::endl;
+		if (p.a.resume)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Resume from checkpoint: " << "yes" << std::endl;
+		if (p.a.checkpoint_interval > 0)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Checkpoint interval: " << p.a.checkpoint_interval << " iterations" << std::endl;
+		if (p.a.incremental)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Incremental adjustment: " << "yes" << std::endl;
+		if (p.a.eliminate_outliers > 0)
+		{
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Eliminate outliers: " << "up to " << p.a.eliminate_outliers << std::endl;
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Elimination rule: " << 
+				(p.a.elimination_rule == Eliminate_chisquare ? "sigma zero within chi-square upper limit" : "no n-statistic exceeds critical value") << std::endl;
+			if (p.a.persist_eliminations)
+				std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Persist eliminations: " << "yes" << std::endl;
+		}
+		if (p.a.persist_gnss_inverses)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Persist GNSS inverses: " << "yes" << std::endl;
+		if (p.a.discard_gnss_inverses)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Discard GNSS inverses: " << "yes" << std::endl;
+		if (!p.a.warm_start_file.empty())
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Warm start file: " << safe_absolute_path(p.a.warm_start_file) << std::endl;
+		if (p.a.lsq_solver == Sparse_cholesky && p.a.adjust_mode == SimultaneousMode)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Normals solver: " << "sparse Cholesky" << std::endl;
+		else if (p.a.lsq_solver == Iterative_pcg && p.a.adjust_mode == SimultaneousMode)
+		{
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Normals solver: " << "preconditioned conjugate gradients" << std::endl;
+			if (!p.a.precision_stations.empty())
+				std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Precision stations: " << p.a.precision_stations << std::endl;
+		}
+		if (p.a.station_ordering == Ordering_rcm)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Station ordering: " << "reverse Cuthill-McKee" << std::endl;
+		else if (p.a.station_ordering == Ordering_mindegree)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Station ordering: " << "minimum degree" << std::endl;
+		if (p.a.assembly_threads != 1)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Normals assembly threads: " << 
+				(p.a.assembly_threads == 0 ? std::string("all cores") : StringFromT(p.a.assembly_threads)) << std::endl;
+		if (p.a.threads != 0)
+			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Adjustment threads: " << p.a.threads << std::endl;
 		if (!p.a.station_constraints.empty())
 		{
 			std::cout << std::setw(PRINT_VAR_PAD) << std::left << "  Station constraints: " << p.a.station_constraints << std::endl;
@@ -1190,7 +1408,7 @@ int main(int argc, char* argv[])
 			// Load the segmentation file parameters into the dll, mainly
 			// the segmentation block count, which is used by the progress 
 			// thread before the adjustment begins
-			netAdjust.LoadSegmentationFileParameters(p.a.seg_file);
+			netAdjust->LoadSegmentationFileParameters(p.a.seg_file);
 		}
 	
 		std::cout << std::endl;
@@ -1239,14 +1457,10 @@ int main(int argc, char* argv[])
 			// to reuse memory mapped files created in the previous staged adjustment?
 			if (p.a.stage && !p.a.recreate_stage_files)
 			{
-				// Simply test one file - the estimated stations file
-				std::string est_mmapfile_name =
+				std::string stage_file_name =
 					p.g.output_folder + FOLDER_SLASH + 
-					p.g.network_name + "-est.mtx";
-				std::string est_mmapfile_wildcard =
-					p.g.output_folder + FOLDER_SLASH + 
-					p.g.network_name + "-*.mtx";
-				if (std::filesystem::exists(est_mmapfile_name))
+					p.g.network_name + "-stage.mtx";
+				if (std::filesystem::exists(stage_file_name))
 				{
 					// Has import been run after the segmentation file was created?
 					
@@ -1261,8 +1475,8 @@ int main(int argc, char* argv[])
 					//     then adjust will attempt to load memory map files using the same parameters from the first import
 					//     and segment.
 					//  Hence, force the user to run adjust with the --create-stage-files option.
-					if ((bst_meta_import && (std::filesystem::last_write_time(est_mmapfile_name) < std::filesystem::last_write_time(p.a.bst_file))) ||
-						(bms_meta_import && (std::filesystem::last_write_time(est_mmapfile_name) < std::filesystem::last_write_time(p.a.bms_file))))
+					if ((bst_meta_import && (std::filesystem::last_write_time(stage_file_name) < std::filesystem::last_write_time(p.a.bst_file))) ||
+						(bms_meta_import && (std::filesystem::last_write_time(stage_file_name) < std::filesystem::last_write_time(p.a.bms_file))))
 					{
 						std::cout << std::endl << std::endl << 
 							"- Error: The raw stations and measurements have been imported after" << std::endl <<
@@ -1270,11 +1484,11 @@ int main(int argc, char* argv[])
 						
 						time_t t_bst = file_time_to_time_t(std::filesystem::last_write_time(p.a.bst_file));
 						time_t t_bms = file_time_to_time_t(std::filesystem::last_write_time(p.a.bms_file));
-						time_t t_mtx = file_time_to_time_t(std::filesystem::last_write_time(est_mmapfile_name));
+						time_t t_mtx = file_time_to_time_t(std::filesystem::last_write_time(stage_file_name));
 
 						std::cout << "   " << leafStr<std::string>(p.a.bst_file) << "  last modified on  " << ctime(&t_bst);
 						std::cout << "   " << leafStr<std::string>(p.a.bms_file) << "  last modified on  " << ctime(&t_bms) << std::endl;
-						std::cout << "   " << leafStr<std::string>(est_mmapfile_wildcard) << "  created on  " << ctime(&t_mtx) << std::endl;
+						std::cout << "   " << leafStr<std::string>(stage_file_name) << "  created on  " << ctime(&t_mtx) << std::endl;
 						std::cout << "  To readjust this network, re-run adjust using the " << RECREATE_STAGE_FILES << " option." << std::endl;
 						cout_mutex.unlock();
 						return EXIT_FAILURE;
@@ -1282,9 +1496,12 @@ int main(int argc, char* argv[])
 				}
 			}
 			
-			if (p.a.multi_thread)
+			if (p.a.multi_thread || p.a.tree_phased)
 			{
-				std::cout << std::endl << "+ Optimised for concurrent processing via multi-threading." << std::endl << std::endl;
+				if (p.a.tree_phased)
+					std::cout << std::endl << "+ Optimised for concurrent processing via tree-structured block elimination." << std::endl << std::endl;
+				else
+					std::cout << std::endl << "+ Optimised for concurrent processing via multi-threading." << std::endl << std::endl;
 				std::cout << "+ The active CPU supports the execution of " << std::thread::hardware_concurrency() << " concurrent threads.";
 			}
 			std::cout << std::endl;
@@ -1328,10 +1545,10 @@ int main(int argc, char* argv[])
 		running = true;
 
         int nthreads_la = init_linear_algebra_threads();
-        std::thread progress(dna_adjust_progress_thread(&netAdjust, &p));
+        std::thread progress(dna_adjust_progress_thread(netAdjust.get(), &p));
 
         // Do adjustment using linear algebra threads
-        dna_adjust_thread(&netAdjust, &p, &adjustStatus)(); 
+        dna_adjust_thread(netAdjust.get(), &p, &adjustStatus)(); 
 
         progress.join();
 	
@@ -1346,52 +1563,72 @@ int main(int argc, char* argv[])
 
 		if (p.a.report_mode)
 			// Load variance matrices into memory
-			DeserialiseVarianceMatrices(&netAdjust, &p);
+			DeserialiseVarianceMatrices(netAdjust.get(), &p);
 
-		elapsed_time = boost::posix_time::milliseconds(netAdjust.adjustTime().count());
+		elapsed_time = boost::posix_time::milliseconds(netAdjust->adjustTime().count());
 
 		// Print summary message
-		PrintSummaryMessage(&netAdjust, &p, &elapsed_time);
+		PrintSummaryMessage(netAdjust.get(), &p, &elapsed_time);
 
-		if (netAdjust.GetStatus() > ADJUST_THRESHOLD_EXCEEDED)
+		if (netAdjust->GetStatus() > ADJUST_THRESHOLD_EXCEEDED)
 			return ADJUST_SUCCESS;
 
 		// Generate statistics
-		GenerateStatistics(&netAdjust, &p);
+		GenerateStatistics(netAdjust.get(), &p);
+
+		if (p.a.eliminate_outliers > 0)
+		{
+			// Eliminate outliers, re-adjusting the network after each
+			if (!EliminateOutliers(netAdjust, &p))
+			{
+				running = false;
+				return EXIT_FAILURE;
+			}
+
+			if (netAdjust->GetStatus() > ADJUST_THRESHOLD_EXCEEDED)
+				return ADJUST_SUCCESS;
+		}
+
+		if (p.a.incremental)
+			// Record the solution for the next incremental adjustment
+			SaveIncrementalState(netAdjust.get(), &p);
+
+		// Record the GNSS inverses for later adjustments
+		SaveGnssInverses(netAdjust.get(), &p);
 
 		if (p.a.max_iterations > 0)
 			// Write variance matrices to disk
-			SerialiseVarianceMatrices(&netAdjust, &p);
+			SerialiseVarianceMatrices(netAdjust.get(), &p);
 
 		// Print adjusted measurements to ADJ file
-		PrintAdjustedMeasurements(&netAdjust, &p);
+		PrintAdjustedMeasurements(netAdjust.get(), &p);
 
 		// Print measurements to stations table
-		PrintMeasurementstoStations(&netAdjust, &p);
+		PrintMeasurementstoStations(netAdjust.get(), &p);
 
 		// Print adjusted stations to adj and xyz files
-		PrintAdjustedNetworkStations(&netAdjust, &p);
+		PrintAdjustedNetworkStations(netAdjust.get(), &p);
 
 		// close adj and xyz files
-		netAdjust.CloseOutputFiles();
+		netAdjust->CloseOutputFiles();
 
 		// Print positional uncertainty
-		PrintPositionalUncertainty(&netAdjust, &p);
+		PrintPositionalUncertainty(netAdjust.get(), &p);
 
 		// Print station coordinates
-		PrintStationCorrections(&netAdjust, &p);
+		PrintStationCorrections(netAdjust.get(), &p);
 
 		// Update bst and bms files with adjustment results
-		UpdateBinaryFiles(&netAdjust, &p);
+		UpdateBinaryFiles(netAdjust.get(), &p);
 
 		// Print adjusted stations and measurements to DynaML
-		ExportDynaML(&netAdjust, &p);
+		ExportDynaML(netAdjust.get(), &p);
 
 		// Print adjusted stations and measurements to DNA stn and msr
-		ExportDNA(&netAdjust, &p);
+		ExportDNA(netAdjust.get(), &p);
 
 		// Print adjusted stations and measurements to SINEX
-		ExportSinex(&netAdjust, &p);
+		ExportSinex(netAdjust.get(), &p);
 	}
 	catch (const NetAdjustException& e) {
 		cout_mutex.lock();
@@ -100,6 +100,7 @@ const char* const MODE_SIMULTANEOUS = "simultaneous-adjustment";
 const char* const MODE_SIMULATION = "simulation";
 const char* const MODE_ADJ_REPORT = "report-results";
 const char* const MODE_PHASED_MT = "multi-thread";
+const char* const MODE_PHASED_TREE = "tree-phased";
 
 const char* const COMMENTS = "comments";
 const char* const CONF_INTERVAL = "conf-interval";
@@ -149,8 +150,24 @@ const char* const OUTPUT_ANGULAR_TYPE_STN = "angular-stn-type";
 //const char* const MVAR_INVERSE_METHOD = "msr-inverse-method";
 const char* const LSQ_INVERSE_METHOD = "inversion-method";
 const char* const SCALE_NORMAL_UNITY = "scale-normals-to-unity";
+const char* const LSQ_SOLVER = "lsq-solver";
+const char* const PRECISION_STATIONS = "precision-stations";
+const char* const STATION_ORDERING = "station-ordering";
+const char* const ASSEMBLY_THREADS = "assembly-threads";
+const char* const ADJUSTMENT_THREADS = "threads";
+const char* const FROZEN_JACOBIAN = "frozen-jacobian";
+const char* const RESUME_ADJUSTMENT = "resume";
+const char* const CHECKPOINT_INTERVAL = "checkpoint-interval";
+const char* const WARM_START_FILE = "warm-start-file";
+const char* const INCREMENTAL_ADJUSTMENT = "incremental";
+const char* const ELIMINATE_OUTLIERS = "eliminate-outliers";
+const char* const ELIMINATION_RULE = "elimination-rule";
+const char* const PERSIST_ELIMINATIONS = "persist-eliminations";
+const char* const PERSIST_GNSS_INVERSES = "persist-gnss-inverses";
+const char* const DISCARD_GNSS_INVERSES = "discard-gnss-inverses";
 const char* const PURGE_STAGE_FILES = "purge-stage-files";
 const char* const RECREATE_STAGE_FILES = "create-stage-files";
+const char* const MEMORY_LIMIT = "memory-limit";
 const char* const UPDATE_ORIGINAL_STN_FILE = "update-orig-stn-file";
 
 const char* const SEG_MIN_INNER_STNS = "min-inner-stns";
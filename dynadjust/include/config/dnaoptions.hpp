@@ -66,7 +66,28 @@ enum inverseMethod
 	Cholesky = 0,
 	Gaussian = 1,
 	Sweep = 2,
-	Cholesky_mkl = 3
+	Cholesky_mkl = 3,
+	Cholesky_mixed = 4		// single precision factorisation with iterative refinement
+};
+
+enum lsqSolver
+{
+	Dense_cholesky = 0,
+	Sparse_cholesky = 1,
+	Iterative_pcg = 2		// preconditioned conjugate gradients
+};
+
+enum eliminationRule
+{
+	Eliminate_nstat = 0,		// until no n-statistic exceeds the critical value
+	Eliminate_chisquare = 1		// until sigma zero no longer exceeds the chi-square upper limit
+};
+
+enum stationOrdering
+{
+	Ordering_none = 0,
+	Ordering_rcm = 1,
+	Ordering_mindegree = 2
 };
 
 
@@ -424,13 +445,14 @@ struct adjust_settings : private boost::equality_comparable<adjust_settings> {
 public:
 	adjust_settings()
 		: adjust_mode(SimultaneousMode)
-		, inverse_method_msr(Cholesky_mkl), inverse_method_lsq(Cholesky_mkl)
-		, max_iterations(10), confidence_interval(95.0), report_mode(false), multi_thread(false), stage(false), scale_normals_to_unity(false)
-		, purge_stage_files(false), recreate_stage_files(false)
+		, inverse_method_msr(Cholesky_mkl), inverse_method_lsq(Cholesky_mkl), lsq_solver(Dense_cholesky), station_ordering(Ordering_none)
+		, assembly_threads(1), threads(0), frozen_jacobian(false)
+		, max_iterations(10), confidence_interval(95.0), report_mode(false), resume(false), checkpoint_interval(0), incremental(false), eliminate_outliers(0), elimination_rule(Eliminate_nstat), persist_eliminations(false), persist_gnss_inverses(false), discard_gnss_inverses(false), multi_thread(false), tree_phased(false), stage(false), scale_normals_to_unity(false)
+		, purge_stage_files(false), recreate_stage_files(false), memory_limit(0)
 		, iteration_threshold((float)0.0005), free_std_dev(10.0), fixed_std_dev(PRECISION_1E6), station_constraints("")
 		, map_file(""), bst_file(""), bms_file(""), seg_file(""), comments("") 
 		, command_line_arguments("")
-		, type_b_global (""), type_b_file ("") {}
+		, type_b_global (""), type_b_file (""), warm_start_file (""), precision_stations ("") {}
 
 private:
 	// Disallow use of compiler generated equality operator.
@@ -463,14 +485,39 @@ public:
 											// 3 Simulation
 	UINT16		inverse_method_msr;		// Inverse method for measurement variances
 	UINT16		inverse_method_lsq;		// Inverse method for solution of normal equations
+											// 3 Cholesky (double precision)
+											// 4 Cholesky (single precision, iterative refinement)
+	UINT16		lsq_solver;				// Solver for the normal equations (simultaneous adjustments)
+											// 0 Dense Cholesky inverse
+											// 1 Sparse Cholesky factorisation
+											// 2 Preconditioned conjugate gradients
+	UINT16		station_ordering;		// Ordering of stations in the normals
+											// 0 Station list (binary station file) order
+											// 1 Reverse Cuthill-McKee
+											// 2 Minimum degree
+	UINT16		assembly_threads;		// Number of threads used to form the normals (0 = all cores)
+	UINT16		threads;				// Number of threads used to prepare blocks and run multi-thread phased adjustments (0 = all cores)
+	UINT16		frozen_jacobian;		// Retain the inverse of the normals over iterations (simultaneous adjustments)
 	UINT16		max_iterations;			// Maximum number of iterations
 	float		confidence_interval;	// Confidence interval
 	UINT16		report_mode;			// Print results only
+	UINT16		resume;					// Resume from the checkpoint of a previous adjustment
+	UINT16		checkpoint_interval;	// Number of iterations between checkpoints (0 = no checkpoints)
+	UINT16		incremental;			// Update the solution of a previous adjustment for added and removed measurements
+	UINT32		eliminate_outliers;		// Maximum number of outliers to be eliminated, re-adjusting the network after each (0 = none)
+	UINT16		elimination_rule;		// Rule by which outlier elimination stops
+	UINT16		persist_eliminations;	// Flag the measurements eliminated as outliers as ignored in the binary measurement file
+											// 0 No n-statistic exceeds the critical value
+											// 1 Sigma zero no longer exceeds the chi-square upper limit
+	UINT16		persist_gnss_inverses;	// Record the inverse variance matrices of GNSS measurements alongside the binary measurement file
+	UINT16		discard_gnss_inverses;	// Form the inverse variance matrices of GNSS measurements each time they are needed, rather than retain them
 	UINT16		multi_thread;			// Use multi threading for phased adjustment?
+	UINT16		tree_phased;			// Eliminate phased adjustment blocks on a binary tree?
 	UINT16		stage;					// Instead of loading all phased adjustment blocks in memory, load only the information required for the current block adjustment and 
 	UINT16		scale_normals_to_unity;	// Scale normals to unity prior to inversion
 	bool		purge_stage_files;		// Purge memory mapped files from disk upon adjustment completion.
 	UINT16		recreate_stage_files;	// Recreate memory mapped files.
+	float		memory_limit;			// Memory (MB) in which staged blocks may remain resident (0 = blocks are unloaded after each use)
 	float		iteration_threshold;	// Convergence limit
 	double		free_std_dev;			// SD for free stations
 	double		fixed_std_dev;			// SD for fixed stations
@@ -483,6 +530,8 @@ public:
 	std::string		command_line_arguments;
 	std::string      type_b_global;          // Comma delimited string containing Type b uncertainties to be applied to all uncertainties computed from an adjustment
 	std::string      type_b_file;            // File path to Type b uncertainties to be applied to specific site uncertainties computed from an adjustment
+	std::string      warm_start_file;        // Coordinate (xyz) or binary station file from a previous adjustment, from which the free stations are to be initialised
+	std::string      precision_stations;     // Stations for which precisions are estimated by the iterative solver
 };
 
 // datum and geoid settings
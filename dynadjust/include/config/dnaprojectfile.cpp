@@ -590,6 +590,17 @@ void CDnaProjectFile::InitialiseAdjustSettings()
 				settings_.o._cor_file += "-stage";
 
 		}
+		else if (settings_.a.tree_phased)
+		{
+			settings_.o._adj_file += "-tree";
+			settings_.o._xyz_file += "-tree";
+			
+			if (settings_.o._positional_uncertainty)
+				settings_.o._apu_file += "-tree";
+
+			if (settings_.o._init_stn_corrections)
+				settings_.o._cor_file += "-tree";
+		}
 		else if (settings_.a.multi_thread)
 		{
 			settings_.o._adj_file += "-mt";
@@ -1308,6 +1319,7 @@ void CDnaProjectFile::LoadSettingAdjust(const std::string& var, std::string& val
 		{
 			settings_.a.adjust_mode = SimultaneousMode;
 			settings_.a.multi_thread = false;
+			settings_.a.tree_phased = false;
 			settings_.a.stage = false;
 		}
 		else if (iequals(val, MODE_PHASED))
@@ -1318,11 +1330,13 @@ void CDnaProjectFile::LoadSettingAdjust(const std::string& var, std::string& val
 		{
 			settings_.a.adjust_mode = Phased_Block_1Mode;
 			settings_.a.multi_thread = false;
+			settings_.a.tree_phased = false;
 		}
 		else if (iequals(val, MODE_SIMULATION))
 		{
 			settings_.a.adjust_mode = SimulationMode;
 			settings_.a.multi_thread = false;
+			settings_.a.tree_phased = false;
 			settings_.a.stage = false;
 		}
 	}
@@ -1333,6 +1347,12 @@ void CDnaProjectFile::LoadSettingAdjust(const std::string& var, std::string& val
 			return;
 		settings_.a.multi_thread = yesno_uint<UINT16, std::string>(val);
 	}
+	else if (iequals(var, MODE_PHASED_TREE))
+	{
+		if (val.empty())
+			return;
+		settings_.a.tree_phased = yesno_uint<UINT16, std::string>(val);
+	}
 	else if (iequals(var, STAGED_ADJUSTMENT))
 	{
 		if (val.empty())
@@ -1376,18 +1396,54 @@ void CDnaProjectFile::LoadSettingAdjust(const std::string& var, std::string& val
 			return;
 		settings_.a.fixed_std_dev = DoubleFromString<double>(val);
 	}
-	//else if (iequals(var, LSQ_INVERSE_METHOD))
-	//{
-	//	if (val.empty())
-	//		return;
-	//	settings_.a.inverse_method_lsq = lexical_cast<UINT16, std::string>(val);
-	//}
+	else if (iequals(var, LSQ_INVERSE_METHOD))
+	{
+		if (val.empty())
+			return;
+		settings_.a.inverse_method_lsq = lexical_cast<UINT16, std::string>(val);
+	}
 	else if (iequals(var, SCALE_NORMAL_UNITY))
 	{
 		if (val.empty())
 			return;
 		settings_.a.scale_normals_to_unity = yesno_uint<UINT16, std::string>(val);
 	}
+	else if (iequals(var, LSQ_SOLVER))
+	{
+		if (val.empty())
+			return;
+		settings_.a.lsq_solver = lexical_cast<UINT16, std::string>(val);
+	}
+	else if (iequals(var, PRECISION_STATIONS))
+	{
+		if (val.empty())
+			return;
+		settings_.a.precision_stations = val;
+	}
+	else if (iequals(var, STATION_ORDERING))
+	{
+		if (val.empty())
+			return;
+		settings_.a.station_ordering = lexical_cast<UINT16, std::string>(val);
+	}
+	else if (iequals(var, ASSEMBLY_THREADS))
+	{
+		if (val.empty())
+			return;
+		settings_.a.assembly_threads = lexical_cast<UINT16, std::string>(val);
+	}
+	else if (iequals(var, ADJUSTMENT_THREADS))
+	{
+		if (val.empty())
+			return;
+		settings_.a.threads = lexical_cast<UINT16, std::string>(val);
+	}
+	else if (iequals(var, FROZEN_JACOBIAN))
+	{
+		if (val.empty())
+			return;
+		settings_.a.frozen_jacobian = yesno_uint<UINT16, std::string>(val);
+	}
 	else if (iequals(var, RECREATE_STAGE_FILES))
 	{
 		if (val.empty())
@@ -1400,6 +1456,12 @@ void CDnaProjectFile::LoadSettingAdjust(const std::string& var, std::string& val
 			return;
 		settings_.a.purge_stage_files = yesno_uint<UINT16, std::string>(val) == 1;
 	}
+	else if (iequals(var, MEMORY_LIMIT))
+	{
+		if (val.empty())
+			return;
+		settings_.a.memory_limit = lexical_cast<float, std::string>(val);
+	}
 	else if (iequals(var, TYPE_B_GLOBAL))
 	{
 		if (val.empty())
@@ -1910,6 +1972,8 @@ void CDnaProjectFile::PrintProjectFile()
 
 	PrintRecord(dnaproj_file, MODE_PHASED_MT, 
 		yesno_string(settings_.a.multi_thread));
+	PrintRecord(dnaproj_file, MODE_PHASED_TREE, 
+		yesno_string(settings_.a.tree_phased));
 	PrintRecord(dnaproj_file, STAGED_ADJUSTMENT, 
 		yesno_string(settings_.a.stage));
 	
@@ -1925,14 +1989,22 @@ void CDnaProjectFile::PrintProjectFile()
 	ss << std::scientific << std::setprecision(4) << settings_.a.fixed_std_dev;
 	PrintRecord(dnaproj_file, FIXED_STN_SD, ss.str());										// SD for fixed stations
 	
-	//PrintRecord(dnaproj_file, LSQ_INVERSE_METHOD, settings_.a.inverse_method_lsq);			// Least squares inverse method
+	PrintRecord(dnaproj_file, LSQ_INVERSE_METHOD, settings_.a.inverse_method_lsq);			// Least squares inverse method
 
 	PrintRecord(dnaproj_file, SCALE_NORMAL_UNITY, 
 		yesno_string(settings_.a.scale_normals_to_unity));									// Scale normals to unity before inversion
+	PrintRecord(dnaproj_file, LSQ_SOLVER, settings_.a.lsq_solver);							// Solver for the normal equations
+	PrintRecord(dnaproj_file, PRECISION_STATIONS, settings_.a.precision_stations);			// Stations for which the iterative solver estimates precisions
+	PrintRecord(dnaproj_file, STATION_ORDERING, settings_.a.station_ordering);				// Ordering of stations in the normals
+	PrintRecord(dnaproj_file, ASSEMBLY_THREADS, settings_.a.assembly_threads);				// Threads used to form the normals
+	PrintRecord(dnaproj_file, ADJUSTMENT_THREADS, settings_.a.threads);						// Threads used to prepare and adjust blocks
+	PrintRecord(dnaproj_file, FROZEN_JACOBIAN, 
+		yesno_string(settings_.a.frozen_jacobian));											// Retain the inverse of the normals over iterations
 	PrintRecord(dnaproj_file, RECREATE_STAGE_FILES, 
 		yesno_string(settings_.a.recreate_stage_files));									// Recreate stage files
 	PrintRecord(dnaproj_file, PURGE_STAGE_FILES, 
 		yesno_string(settings_.a.purge_stage_files));										// Purge stage files
+	PrintRecord(dnaproj_file, MEMORY_LIMIT, settings_.a.memory_limit);						// Memory in which staged blocks may remain resident
 
 	PrintRecord(dnaproj_file, TYPE_B_GLOBAL, settings_.a.type_b_global);					// Global Type B uncertainties
 	PrintRecord(dnaproj_file, TYPE_B_FILE, leafStr<std::string>(settings_.a.type_b_file));		// Type B uncertainty file
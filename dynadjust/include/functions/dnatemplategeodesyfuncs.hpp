@@ -37,6 +37,7 @@
 #include <math.h>
 #include <iostream>
 #include <memory>
+#include <cstddef>
 /// \endcond
 
 #include <include/parameters/dnaellipsoid.hpp>
@@ -45,6 +46,22 @@
 
 using namespace dynadjust::datum_parameters;
 
+// Marks the arithmetic loops of the batched (_Batch) functions for 
+// vectorisation.  The build enables 'omp simd' without the OpenMP runtime
+// (-fopenmp-simd, defining DNA_OPENMP_SIMD) where the compiler supports it.
+// These loops contain no calls to libm other than sqrt, which is inlined
+// when errno is not set by maths functions (-fno-math-errno).
+#if (defined(_OPENMP) && _OPENMP >= 201307) || defined(DNA_OPENMP_SIMD)
+#define DNA_PRAGMA_SIMD _Pragma("omp simd")
+#else
+#define DNA_PRAGMA_SIMD
+#endif
+
+// Number of coordinates converted per pass of the batched functions.  The
+// trigonometric functions of each pass are computed (by libm) into buffers 
+// on the stack, separately from the arithmetic loops.
+const std::size_t GEODESY_BATCH_SIZE(64);
+
 // nu helper
 template <class T>
 T primeVertical(const CDnaEllipsoid* ellipsoid, const T& latitude) 
@@ -319,6 +336,188 @@ T PartialD_Latitude_F(const T& X, const T& Y, const T& Z,
 	return PartialD_Latitude(X, Y, Z, element, *latitude, ellipsoid);
 }
 
+//
+// Batched versions of GeoToCart, CartToGeo and CartToLat, which convert
+// count coordinates held as separate (structure of arrays) buffers.  The
+// output buffers may be the same as the input buffers.  Each element is
+// computed with the same operations as the scalar versions.
+//
+template <class T>
+void GeoToCart_Batch(const T* Latitude, const T* Longitude, const T* Height, T* X, T* Y, T* Z, 
+			   const std::size_t& count, const CDnaEllipsoid* ellipsoid)
+{
+	const T a(ellipsoid->GetSemiMajor()), e2(ellipsoid->GetE1sqd());
+	T sin_lat[GEODESY_BATCH_SIZE], cos_lat[GEODESY_BATCH_SIZE];
+	T sin_lon[GEODESY_BATCH_SIZE], cos_lon[GEODESY_BATCH_SIZE];
+	std::size_t i, k, n;
+
+	for (i = 0; i < count; i += n)
+	{
+		n = std::min(count - i, GEODESY_BATCH_SIZE);
+
+		for (k = 0; k < n; ++k)
+		{
+			sin_lat[k] = sin(Latitude[i + k]);
+			cos_lat[k] = cos(Latitude[i + k]);
+			sin_lon[k] = sin(Longitude[i + k]);
+			cos_lon[k] = cos(Longitude[i + k]);
+		}
+
+		DNA_PRAGMA_SIMD
+		for (k = 0; k < n; ++k)
+		{
+			T height(Height[i + k]);
+			T Nu(a / sqrt(1.0 - e2 * (sin_lat[k] * sin_lat[k])));
+
+			X[i + k] = (Nu + height) * cos_lat[k] * cos_lon[k];
+			Y[i + k] = (Nu + height) * cos_lat[k] * sin_lon[k];
+			Z[i + k] = ((Nu * (1. - e2)) + height) * sin_lat[k];
+		}
+	}
+}
+
+
+// One iteration of Lin and Wang's solution for m (see CartToGeo).  Rather
+// than break on convergence, m is left unchanged once converged.  The step
+// is applied arithmetically rather than by a select, since compilers will 
+// not otherwise if-convert (and hence vectorise) the division.
+template <class T>
+inline T CartToGeo_m_iteration(const T& m, const T& p2, const T& Z2, const T& a2, const T& b2)
+{
+	T twom(m * 2.);
+	T a2twom(a2 + twom);
+	T b2twom(b2 + twom);
+	
+	T f((a2 * p2 / (a2twom * a2twom)) + (b2 * Z2 / (b2twom * b2twom)) - 1.);
+	T df(-4. * ((a2 * p2 / (a2twom * a2twom * a2twom)) + (b2 * Z2 / (b2twom * b2twom * b2twom))));
+	T converged(fabs(f) < PRECISION_1E12 ? 0. : 1.);
+	
+	return m - (f / df) * converged;
+}
+
+
+// Lin and Wang's m for a single point (see CartToGeo).  The five iterations
+// are unrolled so that the batched loops which call this are free of 
+// control flow.
+template <class T>
+inline T CartToGeo_m(const T& p2, const T& Z2, const T& a, const T& b)
+{
+	T a2(a * a);
+	T b2(b * b);
+	T a2Z2(a2 * Z2);
+	T b2p2(b2 * p2);
+	T A(a2Z2 + b2p2);
+
+	T m((a * b * sqrt(A) * A - a2 * b2 * A) / (2. *
+		((a2 * a2Z2) + (b2 * b2p2))));
+
+	m = CartToGeo_m_iteration(m, p2, Z2, a2, b2);
+	m = CartToGeo_m_iteration(m, p2, Z2, a2, b2);
+	m = CartToGeo_m_iteration(m, p2, Z2, a2, b2);
+	m = CartToGeo_m_iteration(m, p2, Z2, a2, b2);
+	m = CartToGeo_m_iteration(m, p2, Z2, a2, b2);
+
+	return m;
+}
+
+
+template <class T>
+void CartToGeo_Batch(const T* X, const T* Y, const T* Z, T* latitude, T* longitude, T* height, 
+			   const std::size_t& count, const CDnaEllipsoid* ellipsoid)
+{
+	const T a(ellipsoid->GetSemiMajor()), b(ellipsoid->GetSemiMinor());
+	const T a2(a * a), b2(b * b);
+	T tan_lat[GEODESY_BATCH_SIZE], h[GEODESY_BATCH_SIZE];
+	std::size_t i, k, n;
+
+	for (i = 0; i < count; i += n)
+	{
+		n = std::min(count - i, GEODESY_BATCH_SIZE);
+
+		DNA_PRAGMA_SIMD
+		for (k = 0; k < n; ++k)
+		{
+			T x(X[i + k]), y(Y[i + k]), z(Z[i + k]);
+
+			T p2((x * x) + (y * y));
+			T p(sqrt(p2));
+			T twom(CartToGeo_m(p2, z * z, a, b) * 2.);
+
+			T p_E(a2 * p / (a2 + twom));
+			T Z_E(b2 * z / (b2 + twom));
+
+			tan_lat[k] = a2 * Z_E / (b2 * p_E);
+
+			T hgt(sqrt(((p - p_E) * (p - p_E)) + ((z - Z_E) * (z - Z_E))));
+			h[k] = (p + fabs(z)) < (p_E + fabs(Z_E)) ? -hgt : hgt;
+		}
+
+		for (k = 0; k < n; ++k)
+		{
+			T x(X[i + k]), y(Y[i + k]);
+
+			// determine correct quadrant and apply negative long accordingly
+			T lon(atan(y / x));
+			longitude[i + k] = (x < 0.0 && y > 0.0) ? lon + PI :
+				((x < 0.0 && y < 0.0) ? -(PI - lon) : lon);
+
+			latitude[i + k] = atan(tan_lat[k]);
+			height[i + k] = h[k];
+		}
+	}
+}
+
+
+template <class T>
+void CartToLat_Batch(const T* X, const T* Y, const T* Z, T* latitude, 
+			   const std::size_t& count, const CDnaEllipsoid* ellipsoid)
+{
+	const T a(ellipsoid->GetSemiMajor()), b(ellipsoid->GetSemiMinor());
+	const T a2(a * a), b2(b * b);
+	std::size_t i;
+
+	DNA_PRAGMA_SIMD
+	for (i = 0; i < count; ++i)
+	{
+		T x(X[i]), y(Y[i]), z(Z[i]);
+
+		T p2((x * x) + (y * y));
+		T twom(CartToGeo_m(p2, z * z, a, b) * 2.);
+
+		T p_E(a2 * sqrt(p2) / (a2 + twom));
+		T Z_E(b2 * z / (b2 + twom));
+
+		latitude[i] = a2 * Z_E / (b2 * p_E);
+	}
+
+	for (i = 0; i < count; ++i)
+		latitude[i] = atan(latitude[i]);
+}
+
+
+// Computes the latitude of (X, Y, Z) and its partial derivatives with
+// respect to X, Y and Z (as for PartialD_Latitude_F and PartialD_Latitude),
+// by computing the four latitudes as one batch
+template <class T>
+void PartialD_Latitude_Batch(const T& X, const T& Y, const T& Z,
+			   T* latitude, T* partials, const CDnaEllipsoid* ellipsoid)
+{
+	const T small_inc = PRECISION_1E4;
+
+	T x[4] = { X, X + small_inc, X, X };
+	T y[4] = { Y, Y, Y + small_inc, Y };
+	T z[4] = { Z, Z, Z, Z + small_inc };
+	T lat[4];
+
+	CartToLat_Batch(x, y, z, lat, 4, ellipsoid);
+
+	*latitude = lat[0];
+	partials[x_element] = (lat[1] - lat[0]) / small_inc;
+	partials[y_element] = (lat[2] - lat[0]) / small_inc;
+	partials[z_element] = (lat[3] - lat[0]) / small_inc;
+}
+	
+
 template <class T>
 T PartialD_HorizAngle(const T X1, const T Y1, const T Z1,
 				 const T X2, const T Y2, const T Z2, 
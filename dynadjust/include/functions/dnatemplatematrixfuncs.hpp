@@ -252,9 +252,9 @@ void FormCarttoGeoRotationMatrix_Cluster(const matrix_2d& mpositions, matrix_2d&
 }
 	
 // Assumes design elements for station 1 and station 2 are always
-// -1 and 1 respectively.
-template <class T>
-void Precision_Adjusted_GNSS_bsl(const matrix_2d& mvariances,
+// -1 and 1 respectively.  M is matrix_2d or symmetric_matrix.
+template <class T, class M>
+void Precision_Adjusted_GNSS_bsl(const M& mvariances,
 	const UINT32& stn1, const UINT32& stn2,
 	matrix_2d* mvariances_mod, bool FILLLOWER=true)
 {
@@ -299,23 +299,29 @@ void Precision_Adjusted_GNSS_bsl(const matrix_2d& mvariances,
 }
 
 template <class T>
-void Prpagate_Variances_Geo_Cart(const matrix_2d& mvariances, matrix_2d mrotations, matrix_2d* mvariances_mod, bool FORWARD=true)
+void Prpagate_Variances_Geo_Cart(const matrix_2d& mvariances, const matrix_2d& mrotations, matrix_2d* mvariances_mod, bool FORWARD=true)
 {
 	// the rotation matrix is in the direction geo to cart (forward)
 	// so to go cart to geo, perform inverse
 	if (!FORWARD)
-		mrotations = mrotations.sweepinverse();		// allows negative diagonal terms
+	{
+		matrix_2d mrotations_inv(mrotations);
+		mrotations_inv.sweepinverse();		// allows negative diagonal terms
+		Prpagate_Variances_Geo_Cart<T>(mvariances, mrotations_inv, mvariances_mod);
+		return;
+	}
 	
-	matrix_2d mV(mrotations);
-	//mV.multiply(mvariances);		// original variance matrix
-	mV.multiply("N", mvariances, "N");		// original variance matrix
+	// mvariances may be the same matrix as mvariances_mod, so
+	// R * V must be formed in a separate matrix
+	matrix_2d mV(mrotations.rows(), mvariances.columns());
+	mV.multiply(mrotations, "N", mvariances, "N");		// original variance matrix
 	//mvariances_mod->multiply_square_t(mV, mrotations);
 	mvariances_mod->multiply(mV, "N", mrotations, "T");
 }
 
 
 template <class T>
-void PropagateVariances_GeoCart(const matrix_2d mvariances, matrix_2d* mvariances_mod, 
+void PropagateVariances_GeoCart(const matrix_2d& mvariances, matrix_2d* mvariances_mod, 
 								const T& latitude, const T& longitude, const T& height, 
 								matrix_2d& mrotations, 
 								const CDnaEllipsoid* ellipsoid, bool GEO_TO_CART, bool CALCULATE_ROTATIONS)
@@ -329,7 +335,7 @@ void PropagateVariances_GeoCart(const matrix_2d mvariances, matrix_2d* mvariance
 	
 
 template <class T>
-void PropagateVariances_GeoCart(const matrix_2d mvariances, matrix_2d* mvariances_mod, 
+void PropagateVariances_GeoCart(const matrix_2d& mvariances, matrix_2d* mvariances_mod, 
 								const T& latitude, const T& longitude, const T& height, 
 								const CDnaEllipsoid* ellipsoid, bool GEO_TO_CART)
 {
@@ -367,10 +373,12 @@ void PropagateVariances_GeoCart_Cluster(const matrix_2d& mvariances, matrix_2d*
 }
 	
 template <class T>
-void ScaleMatrix(const matrix_2d mvariances, matrix_2d* mvariances_mod, const matrix_2d& scalars)
+void ScaleMatrix(const matrix_2d& mvariances, matrix_2d* mvariances_mod, const matrix_2d& scalars)
 {
-	//matrix_2d mV(mvariances_mod->multiply(scalars, mvariances));
-	matrix_2d mV(mvariances_mod->multiply(scalars, "N", mvariances, "N"));
+	// mvariances may be the same matrix as mvariances_mod, so
+	// S * V must be formed in a separate matrix
+	matrix_2d mV(scalars.rows(), mvariances.columns());
+	mV.multiply(scalars, "N", mvariances, "N");
 	//mvariances_mod->multiply_square_t(mV, scalars);
 	mvariances_mod->multiply(mV, "N", scalars, "T");
 }
@@ -34,6 +34,7 @@
 
 #include <include/io/dynadjust_file.hpp>
 #include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
 #include <include/measurement_types/dnastntally.hpp>
 #include <include/measurement_types/dnastation.hpp>
 #include <include/measurement_types/dnameasurement.hpp>
@@ -271,7 +272,7 @@ public:
 
 	void SerialiseSinex(std::ofstream* snx_file, pvstn_t bst_records,
 					binary_file_meta_t& bst_meta, binary_file_meta_t& bms_meta,
-					matrix_2d* estimates, matrix_2d* variances, const project_settings& p,
+					matrix_2d* estimates, symmetric_matrix* variances, const project_settings& p,
 					UINT32& measurement_params, UINT32& unknown_params, double& sigma_zero,
 					uint32_uint32_map* block_stations_map, vUINT32* block_stations,
 					const UINT32& block_count, const UINT32& block,
@@ -322,8 +323,8 @@ protected:
 	void SerialiseStatistics(std::ofstream* snx_file);
 	void SerialiseSiteId(std::ofstream* snx_file, pvstn_t bstRecords);
 	void SerialiseSolutionEstimates(std::ofstream* snx_file, pvstn_t bstRecords,
-			matrix_2d* estimates, matrix_2d* variances, const CDnaDatum* datum);
-	void SerialiseSolutionVariances(std::ofstream* snx_file, matrix_2d* variances);
+			matrix_2d* estimates, symmetric_matrix* variances, const CDnaDatum* datum);
+	void SerialiseSolutionVariances(std::ofstream* snx_file, symmetric_matrix* variances);
 	void PrintLine(std::ofstream* snx_file);
 
 	//string format_exponent(std::string value);
@@ -347,11 +347,12 @@ void SegFile::LoadSegFile(const std::string& seg_filename, UINT32& blockCount,
 					sscanf(line+24, format_spec_measr, &m);
 					v_CML.at(b).at(c) = m;
 
-					if (loadMetrics)
+					// Calculate number of 'measurements' in this measurement.  The
+					// segmentation algorithm only includes measurements with the ignore
+					// flag cleared, but measurements may since have been ignored (for
+					// instance, outliers eliminated by adjust)
+					if (loadMetrics && !bmsBinaryRecords->at(m).ignore)
 					{
-						// Calculate number of 'measurements' in this measurement
-						// No need to check for ignored measurement since the segmentation 
-						// algorithm only includes measurements with the ignore flag cleared
 						switch (bmsBinaryRecords->at(m).measType)
 						{
 						case 'G':	// GPS Baseline
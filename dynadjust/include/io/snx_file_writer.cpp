@@ -37,7 +37,7 @@ constexpr size_t kMaxStationNameLength = 4;
 
 void DnaIoSnx::SerialiseSinex(std::ofstream* snx_file, pvstn_t bst_records,
 					binary_file_meta_t& bst_meta, binary_file_meta_t& bms_meta,
-					matrix_2d* estimates, matrix_2d* variances, const project_settings& p,
+					matrix_2d* estimates, symmetric_matrix* variances, const project_settings& p,
 					UINT32& measurement_params, UINT32& unknown_params, double& sigma_zero,
 					uint32_uint32_map* block_stations_map, vUINT32* block_stations,
 					const UINT32& block_count, const UINT32& block,
@@ -264,7 +264,7 @@ void DnaIoSnx::SerialiseStatistics(std::ofstream* snx_file)
 	
 
 void DnaIoSnx::SerialiseSolutionEstimates(std::ofstream* snx_file, pvstn_t bst_records,
-				matrix_2d* estimates, matrix_2d* variances, const CDnaDatum* datum)
+				matrix_2d* estimates, symmetric_matrix* variances, const CDnaDatum* datum)
 {
 	PrintLine(snx_file);
 
@@ -385,14 +385,14 @@ void DnaIoSnx::PrintMatrixIndex(std::ofstream* snx_file, const UINT32& row, cons
 		std::right << std::setw(5) << col + 1 << " ";
 }
 
-void DnaIoSnx::SerialiseSolutionVariances(std::ofstream* snx_file, matrix_2d* variances)
+void DnaIoSnx::SerialiseSolutionVariances(std::ofstream* snx_file, symmetric_matrix* variances)
 {
 	PrintLine(snx_file);
 
 	*snx_file << "+SOLUTION/MATRIX_ESTIMATE L COVA" << std::endl;
 	*snx_file << "*PARA1 PARA2 ____PARA2+0__________ ____PARA2+1__________ ____PARA2+2__________" << std::endl;
 
-	UINT32 row, col, max_dimension(variances->rows());
+	UINT32 row, col, i, max_dimension(variances->rows());
 	std::string floating_value;
 	std::stringstream ss;
 	ss << std::setiosflags(std::ios_base::uppercase | std::ios_base::scientific);
@@ -400,6 +400,17 @@ void DnaIoSnx::SerialiseSolutionVariances(std::ofstream* snx_file, matrix_2d* va
 	bool newRecord(true);
 	UINT16 field(1);
 
+	// Parameters are printed in station order, which may differ from
+	// the order of the stations in the variance matrix
+	vUINT32 mat_idx(max_dimension);
+	for (i=0; i<blockStationsMap_->size(); ++i)
+	{
+		col = (*blockStationsMap_)[blockStations_->at(i)] * 3;
+		mat_idx.at(i*3) = col;
+		mat_idx.at(i*3+1) = col+1;
+		mat_idx.at(i*3+2) = col+2;
+	}
+
 	// Print stations
 	for (row=0; row<max_dimension; ++row)
 	{
@@ -414,7 +425,7 @@ void DnaIoSnx::SerialiseSolutionVariances(std::ofstream* snx_file, matrix_2d* va
 
 			// variance
 			ss.str("");
-			ss << std::setprecision(14) << variances->get(row, col);
+			ss << std::setprecision(14) << variances->get(mat_idx.at(row), mat_idx.at(col));
 			*snx_file << std::right << std::setw(21) << ss.str() << " ";
 			
 			if (row == col || ++field > 3)
@@ -19,10 +19,14 @@
 // Description  : DynAdjust Matrix library
 //============================================================================
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <include/ide/trace.hpp>
 #include <include/math/dnamatrix_contiguous.hpp>
+#include <include/memory/dnabuffer_arena.hpp>
 #include <iomanip>
 #include <sstream>
 
@@ -44,6 +48,10 @@ std::ostream& operator<<(std::ostream& os, const matrix_2d& rhs) {
         os.write(reinterpret_cast<const char*>(&rhs._mem_rows), sizeof(UINT32));
         os.write(reinterpret_cast<const char*>(&rhs._mem_cols), sizeof(UINT32));
 
+        // padding, so that the elements are aligned
+        const UINT32 padding(0);
+        os.write(reinterpret_cast<const char*>(&padding), sizeof(UINT32));
+
         UINT32 c, r;
 
         switch (rhs._matrixType) {
@@ -159,8 +167,9 @@ matrix_2d::matrix_2d(const UINT32& rows, const UINT32& columns, const double dat
             throw std::runtime_error(ss.str());
         }
 
-        // Create memory and store the data
-        allocate(_rows, _cols);
+        // Create memory and store the data.  Since every element is
+        // written (by fillupper), the buffer is not zeroed.
+        buy(_rows, _cols, &_buffer, false);
 
         for (j = 0; j < columns; ++j) {
             memcpy(getelementref(j, j), dataptr, (static_cast<std::size_t>(rows) - j) * sizeof(double));
@@ -184,7 +193,7 @@ matrix_2d::matrix_2d(const UINT32& rows, const UINT32& columns, const double dat
         }
 
         // Create memory and store the data
-        allocate(_rows, _cols);
+        buy(_rows, _cols, &_buffer, false);
         memcpy(_buffer, data, data_size * sizeof(double));
 
         break;
@@ -202,7 +211,8 @@ matrix_2d::matrix_2d(const matrix_2d& newmat)
       _matrixType(newmat.matrixType()) {
     std::set_new_handler(out_of_memory_handler);
 
-    allocate(_mem_rows, _mem_cols);
+    // the buffer is copied in full, so need not be zeroed
+    buy(_mem_rows, _mem_cols, &_buffer, false);
 
     const double* ptr = newmat.getbuffer();
 
@@ -210,14 +220,30 @@ matrix_2d::matrix_2d(const matrix_2d& newmat)
     memcpy(_buffer, ptr, newmat.buffersize());
 }
 
+matrix_2d::matrix_2d(matrix_2d&& newmat) noexcept
+    : _mem_cols(newmat._mem_cols),
+      _mem_rows(newmat._mem_rows),
+      _cols(newmat._cols),
+      _rows(newmat._rows),
+      _buffer(newmat._buffer),
+      _mapping(std::move(newmat._mapping)),
+      _maxvalCol(newmat._maxvalCol),
+      _maxvalRow(newmat._maxvalRow),
+      _matrixType(newmat._matrixType) {
+    // take ownership of the buffer, leaving newmat empty
+    newmat._buffer = nullptr;
+    newmat._mem_rows = newmat._mem_cols = newmat._rows = newmat._cols = 0;
+    newmat._maxvalRow = newmat._maxvalCol = 0;
+}
+
 matrix_2d::~matrix_2d() {
     // Default destructor
     deallocate();
 }
 
 std::size_t matrix_2d::get_size() {
-    size_t size =
-        (7 * sizeof(UINT32));  // UINT32 _matrixType, _mem_cols, _mem_rows, _cols, _rows, _maxvalRow, _maxvalCol
+    // UINT32 _matrixType, _rows, _cols, _mem_rows, _mem_cols, padding, _maxvalRow, _maxvalCol
+    size_t size = (8 * sizeof(UINT32));
 
     switch (_matrixType) {
     case mtx_lower: size += sumOfConsecutiveIntegers(_mem_rows) * sizeof(double); break;
@@ -250,10 +276,13 @@ void matrix_2d::ReadMappedFileRegion(void* addr) {
     default:
         _mem_rows = *data_U++;
         _mem_cols = *data_U++;
+        data_U++;  // padding
         break;
     }
 
-    allocate(_mem_rows, _mem_cols);
+    // A full matrix is read in its entirety, so need not be zeroed
+    deallocate();
+    buy(_mem_rows, _mem_cols, &_buffer, _matrixType != mtx_full);
 
     double* data_d;
     int* data_i;
@@ -320,6 +349,36 @@ void matrix_2d::ReadMappedFileRegion(void* addr) {
     _maxvalCol = *data_U;
 }
 
+// Wrap the elements of a full matrix held in a memory mapped file
+void matrix_2d::MapFileRegion(void* addr, const std::shared_ptr<void>& mapping) {
+    // IMPORTANT
+    // The following must correspond with ReadMappedFileRegion above.
+
+    PUINT32 data_U = reinterpret_cast<PUINT32>(addr);
+    double* data_d = reinterpret_cast<double*>(data_U + 6);
+
+    if (*data_U != mtx_full || reinterpret_cast<std::uintptr_t>(data_d) % alignof(double) != 0) {
+        ReadMappedFileRegion(addr);
+        return;
+    }
+
+    deallocate();
+
+    _matrixType = *data_U++;
+    _rows = *data_U++;
+    _cols = *data_U++;
+    _mem_rows = *data_U++;
+    _mem_cols = *data_U++;
+
+    _buffer = data_d;
+    _mapping = mapping;
+
+    // skip to UINT32 elements
+    data_U = reinterpret_cast<PUINT32>(data_d + static_cast<std::size_t>(_mem_rows) * _mem_cols);
+    _maxvalRow = *data_U++;
+    _maxvalCol = *data_U;
+}
+
 // Write data to memory mapped file
 void matrix_2d::WriteMappedFileRegion(void* addr) {
     // IMPORTANT
@@ -342,6 +401,7 @@ void matrix_2d::WriteMappedFileRegion(void* addr) {
     default:
         *data_U++ = _mem_rows;
         *data_U++ = _mem_cols;
+        *data_U++ = 0;  // padding
         break;
     }
 
@@ -421,8 +481,10 @@ void matrix_2d::allocate(const UINT32& rows, const UINT32& columns) {
     buy(rows, columns, &_buffer);
 }
 
-// creates memory for desired "memory size", not matrix dimensions
-void matrix_2d::buy(const UINT32& rows, const UINT32& columns, double** mem_space) {
+// creates memory for desired "memory size", not matrix dimensions.
+// Buffers are drawn from buffer_arena, and are zeroed unless the caller
+// is about to overwrite every element.
+void matrix_2d::buy(const UINT32& rows, const UINT32& columns, double** mem_space, const bool zero) {
     //_method_ = "buy";
 
     // set globals for new_memory_handler function
@@ -432,21 +494,19 @@ void matrix_2d::buy(const UINT32& rows, const UINT32& columns, double** mem_spac
     // an exception will be thrown by out_of_memory_handler
     // if memory cannot be allocated
     std::size_t total_size = static_cast<std::size_t>(rows) * static_cast<std::size_t>(columns);
-    (*mem_space) = new double[total_size];
-
-    if ((*mem_space) == nullptr) {
-        std::stringstream ss;
-        ss << "Insufficient memory for a " << rows << " x " << columns << " matrix.";
-        throw NetMemoryException(ss.str());
-    }
-
-    // Initialize memory to zero to prevent uninitialized values
-    std::memset((*mem_space), 0, total_size * sizeof(double));
+    (*mem_space) = memory::buffer_arena::instance().acquire(total_size, zero);
 }
 
 void matrix_2d::deallocate() {
+    if (_mapping != nullptr) {
+        // The buffer belongs to the mapped file region
+        _mapping.reset();
+        _buffer = nullptr;
+        return;
+    }
+
     if (_buffer != nullptr) {
-        delete[] _buffer;
+        memory::buffer_arena::instance().release(_buffer);
         _buffer = nullptr;
     }
 }
@@ -458,6 +518,20 @@ matrix_2d matrix_2d::submatrix(const UINT32& row_begin, const UINT32& col_begin,
     return b;
 }
 
+matrix_view matrix_2d::view() const { return matrix_view(_buffer, _rows, _cols, _mem_rows); }
+
+matrix_view matrix_2d::view(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                            const UINT32& columns) const {
+    if (row_begin + rows > _rows || col_begin + columns > _cols) {
+        std::stringstream ss;
+        ss << row_begin + rows << ", " << col_begin + columns << " lies outside the range of the matrix (" << _rows
+           << ", " << _cols << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    return matrix_view(getbuffer(row_begin, col_begin), rows, columns, _mem_rows);
+}
+
 void matrix_2d::submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest, const UINT32& subrows,
                           const UINT32& subcolumns) const {
     if (row_begin >= _rows) {
@@ -543,23 +617,37 @@ void matrix_2d::redim(const UINT32& rows, const UINT32& columns) {
     double* old_buffer = _buffer;
     UINT32 old_rows = _rows;
     UINT32 old_cols = _cols;
+    UINT32 old_mem_rows = _mem_rows;
     
-    // Allocate new buffer
+    // Allocate new buffer.  Only the elements not copied from the old
+    // buffer are zeroed.
     double* new_buffer;
     std::set_new_handler(out_of_memory_handler);
-    buy(rows, columns, &new_buffer);
-    
+    buy(rows, columns, &new_buffer, false);
+
+    UINT32 copy_rows(0), copy_cols(0);
+    if (old_buffer != nullptr) {
+        copy_rows = std::min(old_rows, rows);
+        copy_cols = std::min(old_cols, columns);
+    }
+
     // Copy old data to new buffer if there was any
-    if (old_buffer != nullptr && old_rows > 0 && old_cols > 0) {
-        for (UINT32 col = 0; col < old_cols && col < columns; ++col) {
-            for (UINT32 row = 0; row < old_rows && row < rows; ++row) {
-                new_buffer[col * rows + row] = old_buffer[col * old_rows + row];
-            }
-        }
-        // Delete old buffer
-        delete[] old_buffer;
+    for (UINT32 col = 0; col < copy_cols; ++col) {
+        memcpy(new_buffer + static_cast<std::size_t>(col) * rows,
+               old_buffer + static_cast<std::size_t>(col) * old_mem_rows, copy_rows * sizeof(double));
+        memset(new_buffer + static_cast<std::size_t>(col) * rows + copy_rows, 0,
+               (rows - copy_rows) * sizeof(double));
     }
-    
+    memset(new_buffer + static_cast<std::size_t>(copy_cols) * rows, 0,
+           static_cast<std::size_t>(columns - copy_cols) * rows * sizeof(double));
+
+    // Release old buffer.  If the old buffer was a mapped file region, the
+    // elements have now been copied, so the region is no longer required.
+    if (_mapping != nullptr)
+        _mapping.reset();
+    else if (old_buffer != nullptr)
+        memory::buffer_arena::instance().release(old_buffer);
+
     _buffer = new_buffer;
     
 
@@ -656,6 +744,12 @@ void matrix_2d::copyelements(const UINT32& row_dest, const UINT32& column_dest,
     copyelements(row_dest, column_dest, *src, row_src, column_src, rows, columns);
 }
 
+void matrix_2d::copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_view& src) {
+    for (UINT32 c(0); c < src.columns(); ++c)
+        memcpy(getelementref(row_dest, column_dest + c), &src.get(0, c),
+               static_cast<std::size_t>(src.rows()) * sizeof(double));
+}
+
 void matrix_2d::sweep(UINT32 k1, UINT32 k2) {
     double eps(1.0e-8), d;
     UINT32 i, j, k, it;
@@ -698,14 +792,14 @@ void matrix_2d::sweep(UINT32 k1, UINT32 k2) {
     }  // end for k																	//	} // end for k
 }
 
-matrix_2d matrix_2d::sweepinverse() {
+matrix_2d& matrix_2d::sweepinverse() {
     if (_rows != _cols) throw std::runtime_error("sweepinverse: Matrix is not square.");
 
     sweep(0, _rows);
     return *this;
 }
 
-matrix_2d matrix_2d::cholesky_inverse(bool LOWER_IS_CLEARED /*=false*/) {
+matrix_2d& matrix_2d::cholesky_inverse(bool LOWER_IS_CLEARED /*=false*/) {
     if (_rows < 1) return *this;
     if (_rows != _cols) throw std::runtime_error("cholesky_inverse(): Matrix is not square.");
 
@@ -735,7 +829,7 @@ matrix_2d matrix_2d::cholesky_inverse(bool LOWER_IS_CLEARED /*=false*/) {
     return *this;
 }
 
-matrix_2d matrix_2d::scale(const double& scalar) {
+matrix_2d& matrix_2d::scale(const double& scalar) {
     UINT32 i, j;
     for (i = 0; i < _rows; ++i)
         for (j = 0; j < _cols; ++j) *getelementref(i, j) *= scalar;
@@ -773,6 +867,24 @@ void matrix_2d::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, co
             elementsubtract(i_dest, j_dest, mat_src.get(i_src, j_src));
 }
 
+void matrix_2d::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(i, j));
+}
+
+void matrix_2d::blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementadd(row_dest + j, col_dest + i, mat_src.get(i, j));
+}
+
+void matrix_2d::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementsubtract(row_dest + i, col_dest + j, mat_src.get(i, j));
+}
+
 // clearlower()
 void matrix_2d::clearlower() {
     // Sets lower triangle elements to zero
@@ -850,6 +962,29 @@ matrix_2d& matrix_2d::operator=(const matrix_2d& rhs) {
     return *this;
 }
 
+matrix_2d& matrix_2d::operator=(matrix_2d&& rhs) noexcept {
+    if (this == &rhs) return *this;
+
+    // release this buffer and take ownership of rhs's buffer
+    deallocate();
+    _mapping = std::move(rhs._mapping);
+
+    _mem_rows = rhs._mem_rows;
+    _mem_cols = rhs._mem_cols;
+    _rows = rhs._rows;
+    _cols = rhs._cols;
+    _buffer = rhs._buffer;
+    _maxvalCol = rhs._maxvalCol;
+    _maxvalRow = rhs._maxvalRow;
+    _matrixType = rhs._matrixType;
+
+    rhs._buffer = nullptr;
+    rhs._mem_rows = rhs._mem_cols = rhs._rows = rhs._cols = 0;
+    rhs._maxvalRow = rhs._maxvalCol = 0;
+
+    return *this;
+}
+
 // Multiplication operator
 matrix_2d matrix_2d::operator*(const double& rhs) const {
     // Answer
@@ -861,7 +996,7 @@ matrix_2d matrix_2d::operator*(const double& rhs) const {
     return m;
 }
 
-matrix_2d matrix_2d::add(const matrix_2d& rhs) {
+matrix_2d& matrix_2d::add(const matrix_2d& rhs) {
     if (_rows != rhs.rows() || _cols != rhs.columns())
         throw std::runtime_error("add: Result matrix dimensions are incompatible.");
 
@@ -874,7 +1009,7 @@ matrix_2d matrix_2d::add(const matrix_2d& rhs) {
 
 // multiplies this matrix by rhs and stores the result in a new matrix
 // Uses Intel MKL dgemm
-matrix_2d matrix_2d::multiply(const char* lhs_trans, const matrix_2d& rhs, const char* rhs_trans) {
+matrix_2d& matrix_2d::multiply(const char* lhs_trans, const matrix_2d& rhs, const char* rhs_trans) {
     matrix_2d m(_rows, rhs.columns());
 
     const double one = 1.0;
@@ -907,12 +1042,13 @@ matrix_2d matrix_2d::multiply(const char* lhs_trans, const matrix_2d& rhs, const
     BLAS_FUNC(dgemm)(CblasColMajor, tA, tB, lhs_rows, rhs_cols, lhs_cols, 1.0, _buffer, _mem_rows, rhs.getbuffer(),
                      rhs.memRows(), 0.0, m.getbuffer(), m.memRows());
 
-    return (*this = m);
+    *this = std::move(m);
+    return *this;
 }
 
 // Multiplies lhs by rhs and stores the result in this.
 // Uses Intel MKL dgemm
-matrix_2d
+matrix_2d&
 matrix_2d::multiply(const matrix_2d& lhs, const char* lhs_trans, const matrix_2d& rhs, const char* rhs_trans) {
     const double one = 1.0;
     const double zero = 0.0;
@@ -948,7 +1084,7 @@ matrix_2d::multiply(const matrix_2d& lhs, const char* lhs_trans, const matrix_2d
 }  // Multiply()
 
 // Transpose()
-matrix_2d matrix_2d::transpose(const matrix_2d& matA) {
+matrix_2d& matrix_2d::transpose(const matrix_2d& matA) {
     if ((matA.columns() != _rows) || (matA.rows() != _cols))
         throw std::runtime_error("transpose: Matrix dimensions are incompatible.");
 
@@ -959,7 +1095,7 @@ matrix_2d matrix_2d::transpose(const matrix_2d& matA) {
 }  // Transpose()
 
 // Transpose()
-matrix_2d matrix_2d::transpose() {
+matrix_2d matrix_2d::transpose() const {
     matrix_2d m(_cols, _rows);
     UINT32 column, row;
     for (row = 0; row < _rows; row++)
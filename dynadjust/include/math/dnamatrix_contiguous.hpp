@@ -24,6 +24,7 @@
 
 /// \cond
 #include <cstring>
+#include <memory>
 /// \endcond
 
 #include <include/config/dnatypes.hpp>
@@ -195,6 +196,30 @@ typedef std::vector<v_mat_2d> vv_mat_2d;
 
 template <typename T> std::size_t byteSize(const UINT32 elements = 1) { return elements * sizeof(T); }
 
+// matrix_view is a non-owning, read-only view of a region of a matrix_2d
+// (see matrix_2d::view), which allows sub-matrices to be passed to blockadd,
+// copyelements, etc. without copying them to a temporary matrix.  A view
+// is only valid whilst the matrix it refers to is neither redimensioned
+// nor destroyed.
+class matrix_view {
+  public:
+    matrix_view(const double* buffer, const UINT32& rows, const UINT32& columns, const UINT32& mem_rows)
+        : _buffer(buffer), _rows(rows), _cols(columns), _mem_rows(mem_rows) {}
+
+    inline UINT32 rows() const { return _rows; }
+    inline UINT32 columns() const { return _cols; }
+
+    inline const double& get(const UINT32& row, const UINT32& column) const {
+        return DNAMATRIX_ELEMENT(_buffer, _mem_rows, _cols, row, column);
+    }
+
+  private:
+    const double* _buffer;  // first element of the region
+    UINT32 _rows;
+    UINT32 _cols;
+    UINT32 _mem_rows;       // leading dimension of the viewed matrix
+};
+
 class matrix_2d : public new_handler_support<matrix_2d> {
   public:
     // Constructors/deconstructors
@@ -202,8 +227,9 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     matrix_2d(const UINT32& rows, const UINT32& columns); // explicit constructor
     matrix_2d(const UINT32& rows, const UINT32& columns, const double data[], const std::size_t& data_size,
               const UINT32& matrix_type = mtx_full);
-    matrix_2d(const matrix_2d&); // copy constructor
-    ~matrix_2d();                // destructor
+    matrix_2d(const matrix_2d&);     // copy constructor
+    matrix_2d(matrix_2d&&) noexcept; // move constructor
+    ~matrix_2d();                    // destructor
 
     inline bool empty() { return _buffer == nullptr; }
 
@@ -231,6 +257,11 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     matrix_2d
     submatrix(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows, const UINT32& columns) const;
 
+    // Non-owning views of this matrix, or a region of it
+    matrix_view view() const;
+    matrix_view view(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                     const UINT32& columns) const;
+
     inline double maxvalue() const { return get(_maxvalRow, _maxvalCol); }
     inline UINT32 maxvalueRow() const { return _maxvalRow; }
     inline UINT32 maxvalueCol() const { return _maxvalCol; }
@@ -261,6 +292,7 @@ class matrix_2d : public new_handler_support<matrix_2d> {
                       const UINT32& column_src, const UINT32& rows, const UINT32& columns);
     void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d* src, const UINT32& row_src,
                       const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_view& src);
 
     inline void elementadd(const UINT32& row, const UINT32& column, const double& increment) {
         *getelementref(row, column) += increment;
@@ -281,19 +313,25 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
                        const UINT32& col_src, const UINT32& rows, const UINT32& cols);
 
-    matrix_2d add(const matrix_2d& rhs);
-    matrix_2d add(const matrix_2d& lhs, const matrix_2d& rhs);
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+    void blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+    void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+
+    // The following operate on (and return a reference to) this matrix
+    matrix_2d& add(const matrix_2d& rhs);
+
+    matrix_2d& multiply(const char* lhs_trans, const matrix_2d& rhs, const char* rhs_trans); // multiplication
+    matrix_2d& multiply(const matrix_2d& lhs, const char* lhs_trans, const matrix_2d& rhs,
+                        const char* rhs_trans); // multiplication
 
-    matrix_2d multiply(const char* lhs_trans, const matrix_2d& rhs, const char* rhs_trans); // multiplication
-    matrix_2d multiply(const matrix_2d& lhs, const char* lhs_trans, const matrix_2d& rhs,
-                       const char* rhs_trans); // multiplication
+    matrix_2d& sweepinverse();                                  // Sweep inverse (good for rotation matrices)
+    matrix_2d& cholesky_inverse(bool LOWER_IS_CLEARED = false); // Cholesky inverse
 
-    matrix_2d sweepinverse();                                  // Sweep inverse (good for rotation matrices)
-    matrix_2d cholesky_inverse(bool LOWER_IS_CLEARED = false); // Cholesky inverse
+    matrix_2d& transpose(const matrix_2d&); // Transpose
+    matrix_2d& scale(const double& scalar); // scale
 
-    matrix_2d transpose(const matrix_2d&); // Transpose
-    matrix_2d transpose();                 //  ''
-    matrix_2d scale(const double& scalar); // scale
+    // Returns a new matrix
+    matrix_2d transpose() const;            // Transpose
 
     // overloaded operators
     // equality
@@ -339,6 +377,7 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     }
 
     matrix_2d& operator=(const matrix_2d& rhs);
+    matrix_2d& operator=(matrix_2d&& rhs) noexcept;
     matrix_2d operator*(const double& rhs) const;
     //
     // Initialisation / manipulation
@@ -366,9 +405,21 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     // Reading from memory mapped file
     void ReadMappedFileRegion(void* addr);
 
+    // Wraps the elements held in a memory mapped file region, rather than
+    // copying them to a new buffer.  mapping keeps the region mapped until
+    // the matrix is deallocated, or until redim exceeds the mapped size, in
+    // which case the elements are copied to a new buffer.  For a copy on
+    // write mapping, changes to the elements are not written to the file,
+    // so the matrix behaves as if it were read.  Matrices that are not
+    // full, or whose elements are not aligned, are read.
+    void MapFileRegion(void* addr, const std::shared_ptr<void>& mapping);
+    inline bool mapped() const { return _mapping != nullptr; }
+
     // Writing to memory mapped file
     void WriteMappedFileRegion(void* addr);
 
+    void deallocate();
+
     // debug
 #ifdef _MSDEBUG
     void trace(const std::string& comment, const std::string& format) const;
@@ -381,8 +432,7 @@ class matrix_2d : public new_handler_support<matrix_2d> {
         return static_cast<std::size_t>(_mem_rows) * static_cast<std::size_t>(_mem_cols) * sizeof(double);
     }
 
-    void deallocate();
-    void buy(const UINT32& rows, const UINT32& columns, double** mem_space);
+    void buy(const UINT32& rows, const UINT32& columns, double** mem_space, const bool zero = true);
     void copybuffer(const UINT32& rows, const UINT32& columns, const matrix_2d& oldmat);
     void copybuffer(const UINT32& rowstart, const UINT32& columnstart, const UINT32& rows, const UINT32& columns,
                     const matrix_2d& mat);
@@ -395,6 +445,7 @@ class matrix_2d : public new_handler_support<matrix_2d> {
     UINT32 _cols;     // number of actual cols
     UINT32 _rows;     // number of actual rows
     double* _buffer;  // matrix buffer elements
+    std::shared_ptr<void> _mapping; // mapped file region holding _buffer (see MapFileRegion)
 
     UINT32 _maxvalCol; // col of max value
     UINT32 _maxvalRow; // row of max value
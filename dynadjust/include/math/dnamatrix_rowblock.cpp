@@ -0,0 +1,411 @@
+//============================================================================
+// Name         : dnamatrix_rowblock.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust compressed row-block matrix library
+//============================================================================
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <include/math/dnamatrix_rowblock.hpp>
+
+namespace dynadjust {
+namespace math {
+
+std::ostream& operator<<(std::ostream& os, const rowblock_matrix& rhs) {
+    // ASCII output (dense), consistent with matrix_2d
+    os << rhs._storage << " " << rhs._rows << " " << rhs._cols << " " << rhs._mem_rows << " " << rhs._mem_cols
+       << std::endl;
+
+    for (UINT32 c, r = 0; r < rhs._rows; ++r) {
+        for (c = 0; c < rhs._cols; ++c) os << std::scientific << std::setprecision(16) << rhs.get(r, c) << " ";
+        os << std::endl;
+    }
+    os << std::endl;
+    return os;
+}
+
+rowblock_matrix::rowblock_matrix()
+    : _rows(0), _cols(0), _mem_rows(0), _mem_cols(0), _storage(blk_rows) {}
+
+rowblock_matrix::rowblock_matrix(const UINT32& rows, const UINT32& columns, const blockStorage& storage)
+    : _rows(rows), _cols(columns), _mem_rows(rows), _mem_cols(columns), _storage(storage) {
+    allocate();
+}
+
+void rowblock_matrix::storage(const blockStorage& storage) {
+    if (storage == _storage) return;
+
+    // Re-arrange any elements held into the new orientation
+    std::vector<line_t> lines;
+    lines.swap(_lines);
+    _storage = storage;
+    allocate();
+
+    UINT32 l, e;
+    for (l = 0; l < lines.size(); ++l)
+        for (const auto& blk : lines.at(l))
+            for (e = 0; e < 3; ++e) {
+                if (blk.value[e] == 0.0) continue;
+                if (_storage == blk_rows)
+                    put(blk.index * 3 + e, l, blk.value[e]);
+                else
+                    put(l, blk.index * 3 + e, blk.value[e]);
+            }
+}
+
+std::size_t rowblock_matrix::nonzeroBlocks() const {
+    std::size_t count(0);
+    for (const auto& l : _lines) count += l.size();
+    return count;
+}
+
+std::size_t rowblock_matrix::memorySize() const {
+    std::size_t bytes(_lines.capacity() * sizeof(line_t));
+    for (const auto& l : _lines) bytes += l.capacity() * sizeof(block3);
+    return bytes;
+}
+
+void rowblock_matrix::allocate() {
+    deallocate();
+    _lines.resize(_storage == blk_rows ? _mem_rows : _mem_cols);
+}
+
+void rowblock_matrix::deallocate() { std::vector<line_t>().swap(_lines); }
+
+void rowblock_matrix::redim(const UINT32& rows, const UINT32& columns) {
+    // As for matrix_2d, retain the elements that lie within the new
+    // dimensions, and zero the rest
+    const UINT32 line_end(_storage == blk_rows ? rows : columns), elem_end(_storage == blk_rows ? columns : rows);
+
+    if (_lines.size() > line_end) _lines.resize(line_end);
+
+    UINT32 e;
+    for (auto& l : _lines) {
+        l.erase(std::remove_if(l.begin(), l.end(), [&elem_end](const block3& blk) { return blk.index * 3 >= elem_end; }),
+                l.end());
+        if (!l.empty())
+            for (e = 0; e < 3; ++e)
+                if (l.back().index * 3 + e >= elem_end) l.back().value[e] = 0.0;
+    }
+
+    if (rows > _mem_rows || columns > _mem_cols) {
+        _mem_rows = rows;
+        _mem_cols = columns;
+    }
+
+    _lines.resize(_storage == blk_rows ? _mem_rows : _mem_cols);
+
+    _rows = rows;
+    _cols = columns;
+}
+
+void rowblock_matrix::setsize(const UINT32& rows, const UINT32& columns) {
+    deallocate();
+    _rows = _mem_rows = rows;
+    _cols = _mem_cols = columns;
+}
+
+void rowblock_matrix::shrink(const UINT32& rows, const UINT32& columns) {
+    if (rows > _rows || columns > _cols) {
+        std::stringstream ss;
+        ss << " " << std::endl;
+        if (rows >= _rows)
+            ss << "    Cannot shrink by " << rows << " rows on a matrix of " << _rows << " rows. " << std::endl;
+        if (columns >= _cols)
+            ss << "    Cannot shrink by " << columns << " columns on a matrix of " << _cols << " columns.";
+        throw std::runtime_error(ss.str());
+    }
+
+    _rows -= rows;
+    _cols -= columns;
+}
+
+void rowblock_matrix::grow(const UINT32& rows, const UINT32& columns) {
+    if ((rows + _rows) > _mem_rows || (columns + _cols) > _mem_cols) {
+        std::stringstream ss;
+        ss << " " << std::endl;
+        if (rows >= _rows)
+            ss << "    Cannot grow matrix by " << rows << " rows: growth exceeds row memory limit (" << _mem_rows
+               << ").";
+        if (columns >= _cols)
+            ss << "    Cannot grow matrix by " << columns << " columns: growth exceeds column memory limit ("
+               << _mem_cols << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    _rows += rows;
+    _cols += columns;
+}
+
+const double* rowblock_matrix::find(const UINT32& line, const UINT32& elem) const {
+    const line_t& l(_lines.at(line));
+    const UINT32 index(elem / 3);
+
+    // Lines hold very few blocks, so a linear search is quicker
+    // than a binary search
+    for (const auto& blk : l) {
+        if (blk.index == index) return &blk.value[elem % 3];
+        if (blk.index > index) break;
+    }
+    return nullptr;
+}
+
+double* rowblock_matrix::find(const UINT32& line, const UINT32& elem) {
+    return const_cast<double*>(static_cast<const rowblock_matrix*>(this)->find(line, elem));
+}
+
+double& rowblock_matrix::findorinsert(const UINT32& line, const UINT32& elem) {
+    line_t& l(_lines.at(line));
+    const UINT32 index(elem / 3);
+
+    line_t::iterator it(l.begin());
+    for (; it != l.end(); ++it) {
+        if (it->index == index) return it->value[elem % 3];
+        if (it->index > index) break;
+    }
+
+    it = l.insert(it, block3{index, {0.0, 0.0, 0.0}});
+    return it->value[elem % 3];
+}
+
+double rowblock_matrix::get(const UINT32& row, const UINT32& column) const {
+    const double* value(find(lineIdx(row, column), elemIdx(row, column)));
+    return value == nullptr ? 0.0 : *value;
+}
+
+void rowblock_matrix::getblock(const UINT32& row, const UINT32& column, double* block) const {
+    const double* value(find(lineIdx(row, column), elemIdx(row, column)));
+    if (value == nullptr) {
+        block[0] = block[1] = block[2] = 0.0;
+        return;
+    }
+    block[0] = value[0];
+    block[1] = value[1];
+    block[2] = value[2];
+}
+
+bool rowblock_matrix::blockrange(const UINT32& line, UINT32& first, UINT32& last) const {
+    const line_t& l(_lines.at(line));
+    if (l.empty()) return false;
+
+    // blocks are held in order of index
+    first = l.front().index;
+    last = l.back().index;
+    return true;
+}
+
+void rowblock_matrix::put(const UINT32& row, const UINT32& column, const double& value) {
+    if (value == 0.0) {
+        // Don't create a block to hold zero
+        double* element(find(lineIdx(row, column), elemIdx(row, column)));
+        if (element != nullptr) *element = 0.0;
+        return;
+    }
+    findorinsert(lineIdx(row, column), elemIdx(row, column)) = value;
+}
+
+void rowblock_matrix::elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+    if (increment == 0.0) return;
+    findorinsert(lineIdx(row, column), elemIdx(row, column)) += increment;
+}
+
+void rowblock_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                               const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols) {
+    UINT32 i, j;
+    for (i = 0; i < rows; ++i)
+        for (j = 0; j < cols; ++j) elementadd(row_dest + i, col_dest + j, mat_src.get(row_src + i, col_src + j));
+}
+
+void rowblock_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d& src,
+                                   const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                   const UINT32& columns) {
+    UINT32 i, j;
+    for (j = 0; j < columns; ++j)
+        for (i = 0; i < rows; ++i) put(row_dest + i, column_dest + j, src.get(row_src + i, column_src + j));
+}
+
+void rowblock_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d* src,
+                                   const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                   const UINT32& columns) {
+    copyelements(row_dest, column_dest, *src, row_src, column_src, rows, columns);
+}
+
+void rowblock_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix& src,
+                                   const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                   const UINT32& columns) {
+    UINT32 i, j;
+    for (j = 0; j < columns; ++j)
+        for (i = 0; i < rows; ++i) put(row_dest + i, column_dest + j, src.get(row_src + i, column_src + j));
+}
+
+void rowblock_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix* src,
+                                   const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                   const UINT32& columns) {
+    copyelements(row_dest, column_dest, *src, row_src, column_src, rows, columns);
+}
+
+void rowblock_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(i, j));
+}
+
+void rowblock_matrix::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementadd(row_dest + i, col_dest + j, -mat_src.get(i, j));
+}
+
+void rowblock_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_view& src) {
+    UINT32 i, j;
+    for (j = 0; j < src.columns(); ++j)
+        for (i = 0; i < src.rows(); ++i) put(row_dest + i, column_dest + j, src.get(i, j));
+}
+
+void rowblock_matrix::replace(const UINT32& rowstart, const UINT32& columnstart, const matrix_2d& newmat) {
+    if (rowstart + newmat.rows() > _rows || columnstart + newmat.columns() > _cols) {
+        std::stringstream ss;
+        ss << " " << std::endl;
+        if (rowstart + newmat.rows() > _rows)
+            ss << "    Row index " << rowstart + newmat.rows() << " exceeds the matrix row count (" << _rows << "). "
+               << std::endl;
+        if (columnstart + newmat.columns() > _cols)
+            ss << "    Column index " << columnstart + newmat.columns() << " exceeds the matrix column count (" << _cols
+               << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    copyelements(rowstart, columnstart, newmat, 0, 0, newmat.rows(), newmat.columns());
+}
+
+void rowblock_matrix::checkrange(const UINT32& row, const UINT32& column, const UINT32& rows,
+                                 const UINT32& columns) const {
+    if (row >= _rows || column >= _cols || row + rows > _rows || column + columns > _cols) {
+        std::stringstream ss;
+        ss << row + rows << ", " << column + columns << " lies outside the range of the matrix (" << _rows << ", "
+           << _cols << ").";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+matrix_2d rowblock_matrix::submatrix(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                                     const UINT32& columns) const {
+    matrix_2d b(rows, columns);
+    submatrix(row_begin, col_begin, &b, rows, columns);
+    return b;
+}
+
+void rowblock_matrix::submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest,
+                                const UINT32& subrows, const UINT32& subcolumns) const {
+    checkrange(row_begin, col_begin, subrows, subcolumns);
+
+    if (subrows > dest->rows() || subcolumns > dest->columns()) {
+        std::stringstream ss;
+        ss << subrows << ", " << subcolumns << " exceeds the size of the matrix (" << dest->rows() << ", "
+           << dest->columns() << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    dest->zero(0, 0, subrows, subcolumns);
+
+    // Scatter the blocks that lie within the sub-matrix
+    const UINT32 line_begin(lineIdx(row_begin, col_begin)), line_end(line_begin + lineIdx(subrows, subcolumns));
+    const UINT32 elem_begin(elemIdx(row_begin, col_begin)), elem_end(elem_begin + elemIdx(subrows, subcolumns));
+    UINT32 l, e, elem;
+
+    for (l = line_begin; l < line_end; ++l)
+        for (const auto& blk : _lines.at(l)) {
+            if ((blk.index + 1) * 3 <= elem_begin) continue;
+            if (blk.index * 3 >= elem_end) break;
+
+            for (e = 0; e < 3; ++e) {
+                elem = blk.index * 3 + e;
+                if (elem < elem_begin || elem >= elem_end) continue;
+                if (_storage == blk_rows)
+                    dest->put(l - line_begin, elem - elem_begin, blk.value[e]);
+                else
+                    dest->put(elem - elem_begin, l - line_begin, blk.value[e]);
+            }
+        }
+}
+
+void rowblock_matrix::zero() {
+    for (auto& l : _lines) l.clear();
+}
+
+void rowblock_matrix::zero(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                           const UINT32& columns) {
+    const UINT32 line_begin(lineIdx(row_begin, col_begin)), line_end(line_begin + lineIdx(rows, columns));
+    const UINT32 elem_begin(elemIdx(row_begin, col_begin)), elem_end(elem_begin + elemIdx(rows, columns));
+    UINT32 l, e, elem;
+
+    for (l = line_begin; l < line_end; ++l) {
+        line_t& line(_lines.at(l));
+        for (auto& blk : line)
+            for (e = 0; e < 3; ++e) {
+                elem = blk.index * 3 + e;
+                if (elem >= elem_begin && elem < elem_end) blk.value[e] = 0.0;
+            }
+
+        // Release blocks that lie entirely within the range
+        line.erase(std::remove_if(line.begin(), line.end(),
+                                  [&elem_begin, &elem_end](const block3& blk) {
+                                      return blk.index * 3 >= elem_begin && blk.index * 3 + 3 <= elem_end;
+                                  }),
+                   line.end());
+    }
+}
+
+void rowblock_matrix::multiply(const matrix_2d& rhs, matrix_2d& result) const {
+    if (_cols != rhs.rows() || result.rows() != _rows || result.columns() != rhs.columns()) {
+        std::stringstream ss;
+        ss << "Cannot multiply a " << _rows << " x " << _cols << " matrix by a " << rhs.rows() << " x "
+           << rhs.columns() << " matrix to form a " << result.rows() << " x " << result.columns() << " matrix.";
+        throw std::runtime_error(ss.str());
+    }
+
+    result.zero();
+
+    const UINT32 lines(lineCount()), elems(elemCount());
+    UINT32 c, l, e, elem;
+    double sum;
+
+    for (c = 0; c < rhs.columns(); ++c)
+        for (l = 0; l < lines; ++l) {
+            if (_storage == blk_rows) {
+                // dot product of row l with column c of rhs
+                sum = 0.0;
+                for (const auto& blk : _lines.at(l))
+                    for (e = 0; e < 3; ++e)
+                        if ((elem = blk.index * 3 + e) < elems) sum += blk.value[e] * rhs.get(elem, c);
+                result.put(l, c, sum);
+            } else {
+                // column l scaled by element (l, c) of rhs
+                sum = rhs.get(l, c);
+                if (sum == 0.0) continue;
+                for (const auto& blk : _lines.at(l))
+                    for (e = 0; e < 3; ++e)
+                        if ((elem = blk.index * 3 + e) < elems) result.elementadd(elem, c, blk.value[e] * sum);
+            }
+        }
+}
+
+} // namespace math
+} // namespace dynadjust
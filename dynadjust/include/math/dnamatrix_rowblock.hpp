@@ -0,0 +1,163 @@
+//============================================================================
+// Name         : dnamatrix_rowblock.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust compressed row-block matrix library
+//============================================================================
+
+#ifndef DNAMATRIX_ROWBLOCK_H_
+#define DNAMATRIX_ROWBLOCK_H_
+
+/// \cond
+#include <cstddef>
+#include <iostream>
+#include <vector>
+/// \endcond
+
+#include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
+
+namespace dynadjust {
+namespace math {
+
+// Storage orientation of a rowblock_matrix
+typedef enum _blockStorage_ {
+    blk_rows = 0,    // each row holds blocks of 3 columns (i.e. A)
+    blk_columns = 1  // each column holds blocks of 3 rows (i.e. At * V-1)
+} blockStorage;
+
+// rowblock_matrix holds a matrix with the structure of a design matrix,
+// in which each measurement row (or column, for At * V-1) has non-zero
+// elements for at most a handful of stations.  Each measurement "line"
+// holds a sorted list of 3-element station blocks, so that memory grows
+// with the number of measurements rather than with
+// measurements x 3 * stations.
+//
+// The interface mirrors that of matrix_2d for the operations used to form
+// A and At * V-1, including the logical (rows, columns) vs memory
+// dimensions used by grow() and shrink().  Elements not held are zero,
+// and put() of a zero element that is not held does not allocate a block.
+class rowblock_matrix {
+  public:
+    rowblock_matrix();
+    rowblock_matrix(const UINT32& rows, const UINT32& columns, const blockStorage& storage = blk_rows);
+
+    friend std::ostream& operator<<(std::ostream& os, const rowblock_matrix& rhs);
+
+    inline UINT32 rows() const { return _rows; }
+    inline UINT32 columns() const { return _cols; }
+    inline UINT32 memRows() const { return _mem_rows; }
+    inline UINT32 memColumns() const { return _mem_cols; }
+
+    inline blockStorage storage() const { return _storage; }
+    void storage(const blockStorage& storage);
+
+    // Number of 3-element blocks held
+    std::size_t nonzeroBlocks() const;
+    // Memory occupied by the lines and the blocks they hold
+    std::size_t memorySize() const;
+
+    // Memory management
+    void allocate();
+    void deallocate();
+    void redim(const UINT32& rows, const UINT32& columns);
+    void setsize(const UINT32& rows, const UINT32& columns);
+    void shrink(const UINT32& rows, const UINT32& columns);
+    void grow(const UINT32& rows, const UINT32& columns);
+
+    // Element access
+    double get(const UINT32& row, const UINT32& column) const;
+    // Copies the station block commencing at (row, column) to block, i.e.
+    // (row, column..column+2) for blk_rows or (row..row+2, column) for
+    // blk_columns.  Elements not held are zero.
+    void getblock(const UINT32& row, const UINT32& column, double* block) const;
+    // Retrieves the first and last station blocks (i.e. element / 3) held
+    // in line.  Returns false if the line holds no blocks.
+    bool blockrange(const UINT32& line, UINT32& first, UINT32& last) const;
+    void put(const UINT32& row, const UINT32& column, const double& value);
+    void elementadd(const UINT32& row, const UINT32& column, const double& increment);
+
+    // Sub-matrix operations with dense matrices
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                  const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d& src, const UINT32& row_src,
+                      const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d* src, const UINT32& row_src,
+                      const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void replace(const UINT32& rowstart, const UINT32& columnstart, const matrix_2d& newmat);
+
+    // Sub-matrix operations with symmetric matrices
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix& src,
+                      const UINT32& row_src, const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix* src,
+                      const UINT32& row_src, const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+
+    // Sub-matrix operations with views of dense matrices
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+    void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_view& src);
+
+    matrix_2d submatrix(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                        const UINT32& columns) const;
+    void submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest, const UINT32& subrows,
+                   const UINT32& subcolumns) const;
+
+    void zero();
+    void zero(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows, const UINT32& columns);
+
+    // result = this * rhs, where result is dimensioned rows() x rhs.columns()
+    void multiply(const matrix_2d& rhs, matrix_2d& result) const;
+
+  private:
+    struct block3 {
+        UINT32 index;     // element (within the line) / 3
+        double value[3];
+    };
+
+    typedef std::vector<block3> line_t;
+
+    inline UINT32 lineIdx(const UINT32& row, const UINT32& column) const {
+        return _storage == blk_rows ? row : column;
+    }
+    inline UINT32 elemIdx(const UINT32& row, const UINT32& column) const {
+        return _storage == blk_rows ? column : row;
+    }
+
+    inline UINT32 lineCount() const { return _storage == blk_rows ? _rows : _cols; }
+    inline UINT32 elemCount() const { return _storage == blk_rows ? _cols : _rows; }
+
+    double* find(const UINT32& line, const UINT32& elem);
+    const double* find(const UINT32& line, const UINT32& elem) const;
+    double& findorinsert(const UINT32& line, const UINT32& elem);
+
+    void checkrange(const UINT32& row, const UINT32& column, const UINT32& rows, const UINT32& columns) const;
+
+    UINT32 _rows;
+    UINT32 _cols;
+    UINT32 _mem_rows;
+    UINT32 _mem_cols;
+    blockStorage _storage;
+
+    std::vector<line_t> _lines;  // one per row (blk_rows) or column (blk_columns), up to memory dimensions
+};
+
+typedef std::vector<rowblock_matrix> v_rowblock_matrix;
+
+} // namespace math
+} // namespace dynadjust
+
+#endif // DNAMATRIX_ROWBLOCK_H_
@@ -0,0 +1,662 @@
+//============================================================================
+// Name         : dnamatrix_sparse.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust sparse (3x3 block) symmetric matrix library
+//============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <include/math/dnamatrix_sparse.hpp>
+
+namespace dynadjust {
+namespace math {
+
+namespace {
+
+const UINT32 NO_BLOCK = std::numeric_limits<UINT32>::max();
+
+// Cholesky factorisation of a 3x3 (column-major) block.  The lower
+// triangle is replaced by the factor and the upper triangle is cleared.
+void cholesky3(double* a) {
+    double d;
+
+    if ((d = a[0]) <= 0.0 || !std::isfinite(d))
+        throw MatrixInversionFailure("Matrix inversion failed, the matrix is not positive definite.");
+    a[0] = sqrt(d);
+    a[1] /= a[0];
+    a[2] /= a[0];
+
+    if ((d = a[4] - a[1] * a[1]) <= 0.0 || !std::isfinite(d))
+        throw MatrixInversionFailure("Matrix inversion failed, the matrix is not positive definite.");
+    a[4] = sqrt(d);
+    a[5] = (a[5] - a[2] * a[1]) / a[4];
+
+    if ((d = a[8] - a[2] * a[2] - a[5] * a[5]) <= 0.0 || !std::isfinite(d))
+        throw MatrixInversionFailure("Matrix inversion failed, the matrix is not positive definite.");
+    a[8] = sqrt(d);
+
+    a[3] = a[6] = a[7] = 0.0;
+}
+
+// b = b * inv(l)', where l is a lower triangular 3x3 factor
+void trsm3(const double* l, double* b) {
+    for (UINT32 r(0); r < 3; ++r) {
+        b[r] /= l[0];
+        b[r + 3] = (b[r + 3] - l[1] * b[r]) / l[4];
+        b[r + 6] = (b[r + 6] - l[2] * b[r] - l[5] * b[r + 3]) / l[8];
+    }
+}
+
+// c = c - a * b'
+void gemmnt3(const double* a, const double* b, double* c) {
+    for (UINT32 col(0); col < 3; ++col)
+        for (UINT32 row(0); row < 3; ++row)
+            c[row + col * 3] -= a[row] * b[col] + a[row + 3] * b[col + 3] + a[row + 6] * b[col + 6];
+}
+
+// c = c - a * b
+void gemmnn3(const double* a, const double* b, double* c) {
+    for (UINT32 col(0); col < 3; ++col)
+        for (UINT32 row(0); row < 3; ++row)
+            c[row + col * 3] -= a[row] * b[col * 3] + a[row + 3] * b[col * 3 + 1] + a[row + 6] * b[col * 3 + 2];
+}
+
+// c = c - a' * b
+void gemmtn3(const double* a, const double* b, double* c) {
+    for (UINT32 col(0); col < 3; ++col)
+        for (UINT32 row(0); row < 3; ++row)
+            c[row + col * 3] -= a[row * 3] * b[col * 3] + a[row * 3 + 1] * b[col * 3 + 1] + a[row * 3 + 2] * b[col * 3 + 2];
+}
+
+// Inverse of a lower triangular 3x3 factor.  The upper triangle is cleared.
+void trinv3(const double* l, double* m) {
+    m[0] = 1.0 / l[0];
+    m[4] = 1.0 / l[4];
+    m[8] = 1.0 / l[8];
+    m[1] = -l[1] * m[0] * m[4];
+    m[5] = -l[5] * m[4] * m[8];
+    m[2] = -(l[2] * m[0] + l[5] * m[1]) * m[8];
+    m[3] = m[6] = m[7] = 0.0;
+}
+
+} // namespace
+
+sparse_matrix::sparse_matrix() : _dimension(0), _blocks(0), _analysed(false), _factorised(false), _inverted(false) {}
+
+sparse_matrix::sparse_matrix(const UINT32& dimension) : _dimension(0), _blocks(0), _analysed(false), _factorised(false), _inverted(false) {
+    initialise(dimension);
+}
+
+// Prepares the matrix for the symbolic phase.  Subsequent calls to elementadd
+// and blockadd register the positions of non-zero blocks until analyse() is called.
+void sparse_matrix::initialise(const UINT32& dimension) {
+    if (dimension % 3 != 0)
+        throw std::runtime_error("initialise(): The dimension of a sparse matrix must be a multiple of 3.");
+
+    _dimension = dimension;
+    _blocks = dimension / 3;
+    _analysed = false;
+    _factorised = false;
+    _inverted = false;
+
+    _colptr.clear();
+    _rowidx.clear();
+    _values.clear();
+    _parent.clear();
+    _scale.clear();
+    _inverse.clear();
+
+    _pattern.assign(_blocks, std::vector<UINT32>());
+
+    // The diagonal blocks are always present
+    for (UINT32 j(0); j < _blocks; ++j) _pattern.at(j).push_back(j);
+}
+
+void sparse_matrix::addpattern(UINT32 block_row, UINT32 block_col) {
+    if (block_row < block_col) std::swap(block_row, block_col);
+
+    std::vector<UINT32>& col(_pattern.at(block_col));
+    if (col.back() != block_row) col.push_back(block_row);
+}
+
+// Computes the elimination tree and the structure of the Cholesky factor
+// from the registered pattern, and allocates storage for the factor.
+void sparse_matrix::analyse() {
+    UINT32 i, j, k;
+    std::size_t p;
+
+    _parent.assign(_blocks, NO_BLOCK);
+    _colptr.assign(static_cast<std::size_t>(_blocks) + 1, 0);
+
+    // Children of each node in the elimination tree
+    std::vector<UINT32> child_head(_blocks, NO_BLOCK), child_next(_blocks, NO_BLOCK);
+    std::vector<UINT32> marker(_blocks, NO_BLOCK);
+    std::vector<std::vector<UINT32>> structure(_blocks);
+
+    for (j = 0; j < _blocks; ++j) {
+        std::vector<UINT32>& col(structure.at(j));
+        col.swap(_pattern.at(j));
+
+        for (i = 0; i < col.size(); ++i) marker.at(col.at(i)) = j;
+
+        // struct(L(:,j)) = struct(A(:,j)) + struct(L(:,c)) for all children c of j
+        for (k = child_head.at(j); k != NO_BLOCK; k = child_next.at(k)) {
+            const std::vector<UINT32>& child(structure.at(k));
+            for (p = 1; p < child.size(); ++p) {
+                if (marker.at(child.at(p)) == j) continue;
+                marker.at(child.at(p)) = j;
+                col.push_back(child.at(p));
+            }
+        }
+
+        std::sort(col.begin(), col.end());
+        col.erase(std::unique(col.begin(), col.end()), col.end());
+
+        // The parent of j is the first off-diagonal row
+        if (col.size() > 1) {
+            _parent.at(j) = col.at(1);
+            child_next.at(j) = child_head.at(col.at(1));
+            child_head.at(col.at(1)) = j;
+        }
+
+        _colptr.at(j + 1) = _colptr.at(j) + col.size();
+    }
+
+    _rowidx.resize(_colptr.at(_blocks));
+    for (j = 0; j < _blocks; ++j) {
+        std::copy(structure.at(j).begin(), structure.at(j).end(), _rowidx.begin() + _colptr.at(j));
+        std::vector<UINT32>().swap(structure.at(j));
+    }
+
+    std::vector<std::vector<UINT32>>().swap(_pattern);
+
+    _values.assign(_rowidx.size() * 9, 0.0);
+    _analysed = true;
+    _factorised = false;
+}
+
+void sparse_matrix::zero() {
+    std::fill(_values.begin(), _values.end(), 0.0);
+    _factorised = false;
+    _inverted = false;
+}
+
+// Returns the position of the block (block_row, block_col) in _rowidx, or
+// the size of _rowidx if the block is not within the structure
+std::size_t sparse_matrix::search(const UINT32& block_row, const UINT32& block_col) const {
+    std::vector<UINT32>::const_iterator begin(_rowidx.begin() + _colptr.at(block_col));
+    std::vector<UINT32>::const_iterator end(_rowidx.begin() + _colptr.at(block_col + 1));
+    std::vector<UINT32>::const_iterator it(std::lower_bound(begin, end, block_row));
+
+    if (it == end || *it != block_row) return _rowidx.size();
+
+    return static_cast<std::size_t>(std::distance(_rowidx.begin(), it));
+}
+
+// Returns the position of the block (block_row, block_col) in _rowidx
+std::size_t sparse_matrix::locate(const UINT32& block_row, const UINT32& block_col) const {
+    const std::size_t p(search(block_row, block_col));
+
+    if (p == _rowidx.size())
+        throw std::runtime_error("locate(): The element is not within the structure of the sparse matrix.");
+
+    return p;
+}
+
+double* sparse_matrix::find(const UINT32& block_row, const UINT32& block_col) {
+    return &_values.at(locate(block_row, block_col) * 9);
+}
+
+const double* sparse_matrix::find(const UINT32& block_row, const UINT32& block_col) const {
+    return const_cast<sparse_matrix*>(this)->find(block_row, block_col);
+}
+
+void sparse_matrix::elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+    if (!_analysed) {
+        addpattern(row / 3, column / 3);
+        return;
+    }
+
+    // Upper triangle elements are discarded
+    if (column > row) return;
+
+    find(row / 3, column / 3)[(row % 3) + (column % 3) * 3] += increment;
+}
+
+void sparse_matrix::stationblockadd(const UINT32& row_dest, const UINT32& col_dest, const double* block) {
+    if (!_analysed) {
+        addpattern(row_dest / 3, col_dest / 3);
+        return;
+    }
+
+    // Upper triangle elements are discarded
+    if (col_dest > row_dest) return;
+
+    double* dest(find(row_dest / 3, col_dest / 3));
+    for (UINT32 i, j(0); j < 3; ++j)
+        for (i = (row_dest == col_dest ? j : 0); i < 3; ++i) dest[i + j * 3] += block[i + j * 3];
+}
+
+void sparse_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                             const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols) {
+    UINT32 i, j;
+
+    // Station blocks can be added without searching for each element
+    if (_analysed && rows == 3 && cols == 3 && row_dest % 3 == 0 && col_dest % 3 == 0 && row_dest > col_dest) {
+        double* block(find(row_dest / 3, col_dest / 3));
+        for (j = 0; j < 3; ++j)
+            for (i = 0; i < 3; ++i) block[i + j * 3] += mat_src.get(row_src + i, col_src + j);
+        return;
+    }
+
+    for (i = 0; i < rows; ++i)
+        for (j = 0; j < cols; ++j) elementadd(row_dest + i, col_dest + j, mat_src.get(row_src + i, col_src + j));
+}
+
+// Same as blockadd, but adds transpose.  mat_src must be square.
+void sparse_matrix::blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                              const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols) {
+    for (UINT32 i(0); i < rows; ++i)
+        for (UINT32 j(0); j < cols; ++j) elementadd(row_dest + i, col_dest + j, mat_src.get(col_src + j, row_src + i));
+}
+
+void sparse_matrix::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                                  const UINT32& row_src, const UINT32& col_src, const UINT32& rows,
+                                  const UINT32& cols) {
+    for (UINT32 i(0); i < rows; ++i)
+        for (UINT32 j(0); j < cols; ++j) elementadd(row_dest + i, col_dest + j, -mat_src.get(row_src + i, col_src + j));
+}
+
+double sparse_matrix::get(const UINT32& row, const UINT32& column) const {
+    if (column > row) return get(column, row);
+
+    const std::size_t p(search(row / 3, column / 3));
+    if (p == _rowidx.size()) return 0.0;
+
+    return _values.at(p * 9 + (row % 3) + (column % 3) * 3);
+}
+
+// Left-looking block Cholesky factorisation.  Each column j is updated by all
+// columns k < j for which L(j,k) is non-zero.  These columns are found using
+// linked lists ordered by the next row to be processed in each column.
+void sparse_matrix::factorise(bool scale_to_unity) {
+    if (!_analysed) throw std::runtime_error("factorise(): The sparse matrix structure has not been analysed.");
+
+    UINT32 i, j, k, k_next, r, c;
+    std::size_t p, q, p_end;
+
+    _scale.clear();
+    _inverted = false;
+
+    if (scale_to_unity) {
+        // Scale the normals so that the diagonal elements are unity
+        _scale.resize(_dimension);
+        for (j = 0; j < _blocks; ++j)
+            for (i = 0; i < 3; ++i) {
+                double d(_values.at(_colptr.at(j) * 9 + i * 4));
+                if (d <= 0.0 || !std::isfinite(d))
+                    throw MatrixInversionFailure("Matrix inversion failed, the matrix is not positive definite.");
+                _scale.at(j * 3 + i) = 1.0 / sqrt(d);
+            }
+
+        for (j = 0; j < _blocks; ++j)
+            for (p = _colptr.at(j); p < _colptr.at(j + 1); ++p)
+                for (c = 0; c < 3; ++c)
+                    for (r = 0; r < 3; ++r)
+                        _values.at(p * 9 + r + c * 3) *= _scale.at(_rowidx.at(p) * 3 + r) * _scale.at(j * 3 + c);
+    }
+
+    std::vector<UINT32> list_head(_blocks, NO_BLOCK), list_next(_blocks, NO_BLOCK);
+    std::vector<std::size_t> next_row(_blocks), position(_blocks);
+
+    double* values(_values.data());
+
+    for (j = 0; j < _blocks; ++j) {
+        p_end = _colptr.at(j + 1);
+
+        // Map block rows of column j to their position in storage
+        for (p = _colptr.at(j); p < p_end; ++p) position.at(_rowidx.at(p)) = p;
+
+        // Apply updates from all columns k where L(j,k) is non-zero
+        for (k = list_head.at(j); k != NO_BLOCK; k = k_next) {
+            k_next = list_next.at(k);
+            p = next_row.at(k);
+
+            const double* ljk(values + p * 9);
+
+            // L(i,j) -= L(i,k) * L(j,k)'
+            for (q = p; q < _colptr.at(k + 1); ++q) gemmnt3(values + q * 9, ljk, values + position.at(_rowidx.at(q)) * 9);
+
+            // Move column k to the list of its next row
+            if (++p < _colptr.at(k + 1)) {
+                next_row.at(k) = p;
+                i = _rowidx.at(p);
+                list_next.at(k) = list_head.at(i);
+                list_head.at(i) = k;
+            }
+        }
+
+        // Factorise the diagonal block and solve for the off-diagonal blocks
+        p = _colptr.at(j);
+        cholesky3(values + p * 9);
+
+        for (q = p + 1; q < p_end; ++q) trsm3(values + p * 9, values + q * 9);
+
+        if (p + 1 < p_end) {
+            next_row.at(j) = p + 1;
+            i = _rowidx.at(p + 1);
+            list_next.at(j) = list_head.at(i);
+            list_head.at(i) = j;
+        }
+    }
+
+    _factorised = true;
+}
+
+// Solves L * y = x, overwriting x with y
+void sparse_matrix::forwardsubstitute(double* x) const {
+    std::size_t p, q;
+    UINT32 i;
+    const double* values(_values.data());
+
+    for (UINT32 j(0); j < _blocks; ++j) {
+        p = _colptr.at(j);
+        const double* l(values + p * 9);
+        double* xj(x + j * 3);
+
+        xj[0] /= l[0];
+        xj[1] = (xj[1] - l[1] * xj[0]) / l[4];
+        xj[2] = (xj[2] - l[2] * xj[0] - l[5] * xj[1]) / l[8];
+
+        for (q = p + 1; q < _colptr.at(j + 1); ++q) {
+            l = values + q * 9;
+            double* xi(x + _rowidx.at(q) * 3);
+            for (i = 0; i < 3; ++i) xi[i] -= l[i] * xj[0] + l[i + 3] * xj[1] + l[i + 6] * xj[2];
+        }
+    }
+}
+
+// Solves L' * x = y, overwriting y with x
+void sparse_matrix::backsubstitute(double* x) const {
+    std::size_t p, q;
+    UINT32 i;
+    const double* values(_values.data());
+
+    for (UINT32 j(_blocks); j-- > 0;) {
+        p = _colptr.at(j);
+        double* xj(x + j * 3);
+
+        for (q = p + 1; q < _colptr.at(j + 1); ++q) {
+            const double* l(values + q * 9);
+            const double* xi(x + _rowidx.at(q) * 3);
+            for (i = 0; i < 3; ++i) xj[i] -= l[i * 3] * xi[0] + l[i * 3 + 1] * xi[1] + l[i * 3 + 2] * xi[2];
+        }
+
+        const double* l(values + p * 9);
+        xj[2] /= l[8];
+        xj[1] = (xj[1] - l[5] * xj[2]) / l[4];
+        xj[0] = (xj[0] - l[1] * xj[1] - l[2] * xj[2]) / l[0];
+    }
+}
+
+void sparse_matrix::solve(const matrix_2d& rhs, matrix_2d& x) const {
+    if (!_factorised) throw std::runtime_error("solve(): The sparse matrix has not been factorised.");
+    if (rhs.rows() != _dimension)
+        throw std::runtime_error("solve(): The dimension of the right hand side does not match the sparse matrix.");
+
+    UINT32 i;
+    std::vector<double> y(_dimension);
+
+    for (i = 0; i < _dimension; ++i) y.at(i) = rhs.get(i, 0);
+
+    if (!_scale.empty())
+        for (i = 0; i < _dimension; ++i) y.at(i) *= _scale.at(i);
+
+    forwardsubstitute(y.data());
+    backsubstitute(y.data());
+
+    if (!_scale.empty())
+        for (i = 0; i < _dimension; ++i) y.at(i) *= _scale.at(i);
+
+    x.redim(_dimension, 1);
+    for (i = 0; i < _dimension; ++i) x.put(i, 0, y.at(i));
+}
+
+void sparse_matrix::inverse(matrix_2d& inv) const {
+    if (!_factorised) throw std::runtime_error("inverse(): The sparse matrix has not been factorised.");
+
+    UINT32 i, j;
+    std::vector<double> y(_dimension);
+
+    inv.redim(_dimension, _dimension);
+
+    // Solve N * inv(:,j) = e(j) for each column
+    for (j = 0; j < _dimension; ++j) {
+        std::fill(y.begin(), y.end(), 0.0);
+        y.at(j) = _scale.empty() ? 1.0 : _scale.at(j);
+
+        forwardsubstitute(y.data());
+        backsubstitute(y.data());
+
+        if (!_scale.empty())
+            for (i = 0; i < _dimension; ++i) y.at(i) *= _scale.at(i);
+
+        memcpy(inv.getelementref(0, j), y.data(), _dimension * sizeof(double));
+    }
+}
+
+void sparse_matrix::inverse(symmetric_matrix& inv) const {
+    if (!_factorised) throw std::runtime_error("inverse(): The sparse matrix has not been factorised.");
+
+    UINT32 i, j;
+    std::vector<double> y(_dimension);
+
+    inv.redim(_dimension, _dimension);
+
+    // Solve N * inv(:,j) = e(j) for each column, retaining the elements
+    // on and below the diagonal
+    for (j = 0; j < _dimension; ++j) {
+        std::fill(y.begin(), y.end(), 0.0);
+        y.at(j) = _scale.empty() ? 1.0 : _scale.at(j);
+
+        forwardsubstitute(y.data());
+        backsubstitute(y.data());
+
+        if (!_scale.empty())
+            for (i = j; i < _dimension; ++i) y.at(i) *= _scale.at(i);
+
+        memcpy(inv.getelementref(j, j), y.data() + j, (_dimension - j) * sizeof(double));
+    }
+}
+
+// Selected inversion.  With N = L * L', and U(k,j) = L(k,j) * inv(L(j,j)),
+// the elements of Z = inv(N) within the structure of L are given by
+//   Z(i,j) = -sum_k Z(i,k) * U(k,j)                          (i > j)
+//   Z(j,j) = inv(L(j,j))' * inv(L(j,j)) - sum_k U(k,j)' * Z(k,j)
+// where k runs over the off-diagonal block rows of column j.  Since the
+// structure of column j is a subset of the structure of its ancestors in
+// the elimination tree, every Z(i,k) required has already been computed
+// when the columns are processed in reverse order.
+void sparse_matrix::selectedinverse() {
+    if (!_factorised) throw std::runtime_error("selectedinverse(): The sparse matrix has not been factorised.");
+
+    UINT32 i, k;
+    std::size_t p, q, r, p_end;
+    double dinv[9], zik[9];
+    std::vector<double> u;
+
+    _inverse.assign(_values.size(), 0.0);
+
+    const double* values(_values.data());
+    double* inverse(_inverse.data());
+
+    for (UINT32 j(_blocks); j-- > 0;) {
+        p = _colptr.at(j);
+        p_end = _colptr.at(j + 1);
+
+        trinv3(values + p * 9, dinv);
+
+        // U(k,j) for all off-diagonal blocks
+        u.assign((p_end - p - 1) * 9, 0.0);
+        for (q = p + 1; q < p_end; ++q)
+            gemmnn3(values + q * 9, dinv, u.data() + (q - p - 1) * 9);
+        for (q = 0; q < u.size(); ++q) u.at(q) = -u.at(q);
+
+        // Z(i,j)
+        for (q = p + 1; q < p_end; ++q) {
+            i = _rowidx.at(q);
+            double* zij(inverse + q * 9);
+
+            for (r = p + 1; r < p_end; ++r) {
+                k = _rowidx.at(r);
+                if (i >= k)
+                    gemmnn3(inverse + locate(i, k) * 9, u.data() + (r - p - 1) * 9, zij);
+                else {
+                    const double* zki(inverse + locate(k, i) * 9);
+                    for (UINT32 c(0); c < 3; ++c)
+                        for (UINT32 b(0); b < 3; ++b) zik[b + c * 3] = zki[c + b * 3];
+                    gemmnn3(zik, u.data() + (r - p - 1) * 9, zij);
+                }
+            }
+        }
+
+        // Z(j,j)
+        double* zjj(inverse + p * 9);
+        for (UINT32 c(0); c < 3; ++c)
+            for (UINT32 b(0); b < 3; ++b) zjj[b + c * 3] = 0.0;
+        gemmtn3(dinv, dinv, zjj);
+        for (q = 0; q < 9; ++q) zjj[q] = -zjj[q];
+
+        for (q = p + 1; q < p_end; ++q) gemmtn3(u.data() + (q - p - 1) * 9, inverse + q * 9, zjj);
+    }
+
+    _inverted = true;
+}
+
+double sparse_matrix::getinverse(const UINT32& row, const UINT32& column) const {
+    if (!_inverted) throw std::runtime_error("getinverse(): The selected inverse has not been computed.");
+    if (column > row) return getinverse(column, row);
+
+    double z(_inverse.at(locate(row / 3, column / 3) * 9 + (row % 3) + (column % 3) * 3));
+    if (!_scale.empty()) z *= _scale.at(row) * _scale.at(column);
+    return z;
+}
+
+bool sparse_matrix::getinverseblock(const UINT32& row, const UINT32& column, double* block) const {
+    if (!_inverted) throw std::runtime_error("getinverseblock(): The selected inverse has not been computed.");
+
+    UINT32 r, c;
+    const bool transpose(column > row);
+    const std::size_t p(transpose ? search(column / 3, row / 3) : search(row / 3, column / 3));
+
+    if (p == _rowidx.size()) {
+        for (r = 0; r < 9; ++r) block[r] = 0.0;
+        return false;
+    }
+
+    // Elements above the diagonal are taken from the lower triangle
+    const double* z(_inverse.data() + p * 9);
+    for (c = 0; c < 3; ++c)
+        for (r = 0; r < 3; ++r)
+            block[r + c * 3] = transpose || (row == column && c > r) ? z[c + r * 3] : z[r + c * 3];
+
+    if (!_scale.empty())
+        for (c = 0; c < 3; ++c)
+            for (r = 0; r < 3; ++r) block[r + c * 3] *= _scale.at(row + r) * _scale.at(column + c);
+
+    return true;
+}
+
+void sparse_matrix::getinversecolumn(const UINT32& column, double* values) const {
+    if (!_inverted) throw std::runtime_error("getinversecolumn(): The selected inverse has not been computed.");
+
+    const UINT32 j(column / 3), c(column % 3);
+    UINT32 r, row;
+    std::size_t p;
+
+    std::fill(values, values + (_dimension - column), 0.0);
+
+    // The block rows of column j are held in ascending order, commencing
+    // with the diagonal block
+    for (p = _colptr.at(j); p < _colptr.at(j + 1); ++p)
+        for (r = (p == _colptr.at(j) ? c : 0); r < 3; ++r) {
+            row = _rowidx.at(p) * 3 + r;
+            values[row - column] = _inverse.at(p * 9 + r + c * 3);
+            if (!_scale.empty()) values[row - column] *= _scale.at(row) * _scale.at(column);
+        }
+}
+
+void sparse_matrix::inverseadd(const UINT32& row, const UINT32& column, const double& increment) {
+    if (!_inverted) throw std::runtime_error("inverseadd(): The selected inverse has not been computed.");
+
+    // Upper triangle elements are discarded
+    if (column > row) return;
+
+    double z(increment);
+    if (!_scale.empty()) z /= _scale.at(row) * _scale.at(column);
+    _inverse.at(locate(row / 3, column / 3) * 9 + (row % 3) + (column % 3) * 3) += z;
+}
+
+void sparse_matrix::scatterinverse(matrix_2d& inv) const {
+    if (!_inverted) throw std::runtime_error("scatterinverse(): The selected inverse has not been computed.");
+
+    UINT32 j, r, c, row, col;
+    std::size_t p;
+    double z;
+
+    inv.redim(_dimension, _dimension);
+    inv.zero();
+
+    for (j = 0; j < _blocks; ++j)
+        for (p = _colptr.at(j); p < _colptr.at(j + 1); ++p)
+            for (c = 0; c < 3; ++c)
+                for (r = 0; r < 3; ++r) {
+                    row = _rowidx.at(p) * 3 + r;
+                    col = j * 3 + c;
+                    z = _inverse.at(p * 9 + r + c * 3);
+                    if (!_scale.empty()) z *= _scale.at(row) * _scale.at(col);
+                    inv.put(row, col, z);
+                    inv.put(col, row, z);
+                }
+}
+
+void sparse_matrix::scatterinverse(symmetric_matrix& inv) const {
+    if (!_inverted) throw std::runtime_error("scatterinverse(): The selected inverse has not been computed.");
+
+    UINT32 j, r, c, row, col;
+    std::size_t p;
+    double z;
+
+    inv.redim(_dimension, _dimension);
+    inv.zero();
+
+    for (j = 0; j < _blocks; ++j)
+        for (p = _colptr.at(j); p < _colptr.at(j + 1); ++p)
+            for (c = 0; c < 3; ++c)
+                for (r = 0; r < 3; ++r) {
+                    row = _rowidx.at(p) * 3 + r;
+                    col = j * 3 + c;
+                    z = _inverse.at(p * 9 + r + c * 3);
+                    if (!_scale.empty()) z *= _scale.at(row) * _scale.at(col);
+                    inv.put(row, col, z);
+                }
+}
+
+} // namespace math
+} // namespace dynadjust
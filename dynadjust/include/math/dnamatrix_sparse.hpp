@@ -0,0 +1,160 @@
+//============================================================================
+// Name         : dnamatrix_sparse.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust sparse (3x3 block) symmetric matrix library
+//============================================================================
+
+#ifndef DNAMATRIX_SPARSE_H_
+#define DNAMATRIX_SPARSE_H_
+
+/// \cond
+#include <vector>
+/// \endcond
+
+#include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
+
+namespace dynadjust {
+namespace math {
+
+// sparse_matrix holds a symmetric positive definite matrix (i.e. the normals
+// At * V-1 * A) as 3x3 blocks, one block row/column per station.  Only
+// the lower triangle is kept, and it is kept in the structure of its
+// Cholesky factor so that the factor can be computed in place.
+//
+// Usage follows three phases:
+//   1. Symbolic: initialise(), then register every non-zero block via
+//      elementadd/blockadd (values are ignored), then analyse().
+//   2. Numeric: zero(), assemble values via elementadd/blockadd, factorise().
+//   3. Solution: solve(), inverse() and selectedinverse() use the factor.
+//      To re-factor, repeat phase 2.  The structure computed in phase 1 is
+//      retained.
+//
+// Each station's 3x3 block column forms a supernode, and the factor is
+// computed by a left-looking block Cholesky factorisation over the
+// elimination tree of the station graph.  Elements in the upper triangle
+// are discarded on assembly, which is consistent with the dense solution
+// (see matrix_2d::clearupper).
+class sparse_matrix {
+  public:
+    sparse_matrix();
+    explicit sparse_matrix(const UINT32& dimension);
+
+    // Symbolic analysis
+    void initialise(const UINT32& dimension);
+    void analyse();
+
+    inline UINT32 rows() const { return _dimension; }
+    inline UINT32 columns() const { return _dimension; }
+    inline UINT32 blockCount() const { return _blocks; }
+    inline bool analysed() const { return _analysed; }
+    inline bool factorised() const { return _factorised; }
+    inline bool inverted() const { return _inverted; }
+
+    // Number of 3x3 blocks held in the factor (including fill-in)
+    inline std::size_t nonzeroBlocks() const { return _rowidx.size(); }
+    // Memory occupied by the factor values
+    inline std::size_t factorSize() const { return _values.size() * sizeof(double); }
+
+    // Assembly
+    void zero();
+    void elementadd(const UINT32& row, const UINT32& column, const double& increment);
+    // Adds the 3x3 (column-major) block to the station block commencing at
+    // (row_dest, col_dest)
+    void stationblockadd(const UINT32& row_dest, const UINT32& col_dest, const double* block);
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                  const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                   const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                       const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+
+    // Element retrieval (lower triangle, prior to factorisation)
+    double get(const UINT32& row, const UINT32& column) const;
+
+    // Numeric factorisation.  If scale_to_unity is true, the matrix is
+    // scaled so that its diagonal elements are unity prior to factorisation,
+    // and the scaling is reversed in solve() and inverse().
+    void factorise(bool scale_to_unity = false);
+
+    // Solves N * x = rhs, where rhs is a column vector.
+    void solve(const matrix_2d& rhs, matrix_2d& x) const;
+
+    // Forms the full inverse of N in inv (dimension x dimension)
+    void inverse(matrix_2d& inv) const;
+    void inverse(symmetric_matrix& inv) const;
+
+    // Computes the elements of the inverse of N within the structure of
+    // the factor (Takahashi et al.), which includes every block in which
+    // N is non-zero.  Requires a fraction of the operations and none of
+    // the dense storage of inverse().
+    void selectedinverse();
+
+    // Element retrieval from the selected inverse.  Throws if the element
+    // is not within the structure of the factor.
+    double getinverse(const UINT32& row, const UINT32& column) const;
+
+    // Retrieves the 3x3 (column-major) block of the selected inverse for the
+    // stations commencing at (row, column).  Returns false, and a zero block,
+    // if the block is not within the structure of the factor.
+    bool getinverseblock(const UINT32& row, const UINT32& column, double* block) const;
+
+    // Retrieves column of the selected inverse from the diagonal down (i.e.
+    // dimension - column elements).  Elements outside the structure are zero.
+    void getinversecolumn(const UINT32& column, double* values) const;
+
+    // Adds increment to an element of the selected inverse (e.g. type b
+    // uncertainties).  As for assembly, upper triangle elements are discarded.
+    void inverseadd(const UINT32& row, const UINT32& column, const double& increment);
+
+    // Copies the selected inverse to inv (dimension x dimension), filling
+    // both triangles.  Elements outside the structure are set to zero.
+    void scatterinverse(matrix_2d& inv) const;
+    void scatterinverse(symmetric_matrix& inv) const;
+
+  private:
+    std::size_t search(const UINT32& block_row, const UINT32& block_col) const;
+    std::size_t locate(const UINT32& block_row, const UINT32& block_col) const;
+    double* find(const UINT32& block_row, const UINT32& block_col);
+    const double* find(const UINT32& block_row, const UINT32& block_col) const;
+
+    void addpattern(UINT32 block_row, UINT32 block_col);
+
+    void forwardsubstitute(double* x) const;
+    void backsubstitute(double* x) const;
+
+    UINT32 _dimension;                  // number of rows (and columns)
+    UINT32 _blocks;                     // number of 3x3 block rows (and columns)
+    bool _analysed;
+    bool _factorised;
+    bool _inverted;
+
+    std::vector<std::vector<UINT32>> _pattern;  // block rows (per block column), symbolic phase only
+
+    std::vector<std::size_t> _colptr;   // start of each block column in _rowidx
+    std::vector<UINT32> _rowidx;        // block row of each block (diagonal block first)
+    std::vector<double> _values;        // 3x3 column-major values of each block
+    std::vector<UINT32> _parent;        // elimination tree
+    std::vector<double> _scale;         // scaling applied prior to factorisation
+    std::vector<double> _inverse;       // selected inverse, in the structure of _values
+};
+
+} // namespace math
+} // namespace dynadjust
+
+#endif // DNAMATRIX_SPARSE_H_
@@ -0,0 +1,567 @@
+//============================================================================
+// Name         : dnamatrix_symmetric.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust packed symmetric matrix library
+//============================================================================
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <include/math/dnamatrix_symmetric.hpp>
+
+namespace dynadjust {
+namespace math {
+
+std::ostream& operator<<(std::ostream& os, const symmetric_matrix& rhs) {
+    const UINT32 matrix_type(mtx_lower), maxval(0);
+
+    if (os.iword(0) == binary) {
+        // Binary output, identical to matrix_2d (mtx_lower)
+        os.write(reinterpret_cast<const char*>(&matrix_type), sizeof(UINT32));
+
+        // output rows and columns (memory dimensions are the same)
+        for (UINT32 i(0); i < 4; ++i) os.write(reinterpret_cast<const char*>(&rhs._dimension), sizeof(UINT32));
+
+        // padding
+        os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+
+        // the packed lower triangle is the same as writing each column
+        // from the diagonal down
+        if (rhs._elements > 0)
+            os.write(reinterpret_cast<const char*>(rhs._data), rhs._elements * sizeof(double));
+
+        // max value info (not used for symmetric matrices)
+        os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+        os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+    } else {
+        // ASCII output (full), consistent with matrix_2d
+        os << matrix_type << " " << rhs._dimension << " " << rhs._dimension << " " << rhs._dimension << " "
+           << rhs._dimension << std::endl;
+
+        for (UINT32 c, r = 0; r < rhs._dimension; ++r) {
+            for (c = 0; c < rhs._dimension; ++c) os << std::scientific << std::setprecision(16) << rhs.get(r, c) << " ";
+            os << std::endl;
+        }
+        os << maxval << " " << maxval << std::endl;
+        os << std::endl;
+    }
+    return os;
+}
+
+symmetric_matrix::symmetric_matrix() : _dimension(0), _data(nullptr), _elements(0) {}
+
+symmetric_matrix::symmetric_matrix(const UINT32& rows, const UINT32& columns)
+    : _dimension(rows), _data(nullptr), _elements(0) {
+    checksquare(rows, columns, "symmetric_matrix");
+    allocate();
+}
+
+symmetric_matrix::symmetric_matrix(const symmetric_matrix& rhs)
+    : _dimension(rhs._dimension), _buffer(rhs._data, rhs._data + rhs._elements) {
+    own();
+}
+
+symmetric_matrix::symmetric_matrix(symmetric_matrix&& rhs) noexcept
+    : _dimension(rhs._dimension),
+      _buffer(std::move(rhs._buffer)),
+      _data(rhs._data),
+      _elements(rhs._elements),
+      _mapping(std::move(rhs._mapping)) {
+    if (!mapped()) own();
+
+    rhs._dimension = 0;
+    buffer_t().swap(rhs._buffer);
+    rhs.own();
+}
+
+symmetric_matrix& symmetric_matrix::operator=(const symmetric_matrix& rhs) {
+    if (this == &rhs) return *this;
+
+    // As for matrix_2d, copy into a mapped file region of the same size
+    if (mapped() && _elements == rhs._elements) {
+        std::copy(rhs._data, rhs._data + rhs._elements, _data);
+        return *this;
+    }
+
+    _dimension = rhs._dimension;
+    _buffer.assign(rhs._data, rhs._data + rhs._elements);
+    own();
+    return *this;
+}
+
+symmetric_matrix& symmetric_matrix::operator=(symmetric_matrix&& rhs) noexcept {
+    if (this == &rhs) return *this;
+
+    _dimension = rhs._dimension;
+    _buffer = std::move(rhs._buffer);
+    _data = rhs._data;
+    _elements = rhs._elements;
+    _mapping = std::move(rhs._mapping);
+    if (!mapped()) own();
+
+    rhs._dimension = 0;
+    buffer_t().swap(rhs._buffer);
+    rhs.own();
+    return *this;
+}
+
+void symmetric_matrix::checksquare(const UINT32& rows, const UINT32& columns, const char* method) const {
+    if (rows != columns) {
+        std::stringstream ss;
+        ss << method << "(): A symmetric matrix must be square (" << rows << ", " << columns << ").";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+void symmetric_matrix::checkrange(const UINT32& row, const UINT32& column, const UINT32& rows,
+                                  const UINT32& columns) const {
+    if (row + rows > _dimension || column + columns > _dimension) {
+        std::stringstream ss;
+        ss << row + rows << ", " << column + columns << " lies outside the range of the matrix (" << _dimension
+           << ", " << _dimension << ").";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+void symmetric_matrix::allocate() {
+    _buffer.assign(sumOfConsecutiveIntegers(_dimension), 0.0);
+    own();
+}
+
+void symmetric_matrix::deallocate() {
+    buffer_t().swap(_buffer);
+    own();
+}
+
+void symmetric_matrix::redim(const UINT32& rows, const UINT32& columns) {
+    checksquare(rows, columns, "redim");
+
+    if (rows == _dimension && !empty()) return;
+
+    // As for matrix_2d, retain the elements that lie within the new
+    // dimensions, and zero the rest.  Since each column's offset depends
+    // on the dimension, the retained columns are re-packed.
+    buffer_t buffer(sumOfConsecutiveIntegers(rows), 0.0);
+
+    if (!empty()) {
+        const UINT32 n(std::min(rows, _dimension));
+        std::size_t offset(0);
+        for (UINT32 c(0); c < n; ++c) {
+            std::copy(_data + packed(c, c), _data + packed(c, c) + (n - c), buffer.begin() + offset);
+            offset += rows - c;
+        }
+    }
+
+    _dimension = rows;
+    _buffer.swap(buffer);
+    own();
+}
+
+void symmetric_matrix::setsize(const UINT32& rows, const UINT32& columns) {
+    checksquare(rows, columns, "setsize");
+    deallocate();
+    _dimension = rows;
+}
+
+void symmetric_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                                const UINT32& row_src, const UINT32& col_src, const UINT32& rows,
+                                const UINT32& cols) {
+    UINT32 i, j;
+    for (j = 0; j < cols; ++j)
+        for (i = 0; i < rows; ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(row_src + i, col_src + j));
+}
+
+// Same as blockadd, but adds transpose (as for matrix_2d::blockTadd)
+void symmetric_matrix::blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                                 const UINT32& row_src, const UINT32& col_src, const UINT32& rows,
+                                 const UINT32& cols) {
+    UINT32 i, j;
+    for (j = 0; j < cols; ++j)
+        for (i = 0; i < rows; ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(col_src + j, row_src + i));
+}
+
+void symmetric_matrix::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                                     const UINT32& row_src, const UINT32& col_src, const UINT32& rows,
+                                     const UINT32& cols) {
+    UINT32 i, j;
+    for (j = 0; j < cols; ++j)
+        for (i = 0; i < rows; ++i)
+            elementsubtract(row_dest + i, col_dest + j, mat_src.get(row_src + i, col_src + j));
+}
+
+void symmetric_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(i, j));
+}
+
+void symmetric_matrix::blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src) {
+    UINT32 i, j;
+    for (j = 0; j < mat_src.columns(); ++j)
+        for (i = 0; i < mat_src.rows(); ++i) elementsubtract(row_dest + i, col_dest + j, mat_src.get(i, j));
+}
+
+void symmetric_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d& src,
+                                    const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                    const UINT32& columns) {
+    checkrange(row_dest, column_dest, rows, columns);
+
+    UINT32 i, j;
+    for (j = 0; j < columns; ++j)
+        for (i = 0; i < rows; ++i) put(row_dest + i, column_dest + j, src.get(row_src + i, column_src + j));
+}
+
+void symmetric_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix& src,
+                                    const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                    const UINT32& columns) {
+    checkrange(row_dest, column_dest, rows, columns);
+    src.checkrange(row_src, column_src, rows, columns);
+
+    UINT32 i, j;
+    for (j = 0; j < columns; ++j)
+        for (i = 0; i < rows; ++i) put(row_dest + i, column_dest + j, src.get(row_src + i, column_src + j));
+}
+
+void symmetric_matrix::copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix* src,
+                                    const UINT32& row_src, const UINT32& column_src, const UINT32& rows,
+                                    const UINT32& columns) {
+    copyelements(row_dest, column_dest, *src, row_src, column_src, rows, columns);
+}
+
+void symmetric_matrix::blockadd(const UINT32& row_dest, const UINT32& col_dest, const symmetric_matrix& mat_src,
+                                const UINT32& row_src, const UINT32& col_src, const UINT32& rows,
+                                const UINT32& cols) {
+    UINT32 i, j;
+    for (j = 0; j < cols; ++j)
+        for (i = 0; i < rows; ++i) elementadd(row_dest + i, col_dest + j, mat_src.get(row_src + i, col_src + j));
+}
+
+void symmetric_matrix::replace(const UINT32& rowstart, const UINT32& columnstart, const matrix_2d& newmat) {
+    copyelements(rowstart, columnstart, newmat, 0, 0, newmat.rows(), newmat.columns());
+}
+
+matrix_2d symmetric_matrix::submatrix(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                                      const UINT32& columns) const {
+    matrix_2d b(rows, columns);
+    submatrix(row_begin, col_begin, &b, rows, columns);
+    return b;
+}
+
+void symmetric_matrix::submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest,
+                                 const UINT32& subrows, const UINT32& subcolumns) const {
+    checkrange(row_begin, col_begin, subrows, subcolumns);
+
+    if (subrows > dest->rows() || subcolumns > dest->columns()) {
+        std::stringstream ss;
+        ss << subrows << ", " << subcolumns << " exceeds the size of the matrix (" << dest->rows() << ", "
+           << dest->columns() << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    UINT32 i, j;
+    for (j = 0; j < subcolumns; ++j)
+        for (i = 0; i < subrows; ++i) dest->put(i, j, get(row_begin + i, col_begin + j));
+}
+
+matrix_2d symmetric_matrix::full() const { return submatrix(0, 0, _dimension, _dimension); }
+
+void symmetric_matrix::zero() { std::fill(_data, _data + _elements, 0.0); }
+
+void symmetric_matrix::zero(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                            const UINT32& columns) {
+    checkrange(row_begin, col_begin, rows, columns);
+
+    UINT32 i, j;
+    for (j = 0; j < columns; ++j)
+        for (i = 0; i < rows; ++i) put(row_begin + i, col_begin + j, 0.0);
+}
+
+void symmetric_matrix::multiply(const matrix_2d& rhs, matrix_2d& result) const {
+    if (rhs.rows() != _dimension) {
+        std::stringstream ss;
+        ss << "multiply(): The number of rows in the right hand side (" << rhs.rows()
+           << ") does not match the dimension of the matrix (" << _dimension << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    if (result.rows() != _dimension || result.columns() != rhs.columns()) result.redim(_dimension, rhs.columns());
+    result.zero();
+
+    // Each packed column j contributes its sub-diagonal elements to both
+    // result(i, k) (lower) and result(j, k) (upper)
+    UINT32 i, j, k;
+    const double* a;
+    double rjk, sum;
+
+    for (k = 0; k < rhs.columns(); ++k)
+        for (j = 0; j < _dimension; ++j) {
+            a = getelementref(j, j);
+            rjk = rhs.get(j, k);
+            sum = a[0] * rjk;
+            for (i = j + 1; i < _dimension; ++i) {
+                *result.getelementref(i, k) += a[i - j] * rjk;
+                sum += a[i - j] * rhs.get(i, k);
+            }
+            *result.getelementref(j, k) += sum;
+        }
+}
+
+symmetric_matrix& symmetric_matrix::diagonalscale(const std::vector<double>& diagonal) {
+    if (diagonal.size() != _dimension) {
+        std::stringstream ss;
+        ss << "diagonalscale(): The number of diagonal elements (" << diagonal.size()
+           << ") does not match the dimension of the matrix (" << _dimension << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    UINT32 i, j;
+    double* a;
+    for (j = 0; j < _dimension; ++j) {
+        a = getelementref(j, j);
+        for (i = j; i < _dimension; ++i) a[i - j] = (diagonal[i] * a[i - j]) * diagonal[j];
+    }
+    return *this;
+}
+
+symmetric_matrix& symmetric_matrix::cholesky_inverse() {
+    if (_dimension < 1) return *this;
+
+    char uplo(LOWER_TRIANGLE);
+    lapack_int info, n = _dimension;
+
+    // Perform Cholesky factorisation
+    LAPACK_FUNC(dpptrf)(&uplo, &n, _data, &info);
+
+    if (info != 0)
+        throw MatrixInversionFailure("Matrix inversion failed, the matrix is singular.");
+
+    // Perform Cholesky inverse
+    LAPACK_FUNC(dpptri)(&uplo, &n, _data, &info);
+
+    if (info != 0)
+        throw MatrixInversionFailure("Matrix inversion failed, the matrix is singular.");
+
+    return *this;
+}
+
+bool symmetric_matrix::cholesky_inverse_mixed(const matrix_2d& rhs, matrix_2d& x, const double& min_rcond) {
+    if (rhs.rows() != _dimension) {
+        std::stringstream ss;
+        ss << "cholesky_inverse_mixed(): The number of rows in the right hand side (" << rhs.rows()
+           << ") does not match the dimension of the matrix (" << _dimension << ").";
+        throw std::runtime_error(ss.str());
+    }
+
+    if (x.rows() != _dimension || x.columns() != rhs.columns()) x.redim(_dimension, rhs.columns());
+    if (_dimension < 1) return false;
+
+    const UINT32 n(_dimension), nrhs(rhs.columns());
+    UINT32 i, j, k;
+    const double* a;
+
+    // 1. Scale to unit diagonal (S * N * S)
+    std::vector<double> scale(n);
+    for (j = 0; j < n; ++j) {
+        if (get(j, j) <= 0.0) throw MatrixInversionFailure("Matrix inversion failed, the matrix is singular.");
+        scale[j] = 1.0 / sqrt(get(j, j));
+    }
+
+    // 2. Single precision copy of the scaled matrix, and its 1-norm
+    std::vector<float, memory::arena_allocator<float> > factor(_elements);
+    std::vector<double> colsum(n, 0.0);
+    float* f(factor.data());
+    double s, norm(0.0);
+    for (j = 0; j < n; ++j) {
+        a = getelementref(j, j);
+        for (i = j; i < n; ++i, ++f) {
+            s = a[i - j] * scale[i] * scale[j];
+            *f = static_cast<float>(s);
+            colsum[j] += fabs(s);
+            if (i != j) colsum[i] += fabs(s);
+        }
+    }
+    for (j = 0; j < n; ++j) norm = std::max(norm, colsum[j]);
+
+    char uplo(LOWER_TRIANGLE);
+    lapack_int info, ln(n), lnrhs(nrhs);
+    bool single(true);
+
+    // 3. Factorise and estimate the condition of the scaled matrix
+    LAPACK_FUNC(spptrf)(&uplo, &ln, factor.data(), &info);
+    if (info != 0)
+        single = false;
+    else {
+        float anorm(static_cast<float>(norm)), rcond(0.f);
+        std::vector<float> work(3 * n);
+        std::vector<lapack_int> iwork(n);
+        LAPACK_FUNC(sppcon)(&uplo, &ln, factor.data(), &anorm, &rcond, work.data(), iwork.data(), &info);
+        single = info == 0 && rcond >= min_rcond;
+    }
+
+    // 4. Solve, and refine until the residual is no larger than that
+    // expected of a double precision solution (as per LAPACK dsposv)
+    if (single) {
+        const UINT32 max_refinements(30);
+        const double tolerance(norm * DBL_EPSILON * sqrt(static_cast<double>(n)));
+
+        matrix_2d y(n, nrhs), sy(n, nrhs), r(n, nrhs);
+        std::vector<float> d(static_cast<std::size_t>(n) * nrhs);
+        double rnorm, ynorm;
+
+        // Scaled right hand side, initially the residual for y = 0
+        for (k = 0; k < nrhs; ++k)
+            for (i = 0; i < n; ++i) r.put(i, k, rhs.get(i, k) * scale[i]);
+
+        single = false;
+        for (UINT32 step(0); step <= max_refinements; ++step) {
+            for (k = 0; k < nrhs; ++k)
+                for (i = 0; i < n; ++i) d[k * n + i] = static_cast<float>(r.get(i, k));
+            LAPACK_FUNC(spptrs)(&uplo, &ln, &lnrhs, factor.data(), d.data(), &ln, &info);
+            if (info != 0) break;
+
+            for (k = 0; k < nrhs; ++k)
+                for (i = 0; i < n; ++i) {
+                    y.get(i, k) += d[k * n + i];
+                    sy.put(i, k, y.get(i, k) * scale[i]);
+                }
+
+            // r = S * (rhs - N * S * y)
+            multiply(sy, r);
+            rnorm = ynorm = 0.0;
+            for (k = 0; k < nrhs; ++k)
+                for (i = 0; i < n; ++i) {
+                    r.put(i, k, (rhs.get(i, k) - r.get(i, k)) * scale[i]);
+                    rnorm = std::max(rnorm, fabs(r.get(i, k)));
+                    ynorm = std::max(ynorm, fabs(y.get(i, k)));
+                }
+
+            if (rnorm <= ynorm * tolerance) {
+                single = true;
+                break;
+            }
+        }
+
+        if (single) {
+            LAPACK_FUNC(spptri)(&uplo, &ln, factor.data(), &info);
+            single = info == 0;
+        }
+
+        if (single) {
+            // x = S * y, and the inverse of N is S * (S * N * S)-1 * S
+            x = sy;
+            f = factor.data();
+            for (j = 0; j < n; ++j) {
+                double* b(getelementref(j, j));
+                for (i = j; i < n; ++i, ++f) b[i - j] = static_cast<double>(*f) * scale[i] * scale[j];
+            }
+            return true;
+        }
+    }
+
+    // 5. Double precision
+    diagonalscale(scale);
+    cholesky_inverse();
+    diagonalscale(scale);
+    multiply(rhs, x);
+    return false;
+}
+
+std::size_t symmetric_matrix::get_size() {
+    // UINT32 _matrixType, _rows, _cols, _mem_rows, _mem_cols, padding, _maxvalRow, _maxvalCol
+    return (8 * sizeof(UINT32)) + sumOfConsecutiveIntegers(_dimension) * sizeof(double);
+}
+
+// Read data from memory mapped file
+void symmetric_matrix::ReadMappedFileRegion(void* addr) {
+    // IMPORTANT
+    // The following read statements must correspond
+    // with that which is written in matrix_2d::WriteMappedFileRegion
+    // for mtx_lower.
+
+    PUINT32 data_U = reinterpret_cast<PUINT32>(addr);
+    const UINT32 matrix_type(*data_U++), rows(*data_U++), cols(*data_U++);
+    const UINT32 mem_rows(*data_U++), mem_cols(*data_U++);
+    data_U++;  // padding
+
+    if (matrix_type != mtx_lower) throw std::runtime_error("ReadMappedFileRegion(): Matrix is not symmetric.");
+    checksquare(rows, cols, "ReadMappedFileRegion");
+    checksquare(mem_rows, mem_cols, "ReadMappedFileRegion");
+
+    // read each column from the diagonal down
+    _dimension = mem_rows;
+    double* data_d = reinterpret_cast<double*>(data_U);
+    _buffer.assign(data_d, data_d + sumOfConsecutiveIntegers(mem_rows));
+    own();
+
+    // A matrix_2d may have been written with memory dimensions
+    // larger than its logical dimensions
+    if (rows != mem_rows) redim(rows, cols);
+}
+
+// Wrap the packed lower triangle held in a memory mapped file
+void symmetric_matrix::MapFileRegion(void* addr, const std::shared_ptr<void>& mapping) {
+    // IMPORTANT
+    // The following must correspond with ReadMappedFileRegion above.
+
+    PUINT32 data_U = reinterpret_cast<PUINT32>(addr);
+    double* data_d = reinterpret_cast<double*>(data_U + 6);
+
+    // Matrices that must be re-packed are read
+    if (data_U[0] != mtx_lower || data_U[1] != data_U[2] || data_U[1] != data_U[3] || data_U[3] != data_U[4] ||
+        reinterpret_cast<std::uintptr_t>(data_d) % alignof(double) != 0) {
+        ReadMappedFileRegion(addr);
+        return;
+    }
+
+    deallocate();
+
+    _dimension = data_U[1];
+    _data = data_d;
+    _elements = sumOfConsecutiveIntegers(_dimension);
+    _mapping = mapping;
+}
+
+// Write data to memory mapped file
+void symmetric_matrix::WriteMappedFileRegion(void* addr) {
+    // IMPORTANT
+    // The following write statements must correspond
+    // with that which is written in operator<< above.
+
+    PUINT32 data_U = reinterpret_cast<UINT32*>(addr);
+    *data_U++ = mtx_lower;
+    *data_U++ = _dimension;
+    *data_U++ = _dimension;
+    *data_U++ = _dimension;
+    *data_U++ = _dimension;
+    *data_U++ = 0;  // padding
+
+    double* data_d = reinterpret_cast<double*>(data_U);
+    if (_elements > 0 && data_d != _data) memcpy(data_d, _data, _elements * sizeof(double));
+    data_d += sumOfConsecutiveIntegers(_dimension);
+
+    data_U = reinterpret_cast<UINT32*>(data_d);
+    *data_U++ = 0;
+    *data_U = 0;
+}
+
+} // namespace math
+} // namespace dynadjust
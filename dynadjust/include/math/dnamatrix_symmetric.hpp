@@ -0,0 +1,265 @@
+//============================================================================
+// Name         : dnamatrix_symmetric.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust packed symmetric matrix library
+//============================================================================
+
+#ifndef DNAMATRIX_SYMMETRIC_H_
+#define DNAMATRIX_SYMMETRIC_H_
+
+/// \cond
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+/// \endcond
+
+#include <include/math/dnamatrix_contiguous.hpp>
+#include <include/memory/dnabuffer_arena.hpp>
+
+#ifndef USE_MKL
+extern "C" {
+void LAPACK_FUNC(dpptrf)(const char* uplo, const lapack_int* n, double* ap, lapack_int* info);
+void LAPACK_FUNC(dpptri)(const char* uplo, const lapack_int* n, double* ap, lapack_int* info);
+void LAPACK_FUNC(spptrf)(const char* uplo, const lapack_int* n, float* ap, lapack_int* info);
+void LAPACK_FUNC(spptrs)(const char* uplo, const lapack_int* n, const lapack_int* nrhs, const float* ap, float* b,
+                         const lapack_int* ldb, lapack_int* info);
+void LAPACK_FUNC(spptri)(const char* uplo, const lapack_int* n, float* ap, lapack_int* info);
+void LAPACK_FUNC(sppcon)(const char* uplo, const lapack_int* n, const float* ap, const float* anorm, float* rcond,
+                         float* work, lapack_int* iwork, lapack_int* info);
+}
+#endif
+
+namespace dynadjust {
+namespace math {
+
+// symmetric_matrix holds a symmetric matrix (i.e. normals and variance
+// matrices) as the lower triangle in LAPACK packed column-major storage,
+// which requires n * (n + 1) / 2 elements rather than n * n.  Column j
+// holds elements (j..n-1, j) contiguously, so the storage is identical to
+// that written by matrix_2d for mtx_lower, and stage files remain
+// interchangeable between the two.
+//
+// The interface mirrors that of matrix_2d for the operations used to form
+// and consume normals and variances:
+//   - get() and put() of (row, col) and (col, row) refer to the same element.
+//   - Additive operations (elementadd, blockadd, blockTadd, blocksubtract)
+//     discard elements in the upper triangle, since the same contribution
+//     is always added to the lower triangle (consistent with clearupper()
+//     and sparse_matrix).
+//   - Copy operations (copyelements, replace) write every element, and so
+//     a block that lies entirely in the upper triangle is held as its
+//     transpose.
+//
+// Since the packed offset of each column depends on the dimension, the
+// memory dimensions always equal the logical dimensions.
+class symmetric_matrix {
+  public:
+    symmetric_matrix();
+    symmetric_matrix(const UINT32& rows, const UINT32& columns);
+    symmetric_matrix(const symmetric_matrix& rhs);
+    symmetric_matrix(symmetric_matrix&& rhs) noexcept;
+
+    symmetric_matrix& operator=(const symmetric_matrix& rhs);
+    symmetric_matrix& operator=(symmetric_matrix&& rhs) noexcept;
+
+    friend std::ostream& operator<<(std::ostream& os, const symmetric_matrix& rhs);
+
+    inline UINT32 rows() const { return _dimension; }
+    inline UINT32 columns() const { return _dimension; }
+    inline UINT32 memRows() const { return _dimension; }
+    inline UINT32 memColumns() const { return _dimension; }
+    inline bool empty() const { return _elements == 0; }
+
+    inline UINT32 matrixType() const { return mtx_lower; }
+
+    // Number of elements held (i.e. n * (n + 1) / 2)
+    inline std::size_t elementCount() const { return _elements; }
+
+    // Memory management
+    void allocate();
+    void deallocate();
+    void redim(const UINT32& rows, const UINT32& columns);
+    void setsize(const UINT32& rows, const UINT32& columns);
+
+    // Element access
+    inline double get(const UINT32& row, const UINT32& column) const { return _data[index(row, column)]; }
+    inline void put(const UINT32& row, const UINT32& column, const double& value) {
+        _data[index(row, column)] = value;
+    }
+    inline void elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+        if (row >= column) _data[packed(row, column)] += increment;
+    }
+    inline void elementsubtract(const UINT32& row, const UINT32& column, const double& decrement) {
+        if (row >= column) _data[packed(row, column)] -= decrement;
+    }
+
+    // Adds the 3x3 (column-major) block to the station block commencing at
+    // (row_dest, col_dest), where both are the first element of a station.
+    // As for elementadd, elements in the upper triangle are discarded.
+    inline void stationblockadd(const UINT32& row_dest, const UINT32& col_dest, const double* block) {
+        if (row_dest < col_dest) return;
+        double* column;
+        for (UINT32 first, row, col(0); col < 3; ++col) {
+            first = row_dest == col_dest ? col : 0;
+            column = &_data[packed(row_dest + first, col_dest + col)];
+            for (row = first; row < 3; ++row) column[row - first] += block[col * 3 + row];
+        }
+    }
+
+    // Pointer to element (row, column), where row >= column.  Elements
+    // (row..rows()-1, column) follow contiguously.
+    inline double* getelementref(const UINT32& row, const UINT32& column) { return &_data[packed(row, column)]; }
+    inline const double* getelementref(const UINT32& row, const UINT32& column) const {
+        return &_data[packed(row, column)];
+    }
+
+    // Sub-matrix operations with dense matrices
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                  const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void blockTadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                   const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src,
+                       const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const matrix_2d& src, const UINT32& row_src,
+                      const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void replace(const UINT32& rowstart, const UINT32& columnstart, const matrix_2d& newmat);
+
+    // Sub-matrix operations with views of dense matrices
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+    void blocksubtract(const UINT32& row_dest, const UINT32& col_dest, const matrix_view& mat_src);
+
+    // Sub-matrix operations between symmetric matrices
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const symmetric_matrix& mat_src,
+                  const UINT32& row_src, const UINT32& col_src, const UINT32& rows, const UINT32& cols);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix& src,
+                      const UINT32& row_src, const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+    void copyelements(const UINT32& row_dest, const UINT32& column_dest, const symmetric_matrix* src,
+                      const UINT32& row_src, const UINT32& column_src, const UINT32& rows, const UINT32& columns);
+
+    matrix_2d submatrix(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows,
+                        const UINT32& columns) const;
+    void submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest, const UINT32& subrows,
+                   const UINT32& subcolumns) const;
+
+    // Dense copy of the full (symmetric) matrix
+    matrix_2d full() const;
+
+    void zero();
+    void zero(const UINT32& row_begin, const UINT32& col_begin, const UINT32& rows, const UINT32& columns);
+
+    // result = this * rhs, where result is dimensioned rows() x rhs.columns()
+    void multiply(const matrix_2d& rhs, matrix_2d& result) const;
+
+    // this = D * this * D, where D is the diagonal matrix of the elements
+    // in diagonal (i.e. scaling of normals)
+    symmetric_matrix& diagonalscale(const std::vector<double>& diagonal);
+
+    // Inverse by Cholesky factorisation of the packed lower triangle
+    // (dpptrf / dpptri).  Throws MatrixInversionFailure if the matrix
+    // is not positive definite.
+    symmetric_matrix& cholesky_inverse();
+
+    // Inverse by Cholesky factorisation in single precision (spptrf /
+    // spptri), which also solves this * x = rhs.  The matrix is scaled to
+    // unit diagonal prior to factorisation, and x is refined to double
+    // precision against this (double precision) matrix.  The inverse is not
+    // refined, and so holds single precision accuracy only (i.e. a relative
+    // error of about FLT_EPSILON / rcond).  As for LAPACK dsposv, the
+    // inverse and x are formed in double precision instead if refinement
+    // does not converge.  min_rcond is a floor on the reciprocal condition
+    // number of the scaled matrix, below which the single precision inverse
+    // would hold fewer than half of its digits.  Returns true if single
+    // precision was used.  Throws MatrixInversionFailure if the matrix is
+    // not positive definite.
+    bool cholesky_inverse_mixed(const matrix_2d& rhs, matrix_2d& x,
+                                const double& min_rcond = std::sqrt(static_cast<double>(FLT_EPSILON)));
+
+    // Writes a matrix of the given dimension in the binary format of
+    // operator<<, without holding it in memory.  column(j, values) must
+    // provide the elements of column j from the diagonal down.
+    template <typename Column>
+    static void writepacked(std::ostream& os, const UINT32& dimension, Column column);
+
+    // Memory mapped file serialisation (identical to matrix_2d mtx_lower)
+    std::size_t get_size();
+    void ReadMappedFileRegion(void* addr);
+    void WriteMappedFileRegion(void* addr);
+
+    // Wraps the packed lower triangle held in a memory mapped file region,
+    // rather than copying it (see matrix_2d::MapFileRegion).  Since the
+    // packing depends on the dimension, the elements are copied to a new
+    // buffer upon any redim.
+    void MapFileRegion(void* addr, const std::shared_ptr<void>& mapping);
+    inline bool mapped() const { return _mapping != nullptr; }
+
+  private:
+    // Offset of (row, column) in the packed lower triangle, where row >= column
+    inline std::size_t packed(const UINT32& row, const UINT32& column) const {
+        return static_cast<std::size_t>(column) * (2 * static_cast<std::size_t>(_dimension) - column - 1) / 2 + row;
+    }
+    inline std::size_t index(const UINT32& row, const UINT32& column) const {
+        return row >= column ? packed(row, column) : packed(column, row);
+    }
+
+    void checkrange(const UINT32& row, const UINT32& column, const UINT32& rows, const UINT32& columns) const;
+    void checksquare(const UINT32& rows, const UINT32& columns, const char* method) const;
+
+    // Buffers are drawn from buffer_arena, as for matrix_2d
+    typedef std::vector<double, memory::arena_allocator<double> > buffer_t;
+
+    // Points _data to the owned buffer
+    inline void own() {
+        _mapping.reset();
+        _data = _buffer.data();
+        _elements = _buffer.size();
+    }
+
+    UINT32 _dimension;
+    buffer_t _buffer;               // packed lower triangle (empty whilst mapped)
+    double* _data;                  // first element of _buffer, or of the mapped file region
+    std::size_t _elements;
+    std::shared_ptr<void> _mapping; // mapped file region holding _data
+};
+
+template <typename Column>
+void symmetric_matrix::writepacked(std::ostream& os, const UINT32& dimension, Column column) {
+    const UINT32 matrix_type(mtx_lower), maxval(0);
+
+    os.write(reinterpret_cast<const char*>(&matrix_type), sizeof(UINT32));
+    for (UINT32 i(0); i < 4; ++i) os.write(reinterpret_cast<const char*>(&dimension), sizeof(UINT32));
+    os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+
+    std::vector<double> values(dimension);
+    for (UINT32 j(0); j < dimension; ++j) {
+        column(j, values.data());
+        os.write(reinterpret_cast<const char*>(values.data()), (dimension - j) * sizeof(double));
+    }
+
+    os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+    os.write(reinterpret_cast<const char*>(&maxval), sizeof(UINT32));
+}
+
+typedef std::vector<symmetric_matrix> v_sym_mat, *pv_sym_mat;
+
+} // namespace math
+} // namespace dynadjust
+
+#endif // DNAMATRIX_SYMMETRIC_H_
@@ -0,0 +1,216 @@
+//============================================================================
+// Name         : dnamatrix_variance.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust variance matrix (inverse of the normals) view
+//============================================================================
+
+#ifndef DNAMATRIX_VARIANCE_H_
+#define DNAMATRIX_VARIANCE_H_
+
+/// \cond
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <vector>
+/// \endcond
+
+#include <include/math/dnamatrix_sparse.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
+
+namespace dynadjust {
+namespace math {
+
+// column_inverse holds the three columns of the inverse of the normals for
+// each of a selected set of stations, as solved by the iterative solver
+// (see --precision-stations).  Since the inverse is symmetric, an element
+// is held if either its row or its column belongs to a selected station.
+// Elements which are not held are zero.
+class column_inverse {
+  public:
+    column_inverse() : _dimension(0) {}
+
+    // Clears the columns held, for an inverse of the given dimension
+    inline void initialise(const UINT32& dimension) {
+        _dimension = dimension;
+        _station.assign(dimension / 3, NOT_HELD);
+        _values.clear();
+    }
+
+    inline UINT32 rows() const { return _dimension; }
+    inline bool held(const UINT32& column) const { return _station.at(column / 3) != NOT_HELD; }
+    inline std::size_t stationCount() const { return _values.size() / (static_cast<std::size_t>(_dimension) * 3); }
+    inline std::size_t memorySize() const { return _values.capacity() * sizeof(double); }
+
+    // Returns the (dimension) elements of column, adding the columns of
+    // its station if they are not held
+    inline double* column(const UINT32& column) {
+        const std::size_t n(_dimension);
+        if (!held(column)) {
+            _station.at(column / 3) = stationCount();
+            _values.resize(_values.size() + n * 3, 0.0);
+        }
+        return _values.data() + (_station.at(column / 3) * 3 + column % 3) * n;
+    }
+
+    inline double get(const UINT32& row, const UINT32& column) const {
+        if (held(column)) return element(row, column);
+        if (held(row)) return element(column, row);
+        return 0.0;
+    }
+
+    // Retrieves column from the diagonal down (i.e. dimension - column
+    // elements)
+    void getcolumn(const UINT32& column, double* values) const {
+        UINT32 row;
+        if (held(column)) {
+            for (row = column; row < _dimension; ++row) values[row - column] = element(row, column);
+            return;
+        }
+
+        std::fill(values, values + (_dimension - column), 0.0);
+        for (UINT32 s(0); s < _station.size(); ++s)
+            if (_station.at(s) != NOT_HELD)
+                for (row = std::max(s * 3, column); row < s * 3 + 3; ++row) values[row - column] = element(column, row);
+    }
+
+    // Adds increment to (row, column) in every column in which it is held.
+    // As for symmetric_matrix, elements in the upper triangle are discarded.
+    inline void elementadd(const UINT32& row, const UINT32& column, const double& increment) {
+        if (column > row) return;
+        if (held(column)) element(row, column) += increment;
+        if (held(row) && row != column) element(column, row) += increment;
+    }
+
+  private:
+    static constexpr std::size_t NOT_HELD = std::numeric_limits<std::size_t>::max();
+
+    inline double& element(const UINT32& row, const UINT32& column) {
+        return _values.at((_station.at(column / 3) * 3 + column % 3) * static_cast<std::size_t>(_dimension) + row);
+    }
+    inline const double& element(const UINT32& row, const UINT32& column) const {
+        return _values.at((_station.at(column / 3) * 3 + column % 3) * static_cast<std::size_t>(_dimension) + row);
+    }
+
+    UINT32 _dimension;
+    std::vector<std::size_t> _station;  // position of each station's columns, or NOT_HELD
+    std::vector<double> _values;        // columns of each selected station (column-major)
+};
+
+// variance_matrix refers to the variance matrix of the estimates (i.e. the
+// inverse of the normals), however the inverse is held.  The dense solvers
+// hold the inverse in a symmetric_matrix, whereas the sparse solver holds
+// only the selected inverse in its sparse_matrix, and the iterative solver
+// only the columns of selected stations (column_inverse).  The precisions of
+// adjusted measurements and stations are read through this class so that
+// a dense inverse is only formed when covariances between all stations are
+// required.
+//
+// Elements which are not held (i.e. those outside the structure of the
+// selected inverse, or of stations not selected) are zero.  Like
+// matrix_view, a variance_matrix does not own the matrix to which it refers.
+class variance_matrix {
+  public:
+    variance_matrix() : _dense(nullptr), _sparse(nullptr), _columns(nullptr) {}
+    variance_matrix(symmetric_matrix* dense) : _dense(dense), _sparse(nullptr), _columns(nullptr) {}
+    variance_matrix(sparse_matrix* sparse) : _dense(nullptr), _sparse(sparse), _columns(nullptr) {}
+    variance_matrix(column_inverse* columns) : _dense(nullptr), _sparse(nullptr), _columns(columns) {}
+
+    inline explicit operator bool() const { return _dense != nullptr || _sparse != nullptr || _columns != nullptr; }
+    inline UINT32 rows() const {
+        if (_dense != nullptr) return _dense->rows();
+        return _sparse != nullptr ? _sparse->rows() : _columns->rows();
+    }
+
+    // Element retrieval
+    inline double get(const UINT32& row, const UINT32& column) const {
+        if (_dense != nullptr) return _dense->get(row, column);
+        if (_columns != nullptr) return _columns->get(row, column);
+
+        double block[9];
+        _sparse->getinverseblock(row - row % 3, column - column % 3, block);
+        return block[(row % 3) + (column % 3) * 3];
+    }
+
+    // Retrieves the 3x3 (column-major) block of the stations commencing at
+    // (row, column)
+    inline void getblock(const UINT32& row, const UINT32& column, double* block) const {
+        if (_sparse != nullptr) {
+            _sparse->getinverseblock(row, column, block);
+            return;
+        }
+
+        for (UINT32 r, c(0); c < 3; ++c)
+            for (r = 0; r < 3; ++r) block[r + c * 3] = get(row + r, column + c);
+    }
+
+    void submatrix(const UINT32& row_begin, const UINT32& col_begin, matrix_2d* dest, const UINT32& subrows,
+                   const UINT32& subcolumns) const {
+        if (_dense != nullptr) {
+            _dense->submatrix(row_begin, col_begin, dest, subrows, subcolumns);
+            return;
+        }
+
+        for (UINT32 r, c(0); c < subcolumns; ++c)
+            for (r = 0; r < subrows; ++r) dest->put(r, c, get(row_begin + r, col_begin + c));
+    }
+
+    // As for symmetric_matrix, elements in the upper triangle are discarded
+    void blockadd(const UINT32& row_dest, const UINT32& col_dest, const matrix_2d& mat_src, const UINT32& row_src,
+                  const UINT32& col_src, const UINT32& rows, const UINT32& cols) {
+        if (_dense != nullptr) {
+            _dense->blockadd(row_dest, col_dest, mat_src, row_src, col_src, rows, cols);
+            return;
+        }
+
+        for (UINT32 r, c(0); c < cols; ++c)
+            for (r = 0; r < rows; ++r) {
+                if (_sparse != nullptr)
+                    _sparse->inverseadd(row_dest + r, col_dest + c, mat_src.get(row_src + r, col_src + c));
+                else
+                    _columns->elementadd(row_dest + r, col_dest + c, mat_src.get(row_src + r, col_src + c));
+            }
+    }
+
+    // Writes the variance matrix in the binary format of symmetric_matrix.
+    // The selected inverse (or selected columns) is written a column at a
+    // time, so that it can be read as a symmetric_matrix without forming
+    // the dense inverse.
+    void write(std::ostream& os) const {
+        if (_dense != nullptr) {
+            os << *_dense;
+            return;
+        }
+
+        symmetric_matrix::writepacked(os, rows(), [this](const UINT32& column, double* values) {
+            if (_sparse != nullptr)
+                _sparse->getinversecolumn(column, values);
+            else
+                _columns->getcolumn(column, values);
+        });
+    }
+
+  private:
+    symmetric_matrix* _dense;
+    sparse_matrix* _sparse;
+    column_inverse* _columns;
+};
+
+} // namespace math
+} // namespace dynadjust
+
+#endif // DNAMATRIX_VARIANCE_H_
@@ -0,0 +1,258 @@
+//============================================================================
+// Name         : dnaordering.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust station (graph) ordering library
+//============================================================================
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <set>
+#include <utility>
+
+#include <include/math/dnaordering.hpp>
+
+namespace dynadjust {
+namespace math {
+
+namespace {
+
+// Forms the level structure of the component containing root, excluding
+// nodes already numbered.  Returns the number of levels.  On return, last_level
+// holds the nodes in the deepest level.
+UINT32 LevelStructure(const vvUINT32& adjacency, const UINT32& root, const std::vector<bool>& numbered,
+	std::vector<UINT32>& marker, const UINT32& stamp, vUINT32& last_level)
+{
+	vUINT32 level(1, root), next;
+	UINT32 depth(1);
+	marker.at(root) = stamp;
+
+	while (true)
+	{
+		next.clear();
+		for (const auto& v : level)
+			for (const auto& u : adjacency.at(v))
+			{
+				if (numbered.at(u) || marker.at(u) == stamp)
+					continue;
+				marker.at(u) = stamp;
+				next.push_back(u);
+			}
+
+		if (next.empty())
+			break;
+
+		level.swap(next);
+		depth++;
+	}
+
+	last_level = level;
+	return depth;
+}
+
+// Finds a pseudo-peripheral node (George and Liu) of the component
+// containing start, i.e. a node of (near) maximum eccentricity
+UINT32 PseudoPeripheralNode(const vvUINT32& adjacency, const UINT32& start, const std::vector<bool>& numbered,
+	std::vector<UINT32>& marker, UINT32& stamp)
+{
+	vUINT32 last_level;
+	UINT32 root(start), candidate;
+	UINT32 depth(LevelStructure(adjacency, root, numbered, marker, ++stamp, last_level)), candidate_depth;
+
+	while (true)
+	{
+		// Pick the node of least degree in the deepest level
+		candidate = *std::min_element(last_level.begin(), last_level.end(),
+			[&adjacency](const UINT32& a, const UINT32& b) {
+				return adjacency.at(a).size() < adjacency.at(b).size() ||
+					(adjacency.at(a).size() == adjacency.at(b).size() && a < b);
+			});
+
+		candidate_depth = LevelStructure(adjacency, candidate, numbered, marker, ++stamp, last_level);
+		if (candidate_depth <= depth)
+			return root;
+
+		root = candidate;
+		depth = candidate_depth;
+	}
+}
+
+// Eliminates node v from the elimination graph, connecting all of its
+// neighbours.  Calls update(u, old_degree) for each neighbour u.
+template <typename U>
+void EliminateNode(vvUINT32& graph, const UINT32& v, U update)
+{
+	vUINT32 neighbours;
+	neighbours.swap(graph.at(v));
+
+	vUINT32 merged;
+	std::size_t old_degree;
+
+	for (const auto& u : neighbours)
+	{
+		vUINT32& adj(graph.at(u));
+		old_degree = adj.size();
+
+		// adj + neighbours, less v and u
+		merged.clear();
+		merged.reserve(adj.size() + neighbours.size());
+		std::set_union(adj.begin(), adj.end(), neighbours.begin(), neighbours.end(),
+			std::back_inserter(merged));
+		merged.erase(std::remove_if(merged.begin(), merged.end(),
+			[&v, &u](const UINT32& w) { return w == v || w == u; }), merged.end());
+
+		adj.swap(merged);
+		update(u, old_degree);
+	}
+}
+
+// Copies the adjacency lists, ensuring each is sorted and unique
+void InitialiseGraph(const vvUINT32& adjacency, vvUINT32& graph)
+{
+	graph = adjacency;
+	for (auto& adj : graph)
+	{
+		std::sort(adj.begin(), adj.end());
+		adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+	}
+}
+
+} // namespace
+
+
+void ReverseCuthillMcKee(const vvUINT32& adjacency, vUINT32& order)
+{
+	const UINT32 n(static_cast<UINT32>(adjacency.size()));
+
+	order.clear();
+	order.reserve(n);
+
+	std::vector<bool> numbered(n, false);
+	std::vector<UINT32> marker(n, 0);
+	UINT32 stamp(0), root, i;
+
+	auto by_degree = [&adjacency](const UINT32& a, const UINT32& b) {
+		return adjacency.at(a).size() < adjacency.at(b).size() ||
+			(adjacency.at(a).size() == adjacency.at(b).size() && a < b);
+	};
+
+	// Start each component from a node of least degree
+	vUINT32 nodes(n), neighbours;
+	std::iota(nodes.begin(), nodes.end(), 0);
+	std::sort(nodes.begin(), nodes.end(), by_degree);
+
+	for (const auto& start : nodes)
+	{
+		if (numbered.at(start))
+			continue;
+
+		root = PseudoPeripheralNode(adjacency, start, numbered, marker, stamp);
+
+		// Breadth first search, numbering the neighbours of each
+		// node in order of increasing degree
+		i = static_cast<UINT32>(order.size());
+		numbered.at(root) = true;
+		order.push_back(root);
+
+		for (; i < order.size(); ++i)
+		{
+			neighbours.clear();
+			for (const auto& u : adjacency.at(order.at(i)))
+				if (!numbered.at(u))
+				{
+					numbered.at(u) = true;
+					neighbours.push_back(u);
+				}
+
+			std::sort(neighbours.begin(), neighbours.end(), by_degree);
+			order.insert(order.end(), neighbours.begin(), neighbours.end());
+		}
+	}
+
+	std::reverse(order.begin(), order.end());
+}
+
+
+void MinimumDegree(const vvUINT32& adjacency, vUINT32& order)
+{
+	const UINT32 n(static_cast<UINT32>(adjacency.size()));
+
+	order.clear();
+	order.reserve(n);
+
+	vvUINT32 graph;
+	InitialiseGraph(adjacency, graph);
+
+	// Nodes ordered by (degree, node), so that ties are resolved
+	// by the original order
+	std::set<std::pair<std::size_t, UINT32> > degree_queue;
+	UINT32 v;
+	for (v = 0; v < n; ++v)
+		degree_queue.insert(std::make_pair(graph.at(v).size(), v));
+
+	while (!degree_queue.empty())
+	{
+		v = degree_queue.begin()->second;
+		degree_queue.erase(degree_queue.begin());
+		order.push_back(v);
+
+		EliminateNode(graph, v,
+			[&degree_queue, &graph](const UINT32& u, const std::size_t& old_degree) {
+				degree_queue.erase(std::make_pair(old_degree, u));
+				degree_queue.insert(std::make_pair(graph.at(u).size(), u));
+			});
+	}
+}
+
+
+UINT32 OrderingBandwidth(const vvUINT32& adjacency, const vUINT32& order)
+{
+	vUINT32 position(order.size());
+	UINT32 k, bandwidth(0);
+	for (k = 0; k < order.size(); ++k)
+		position.at(order.at(k)) = k;
+
+	for (k = 0; k < adjacency.size(); ++k)
+		for (const auto& u : adjacency.at(k))
+			bandwidth = std::max(bandwidth,
+				position.at(k) > position.at(u) ? position.at(k) - position.at(u) : position.at(u) - position.at(k));
+
+	return bandwidth;
+}
+
+
+std::size_t OrderingFactorBlocks(const vvUINT32& adjacency, const vUINT32& order)
+{
+	vvUINT32 graph;
+	InitialiseGraph(adjacency, graph);
+
+	std::size_t blocks(0);
+
+	// Each node's (remaining) neighbours at the time of its
+	// elimination form the non-zero blocks of its factor column
+	for (const auto& v : order)
+	{
+		blocks += graph.at(v).size() + 1;
+		EliminateNode(graph, v, [](const UINT32&, const std::size_t&) {});
+	}
+
+	return blocks;
+}
+
+} // namespace math
+} // namespace dynadjust
@@ -0,0 +1,60 @@
+//============================================================================
+// Name         : dnaordering.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust station (graph) ordering library
+//============================================================================
+
+#ifndef DNAORDERING_H_
+#define DNAORDERING_H_
+
+/// \cond
+#include <cstddef>
+/// \endcond
+
+#include <include/config/dnatypes-containers.hpp>
+
+namespace dynadjust {
+namespace math {
+
+// The functions in this file operate on the station graph of a network (or
+// block), in which each station is a node and two stations are adjacent if
+// they are connected by a measurement.  adjacency holds, for each node, the
+// (unique) nodes adjacent to it, excluding the node itself.
+//
+// An ordering is returned in order, where order[k] is the (original) node
+// placed at position k.
+
+// Reverse Cuthill-McKee ordering, which minimises the bandwidth (and
+// profile) of the normals
+void ReverseCuthillMcKee(const vvUINT32& adjacency, vUINT32& order);
+
+// Minimum degree ordering, which minimises the fill-in of the Cholesky
+// factor of the normals
+void MinimumDegree(const vvUINT32& adjacency, vUINT32& order);
+
+// Bandwidth of the graph under the given ordering
+UINT32 OrderingBandwidth(const vvUINT32& adjacency, const vUINT32& order);
+
+// Number of non-zero (station) blocks in the lower triangle of the Cholesky
+// factor, including the diagonal, under the given ordering
+std::size_t OrderingFactorBlocks(const vvUINT32& adjacency, const vUINT32& order);
+
+} // namespace math
+} // namespace dynadjust
+
+#endif // DNAORDERING_H_
@@ -402,7 +402,7 @@ void CDnaGpsPoint::SimulateMsr(vdnaStnPtr* vStations, const CDnaEllipsoid* ellip
 }
 
 void CDnaGpsPoint::PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStationsMap, vUINT32* blockStations,
-		const UINT32& map_idx, const CDnaDatum* datum, matrix_2d* estimates, matrix_2d* variances)
+		const UINT32& map_idx, const CDnaDatum* datum, matrix_2d* estimates, symmetric_matrix* variances)
 {
 	// populate station coordinate information
 	m_strType = 'Y';
@@ -441,7 +441,6 @@ void CDnaGpsPoint::PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStati
 	m_vPointCovariances.resize(covariance_count);
 
 	std::vector<CDnaCovariance>::iterator _it_cov = m_vPointCovariances.begin();
-	matrix_2d variances_cart(3, 3);
 	UINT32 ic, jc;
 
 	for (ic=map_idx+1; ic<blockStationsMap->size(); ++ic)
@@ -449,17 +448,15 @@ void CDnaGpsPoint::PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStati
 		jc = (*blockStationsMap)[blockStations->at(ic)] * 3;
 		
 		// get cartesian submatrix corresponding to the covariance
-		variances->submatrix(mat_idx, jc, &variances_cart, 3, 3);
-	
-		_it_cov->SetM11(variances_cart.get(0, 0));
-		_it_cov->SetM12(variances_cart.get(0, 1));
-		_it_cov->SetM13(variances_cart.get(0, 2));
-		_it_cov->SetM21(variances_cart.get(1, 0));
-		_it_cov->SetM22(variances_cart.get(1, 1));
-		_it_cov->SetM23(variances_cart.get(1, 2));
-		_it_cov->SetM31(variances_cart.get(2, 0));
-		_it_cov->SetM32(variances_cart.get(2, 1));
-		_it_cov->SetM33(variances_cart.get(2, 2));
+		_it_cov->SetM11(variances->get(mat_idx, jc));
+		_it_cov->SetM12(variances->get(mat_idx, jc+1));
+		_it_cov->SetM13(variances->get(mat_idx, jc+2));
+		_it_cov->SetM21(variances->get(mat_idx+1, jc));
+		_it_cov->SetM22(variances->get(mat_idx+1, jc+1));
+		_it_cov->SetM23(variances->get(mat_idx+1, jc+2));
+		_it_cov->SetM31(variances->get(mat_idx+2, jc));
+		_it_cov->SetM32(variances->get(mat_idx+2, jc+1));
+		_it_cov->SetM33(variances->get(mat_idx+2, jc+2));
 		
 		++_it_cov;
 	}
@@ -971,7 +968,7 @@ void CDnaGpsPointCluster::SimulateMsr(vdnaStnPtr* vStations, const CDnaEllipsoid
 }
 
 void CDnaGpsPointCluster::PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStationsMap, vUINT32* blockStations,
-		const UINT32& block, const CDnaDatum* datum, matrix_2d* estimates, matrix_2d* variances)
+		const UINT32& block, const CDnaDatum* datum, matrix_2d* estimates, symmetric_matrix* variances)
 {
 	m_strType = 'Y';
 	m_bIgnore = false;
@@ -121,7 +121,7 @@ public:
 	virtual void WriteDNAMsr(std::ofstream* dna_stream, const dna_msr_fields& dmw, const dna_msr_fields& dml, bool) const;
 	virtual void SimulateMsr(vdnaStnPtr* vStations, const CDnaEllipsoid* ellipsoid);
 	virtual void PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStationsMap, vUINT32* blockStations,
-		const UINT32& stn, const CDnaDatum* datum, math::matrix_2d* estimates, math::matrix_2d* variances);
+		const UINT32& stn, const CDnaDatum* datum, math::matrix_2d* estimates, math::symmetric_matrix* variances);
 
 	virtual void SerialiseDatabaseMap(std::ofstream* os);
 
@@ -238,7 +238,7 @@ public:
 	void WriteDNAMsr(std::ofstream* dna_stream, const dna_msr_fields& dmw, const dna_msr_fields& dml, bool) const override;
 	void SimulateMsr(vdnaStnPtr* vStations, const CDnaEllipsoid* ellipsoid) override;
 	void PopulateMsr(pvstn_t bstRecords, uint32_uint32_map* blockStationsMap, vUINT32* blockStations,
-		const UINT32& block, const CDnaDatum* datum, math::matrix_2d* estimates, math::matrix_2d* variances) override;
+		const UINT32& block, const CDnaDatum* datum, math::matrix_2d* estimates, math::symmetric_matrix* variances) override;
 
 	void SerialiseDatabaseMap(std::ofstream* os) override;
 
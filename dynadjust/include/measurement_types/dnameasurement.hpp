@@ -46,6 +46,7 @@
 #include <include/config/dnatypes-fwd.hpp>
 #include <include/measurement_types/dnastation.hpp>
 #include <include/math/dnamatrix_contiguous.hpp>
+#include <include/math/dnamatrix_symmetric.hpp>
 #include <include/parameters/dnadatum.hpp>
 
 
@@ -355,7 +356,7 @@ public:
 	// A function used by CDnaGpsPoint and CDnaGpsPointCluster only.
 	// Used to export latest station coordinate and variance estimates to Y measurement
 	virtual void PopulateMsr(pvstn_t, uint32_uint32_map*, vUINT32*,
-		const UINT32&, const CDnaDatum*, math::matrix_2d*, math::matrix_2d*) {}
+		const UINT32&, const CDnaDatum*, math::matrix_2d*, math::symmetric_matrix*) {}
 
 	// virtual functions overridden by specialised classes
 	virtual inline UINT32 GetClusterID() const { return 0; }
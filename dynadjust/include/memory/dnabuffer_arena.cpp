@@ -0,0 +1,275 @@
+//============================================================================
+// Name         : dnabuffer_arena.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust matrix buffer arena
+//============================================================================
+
+/// \cond
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
+/// \endcond
+
+#include <include/memory/dnabuffer_arena.hpp>
+
+namespace dynadjust {
+namespace memory {
+
+namespace {
+
+// Each buffer is preceded by a header recording its size class and the
+// lease it was acquired under.  The header is 16 bytes, which retains the
+// alignment of ::operator new.
+struct buffer_header {
+    UINT32 size_class;
+    UINT32 lease;
+    UINT32 reserved[2];
+};
+
+const std::size_t HEADER_SIZE(sizeof(buffer_header));
+const std::size_t SIZE_CLASSES(160);                          // up to 2^40 elements
+const std::size_t DEFAULT_RETENTION(256 * std::size_t(1048576));  // 256 MB
+
+inline buffer_header* header(const double* buffer) {
+    return reinterpret_cast<buffer_header*>(const_cast<char*>(reinterpret_cast<const char*>(buffer)) - HEADER_SIZE);
+}
+
+inline double* data(buffer_header* h) { return reinterpret_cast<double*>(reinterpret_cast<char*>(h) + HEADER_SIZE); }
+
+thread_local UINT32 t_lease(0);
+thread_local std::size_t t_shard(std::size_t(-1));
+
+} // namespace
+
+buffer_arena& buffer_arena::instance() {
+    // Never destroyed, since matrices with static storage duration may
+    // release their buffers after this function's statics are destroyed.
+    static buffer_arena* arena = new buffer_arena;
+    return *arena;
+}
+
+buffer_arena::buffer_arena()
+    : _retention_limit(DEFAULT_RETENTION),
+      _bytes_in_use(0),
+      _peak_bytes_in_use(0),
+      _bytes_cached(0),
+      _acquisitions(0),
+      _reuses(0) {
+    std::size_t shards(std::thread::hardware_concurrency());
+    shards = std::min(std::max(shards, std::size_t(4)), std::size_t(64));
+
+    _shared.resize(shards);
+    for (auto& p : _shared) {
+        p.reset(new pool);
+        p->free.resize(SIZE_CLASSES);
+    }
+}
+
+buffer_arena::~buffer_arena() { trim(); }
+
+// Size classes hold 4, 8, 12 and 16 elements, and then four classes per
+// power of two (i.e. 20, 24, 28, 32, 40, 48, 56, 64, ...), so that no more
+// than one quarter of a buffer is unused.
+std::size_t buffer_arena::size_class(const std::size_t& elements) {
+    if (elements <= 16) return elements < 1 ? 0 : (elements - 1) >> 2;
+
+    const std::size_t n(elements - 1);
+    std::size_t e(4);
+    while ((n >> (e + 1)) != 0) ++e;
+
+    // n lies in [2^e, 2^(e+1)), and (n >> (e - 2)) lies in [4, 8)
+    return (e - 4) * 4 + (n >> (e - 2));
+}
+
+std::size_t buffer_arena::class_elements(const std::size_t& size_class) {
+    if (size_class < 4) return (size_class + 1) << 2;
+
+    const std::size_t g(size_class / 4), r(size_class % 4);
+    return (5 + r) << (g + 1);
+}
+
+std::size_t buffer_arena::capacity(const double* buffer) {
+    if (buffer == nullptr) return 0;
+    return class_elements(header(buffer)->size_class);
+}
+
+buffer_arena::pool& buffer_arena::shared_pool() {
+    if (t_shard == std::size_t(-1)) t_shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % _shared.size();
+    return *_shared[t_shard];
+}
+
+buffer_arena::pool* buffer_arena::lease_pool(const UINT32& lease, const bool create) {
+    std::lock_guard<std::mutex> lock(_lease_mutex);
+
+    auto it = _leases.find(lease);
+    if (it != _leases.end()) return it->second.get();
+    if (!create) return nullptr;
+
+    std::unique_ptr<pool> p(new pool);
+    p->free.resize(SIZE_CLASSES);
+    pool* ptr(p.get());
+    _leases[lease] = std::move(p);
+    return ptr;
+}
+
+double* buffer_arena::take(pool& p, const std::size_t& size_class) {
+    std::lock_guard<std::mutex> lock(p.mutex);
+    std::vector<double*>& list(p.free[size_class]);
+    if (list.empty()) return nullptr;
+
+    double* buffer(list.back());
+    list.pop_back();
+
+    const std::size_t bytes(class_elements(size_class) * sizeof(double));
+    p.bytes_cached -= bytes;
+    _bytes_cached -= bytes;
+    return buffer;
+}
+
+bool buffer_arena::cache(pool& p, double* buffer) {
+    const std::size_t size_class(header(buffer)->size_class);
+    const std::size_t bytes(class_elements(size_class) * sizeof(double));
+
+    if (_bytes_cached.load() + bytes > _retention_limit.load()) return false;
+
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.free[size_class].push_back(buffer);
+    p.bytes_cached += bytes;
+    _bytes_cached += bytes;
+    return true;
+}
+
+void buffer_arena::free_all(pool& p) {
+    std::lock_guard<std::mutex> lock(p.mutex);
+    for (std::size_t c(0); c < p.free.size(); ++c) {
+        for (double* buffer : p.free[c]) ::operator delete(header(buffer));
+        p.free[c].clear();
+    }
+    _bytes_cached -= p.bytes_cached;
+    p.bytes_cached = 0;
+}
+
+double* buffer_arena::acquire(const std::size_t& elements, const bool zero) {
+    const std::size_t size_class(buffer_arena::size_class(elements));
+    const std::size_t bytes(class_elements(size_class) * sizeof(double));
+    const UINT32 lease(t_lease);
+
+    ++_acquisitions;
+
+    double* buffer(nullptr);
+
+    // Try this lease's buffers first, then the shared buffers, starting
+    // with this thread's shard
+    if (lease != 0) buffer = take(*lease_pool(lease, true), size_class);
+
+    if (buffer == nullptr) {
+        pool& own(shared_pool());
+        buffer = take(own, size_class);
+        for (std::size_t s(0); buffer == nullptr && s < _shared.size(); ++s)
+            if (_shared[s].get() != &own) buffer = take(*_shared[s], size_class);
+    }
+
+    if (buffer != nullptr)
+        ++_reuses;
+    else {
+        // ::operator new calls the installed new handler (i.e.
+        // out_of_memory_handler) if memory cannot be allocated
+        buffer_header* h(static_cast<buffer_header*>(::operator new(HEADER_SIZE + bytes)));
+        h->size_class = static_cast<UINT32>(size_class);
+        buffer = data(h);
+    }
+
+    header(buffer)->lease = lease;
+
+    const std::size_t in_use(_bytes_in_use += bytes);
+    std::size_t peak(_peak_bytes_in_use.load());
+    while (in_use > peak && !_peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {}
+
+    if (zero) memset(buffer, 0, elements * sizeof(double));
+
+    return buffer;
+}
+
+void buffer_arena::release(double* buffer) {
+    if (buffer == nullptr) return;
+
+    buffer_header* h(header(buffer));
+    _bytes_in_use -= class_elements(h->size_class) * sizeof(double);
+
+    pool* p(nullptr);
+    if (h->lease != 0) p = lease_pool(h->lease, false);
+    if (p == nullptr) p = &shared_pool();
+
+    if (!cache(*p, buffer)) ::operator delete(h);
+}
+
+void buffer_arena::release_lease(const UINT32& lease) {
+    std::unique_ptr<pool> p;
+    {
+        std::lock_guard<std::mutex> lock(_lease_mutex);
+        auto it = _leases.find(lease);
+        if (it == _leases.end()) return;
+        p = std::move(it->second);
+        _leases.erase(it);
+    }
+
+    // Hand the lease's buffers to the shared free lists.  These bytes
+    // are already counted in _bytes_cached.
+    pool& shared(shared_pool());
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for (std::size_t c(0); c < p->free.size(); ++c) {
+        std::vector<double*>& list(shared.free[c]);
+        list.insert(list.end(), p->free[c].begin(), p->free[c].end());
+    }
+    shared.bytes_cached += p->bytes_cached;
+}
+
+void buffer_arena::retention_limit(const std::size_t& bytes) {
+    _retention_limit = bytes;
+    if (_bytes_cached.load() > bytes) trim();
+}
+
+arena_statistics buffer_arena::statistics() const {
+    arena_statistics stats;
+    stats.bytes_in_use = _bytes_in_use.load();
+    stats.peak_bytes_in_use = _peak_bytes_in_use.load();
+    stats.bytes_cached = _bytes_cached.load();
+    stats.acquisitions = _acquisitions.load();
+    stats.reuses = _reuses.load();
+    return stats;
+}
+
+void buffer_arena::reset_peak() { _peak_bytes_in_use = _bytes_in_use.load(); }
+
+void buffer_arena::trim() {
+    for (auto& p : _shared) free_all(*p);
+
+    std::lock_guard<std::mutex> lock(_lease_mutex);
+    for (auto& p : _leases) free_all(*p.second);
+}
+
+arena_lease::arena_lease(const UINT32& lease) : _previous(t_lease) { t_lease = lease; }
+
+arena_lease::~arena_lease() { t_lease = _previous; }
+
+UINT32 arena_lease::current() { return t_lease; }
+
+} // namespace memory
+} // namespace dynadjust
@@ -0,0 +1,180 @@
+//============================================================================
+// Name         : dnabuffer_arena.hpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : DynAdjust matrix buffer arena
+//============================================================================
+
+#ifndef DNABUFFER_ARENA_H_
+#define DNABUFFER_ARENA_H_
+
+#if defined(_MSC_VER)
+#if defined(LIST_INCLUDES_ON_BUILD)
+#pragma message("  " __FILE__)
+#endif
+#endif
+
+/// \cond
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+/// \endcond
+
+#include <include/config/dnatypes.hpp>
+
+namespace dynadjust {
+namespace memory {
+
+// Usage of the buffer arena, in bytes
+struct arena_statistics {
+    std::size_t bytes_in_use;       // held by matrices
+    std::size_t peak_bytes_in_use;  // maximum of bytes_in_use
+    std::size_t bytes_cached;       // held in free lists for reuse
+    std::size_t acquisitions;       // calls to acquire()
+    std::size_t reuses;             // calls to acquire() satisfied from free lists
+};
+
+// buffer_arena supplies the element buffers for matrix_2d and
+// symmetric_matrix.  The same matrix shapes are allocated again and again
+// over iterations and blocks, so rather than returning buffers to the
+// system, released buffers are held in free lists and reused.
+//
+// - Buffers are rounded up to one of four size classes per power of two,
+//   so that a buffer can be reused by a matrix of a similar (not just
+//   identical) size.  For large buffers, the unused tail is never touched
+//   and so is never committed by the operating system.
+// - Free lists are sharded by thread, so that threads adjusting
+//   different blocks seldom contend for the same lock.
+// - A buffer acquired whilst a lease is active (see arena_lease) is
+//   returned to that lease's free lists, so that a block's matrices reuse
+//   that block's buffers.  Releasing the lease (i.e. UnloadBlock) hands the
+//   lease's buffers back to the shared free lists, retaining no more than
+//   retention_limit() bytes in all.
+// - Zeroing is optional, so that buffers which are about to be
+//   overwritten in full are not cleared first.
+class buffer_arena {
+  public:
+    static buffer_arena& instance();
+
+    // Returns a buffer of at least elements doubles.  If zero is true,
+    // the first elements doubles are set to zero.
+    double* acquire(const std::size_t& elements, const bool zero = true);
+    void release(double* buffer);
+
+    // Number of doubles that can be held by a buffer from acquire()
+    static std::size_t capacity(const double* buffer);
+
+    // Leases.  A lease is identified by a non-zero key (i.e. block + 1).
+    void release_lease(const UINT32& lease);
+
+    // Maximum number of bytes held in free lists.  Buffers released beyond
+    // this limit are returned to the system.
+    inline std::size_t retention_limit() const { return _retention_limit.load(); }
+    void retention_limit(const std::size_t& bytes);
+
+    arena_statistics statistics() const;
+    void reset_peak();
+
+    // Returns all cached buffers to the system
+    void trim();
+
+  private:
+    buffer_arena();
+    ~buffer_arena();
+
+    buffer_arena(const buffer_arena&) = delete;
+    buffer_arena& operator=(const buffer_arena&) = delete;
+
+    struct pool {
+        std::mutex mutex;
+        std::vector<std::vector<double*> > free;  // one list per size class
+        std::size_t bytes_cached = 0;
+    };
+
+    static std::size_t size_class(const std::size_t& elements);
+    static std::size_t class_elements(const std::size_t& size_class);
+
+    pool* lease_pool(const UINT32& lease, const bool create);
+    pool& shared_pool();
+
+    bool cache(pool& p, double* buffer);
+    double* take(pool& p, const std::size_t& size_class);
+    void free_all(pool& p);
+
+    std::vector<std::unique_ptr<pool> > _shared;       // sharded by thread
+    std::map<UINT32, std::unique_ptr<pool> > _leases;
+    std::mutex _lease_mutex;
+
+    std::atomic<std::size_t> _retention_limit;
+
+    std::atomic<std::size_t> _bytes_in_use;
+    std::atomic<std::size_t> _peak_bytes_in_use;
+    std::atomic<std::size_t> _bytes_cached;
+    std::atomic<std::size_t> _acquisitions;
+    std::atomic<std::size_t> _reuses;
+};
+
+// Charges buffers acquired by this thread to a lease for the lifetime
+// of the object
+class arena_lease {
+  public:
+    explicit arena_lease(const UINT32& lease);
+    ~arena_lease();
+
+    static UINT32 current();
+
+  private:
+    arena_lease(const arena_lease&) = delete;
+    arena_lease& operator=(const arena_lease&) = delete;
+
+    UINT32 _previous;
+};
+
+// Standard allocator drawing from buffer_arena, for containers of
+// doubles (i.e. symmetric_matrix)
+template <typename T>
+class arena_allocator {
+  public:
+    typedef T value_type;
+
+    arena_allocator() noexcept {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U>&) noexcept {}
+
+    T* allocate(const std::size_t n) {
+        return reinterpret_cast<T*>(
+            buffer_arena::instance().acquire((n * sizeof(T) + sizeof(double) - 1) / sizeof(double), false));
+    }
+    void deallocate(T* p, const std::size_t) noexcept { buffer_arena::instance().release(reinterpret_cast<double*>(p)); }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const arena_allocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+} // namespace memory
+} // namespace dynadjust
+
+#endif // DNABUFFER_ARENA_H_
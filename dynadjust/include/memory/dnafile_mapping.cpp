@@ -81,6 +81,18 @@ void block_map_t::MapRegion(FileMapPtr file_map_ptr) {
 }
 
 
+MapRegPtr block_map_t::MapPrivateRegion(FileMapPtr file_map_ptr) const {
+	return MapRegPtr(
+		new boost::interprocess::mapped_region(
+			*file_map_ptr, 
+			boost::interprocess::copy_on_write, 
+			region_offset_, 
+			data_size_
+			)
+		);
+}
+
+
 // class to hold addresses and sizes for all matrices 
 // in a vector of segmented blocks
 vmat_file_map::vmat_file_map()
@@ -135,6 +147,12 @@ void vmat_file_map::MapRegion(const UINT32 block)
 }
 	
 
+MapRegPtr vmat_file_map::MapPrivateRegion(const UINT32 block) const
+{
+	return vblockMapRegions_.at(block).MapPrivateRegion(file_map_ptr_);
+}
+	
+
 }	// namespace memory 
 }	// namespace dynadjust 
 
@@ -70,6 +70,10 @@ public:
 	
 	void MapRegion(FileMapPtr file_map_ptr);
 
+	// Maps a private (copy on write) view of this region.  Changes made 
+	// through the view are not written to the file.
+	MapRegPtr MapPrivateRegion(FileMapPtr file_map_ptr) const;
+
 	size_t			data_size_;		// Size of this matrix.  
 	size_t			region_offset_;		// Offset from the beginning of the region
 	MapRegPtr		region_ptr_;		// shared pointer to the region
@@ -92,6 +96,7 @@ public:
 	void setnewFilePath(const std::string& filePath, bool remove_mapped_file);
 	void CreateFileMap();
 	void MapRegion(const UINT32 block);
+	MapRegPtr MapPrivateRegion(const UINT32 block) const;
 
 	inline FileMapPtr getFileMapPtr() const { return file_map_ptr_; }
 	inline void* GetBlockRegionAddr(const UINT32 block) const { 
@@ -31,7 +31,14 @@
 /// \cond
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <queue>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <sstream>
@@ -40,187 +47,461 @@
 
 #include <include/config/dnatypes-fwd.hpp>
 
-template<typename T>
-class concurrent_block_adjustment
+// Runs a set of tasks, some of which depend upon the completion of others,
+// on a pool of worker threads.  Each worker holds a deque of tasks that are 
+// ready to run.  A worker runs the most recently readied task in its own 
+// deque and, once its deque is empty, steals the oldest task from the deque
+// of another worker.  Idle workers wait (rather than poll) until a task is
+// readied or the graph has finished.
+//
+// If a task throws, no further tasks are started, and the exception is
+// re-thrown by run() once the running tasks have finished.  Likewise, no
+// further tasks are started once the (optional) cancellation test passed
+// to run() returns true.
+//
+// The worker threads are retained between calls to run(), so that a graph
+// which is run repeatedly (e.g. on every iteration) does not create threads
+// each time.
+class task_graph
 {
 public:
-	concurrent_block_adjustment() 
-		: forward_is_running(false), reverse_is_running(false), combine_is_running(false) {
-	}
-	virtual ~concurrent_block_adjustment() {}
-
-	inline void resize_forward_run(const T size) {
-		// a lock is not needed since this function is called 
-		// prior to creating threads 
-		//lock_guard<mutex> lock_fwd(forward_mutex);
-		v_fwd_blocks.resize(size);
-		T id(0);
-		for_each(v_fwd_blocks.begin(), v_fwd_blocks.end(),
-			[this, &id] (sequential_adj_t<T, bool>& a) { 
-				a.block_index = id++;
-		});
-	}
-
-	inline void resize_reverse_run(const T size) {
-		// a lock is not needed since this function is called 
-		// prior to creating threads 
-		//lock_guard<mutex> lock_rev(reverse_mutex);
-		v_rev_blocks.resize(size);
-		T id(0);
-		for_each(v_rev_blocks.begin(), v_rev_blocks.end(),
-			[this, &id] (sequential_adj_t<T, bool>& a) { 
-				a.block_index = id++;
-		});
-	}
-	inline void resize_runs(const T size) {
-		resize_forward_run(size);
-		resize_reverse_run(size);
-	}
-
-	inline void reset_forward_run() {
-		// a lock is not needed since this function is called 
-		// prior to creating threads 
-		//lock_guard<mutex> lock_fwd(forward_mutex);
-		for_each(v_fwd_blocks.begin(), v_fwd_blocks.end(), 
-			boost::mem_fn(&sequential_adj::nosolution)); 
-	}
-
-	inline void reset_reverse_run() {
-		// a lock is not needed since this function is called 
-		// prior to creating threads 
-		//lock_guard<mutex> lock_rev(reverse_mutex);
-		for_each(v_rev_blocks.begin(), v_rev_blocks.end(), 
-			boost::mem_fn(&sequential_adj::nosolution)); 
-	}	
-
-	inline void reset_adjustment_runs() {
-		reset_forward_run();
-		reset_reverse_run();
-	}
-
-	inline std::string print_adjusted_forward_blocks() {
-		std::stringstream ss("");
-		std::lock_guard<std::mutex> lock(forward_mutex);
-		ss << "Forward blocks (" << v_fwd_blocks.size() << "):" << std::endl;
-		for (UINT32 i=0; i<v_fwd_blocks.size(); ++i)
-			if (v_fwd_blocks.at(i).adjusted)
-				ss << v_fwd_blocks.at(i).block_index << " ";
-		return ss.str();
-	}
-
-	inline std::string print_adjusted_reverse_blocks() {
-		std::lock_guard<std::mutex> lock(reverse_mutex);
-		std::stringstream ss;
-		ss << "Reverse blocks (" << v_fwd_blocks.size() << "):" << std::endl;
-		for (UINT32 i=0; i<v_rev_blocks.size(); ++i)
-			if (v_rev_blocks.at(i).adjusted)
-				ss << v_rev_blocks.at(i).block_index << " ";
-		return ss.str();
-	}
-
-	inline std::string print_adjusted_blocks() {
-		std::stringstream ss;
-		ss << std::endl <<
-			print_adjusted_forward_blocks() << std::endl <<
-			print_adjusted_reverse_blocks() << std::endl;
-		return ss.str();
+	task_graph() : generation_(0), pool_threads_(0), pool_active_(0), shutdown_(false) {}
+	virtual ~task_graph()
+	{
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex_);
+			shutdown_ = true;
+		}
+		pool_wake_.notify_all();
+		for_each(pool_.begin(), pool_.end(), std::mem_fn(&std::thread::join));
 	}
 
-	// Set started state to true
-	inline void combine_run_started() {					// combine run
-		std::lock_guard<std::mutex> lock(cmb_state_mutex);
-		combine_is_running = true; 
+	// Adds a task and returns its id
+	inline UINT32 add_task(const std::function<void()>& task) {
+		tasks_.push_back(task);
+		successors_.push_back(std::vector<UINT32>());
+		predecessors_.push_back(0);
+		return static_cast<UINT32>(tasks_.size() - 1);
 	}
-	inline void forward_run_started() {					// forward run 
-		std::lock_guard<std::mutex> lock(fwd_state_mutex);
-		forward_is_running = true; 
+
+	// Task after cannot start until task before has finished.  When a task
+	// finishes, the worker that ran it continues with the first of its 
+	// successors that is ready to run.  Hence, dependencies on the critical 
+	// path (e.g. from one block to the next) should be added first.
+	inline void add_dependency(const UINT32& before, const UINT32& after) {
+		successors_.at(before).push_back(after);
+		++predecessors_.at(after);
 	}
-	inline void reverse_run_started() {					// reverse run
-		std::lock_guard<std::mutex> lock(rev_state_mutex);
-		reverse_is_running = true; 
+
+	inline std::size_t size() const { return tasks_.size(); }
+
+	inline void clear() {
+		tasks_.clear();
+		successors_.clear();
+		predecessors_.clear();
 	}
-	
-	// Set finished state to true
-	inline void combine_run_stopped() {					// combine run
-		std::lock_guard<std::mutex> lock(cmb_state_mutex);
-		combine_is_running = false;						
-	}													
-	inline void forward_run_finished() {				// forward run
-		std::lock_guard<std::mutex> lock(fwd_state_mutex);
-		forward_is_running = false;						
-	}													
-	inline void reverse_run_finished() {				// reverse run
-		std::lock_guard<std::mutex> lock(rev_state_mutex);
-		reverse_is_running = false; 
+
+	// Index of the worker running the calling task.  The thread calling
+	// run() is worker 0.
+	static inline UINT32& worker_id() {
+		static thread_local UINT32 id(0);
+		return id;
 	}
-	
-	// Get running state
-	inline bool get_combine_state() {		// combine run
-		std::lock_guard<std::mutex> lock(cmb_state_mutex);
-		return combine_is_running;				  
-	}											  
-	inline bool get_forward_state() {		// forward run
-		std::lock_guard<std::mutex> lock(fwd_state_mutex);
-		return forward_is_running;				  
-	}											  
-	inline bool get_reverse_state() {		// reverse run
-		std::lock_guard<std::mutex> lock(rev_state_mutex);
-		return reverse_is_running; 
+
+	// Is the calling thread running a task?  Work which could itself be 
+	// divided amongst threads should not be when this is so, since the
+	// cores are already occupied by the graph's workers.
+	static inline bool& in_task() {
+		static thread_local bool running(false);
+		return running;
 	}
-	
-	inline bool is_forward_finished() {		// forward run
-		std::lock_guard<std::mutex> lock(fwd_state_mutex);
-		return forward_is_running == false;				  
-	}											  
-	inline bool is_reverse_finished() {		// reverse run
-		std::lock_guard<std::mutex> lock(rev_state_mutex);
-		return reverse_is_running == false;				  
-	}											  
-	
-	// It is dangerous to aquire a lock if one is already held 
-	// (e.g. lock fwd_state_mutex, then lock rev_state_mutex)
-	// so use unlock for forward before locking reverse
-	inline bool any_still_running() { 
-		if (get_forward_state())
-			return true;		
-		std::lock_guard<std::mutex> lock_r(rev_state_mutex);
-		return reverse_is_running; 
-	}
-	inline bool finished_all_runs() { 
-		if (get_forward_state())
-			return false;		
-		std::lock_guard<std::mutex> lock_r(rev_state_mutex);
-		return !reverse_is_running; 
+
+	// Runs all tasks using the calling thread and threads-1 additional
+	// threads (0 uses all cores).  run() may be called more than once.
+	inline void run(UINT32 threads, const std::function<bool()>& cancelled = std::function<bool()>())
+	{
+		const UINT32 count(static_cast<UINT32>(tasks_.size()));
+		if (count == 0)
+			return;
+
+		check_acyclic();
+
+		if (threads == 0)
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		threads = std::min(threads, count);
+
+		pending_.reset(new std::atomic<UINT32>[count]);
+		for (UINT32 t(0); t<count; ++t)
+			pending_[t] = predecessors_.at(t);
+
+		workers_.clear();
+		for (UINT32 w(0); w<threads; ++w)
+			workers_.push_back(std::unique_ptr<worker_queue>(new worker_queue));
+
+		ready_ = 0;
+		remaining_ = count;
+		stop_ = false;
+		error_ = std::exception_ptr();
+		cancelled_ = cancelled;
+
+		// Share the tasks without dependencies amongst the workers, such 
+		// that each worker starts them in order of id
+		std::vector<UINT32> initial;
+		for (UINT32 t(0); t<count; ++t)
+			if (predecessors_.at(t) == 0)
+				initial.push_back(t);
+		for (UINT32 i(static_cast<UINT32>(initial.size())); i>0; --i)
+		{
+			workers_.at((i - 1) % threads)->tasks.push_back(initial.at(i - 1));
+			++ready_;
+		}
+
+		try {
+			// Add to the retained threads if fewer than required
+			while (pool_.size() + 1 < threads)
+				pool_.push_back(std::thread(&task_graph::pool_work, this, 
+					static_cast<UINT32>(pool_.size() + 1), generation_));
+		}
+		catch (...) {
+			// Thread creation failed
+			stop(std::current_exception());
+		}
+
+		if (!stop_)
+		{
+			// Start threads 1 to threads-1 on this run
+			{
+				std::lock_guard<std::mutex> lock(pool_mutex_);
+				++generation_;
+				pool_threads_ = threads - 1;
+				pool_active_ = threads - 1;
+			}
+			pool_wake_.notify_all();
+
+			work(0);
+
+			std::unique_lock<std::mutex> lock(pool_mutex_);
+			pool_done_.wait(lock, [this] { return pool_active_ == 0; });
+		}
+
+		workers_.clear();
+		pending_.reset();
+		cancelled_ = std::function<bool()>();
+
+		if (error_)
+			std::rethrow_exception(error_);
 	}
-	
-	inline void set_forward_block_adjusted(const T& block) {
-		std::lock_guard<std::mutex> lock(forward_mutex);
-		v_fwd_blocks.at(block).solution();
+
+private:
+	struct worker_queue {
+		std::mutex mutex;
+		std::deque<UINT32> tasks;
+	};
+
+	inline void check_acyclic() const
+	{
+		const UINT32 count(static_cast<UINT32>(tasks_.size()));
+		std::vector<UINT32> pending(predecessors_), ready;
+		for (UINT32 t(0); t<count; ++t)
+			if (pending.at(t) == 0)
+				ready.push_back(t);
+		
+		UINT32 visited(0);
+		while (!ready.empty())
+		{
+			const UINT32 t(ready.back());
+			ready.pop_back();
+			++visited;
+			for (const UINT32& s : successors_.at(t))
+				if (--pending.at(s) == 0)
+					ready.push_back(s);
+		}
+
+		if (visited != count)
+			throw std::runtime_error("task_graph::run(): The task dependencies form a cycle.");
 	}
-	inline void set_reverse_block_adjusted(const T& block) {
-		std::lock_guard<std::mutex> lock(reverse_mutex);
-		v_rev_blocks.at(block).solution();
+
+	inline bool next_task(const UINT32& w, UINT32& task)
+	{
+		const UINT32 threads(static_cast<UINT32>(workers_.size()));
+		for (UINT32 i(0); i<threads; ++i)
+		{
+			worker_queue& queue(*workers_.at((w + i) % threads));
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+				continue;
+			// Take the newest task from this worker's deque, or 
+			// steal the oldest task from another worker's deque
+			if (i == 0)
+			{
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+			--ready_;
+			return true;
+		}
+		return false;
 	}
-	
-	inline bool forward_block_adjusted(const T& block) {
-		std::lock_guard<std::mutex> lock(forward_mutex);
-		return v_fwd_blocks.at(block).adjusted;
-	}	
-	inline bool reverse_block_adjusted(const T& block) {
-		std::lock_guard<std::mutex> lock(reverse_mutex);
-		return v_rev_blocks.at(block).adjusted;
+
+	inline void push(const UINT32& w, const UINT32& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(workers_.at(w)->mutex);
+			workers_.at(w)->tasks.push_back(task);
+		}
+		{
+			std::lock_guard<std::mutex> lock(wait_mutex_);
+			++ready_;
+		}
+		wake_.notify_one();
 	}
-private:
-	bool forward_is_running;
-	bool reverse_is_running;
-	bool combine_is_running;
 
-	std::vector< sequential_adj_t<T, bool> > v_fwd_blocks;
-	std::vector< sequential_adj_t<T, bool> > v_rev_blocks;
+	inline void stop(const std::exception_ptr& error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(wait_mutex_);
+			if (error && !error_)
+				error_ = error;
+			stop_ = true;
+		}
+		wake_.notify_all();
+	}
+
+	inline void work(const UINT32 w)
+	{
+		worker_id() = w;
+		UINT32 task;
+
+		while (true)
+		{
+			if (!next_task(w, task))
+			{
+				// Wait until a task is readied, or there is nothing left to do
+				std::unique_lock<std::mutex> lock(wait_mutex_);
+				wake_.wait(lock, [this] { return ready_ > 0 || remaining_ == 0 || stop_; });
+				if (remaining_ == 0 || stop_)
+					return;
+				continue;
+			}
+
+			if (stop_)
+				return;
+
+			const bool nested(in_task());
+			try {
+				if (cancelled_ && cancelled_())
+				{
+					stop(std::exception_ptr());
+					return;
+				}
+				in_task() = true;
+				tasks_.at(task)();
+				in_task() = nested;
+			}
+			catch (...) {
+				in_task() = nested;
+				stop(std::current_exception());
+				return;
+			}
+
+			// Ready the successors of this task, such that the first 
+			// successor is the next task taken by this worker
+			const std::vector<UINT32>& successors(successors_.at(task));
+			for (auto s = successors.rbegin(); s != successors.rend(); ++s)
+				if (--pending_[*s] == 0)
+					push(w, *s);
+
+			if (--remaining_ == 0)
+			{
+				std::lock_guard<std::mutex> lock(wait_mutex_);
+				wake_.notify_all();
+			}
+		}
+	}
+
+	// A retained thread, which runs as worker w on each run() requiring
+	// more than w threads
+	inline void pool_work(const UINT32 w, UINT32 generation)
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(pool_mutex_);
+				pool_wake_.wait(lock, [this, &generation] { return shutdown_ || generation_ != generation; });
+				if (shutdown_)
+					return;
+				generation = generation_;
+				if (w > pool_threads_)
+					continue;
+			}
+
+			work(w);
+
+			{
+				std::lock_guard<std::mutex> lock(pool_mutex_);
+				--pool_active_;
+			}
+			pool_done_.notify_all();
+		}
+	}
+
+	std::vector< std::function<void()> > tasks_;
+	std::vector< std::vector<UINT32> > successors_;
+	std::vector<UINT32> predecessors_;
+
+	// Retained threads
+	std::vector<std::thread> pool_;
+	UINT32 generation_;				// incremented on each run()
+	UINT32 pool_threads_;			// retained threads required by the current run
+	UINT32 pool_active_;			// retained threads yet to finish the current run
+	bool shutdown_;
+	std::mutex pool_mutex_;
+	std::condition_variable pool_wake_;
+	std::condition_variable pool_done_;
+
+	// State of the current run
+	std::vector< std::unique_ptr<worker_queue> > workers_;
+	std::unique_ptr< std::atomic<UINT32>[] > pending_;
+	std::atomic<UINT32> ready_;
+	std::atomic<UINT32> remaining_;
+	std::atomic<bool> stop_;
+	std::exception_ptr error_;
+	std::function<bool()> cancelled_;
+	std::mutex wait_mutex_;
+	std::condition_variable wake_;
+};
+
 
-	mutable std::mutex forward_mutex, reverse_mutex, combine_mutex;
-	mutable std::mutex fwd_state_mutex, rev_state_mutex, cmb_state_mutex;
+// Runs tasks in order of submission on a single background thread, so
+// that (file) i/o can proceed whilst the calling thread carries on with
+// other work.  Each task is tagged with a key (e.g. a block number).  No
+// more than max_in_flight tasks may be queued or running at once, so
+// submit() waits until an earlier task has finished once this limit is
+// reached.  wait(key) waits until all tasks tagged with key have finished,
+// and wait_all() waits until the queue is empty.
+//
+// If a task throws, the exception is re-thrown by the next call to
+// submit(), wait() or wait_all().
+class io_pipeline
+{
+public:
+	io_pipeline(const UINT32 max_in_flight = 2)
+		: max_in_flight_(std::max(max_in_flight, 1u)), stop_(false), running_(false) {}
+
+	virtual ~io_pipeline() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		if (worker_.joinable())
+			worker_.join();
+	}
+
+	inline void submit(const UINT32& key, const std::function<void()>& task)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [this] { return queue_.size() < max_in_flight_ || error_; });
+		rethrow(lock);
+		queue_.push_back(std::make_pair(key, task));
+
+		// Start the worker upon the first submission
+		if (!worker_.joinable())
+			worker_ = std::thread(&io_pipeline::work, this);
+
+		lock.unlock();
+		wake_.notify_one();
+	}
+
+	inline void wait(const UINT32& key)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [this, &key] {
+			return error_ ||
+				std::find_if(queue_.begin(), queue_.end(),
+					[&key](const std::pair<UINT32, std::function<void()> >& task) {
+						return task.first == key; }) == queue_.end(); });
+		rethrow(lock);
+	}
+
+	inline void wait_all()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [this] { return queue_.empty() || error_; });
+		rethrow(lock);
+	}
+
+	inline bool empty() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return queue_.empty();
+	}
+
+private:
+	inline void rethrow(std::unique_lock<std::mutex>& lock)
+	{
+		if (!error_)
+			return;
+
+		// Discard the tasks yet to run, and wait for the running
+		// task (if any) to finish before reporting the error
+		std::exception_ptr error(error_);
+		if (running_)
+			queue_.erase(queue_.begin() + 1, queue_.end());
+		else
+			queue_.clear();
+		done_.wait(lock, [this] { return !running_; });
+		queue_.clear();
+		error_ = std::exception_ptr();
+		std::rethrow_exception(error);
+	}
+
+	inline void work()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true)
+		{
+			wake_.wait(lock, [this] { return !queue_.empty() || stop_; });
+			if (queue_.empty())
+				return;
+
+			// The task remains at the front of the queue whilst running,
+			// so that wait() sees it
+			std::function<void()> task(queue_.front().second);
+			running_ = true;
+			lock.unlock();
+
+			std::exception_ptr error;
+			try {
+				task();
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+
+			lock.lock();
+			running_ = false;
+			if (!queue_.empty())
+				queue_.pop_front();
+			if (error && !error_)
+				error_ = error;
+			done_.notify_all();
+		}
+	}
 
+	const UINT32 max_in_flight_;
+	std::deque< std::pair<UINT32, std::function<void()> > > queue_;
+	bool stop_;
+	bool running_;
+	std::exception_ptr error_;
+	std::thread worker_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
 };
 
 
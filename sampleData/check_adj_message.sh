@@ -0,0 +1,10 @@
+#!/bin/bash
+# Check that an adjustment output file contains a message. Exits 1 if not.
+[ $# -lt 2 ] && { echo "Usage: $0 <file> <message> ..."; exit 1; }
+f="$1"; shift
+[ -f "$f" ] || { echo "FAIL: $f not found"; exit 1; }
+r=0
+for m in "$@"; do
+    grep -Fq "$m" "$f" && echo "PASS: \"$m\" in $f" || { echo "FAIL: \"$m\" not in $f"; r=1; }
+done
+exit $r
@@ -0,0 +1,161 @@
+//============================================================================
+// Name         : test_buffer_arena.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "math/dnamatrix_contiguous.hpp"
+#include "math/dnamatrix_symmetric.hpp"
+#include "memory/dnabuffer_arena.hpp"
+#include "testing.hpp"
+
+using namespace dynadjust::math;
+using namespace dynadjust::memory;
+
+TEST_CASE("Buffers are rounded up to size classes", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+
+    const std::size_t sizes[] = {0, 1, 3, 9, 16, 17, 33, 100, 1000, 123457};
+    for (const std::size_t& n : sizes) {
+        double* buffer(arena.acquire(n));
+        const std::size_t capacity(buffer_arena::capacity(buffer));
+        REQUIRE(capacity >= n);
+        REQUIRE(capacity <= 16 || capacity * 4 <= n * 5 + 4);
+        for (std::size_t i(0); i < n; ++i) REQUIRE(buffer[i] == 0.0);
+        arena.release(buffer);
+    }
+}
+
+TEST_CASE("Released buffers are reused", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+
+    double* buffer(arena.acquire(90));
+    for (std::size_t i(0); i < 90; ++i) buffer[i] = 1.0;
+    arena.release(buffer);
+
+    const arena_statistics before(arena.statistics());
+
+    // A buffer of a similar size is drawn from the same size class
+    double* reused(arena.acquire(92, false));
+    REQUIRE(reused == buffer);
+    REQUIRE(arena.statistics().reuses == before.reuses + 1);
+
+    // Lazy zeroing leaves the previous contents
+    REQUIRE(reused[0] == 1.0);
+    arena.release(reused);
+
+    reused = arena.acquire(92);
+    REQUIRE(reused == buffer);
+    REQUIRE(reused[0] == 0.0);
+    arena.release(reused);
+}
+
+TEST_CASE("Matrices draw from the arena", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+    arena.reset_peak();
+    const arena_statistics before(arena.statistics());
+
+    {
+        matrix_2d a(30, 30), b(a);
+        symmetric_matrix n(30, 30);
+        REQUIRE(arena.statistics().bytes_in_use >= before.bytes_in_use + 2 * 900 * sizeof(double));
+        REQUIRE(arena.statistics().peak_bytes_in_use >= arena.statistics().bytes_in_use);
+
+        // redim retains elements when the buffer grows
+        a.put(29, 29, 5.0);
+        a.put(3, 7, 2.0);
+        a.redim(40, 35);
+        REQUIRE(a.get(29, 29) == 5.0);
+        REQUIRE(a.get(3, 7) == 2.0);
+        REQUIRE(a.get(39, 34) == 0.0);
+        REQUIRE(a.get(35, 29) == 0.0);
+    }
+
+    REQUIRE(arena.statistics().bytes_in_use == before.bytes_in_use);
+}
+
+TEST_CASE("Lease buffers are returned to the shared lists", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+    double* buffer;
+    {
+        arena_lease lease(7);
+        REQUIRE(arena_lease::current() == 7);
+        buffer = arena.acquire(500);
+        arena.release(buffer);
+
+        // reused within the lease
+        REQUIRE(arena.acquire(500) == buffer);
+        arena.release(buffer);
+    }
+    REQUIRE(arena_lease::current() == 0);
+
+    // not available outside the lease until the lease is released
+    double* other(arena.acquire(500));
+    REQUIRE(other != buffer);
+    arena.release(other);
+
+    arena.release_lease(7);
+
+    double* first(arena.acquire(500));
+    double* second(arena.acquire(500));
+    REQUIRE((first == buffer || second == buffer));
+    arena.release(first);
+    arena.release(second);
+}
+
+TEST_CASE("Retention limit bounds cached memory", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+    const std::size_t limit(arena.retention_limit());
+
+    arena.retention_limit(0);
+    REQUIRE(arena.statistics().bytes_cached == 0);
+
+    double* buffer(arena.acquire(1000));
+    arena.release(buffer);
+    REQUIRE(arena.statistics().bytes_cached == 0);
+
+    arena.retention_limit(limit);
+}
+
+TEST_CASE("Buffers may be acquired and released by many threads", "[buffer_arena]") {
+    buffer_arena& arena(buffer_arena::instance());
+    const std::size_t in_use(arena.statistics().bytes_in_use);
+
+    std::vector<std::thread> threads;
+    for (UINT32 t(0); t < 4; ++t)
+        threads.push_back(std::thread([t]() {
+            arena_lease lease(t % 2 == 0 ? t + 100 : 0);
+            for (UINT32 i(0); i < 200; ++i) {
+                matrix_2d m(3 + (i % 5), 3);
+                m.put(0, 0, 1.0);
+                matrix_2d c(m);
+                if (c.get(0, 0) != 1.0) throw std::runtime_error("copy failed");
+            }
+        }));
+    for (auto& t : threads) t.join();
+
+    arena.release_lease(100);
+    arena.release_lease(102);
+    REQUIRE(arena.statistics().bytes_in_use == in_use);
+}
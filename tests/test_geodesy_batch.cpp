@@ -0,0 +1,112 @@
+//============================================================================
+// Name         : test_geodesy_batch.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <cmath>
+#include <vector>
+
+#include "config/dnaconsts.hpp"
+#include "config/dnatypes-basic.hpp"
+#include "functions/dnatemplategeodesyfuncs.hpp"
+#include "testing.hpp"
+
+namespace {
+
+const std::size_t point_count(157);  // several batches, and not a multiple of the vector width
+const double tolerance(1.0e-12);
+
+// Geographic coordinates spread over all four quadrants, both
+// hemispheres and a range of heights
+void form_geographic(std::vector<double>& latitude, std::vector<double>& longitude, std::vector<double>& height) {
+    latitude.resize(point_count);
+    longitude.resize(point_count);
+    height.resize(point_count);
+    for (std::size_t i(0); i < point_count; ++i) {
+        latitude.at(i) = -1.5 + 3.0 * i / (point_count - 1);
+        longitude.at(i) = -3.1 + 6.2 * ((i * 7) % point_count) / (point_count - 1);
+        height.at(i) = -100.0 + 250.0 * ((i * 5) % 11);
+    }
+}
+
+bool close(const double& a, const double& b) { return fabs(a - b) <= tolerance * std::max(1.0, fabs(b)); }
+
+} // namespace
+
+TEST_CASE("Batched GeoToCart matches scalar GeoToCart", "[geodesy]") {
+    CDnaEllipsoid ellipsoid;
+    std::vector<double> latitude, longitude, height;
+    form_geographic(latitude, longitude, height);
+
+    std::vector<double> x(point_count), y(point_count), z(point_count);
+    GeoToCart_Batch(latitude.data(), longitude.data(), height.data(), x.data(), y.data(), z.data(), point_count,
+                    &ellipsoid);
+
+    double X, Y, Z;
+    for (std::size_t i(0); i < point_count; ++i) {
+        GeoToCart(latitude.at(i), longitude.at(i), height.at(i), &X, &Y, &Z, &ellipsoid);
+        REQUIRE(close(x.at(i), X));
+        REQUIRE(close(y.at(i), Y));
+        REQUIRE(close(z.at(i), Z));
+    }
+}
+
+TEST_CASE("Batched CartToGeo matches scalar CartToGeo", "[geodesy]") {
+    CDnaEllipsoid ellipsoid;
+    std::vector<double> latitude, longitude, height;
+    form_geographic(latitude, longitude, height);
+
+    std::vector<double> x(point_count), y(point_count), z(point_count), lat(point_count);
+    GeoToCart_Batch(latitude.data(), longitude.data(), height.data(), x.data(), y.data(), z.data(), point_count,
+                    &ellipsoid);
+
+    CartToLat_Batch(x.data(), y.data(), z.data(), lat.data(), point_count, &ellipsoid);
+
+    // Convert in place
+    CartToGeo_Batch(x.data(), y.data(), z.data(), x.data(), y.data(), z.data(), point_count, &ellipsoid);
+
+    double X, Y, Z, Latitude, Longitude, Height;
+    for (std::size_t i(0); i < point_count; ++i) {
+        GeoToCart(latitude.at(i), longitude.at(i), height.at(i), &X, &Y, &Z, &ellipsoid);
+        CartToGeo(X, Y, Z, &Latitude, &Longitude, &Height, &ellipsoid);
+        REQUIRE(close(x.at(i), Latitude));
+        REQUIRE(close(y.at(i), Longitude));
+        REQUIRE(close(z.at(i), Height));
+        REQUIRE(close(lat.at(i), CartToLat(X, Y, Z, &ellipsoid)));
+    }
+}
+
+TEST_CASE("Batched latitude partial derivatives match scalar derivatives", "[geodesy]") {
+    CDnaEllipsoid ellipsoid;
+    std::vector<double> latitude, longitude, height;
+    form_geographic(latitude, longitude, height);
+
+    double X, Y, Z, lat, lat_batch, partials[3];
+    for (std::size_t i(0); i < point_count; ++i) {
+        GeoToCart(latitude.at(i), longitude.at(i), height.at(i), &X, &Y, &Z, &ellipsoid);
+        PartialD_Latitude_Batch(X, Y, Z, &lat_batch, partials, &ellipsoid);
+
+        REQUIRE(close(partials[x_element], PartialD_Latitude_F(X, Y, Z, x_element, &lat, &ellipsoid)));
+        REQUIRE(close(lat_batch, lat));
+        REQUIRE(close(partials[y_element], PartialD_Latitude(X, Y, Z, y_element, lat, &ellipsoid)));
+        REQUIRE(close(partials[z_element], PartialD_Latitude(X, Y, Z, z_element, lat, &ellipsoid)));
+    }
+}
@@ -22,7 +22,10 @@
 #define TESTING_MAIN
 
 #include <cmath>
+#include <memory>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "math/dnamatrix_contiguous.hpp"
 #include "testing.hpp"
@@ -53,6 +56,86 @@ TEST_CASE("Copy constructor", "[matrix_2d]") {
     REQUIRE(mat2.get(1, 1) == 4.0);
 }
 
+TEST_CASE("Move constructor takes ownership of the buffer", "[matrix_2d]") {
+    matrix_2d mat1(3, 2);
+    mat1.put(2, 1, 5.0);
+    const double* buffer(mat1.getbuffer());
+
+    matrix_2d mat2(std::move(mat1));
+
+    REQUIRE(mat2.getbuffer() == buffer);
+    REQUIRE(mat2.rows() == 3);
+    REQUIRE(mat2.columns() == 2);
+    REQUIRE(mat2.get(2, 1) == 5.0);
+    REQUIRE(mat1.empty());
+    REQUIRE(mat1.rows() == 0);
+}
+
+TEST_CASE("Move assignment takes ownership of the buffer", "[matrix_2d]") {
+    matrix_2d mat1(4, 4), mat2(2, 2);
+    mat1.put(3, 3, 7.0);
+    const double* buffer(mat1.getbuffer());
+
+    mat2 = std::move(mat1);
+
+    REQUIRE(mat2.getbuffer() == buffer);
+    REQUIRE(mat2.rows() == 4);
+    REQUIRE(mat2.memRows() == 4);
+    REQUIRE(mat2.get(3, 3) == 7.0);
+    REQUIRE(mat1.empty());
+
+    // vectors of matrices move (rather than copy) on reallocation
+    std::vector<matrix_2d> mats(1, matrix_2d(2, 2));
+    buffer = mats.at(0).getbuffer();
+    mats.reserve(mats.capacity() + 1);
+    REQUIRE(mats.at(0).getbuffer() == buffer);
+}
+
+TEST_CASE("In-place operations return this matrix", "[matrix_2d]") {
+    matrix_2d mat(2, 2);
+    mat.put(0, 0, 1.0);
+    mat.put(1, 1, 2.0);
+
+    REQUIRE(&mat.scale(2.0) == &mat);
+    REQUIRE(&mat.add(mat) == &mat);
+    REQUIRE(mat.get(1, 1) == 8.0);
+}
+
+TEST_CASE("Views of sub-matrices", "[matrix_2d]") {
+    matrix_2d src(4, 5), dest(3, 3), expected(3, 3);
+    for (UINT32 i(0); i < 4; ++i)
+        for (UINT32 j(0); j < 5; ++j) src.put(i, j, i * 10.0 + j);
+
+    matrix_view view(src.view(1, 2, 3, 3));
+    REQUIRE(view.rows() == 3);
+    REQUIRE(view.columns() == 3);
+    REQUIRE(view.get(0, 0) == 12.0);
+    REQUIRE(view.get(2, 1) == 33.0);
+
+    // view-based operations match their (row, column, rows, cols) counterparts
+    dest.copyelements(0, 0, view);
+    expected.copyelements(0, 0, src, 1, 2, 3, 3);
+    REQUIRE(dest.get(2, 2) == expected.get(2, 2));
+    REQUIRE(dest.get(1, 0) == expected.get(1, 0));
+
+    dest.blockadd(0, 0, view);
+    expected.blockadd(0, 0, src, 1, 2, 3, 3);
+    dest.blockTadd(0, 0, src.view(1, 1, 3, 3));
+    expected.blockTadd(0, 0, src, 1, 1, 3, 3);
+    dest.blocksubtract(0, 0, src.view(0, 0, 3, 3));
+    expected.blocksubtract(0, 0, src, 0, 0, 3, 3);
+    for (UINT32 i(0); i < 3; ++i)
+        for (UINT32 j(0); j < 3; ++j) REQUIRE(dest.get(i, j) == expected.get(i, j));
+
+    bool caught = false;
+    try {
+        src.view(2, 2, 3, 3);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
 TEST_CASE("Addition", "[matrix_2d]") {
     matrix_2d mat1(2, 2);
     mat1.put(0, 0, 1.0);
@@ -587,3 +670,51 @@ TEST_CASE("Cholesky inverse with LOWER_IS_CLEARED", "[matrix_2d]") {
     REQUIRE(abs(inverse.get(0, 2) - inverse.get(2, 0)) < 1e-10);
     REQUIRE(abs(inverse.get(1, 2) - inverse.get(2, 1)) < 1e-10);
 }
+
+TEST_CASE("Mapped file regions are wrapped rather than copied", "[matrix_2d]") {
+    matrix_2d mat(4, 3);
+    for (UINT32 r = 0; r < 4; ++r)
+        for (UINT32 c = 0; c < 3; ++c) mat.put(r, c, r * 3.0 + c);
+    mat.shrink(1, 0);
+
+    // Regions hold doubles, and so are aligned as such
+    std::shared_ptr<std::vector<double> > region(
+        new std::vector<double>(mat.get_size() / sizeof(double) + 1));
+    mat.WriteMappedFileRegion(region->data());
+
+    matrix_2d mapped;
+    mapped.MapFileRegion(region->data(), region);
+    REQUIRE(mapped.mapped());
+    REQUIRE(mapped.rows() == 3);
+    REQUIRE(mapped.memRows() == 4);
+    REQUIRE(mapped.get(2, 1) == 7.0);
+
+    // Changes are made to the region
+    mapped.put(0, 0, -1.0);
+    matrix_2d read;
+    read.ReadMappedFileRegion(region->data());
+    REQUIRE(read.get(0, 0) == -1.0);
+    REQUIRE(!read.mapped());
+
+    // Growing within the mapped size does not copy
+    mapped.grow(1, 0);
+    mapped.redim(4, 2);
+    REQUIRE(mapped.mapped());
+
+    // Growing beyond the mapped size copies the elements
+    mapped.redim(5, 3);
+    REQUIRE(!mapped.mapped());
+    REQUIRE(mapped.get(0, 0) == -1.0);
+    REQUIRE(mapped.get(3, 1) == 10.0);
+    mapped.put(0, 0, 1.0);
+    read.ReadMappedFileRegion(region->data());
+    REQUIRE(read.get(0, 0) == -1.0);
+
+    // The region is released once no longer used
+    std::weak_ptr<std::vector<double> > released(region);
+    mapped.MapFileRegion(region->data(), region);
+    region.reset();
+    REQUIRE(!released.expired());
+    mapped.deallocate();
+    REQUIRE(released.expired());
+}
@@ -124,7 +124,7 @@ TEST_CASE("LoadForSimultaneous throws on missing files", "[network_data_loader][
     std::vector<blockMeta_t> v_blockMeta;
     vvUINT32 v_parameterStationList;
     vv_stn_appear v_paramStnAppearance;
-    v_mat_2d v_junctionVariances, v_junctionVariancesFwd;
+    v_sym_mat v_junctionVariances, v_junctionVariancesFwd;
 
     bool threw = false;
     try {
@@ -0,0 +1,236 @@
+//============================================================================
+// Name         : test_rowblock_matrix.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <cmath>
+#include <stdexcept>
+
+#include "math/dnamatrix_rowblock.hpp"
+#include "testing.hpp"
+
+using namespace dynadjust::math;
+
+namespace {
+
+const UINT32 msr_count(12);
+const UINT32 unknowns_count(18);  // 6 stations
+
+// Forms a design matrix in which each measurement row connects two
+// stations, in both dense and row-block form
+template <typename T>
+void form_design(T& design) {
+    UINT32 m, e, stn1, stn2;
+    for (m = 0; m < msr_count; ++m) {
+        stn1 = (m % 6) * 3;
+        stn2 = ((m * 5 + 1) % 6) * 3;
+        for (e = 0; e < 3; ++e) {
+            design.put(m, stn1 + e, 1.0 + 0.1 * m + 0.01 * e);
+            design.put(m, stn2 + e, -1.0 - 0.1 * m - 0.01 * e);
+        }
+    }
+}
+
+template <typename T>
+void form_atvinv(T& atvinv) {
+    UINT32 m, e, stn;
+    for (m = 0; m < msr_count; ++m) {
+        stn = ((m * 7 + 2) % 6) * 3;
+        for (e = 0; e < 3; ++e) atvinv.put(stn + e, m, cos(1.0 + m + e));
+    }
+}
+
+template <typename T, typename U>
+bool equal(const T& a, const U& b) {
+    if (a.rows() != b.rows() || a.columns() != b.columns()) return false;
+    for (UINT32 i(0); i < a.rows(); ++i)
+        for (UINT32 j(0); j < a.columns(); ++j)
+            if (a.get(i, j) != b.get(i, j)) return false;
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Row-block storage holds only station blocks", "[rowblock_matrix]") {
+    rowblock_matrix design(msr_count, unknowns_count);
+    matrix_2d dense(msr_count, unknowns_count);
+    form_design(design);
+    form_design(dense);
+
+    REQUIRE(equal(design, dense));
+    // at most two blocks per measurement
+    REQUIRE(design.nonzeroBlocks() <= msr_count * 2);
+    REQUIRE(design.memorySize() >= design.nonzeroBlocks() * 3 * sizeof(double));
+
+    // Zero elements are not stored
+    design.put(0, 9, 0.0);
+    REQUIRE(design.get(0, 9) == 0.0);
+    REQUIRE(design.nonzeroBlocks() <= msr_count * 2);
+}
+
+TEST_CASE("Column storage matches dense At * V-1", "[rowblock_matrix]") {
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns);
+    matrix_2d dense(unknowns_count, msr_count);
+    form_atvinv(atvinv);
+    form_atvinv(dense);
+
+    REQUIRE(equal(atvinv, dense));
+    REQUIRE(atvinv.nonzeroBlocks() == msr_count);
+
+    // Changing the orientation retains the elements
+    atvinv.storage(blk_rows);
+    REQUIRE(equal(atvinv, dense));
+    atvinv.storage(blk_columns);
+    REQUIRE(equal(atvinv, dense));
+}
+
+TEST_CASE("Station blocks match element access", "[rowblock_matrix]") {
+    rowblock_matrix design(msr_count, unknowns_count);
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns);
+    form_design(design);
+    form_atvinv(atvinv);
+
+    double block[3];
+    UINT32 m, s, e;
+    for (m = 0; m < msr_count; ++m)
+        for (s = 0; s < unknowns_count; s += 3) {
+            design.getblock(m, s, block);
+            for (e = 0; e < 3; ++e) REQUIRE(block[e] == design.get(m, s + e));
+            atvinv.getblock(s, m, block);
+            for (e = 0; e < 3; ++e) REQUIRE(block[e] == atvinv.get(s + e, m));
+        }
+}
+
+TEST_CASE("Block range spans the stations of a line", "[rowblock_matrix]") {
+    rowblock_matrix design(msr_count, unknowns_count);
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns);
+    form_design(design);
+    form_atvinv(atvinv);
+
+    UINT32 m, first, last, stn1, stn2;
+    for (m = 0; m < msr_count; ++m) {
+        stn1 = m % 6;
+        stn2 = (m * 5 + 1) % 6;
+        REQUIRE(design.blockrange(m, first, last));
+        REQUIRE(first == std::min(stn1, stn2));
+        REQUIRE(last == std::max(stn1, stn2));
+
+        REQUIRE(atvinv.blockrange(m, first, last));
+        REQUIRE(first == (m * 7 + 2) % 6);
+        REQUIRE(last == first);
+    }
+
+    rowblock_matrix empty(msr_count, unknowns_count);
+    REQUIRE(!empty.blockrange(0, first, last));
+}
+
+TEST_CASE("Product with a dense vector matches dense multiply", "[rowblock_matrix]") {
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns), design(msr_count, unknowns_count);
+    matrix_2d dense_atvinv(unknowns_count, msr_count), dense_design(msr_count, unknowns_count);
+    form_atvinv(atvinv);
+    form_atvinv(dense_atvinv);
+    form_design(design);
+    form_design(dense_design);
+
+    matrix_2d v(msr_count, 1), x(unknowns_count, 1);
+    for (UINT32 i(0); i < msr_count; ++i) v.put(i, 0, sin(1.0 + i));
+    for (UINT32 i(0); i < unknowns_count; ++i) x.put(i, 0, sin(2.0 + i));
+
+    matrix_2d result(unknowns_count, 1), expected(unknowns_count, 1);
+    atvinv.multiply(v, result);
+    expected.multiply(dense_atvinv, "N", v, "N");
+    for (UINT32 i(0); i < unknowns_count; ++i) REQUIRE(fabs(result.get(i, 0) - expected.get(i, 0)) < 1e-14);
+
+    matrix_2d result2(msr_count, 1), expected2(msr_count, 1);
+    design.multiply(x, result2);
+    expected2.multiply(dense_design, "N", x, "N");
+    for (UINT32 i(0); i < msr_count; ++i) REQUIRE(fabs(result2.get(i, 0) - expected2.get(i, 0)) < 1e-14);
+
+    bool caught = false;
+    try {
+        design.multiply(v, result2);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Sub-matrix operations match dense matrices", "[rowblock_matrix]") {
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns);
+    matrix_2d dense(unknowns_count, msr_count), block(3, 6);
+    form_atvinv(atvinv);
+    form_atvinv(dense);
+
+    for (UINT32 i(0); i < 3; ++i)
+        for (UINT32 j(0); j < 6; ++j) block.put(i, j, 0.5 * (i + 1) - j);
+
+    atvinv.blockadd(4, 3, block, 0, 0, 3, 6);
+    dense.blockadd(4, 3, block, 0, 0, 3, 6);
+    REQUIRE(equal(atvinv, dense));
+
+    atvinv.copyelements(9, 1, block, 0, 2, 3, 3);
+    dense.copyelements(9, 1, block, 0, 2, 3, 3);
+    REQUIRE(equal(atvinv, dense));
+
+    atvinv.replace(12, 6, block);
+    dense.replace(12, 6, block);
+    REQUIRE(equal(atvinv, dense));
+
+    REQUIRE(equal(atvinv.submatrix(2, 1, 7, 5), dense.submatrix(2, 1, 7, 5)));
+
+    atvinv.zero(3, 2, 8, 4);
+    dense.zero(3, 2, 8, 4);
+    REQUIRE(equal(atvinv, dense));
+}
+
+TEST_CASE("Shrink and grow retain elements", "[rowblock_matrix]") {
+    rowblock_matrix atvinv(unknowns_count, msr_count, blk_columns);
+    matrix_2d dense(unknowns_count, msr_count);
+    form_atvinv(atvinv);
+    form_atvinv(dense);
+
+    atvinv.shrink(0, 3);
+    REQUIRE(atvinv.columns() == msr_count - 3);
+    REQUIRE(atvinv.memColumns() == msr_count);
+
+    atvinv.grow(0, 3);
+    REQUIRE(equal(atvinv, dense));
+
+    bool caught = false;
+    try {
+        atvinv.grow(0, 1);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+
+    // redim retains elements within the new dimensions
+    atvinv.redim(unknowns_count - 2, msr_count - 1);
+    for (UINT32 i(0); i < atvinv.rows(); ++i)
+        for (UINT32 j(0); j < atvinv.columns(); ++j) REQUIRE(atvinv.get(i, j) == dense.get(i, j));
+
+    // and zeroes the rest
+    REQUIRE(dense.get(unknowns_count - 1, 3) != 0.0);
+    REQUIRE(dense.get(3, msr_count - 1) != 0.0);
+    atvinv.redim(unknowns_count, msr_count);
+    REQUIRE(atvinv.get(unknowns_count - 1, 3) == 0.0);
+    REQUIRE(atvinv.get(3, msr_count - 1) == 0.0);
+}
@@ -15,6 +15,7 @@
 #include "../dynadjust/include/functions/dnatemplatedatetimefuncs.hpp"
 #include "../dynadjust/include/functions/dnachronutils.hpp"
 #include "../dynadjust/include/math/dnamatrix_contiguous.hpp"
+#include "../dynadjust/include/math/dnamatrix_symmetric.hpp"
 #include "../dynadjust/include/parameters/dnadatum.hpp"
 #include "../dynadjust/include/config/dnaoptions.hpp"
 #include "../dynadjust/include/functions/dnastrmanipfuncs.hpp"
@@ -61,7 +62,7 @@ void create_test_stations(vstn_t& stations) {
 }
 
 // Helper to create test estimates and variances
-void create_test_matrices(matrix_2d& estimates, matrix_2d& variances, size_t num_stations) {
+void create_test_matrices(matrix_2d& estimates, symmetric_matrix& variances, size_t num_stations) {
     size_t dim = num_stations * 3;
     
     // Initialize estimates (X, Y, Z for each station)
@@ -358,7 +359,8 @@ TEST_CASE("DnaIoSnx warning system", "[sinex][warnings]") {
     binary_file_meta_t bst_meta, bms_meta;
     create_test_metadata(bst_meta, bms_meta);
     
-    matrix_2d estimates, variances;
+    matrix_2d estimates;
+    symmetric_matrix variances;
     create_test_matrices(estimates, variances, stations.size());
     
     uint32_uint32_map blockStationsMap;
@@ -412,7 +414,8 @@ TEST_CASE("Write complete SINEX file", "[sinex][integration]") {
     binary_file_meta_t bst_meta, bms_meta;
     create_test_metadata(bst_meta, bms_meta);
     
-    matrix_2d estimates, variances;
+    matrix_2d estimates;
+    symmetric_matrix variances;
     create_test_matrices(estimates, variances, stations.size());
     
     uint32_uint32_map blockStationsMap;
@@ -493,7 +496,8 @@ TEST_CASE("SINEX site ID formatting", "[sinex][formatting]") {
     binary_file_meta_t bst_meta, bms_meta;
     create_test_metadata(bst_meta, bms_meta);
     
-    matrix_2d estimates, variances;
+    matrix_2d estimates;
+    symmetric_matrix variances;
     create_test_matrices(estimates, variances, 1);
     
     uint32_uint32_map blockStationsMap;
@@ -554,7 +558,7 @@ TEST_CASE("SINEX solution estimates formatting", "[sinex][formatting]") {
     estimates.put(1, 0, 2500000.98765432109876);   // Y
     estimates.put(2, 0, -3700000.11111111111111);  // Z
     
-    matrix_2d variances(3, 3);
+    symmetric_matrix variances(3, 3);
     variances.zero();
     variances.put(0, 0, 0.0001);  // X variance
     variances.put(1, 1, 0.0004);  // Y variance
@@ -618,7 +622,7 @@ TEST_CASE("SINEX variance matrix formatting", "[sinex][formatting]") {
     estimates.zero();
     
     // Create a 6x6 variance matrix with specific pattern
-    matrix_2d variances(6, 6);
+    symmetric_matrix variances(6, 6);
     variances.zero();
     
     // Fill lower triangular with test values
@@ -675,7 +679,7 @@ TEST_CASE("Handle empty data", "[sinex][edge]") {
     create_test_metadata(bst_meta, bms_meta);
     
     matrix_2d estimates(0, 0);
-    matrix_2d variances(0, 0);
+    symmetric_matrix variances(0, 0);
     
     uint32_uint32_map blockStationsMap;
     vUINT32 blockStations;
@@ -717,7 +721,8 @@ TEST_CASE("Multi-block SINEX output", "[sinex][multiblock]") {
     binary_file_meta_t bst_meta, bms_meta;
     create_test_metadata(bst_meta, bms_meta);
     
-    matrix_2d estimates, variances;
+    matrix_2d estimates;
+    symmetric_matrix variances;
     create_test_matrices(estimates, variances, stations.size());
     
     uint32_uint32_map blockStationsMap;
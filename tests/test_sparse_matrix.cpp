@@ -0,0 +1,338 @@
+//============================================================================
+// Name         : test_sparse_matrix.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "math/dnamatrix_sparse.hpp"
+#include "math/dnamatrix_variance.hpp"
+#include "testing.hpp"
+
+using namespace dynadjust::math;
+
+namespace {
+
+// Station pairs connected by a measurement.  Stations 0-5 form a ring
+// (which causes fill-in), and station 7 is connected to 0 and 6.
+const std::vector<std::pair<UINT32, UINT32>> connections = {
+    {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 0}, {6, 7}, {0, 7}, {2, 6}};
+
+const UINT32 station_count(8);
+
+// Forms a 3x3 block for the station pair (a, b) that is unique to the pair
+void pair_block(const UINT32& a, const UINT32& b, matrix_2d& block) {
+    for (UINT32 i(0); i < 3; ++i)
+        for (UINT32 j(0); j < 3; ++j) block.put(i, j, -0.1 * (1.0 + 0.1 * (a + b) + 0.01 * (i + j)));
+}
+
+// Adds symmetric normals for the test network to dense and sparse matrices
+template <typename T>
+void form_normals(T& normals, const double& diagonal) {
+    matrix_2d block(3, 3), var(3, 3);
+    UINT32 s, i, j;
+
+    for (s = 0; s < station_count; ++s) {
+        for (i = 0; i < 3; ++i)
+            for (j = 0; j < 3; ++j) var.put(i, j, i == j ? diagonal * (1.0 + s) : 0.05);
+        normals.blockadd(s * 3, s * 3, var, 0, 0, 3, 3);
+    }
+
+    for (const auto& c : connections) {
+        pair_block(c.first, c.second, block);
+        normals.blockadd(c.first * 3, c.second * 3, block, 0, 0, 3, 3);
+        normals.blockTadd(c.second * 3, c.first * 3, block, 0, 0, 3, 3);
+    }
+}
+
+void form_sparse(sparse_matrix& sparse, const double& diagonal) {
+    sparse.initialise(station_count * 3);
+    form_normals(sparse, diagonal);
+    sparse.analyse();
+    form_normals(sparse, diagonal);
+}
+
+} // namespace
+
+TEST_CASE("Symbolic analysis includes fill-in", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    form_sparse(sparse, 10.0);
+
+    REQUIRE(sparse.analysed());
+    REQUIRE(sparse.rows() == station_count * 3);
+    REQUIRE(sparse.blockCount() == station_count);
+    // 8 diagonal blocks + 9 measurement connections + fill caused by the ring
+    REQUIRE(sparse.nonzeroBlocks() > 17);
+    REQUIRE(sparse.nonzeroBlocks() < station_count * (station_count + 1) / 2);
+}
+
+TEST_CASE("Assembly retains the lower triangle", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    matrix_2d dense(station_count * 3, station_count * 3);
+    form_sparse(sparse, 10.0);
+    form_normals(dense, 10.0);
+
+    for (UINT32 i(0); i < dense.rows(); ++i)
+        for (UINT32 j(0); j <= i; ++j) REQUIRE(fabs(sparse.get(i, j) - dense.get(i, j)) < 1e-15);
+}
+
+TEST_CASE("Solution matches dense Cholesky inverse", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    matrix_2d dense(station_count * 3, station_count * 3);
+    form_sparse(sparse, 10.0);
+    form_normals(dense, 10.0);
+
+    sparse.factorise();
+    REQUIRE(sparse.factorised());
+
+    matrix_2d rhs(station_count * 3, 1), x, x_dense(station_count * 3, 1);
+    for (UINT32 i(0); i < rhs.rows(); ++i) rhs.put(i, 0, sin(1.0 + i));
+
+    sparse.solve(rhs, x);
+
+    dense.clearupper();
+    dense.cholesky_inverse();
+    x_dense.multiply(dense, "N", rhs, "N");
+
+    REQUIRE(x.rows() == rhs.rows());
+    for (UINT32 i(0); i < rhs.rows(); ++i) REQUIRE(fabs(x.get(i, 0) - x_dense.get(i, 0)) < 1e-12);
+
+    matrix_2d inverse;
+    sparse.inverse(inverse);
+    for (UINT32 i(0); i < dense.rows(); ++i)
+        for (UINT32 j(0); j < dense.columns(); ++j) REQUIRE(fabs(inverse.get(i, j) - dense.get(i, j)) < 1e-12);
+}
+
+TEST_CASE("Scaling to unity does not alter the solution", "[sparse_matrix]") {
+    sparse_matrix sparse, scaled;
+    form_sparse(sparse, 1.0e6);
+    form_sparse(scaled, 1.0e6);
+
+    sparse.factorise(false);
+    scaled.factorise(true);
+
+    matrix_2d rhs(station_count * 3, 1), x, x_scaled;
+    for (UINT32 i(0); i < rhs.rows(); ++i) rhs.put(i, 0, cos(1.0 + i));
+
+    sparse.solve(rhs, x);
+    scaled.solve(rhs, x_scaled);
+
+    for (UINT32 i(0); i < rhs.rows(); ++i) REQUIRE(fabs(x.get(i, 0) - x_scaled.get(i, 0)) < 1e-15);
+}
+
+TEST_CASE("Refactorisation after zero", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    form_sparse(sparse, 10.0);
+    sparse.factorise();
+
+    sparse.zero();
+    REQUIRE(!sparse.factorised());
+    form_normals(sparse, 20.0);
+    sparse.factorise();
+
+    matrix_2d dense(station_count * 3, station_count * 3), inverse;
+    form_normals(dense, 20.0);
+    dense.clearupper();
+    dense.cholesky_inverse();
+
+    sparse.inverse(inverse);
+    for (UINT32 i(0); i < dense.rows(); ++i)
+        for (UINT32 j(0); j < dense.columns(); ++j) REQUIRE(fabs(inverse.get(i, j) - dense.get(i, j)) < 1e-12);
+}
+
+TEST_CASE("Selected inverse matches dense inverse within structure", "[sparse_matrix]") {
+    for (const bool& scale : {false, true}) {
+        sparse_matrix sparse;
+        matrix_2d dense(station_count * 3, station_count * 3), selected;
+        form_sparse(sparse, 1.0e3);
+        form_normals(dense, 1.0e3);
+
+        sparse.factorise(scale);
+        sparse.selectedinverse();
+        REQUIRE(sparse.inverted());
+
+        dense.clearupper();
+        dense.cholesky_inverse();
+
+        // Diagonal blocks and the blocks of connected stations
+        UINT32 s, i, j;
+        for (s = 0; s < station_count; ++s)
+            for (i = 0; i < 3; ++i)
+                for (j = 0; j < 3; ++j)
+                    REQUIRE(fabs(sparse.getinverse(s * 3 + i, s * 3 + j) - dense.get(s * 3 + i, s * 3 + j)) < 1e-14);
+
+        for (const auto& c : connections)
+            for (i = 0; i < 3; ++i)
+                for (j = 0; j < 3; ++j) {
+                    REQUIRE(fabs(sparse.getinverse(c.first * 3 + i, c.second * 3 + j) -
+                                 dense.get(c.first * 3 + i, c.second * 3 + j)) < 1e-14);
+                    REQUIRE(fabs(sparse.getinverse(c.second * 3 + j, c.first * 3 + i) -
+                                 dense.get(c.second * 3 + j, c.first * 3 + i)) < 1e-14);
+                }
+
+        // Elements in the structure (including fill-in) are exact,
+        // and all others are zero
+        sparse.scatterinverse(selected);
+        for (i = 0; i < dense.rows(); ++i)
+            for (j = 0; j < dense.columns(); ++j)
+                REQUIRE(selected.get(i, j) == 0.0 || fabs(selected.get(i, j) - dense.get(i, j)) < 1e-14);
+    }
+}
+
+TEST_CASE("Selected inverse blocks and columns match elements", "[sparse_matrix]") {
+    for (const bool& scale : {false, true}) {
+        sparse_matrix sparse;
+        form_sparse(sparse, 1.0e3);
+        sparse.factorise(scale);
+        sparse.selectedinverse();
+
+        double block[9];
+        std::vector<double> column(station_count * 3);
+        UINT32 s, t, i, j;
+
+        for (s = 0; s < station_count; ++s)
+            for (t = 0; t < station_count; ++t) {
+                const bool held(sparse.getinverseblock(s * 3, t * 3, block));
+                for (i = 0; i < 3; ++i)
+                    for (j = 0; j < 3; ++j) {
+                        if (held)
+                            REQUIRE(block[i + j * 3] == sparse.getinverse(s * 3 + i, t * 3 + j));
+                        else
+                            REQUIRE(block[i + j * 3] == 0.0);
+                    }
+            }
+
+        for (j = 0; j < station_count * 3; ++j) {
+            sparse.getinversecolumn(j, column.data());
+            for (i = j; i < station_count * 3; ++i) {
+                if (sparse.getinverseblock((i / 3) * 3, (j / 3) * 3, block))
+                    REQUIRE(column.at(i - j) == sparse.getinverse(i, j));
+                else
+                    REQUIRE(column.at(i - j) == 0.0);
+            }
+        }
+
+        // Additions to the lower triangle are retained, in scaled storage
+        const double variance(sparse.getinverse(4, 3));
+        sparse.inverseadd(4, 3, 0.25);
+        sparse.inverseadd(3, 4, 0.25);
+        REQUIRE(fabs(sparse.getinverse(3, 4) - variance - 0.25) < 1e-15);
+    }
+}
+
+TEST_CASE("Selected inverse is written as a symmetric matrix", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    form_sparse(sparse, 1.0e3);
+    sparse.factorise(true);
+    sparse.selectedinverse();
+
+    const variance_matrix variances(&sparse);
+    std::stringstream ss;
+    variances.write(ss);
+
+    symmetric_matrix written;
+    std::string buffer(ss.str());
+    REQUIRE(buffer.size() == written.get_size() + sumOfConsecutiveIntegers(station_count * 3) * sizeof(double));
+    written.ReadMappedFileRegion(&buffer[0]);
+    REQUIRE(written.rows() == station_count * 3);
+
+    double block[9];
+    for (UINT32 i(0); i < written.rows(); ++i)
+        for (UINT32 j(0); j < written.rows(); ++j) {
+            REQUIRE(written.get(i, j) == variances.get(i, j));
+            variances.getblock((i / 3) * 3, (j / 3) * 3, block);
+            REQUIRE(block[(i % 3) + (j % 3) * 3] == variances.get(i, j));
+        }
+}
+
+TEST_CASE("Columns of selected stations are written as a symmetric matrix", "[sparse_matrix]") {
+    matrix_2d dense(station_count * 3, station_count * 3);
+    form_normals(dense, 1.0e3);
+    dense.clearupper();
+    dense.cholesky_inverse();
+
+    // Columns of stations 2 and 5 only
+    column_inverse columns;
+    columns.initialise(station_count * 3);
+    UINT32 i, j;
+    for (const UINT32& s : {5u, 2u})
+        for (j = s * 3; j < s * 3 + 3; ++j) {
+            double* column(columns.column(j));
+            for (i = 0; i < dense.rows(); ++i) column[i] = dense.get(i, j);
+        }
+    REQUIRE(columns.stationCount() == 2);
+
+    const variance_matrix variances(&columns);
+    for (i = 0; i < dense.rows(); ++i)
+        for (j = 0; j < dense.columns(); ++j) {
+            if (columns.held(i) || columns.held(j))
+                REQUIRE(variances.get(i, j) == dense.get(std::max(i, j), std::min(i, j)));
+            else
+                REQUIRE(variances.get(i, j) == 0.0);
+        }
+
+    std::stringstream ss;
+    variances.write(ss);
+
+    symmetric_matrix written;
+    std::string buffer(ss.str());
+    REQUIRE(buffer.size() == written.get_size() + sumOfConsecutiveIntegers(station_count * 3) * sizeof(double));
+    written.ReadMappedFileRegion(&buffer[0]);
+    for (i = 0; i < written.rows(); ++i)
+        for (j = 0; j < written.rows(); ++j) REQUIRE(written.get(i, j) == variances.get(i, j));
+}
+
+TEST_CASE("Selected inverse is reset on refactorisation", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    form_sparse(sparse, 10.0);
+    sparse.factorise();
+    sparse.selectedinverse();
+    REQUIRE(sparse.inverted());
+
+    sparse.zero();
+    REQUIRE(!sparse.inverted());
+
+    bool caught = false;
+    try {
+        sparse.getinverse(0, 0);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Factorisation of indefinite matrix throws", "[sparse_matrix]") {
+    sparse_matrix sparse;
+    form_sparse(sparse, -1.0);
+
+    bool caught = false;
+    try {
+        sparse.factorise();
+    } catch (const MatrixInversionFailure&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
@@ -0,0 +1,134 @@
+//============================================================================
+// Name         : test_station_ordering.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <algorithm>
+#include <numeric>
+
+#include "math/dnaordering.hpp"
+#include "testing.hpp"
+
+using namespace dynadjust::math;
+
+namespace {
+
+void connect(vvUINT32& adjacency, const UINT32& a, const UINT32& b) {
+    adjacency.at(a).push_back(b);
+    adjacency.at(b).push_back(a);
+}
+
+// A rows x cols grid of stations, numbered so that neighbouring stations
+// are far apart in the natural order (i.e. a poorly ordered network)
+vvUINT32 scrambled_grid(const UINT32& rows, const UINT32& cols) {
+    const UINT32 n(rows * cols);
+    vUINT32 label(n);
+    for (UINT32 i(0); i < n; ++i) label.at(i) = (i * 7919) % n;
+
+    vvUINT32 adjacency(n);
+    for (UINT32 r(0); r < rows; ++r)
+        for (UINT32 c(0); c < cols; ++c) {
+            if (c + 1 < cols) connect(adjacency, label.at(r * cols + c), label.at(r * cols + c + 1));
+            if (r + 1 < rows) connect(adjacency, label.at(r * cols + c), label.at((r + 1) * cols + c));
+        }
+    return adjacency;
+}
+
+bool is_permutation(const vUINT32& order, const UINT32& n) {
+    vUINT32 sorted(order), identity(n);
+    std::sort(sorted.begin(), sorted.end());
+    std::iota(identity.begin(), identity.end(), 0);
+    return sorted == identity;
+}
+
+vUINT32 natural_order(const UINT32& n) {
+    vUINT32 order(n);
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+}
+
+} // namespace
+
+TEST_CASE("Orderings are permutations", "[ordering]") {
+    vvUINT32 adjacency(scrambled_grid(12, 9));
+    vUINT32 order;
+
+    ReverseCuthillMcKee(adjacency, order);
+    REQUIRE(is_permutation(order, 108));
+
+    MinimumDegree(adjacency, order);
+    REQUIRE(is_permutation(order, 108));
+}
+
+TEST_CASE("Disconnected stations are ordered", "[ordering]") {
+    // two components and an isolated station
+    vvUINT32 adjacency(7);
+    connect(adjacency, 0, 3);
+    connect(adjacency, 3, 5);
+    connect(adjacency, 1, 4);
+    vUINT32 order;
+
+    ReverseCuthillMcKee(adjacency, order);
+    REQUIRE(is_permutation(order, 7));
+
+    MinimumDegree(adjacency, order);
+    REQUIRE(is_permutation(order, 7));
+}
+
+TEST_CASE("Reverse Cuthill-McKee reduces bandwidth", "[ordering]") {
+    vvUINT32 adjacency(scrambled_grid(20, 6));
+    vUINT32 order;
+
+    ReverseCuthillMcKee(adjacency, order);
+
+    // The bandwidth of a 20 x 6 grid ordered across its narrow
+    // dimension is 6
+    REQUIRE(OrderingBandwidth(adjacency, order) <= 7);
+    REQUIRE(OrderingBandwidth(adjacency, order) < OrderingBandwidth(adjacency, natural_order(120)));
+}
+
+TEST_CASE("Minimum degree reduces fill-in", "[ordering]") {
+    vvUINT32 adjacency(scrambled_grid(15, 15));
+    vUINT32 rcm, md;
+
+    ReverseCuthillMcKee(adjacency, rcm);
+    MinimumDegree(adjacency, md);
+
+    const std::size_t natural_blocks(OrderingFactorBlocks(adjacency, natural_order(225)));
+
+    REQUIRE(OrderingFactorBlocks(adjacency, rcm) < natural_blocks);
+    REQUIRE(OrderingFactorBlocks(adjacency, md) < OrderingFactorBlocks(adjacency, rcm));
+}
+
+TEST_CASE("Factor blocks of a tree incur no fill-in", "[ordering]") {
+    // A star network: eliminating the hub first fills the factor,
+    // whereas minimum degree eliminates the leaves first
+    vvUINT32 adjacency(10);
+    for (UINT32 i(1); i < 10; ++i) connect(adjacency, 0, i);
+
+    vUINT32 order;
+    MinimumDegree(adjacency, order);
+
+    // The hub is not eliminated until all but one leaf have been
+    REQUIRE(std::find(order.begin(), order.end(), 0) - order.begin() >= 8);
+    REQUIRE(OrderingFactorBlocks(adjacency, order) == 19);
+    REQUIRE(OrderingFactorBlocks(adjacency, natural_order(10)) == 55);
+}
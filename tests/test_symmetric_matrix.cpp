@@ -0,0 +1,344 @@
+//============================================================================
+// Name         : test_symmetric_matrix.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "math/dnamatrix_symmetric.hpp"
+#include "testing.hpp"
+
+using namespace dynadjust::math;
+
+namespace {
+
+const UINT32 dimension(12);  // 4 stations
+
+// Forms normals for a chain of stations by adding 3x3 station blocks, in
+// the same way as the adjustment (i.e. both triangles are added, and the
+// symmetric form discards the upper triangle)
+template <typename T>
+void form_normals(T& normals) {
+    matrix_2d block(3, 3);
+    UINT32 s, i, j, stn1, stn2;
+    for (s = 0; s < 3; ++s) {
+        stn1 = s * 3;
+        stn2 = (s + 1) * 3;
+        for (i = 0; i < 3; ++i)
+            for (j = 0; j < 3; ++j) block.put(i, j, (i == j ? 4.0 : 0.5) + 0.1 * s);
+
+        normals.blockadd(stn1, stn1, block, 0, 0, 3, 3);
+        normals.blockadd(stn2, stn2, block, 0, 0, 3, 3);
+
+        for (i = 0; i < 3; ++i)
+            for (j = 0; j < 3; ++j) block.put(i, j, -0.25 - 0.01 * (i + j + s));
+
+        normals.blockadd(stn1, stn2, block, 0, 0, 3, 3);
+        normals.blockTadd(stn2, stn1, block, 0, 0, 3, 3);
+    }
+}
+
+template <typename T, typename U>
+bool close(const T& a, const U& b, const double& tolerance) {
+    if (a.rows() != b.rows() || a.columns() != b.columns()) return false;
+    for (UINT32 i(0); i < a.rows(); ++i)
+        for (UINT32 j(0); j < a.columns(); ++j)
+            if (fabs(a.get(i, j) - b.get(i, j)) > tolerance) return false;
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Packed storage holds the lower triangle", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    REQUIRE(normals.elementCount() == dimension * (dimension + 1) / 2);
+    REQUIRE(normals.matrixType() == mtx_lower);
+
+    normals.put(7, 2, 1.5);
+    REQUIRE(normals.get(7, 2) == 1.5);
+    REQUIRE(normals.get(2, 7) == 1.5);
+
+    normals.put(2, 7, -3.0);
+    REQUIRE(normals.get(7, 2) == -3.0);
+
+    // Additive operations discard the upper triangle
+    normals.elementadd(2, 7, 10.0);
+    REQUIRE(normals.get(7, 2) == -3.0);
+    normals.elementadd(7, 2, 10.0);
+    REQUIRE(normals.get(2, 7) == 7.0);
+
+    bool caught = false;
+    try {
+        symmetric_matrix rectangular(3, 4);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Assembly matches dense normals", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    matrix_2d dense(dimension, dimension);
+    form_normals(normals);
+    form_normals(dense);
+
+    REQUIRE(close(normals, dense, 0.0));
+    REQUIRE(close(normals.full(), dense, 0.0));
+    REQUIRE(close(normals.submatrix(3, 6, 6, 3), dense.submatrix(3, 6, 6, 3), 0.0));
+
+    matrix_2d block(3, 3);
+    normals.submatrix(9, 3, &block, 3, 3);
+    REQUIRE(close(block, dense.submatrix(9, 3, 3, 3), 0.0));
+
+    // Copy of a block in the upper triangle is held as its transpose
+    block.put(0, 2, 9.0);
+    normals.copyelements(0, 9, block, 0, 0, 3, 3);
+    dense.copyelements(0, 9, block, 0, 0, 3, 3);
+    for (UINT32 i(0); i < 3; ++i)
+        for (UINT32 j(0); j < 3; ++j) {
+            REQUIRE(normals.get(i, 9 + j) == dense.get(i, 9 + j));
+            REQUIRE(normals.get(9 + j, i) == dense.get(i, 9 + j));
+        }
+
+    normals.zero(3, 3, 3, 3);
+    REQUIRE(normals.get(4, 5) == 0.0);
+    REQUIRE(normals.get(6, 3) != 0.0);
+}
+
+TEST_CASE("Station block assembly matches element assembly", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension), expected(dimension, dimension);
+    double block[9];
+    UINT32 row, col, i, j;
+
+    for (row = 0; row < dimension; row += 3)
+        for (col = 0; col < dimension; col += 3) {
+            for (j = 0; j < 3; ++j)
+                for (i = 0; i < 3; ++i) {
+                    block[i + j * 3] = 1.0 + row + 0.5 * col + 0.1 * i + 0.01 * j;
+                    expected.elementadd(row + i, col + j, block[i + j * 3]);
+                }
+            normals.stationblockadd(row, col, block);
+        }
+
+    REQUIRE(close(normals, expected, 0.0));
+}
+
+TEST_CASE("Inverse and product match dense matrices", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    matrix_2d dense(dimension, dimension);
+    form_normals(normals);
+    form_normals(dense);
+
+    matrix_2d v(dimension, 1), result(dimension, 1), expected(dimension, 1);
+    for (UINT32 i(0); i < dimension; ++i) v.put(i, 0, sin(1.0 + i));
+
+    normals.multiply(v, result);
+    expected.multiply(dense, "N", v, "N");
+    REQUIRE(close(result, expected, 1e-14));
+
+    normals.cholesky_inverse();
+    dense.cholesky_inverse();
+    REQUIRE(close(normals, dense, 1e-14));
+
+    // Scaling, as applied to normals before inversion
+    std::vector<double> scale(dimension);
+    for (UINT32 i(0); i < dimension; ++i) scale[i] = 1.0 / sqrt(normals.get(i, i));
+    normals.diagonalscale(scale);
+    for (UINT32 i(0); i < dimension; ++i) {
+        REQUIRE(fabs(normals.get(i, i) - 1.0) < 1e-14);
+        for (UINT32 j(0); j < i; ++j)
+            REQUIRE(fabs(normals.get(i, j) - dense.get(i, j) * scale[i] * scale[j]) < 1e-14);
+    }
+}
+
+TEST_CASE("Inverse of a singular matrix throws", "[symmetric_matrix]") {
+    symmetric_matrix normals(3, 3);
+    normals.put(0, 0, 1.0);
+    normals.put(1, 0, 1.0);
+    normals.put(1, 1, 1.0);
+    normals.put(2, 2, 1.0);
+
+    bool caught = false;
+    try {
+        normals.cholesky_inverse();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Mixed precision inverse refines the solution", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    matrix_2d dense(dimension, dimension);
+    form_normals(normals);
+    form_normals(dense);
+
+    // Disparate scales, as with station coordinates and scale parameters
+    std::vector<double> scale(dimension);
+    for (UINT32 i(0); i < dimension; ++i) scale[i] = (i % 3 == 0 ? 1.0e4 : 1.0);
+    normals.diagonalscale(scale);
+    for (UINT32 i(0); i < dimension; ++i)
+        for (UINT32 j(0); j < dimension; ++j) dense.put(i, j, dense.get(i, j) * scale[i] * scale[j]);
+
+    matrix_2d b(dimension, 1), x(dimension, 1), expected(dimension, 1);
+    for (UINT32 i(0); i < dimension; ++i) b.put(i, 0, sin(1.0 + i) * scale[i]);
+
+    symmetric_matrix mixed(normals);
+    REQUIRE(mixed.cholesky_inverse_mixed(b, x));
+
+    dense.cholesky_inverse();
+    expected.multiply(dense, "N", b, "N");
+
+    // The solution is refined to double precision...
+    for (UINT32 i(0); i < dimension; ++i)
+        REQUIRE(fabs(x.get(i, 0) - expected.get(i, 0)) <= 1e-12 * fabs(expected.get(i, 0)) + 1e-20);
+
+    // ...whilst the inverse holds single precision
+    for (UINT32 i(0); i < dimension; ++i)
+        for (UINT32 j(0); j <= i; ++j)
+            REQUIRE(fabs(mixed.get(i, j) - dense.get(i, j)) <=
+                    1e-5 * sqrt(fabs(dense.get(i, i) * dense.get(j, j))));
+
+    // Normals too poorly conditioned for single precision are inverted
+    // in double precision
+    symmetric_matrix fallback(normals);
+    REQUIRE(!fallback.cholesky_inverse_mixed(b, x, 1.0));
+    REQUIRE(close(x, expected, 1e-12));
+    for (UINT32 i(0); i < dimension; ++i)
+        for (UINT32 j(0); j <= i; ++j)
+            REQUIRE(fabs(fallback.get(i, j) - dense.get(i, j)) <=
+                    1e-13 * sqrt(fabs(dense.get(i, i) * dense.get(j, j))));
+}
+
+TEST_CASE("Mixed precision inverse is gated on refinement", "[symmetric_matrix]") {
+    // Pairs of strongly correlated parameters, for which the reciprocal
+    // condition number (about 5e-4) is above the floor but too small for
+    // an accurate single precision inverse
+    const double correlation(1.0 - 1.0e-3);
+    symmetric_matrix normals(dimension, dimension);
+    for (UINT32 i(0); i < dimension; i += 2) {
+        normals.put(i, i, 1.0);
+        normals.put(i + 1, i + 1, 1.0);
+        normals.put(i + 1, i, correlation);
+    }
+
+    matrix_2d b(dimension, 1), x(dimension, 1), expected(dimension, 1);
+    for (UINT32 i(0); i < dimension; ++i) b.put(i, 0, cos(1.0 + i));
+
+    symmetric_matrix dense(normals);
+    dense.cholesky_inverse();
+    dense.multiply(b, expected);
+
+    // Refinement converges, so single precision is used...
+    symmetric_matrix mixed(normals);
+    REQUIRE(mixed.cholesky_inverse_mixed(b, x));
+    for (UINT32 i(0); i < dimension; ++i)
+        REQUIRE(fabs(x.get(i, 0) - expected.get(i, 0)) <= 1e-12 * fabs(expected.get(i, 0)) + 1e-12);
+
+    // ...unless the condition is below the floor
+    symmetric_matrix floor(normals);
+    REQUIRE(!floor.cholesky_inverse_mixed(b, x, 1.0e-3));
+    REQUIRE(close(x, expected, 1e-10));
+}
+
+TEST_CASE("Redim retains elements", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    matrix_2d dense(dimension, dimension);
+    form_normals(normals);
+    form_normals(dense);
+
+    normals.redim(dimension - 3, dimension - 3);
+    REQUIRE(normals.elementCount() == (dimension - 3) * (dimension - 2) / 2);
+    REQUIRE(close(normals, dense.submatrix(0, 0, dimension - 3, dimension - 3), 0.0));
+
+    normals.redim(dimension, dimension);
+    REQUIRE(normals.get(dimension - 1, dimension - 1) == 0.0);
+    REQUIRE(normals.get(dimension - 1, dimension - 4) == 0.0);
+    REQUIRE(normals.get(4, 1) == dense.get(4, 1));
+}
+
+TEST_CASE("Mapped file regions are interchangeable with matrix_2d", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    matrix_2d dense(dimension, dimension);
+    form_normals(normals);
+    form_normals(dense);
+    dense.matrixType(mtx_lower);
+
+    REQUIRE(normals.get_size() == dense.get_size());
+
+    // symmetric -> matrix_2d
+    std::vector<char> region(normals.get_size());
+    normals.WriteMappedFileRegion(&region[0]);
+    matrix_2d dense_read(dimension, dimension);
+    dense_read.matrixType(mtx_lower);
+    dense_read.ReadMappedFileRegion(&region[0]);
+    dense_read.fillupper();
+    REQUIRE(close(dense_read, dense, 0.0));
+
+    // matrix_2d -> symmetric
+    std::vector<char> region2(dense.get_size());
+    dense.WriteMappedFileRegion(&region2[0]);
+    symmetric_matrix normals_read(dimension, dimension);
+    normals_read.ReadMappedFileRegion(&region2[0]);
+    REQUIRE(close(normals_read, dense, 0.0));
+}
+
+TEST_CASE("Mapped file regions are wrapped rather than copied", "[symmetric_matrix]") {
+    symmetric_matrix normals(dimension, dimension);
+    form_normals(normals);
+
+    std::shared_ptr<std::vector<double> > region(
+        new std::vector<double>(normals.get_size() / sizeof(double) + 1));
+    normals.WriteMappedFileRegion(region->data());
+
+    symmetric_matrix mapped;
+    mapped.MapFileRegion(region->data(), region);
+    REQUIRE(mapped.mapped());
+    REQUIRE(close(mapped, normals, 0.0));
+
+    // Copies are not mapped, and assignment of the same dimension
+    // writes to the region
+    symmetric_matrix copy(mapped);
+    REQUIRE(!copy.mapped());
+    copy.put(1, 0, -1.0);
+    mapped = copy;
+    REQUIRE(mapped.mapped());
+    symmetric_matrix read;
+    read.ReadMappedFileRegion(region->data());
+    REQUIRE(read.get(0, 1) == -1.0);
+
+    // Changing the dimension copies the elements
+    mapped.redim(dimension + 3, dimension + 3);
+    REQUIRE(!mapped.mapped());
+    REQUIRE(mapped.get(0, 1) == -1.0);
+    REQUIRE(mapped.get(dimension + 2, 0) == 0.0);
+
+    // The region is released once no longer used
+    std::weak_ptr<std::vector<double> > released(region);
+    mapped.MapFileRegion(region->data(), region);
+    region.reset();
+    REQUIRE(!released.expired());
+    mapped.deallocate();
+    REQUIRE(released.expired());
+}
@@ -0,0 +1,244 @@
+//============================================================================
+// Name         : test_task_graph.cpp
+// Author       : Roger Fraser
+// Contributors :
+// Copyright    : Copyright 2017-2025 Geoscience Australia
+//
+//                Licensed under the Apache License, Version 2.0 (the "License");
+//                you may not use this file except in compliance with the License.
+//                You may obtain a copy of the License at
+//
+//                http ://www.apache.org/licenses/LICENSE-2.0
+//
+//                Unless required by applicable law or agreed to in writing, software
+//                distributed under the License is distributed on an "AS IS" BASIS,
+//                WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//                See the License for the specific language governing permissions and
+//                limitations under the License.
+//
+// Description  : Unit tests
+//============================================================================
+
+#define TESTING_MAIN
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "thread/dnathreading.hpp"
+#include "testing.hpp"
+
+namespace {
+
+const UINT32 blocks(40);
+
+// Forms the tasks of a phased adjustment, i.e. forward and reverse runs
+// through the blocks, and a combination of each intermediate block once
+// both runs have passed it.  Each task records its position in the order
+// of completion.
+void form_phased_tasks(task_graph& graph, std::vector<UINT32>& forward, std::vector<UINT32>& reverse,
+                       std::vector<UINT32>& combine, std::atomic<UINT32>& sequence) {
+    forward.assign(blocks, 0);
+    reverse.assign(blocks, 0);
+    combine.assign(blocks, 0);
+
+    std::vector<UINT32> f(blocks), r(blocks);
+    for (UINT32 b(0); b < blocks; ++b) {
+        f[b] = graph.add_task([&forward, &sequence, b]() { forward[b] = ++sequence; });
+        r[b] = graph.add_task([&reverse, &sequence, b]() { reverse[b] = ++sequence; });
+    }
+    for (UINT32 b(1); b < blocks; ++b) {
+        graph.add_dependency(f[b - 1], f[b]);
+        graph.add_dependency(r[b], r[b - 1]);
+    }
+    for (UINT32 b(1); b < blocks - 1; ++b) {
+        const UINT32 c(graph.add_task([&combine, &sequence, b]() { combine[b] = ++sequence; }));
+        graph.add_dependency(f[b], c);
+        graph.add_dependency(r[b], c);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Tasks run after their dependencies", "[task_graph]") {
+    const UINT32 threads[] = {1, 2, 4, 16};
+    for (const UINT32& t : threads) {
+        task_graph graph;
+        std::vector<UINT32> forward, reverse, combine;
+        std::atomic<UINT32> sequence(0);
+        form_phased_tasks(graph, forward, reverse, combine, sequence);
+
+        // The graph may be run more than once
+        for (UINT32 run(0); run < 2; ++run) {
+            sequence = 0;
+            graph.run(t);
+            REQUIRE(sequence == graph.size());
+
+            for (UINT32 b(1); b < blocks; ++b) {
+                REQUIRE(forward[b] > forward[b - 1]);
+                REQUIRE(reverse[b - 1] > reverse[b]);
+            }
+            for (UINT32 b(1); b < blocks - 1; ++b) {
+                REQUIRE(combine[b] > forward[b]);
+                REQUIRE(combine[b] > reverse[b]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Idle workers steal ready tasks", "[task_graph]") {
+    // A single task readies many independent tasks on one worker
+    task_graph graph;
+    std::mutex mutex;
+    std::vector<UINT32> workers;
+    const UINT32 first(graph.add_task([]() {}));
+    for (UINT32 i(0); i < 64; ++i) {
+        const UINT32 t(graph.add_task([&mutex, &workers]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::lock_guard<std::mutex> lock(mutex);
+            workers.push_back(task_graph::worker_id());
+        }));
+        graph.add_dependency(first, t);
+    }
+
+    graph.run(4);
+    REQUIRE(workers.size() == 64);
+    sort(workers.begin(), workers.end());
+    REQUIRE(workers.front() != workers.back());
+}
+
+TEST_CASE("Worker threads are retained between runs", "[task_graph]") {
+    task_graph graph;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    bool in_task(true);
+    for (UINT32 i(0); i < 16; ++i)
+        graph.add_task([&mutex, &threads, &in_task]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            in_task = in_task && task_graph::in_task();
+        });
+
+    for (UINT32 run(0); run < 20; ++run) graph.run(run % 2 == 0 ? 4 : 2);
+    REQUIRE(threads.size() <= 4);
+    REQUIRE(in_task);
+    REQUIRE(!task_graph::in_task());
+}
+
+TEST_CASE("Exceptions stop the graph and are re-thrown", "[task_graph]") {
+    task_graph graph;
+    std::atomic<UINT32> count(0);
+    UINT32 previous(graph.add_task([&count]() { ++count; }));
+    for (UINT32 i(1); i < 100; ++i) {
+        const UINT32 t(graph.add_task([&count, i]() {
+            if (i == 10) throw std::runtime_error("failed");
+            ++count;
+        }));
+        graph.add_dependency(previous, t);
+        previous = t;
+    }
+
+    bool caught(false);
+    try {
+        graph.run(3);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+    REQUIRE(count == 10);
+}
+
+TEST_CASE("Cancellation stops the graph", "[task_graph]") {
+    task_graph graph;
+    std::atomic<UINT32> count(0);
+    for (UINT32 i(0); i < 100; ++i) graph.add_task([&count]() { ++count; });
+
+    graph.run(2, [&count]() { return count >= 5; });
+    REQUIRE(count >= 5);
+    REQUIRE(count < 100);
+}
+
+TEST_CASE("Cyclic dependencies are rejected", "[task_graph]") {
+    task_graph graph;
+    const UINT32 a(graph.add_task([]() {}));
+    const UINT32 b(graph.add_task([]() {}));
+    graph.add_dependency(a, b);
+    graph.add_dependency(b, a);
+
+    bool caught(false);
+    try {
+        graph.run(2);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Pipelined tasks run in order of submission", "[io_pipeline]") {
+    std::vector<UINT32> order;
+    {
+        io_pipeline pipeline(2);
+        for (UINT32 i(0); i < 50; ++i)
+            pipeline.submit(i % 5, [&order, i]() { order.push_back(i); });
+        pipeline.wait(3);
+        REQUIRE(order.size() >= 49);
+        pipeline.wait_all();
+        REQUIRE(pipeline.empty());
+        REQUIRE(order.size() == 50);
+
+        // Tasks submitted after wait_all() still run
+        pipeline.submit(0, [&order]() { order.push_back(50); });
+    }
+    // The destructor finishes outstanding tasks
+    REQUIRE(order.size() == 51);
+    for (UINT32 i(0); i < 51; ++i) REQUIRE(order[i] == i);
+}
+
+TEST_CASE("Pipelined tasks are bounded in flight", "[io_pipeline]") {
+    io_pipeline pipeline(3);
+    std::atomic<bool> release(false);
+    std::atomic<UINT32> submitted(0);
+
+    std::thread producer([&pipeline, &release, &submitted]() {
+        for (UINT32 i(0); i < 5; ++i) {
+            pipeline.submit(i, [&release]() {
+                while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+            ++submitted;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(submitted == 3);
+    release = true;
+    producer.join();
+    pipeline.wait_all();
+    REQUIRE(submitted == 5);
+}
+
+TEST_CASE("Pipelined exceptions are re-thrown on wait", "[io_pipeline]") {
+    io_pipeline pipeline;
+    std::atomic<UINT32> count(0);
+    pipeline.submit(0, [&count]() { ++count; });
+    pipeline.submit(1, []() { throw std::runtime_error("failed"); });
+
+    bool caught(false);
+    try {
+        pipeline.wait(1);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+    REQUIRE(count == 1);
+
+    // The pipeline is usable once the error has been reported
+    pipeline.submit(2, [&count]() { ++count; });
+    pipeline.wait_all();
+    REQUIRE(count == 2);
+}